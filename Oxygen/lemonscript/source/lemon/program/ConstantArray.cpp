@@ -41,65 +41,15 @@ namespace lemon
 	void ConstantArray::serializeData(VectorBinarySerializer& serializer)
 	{
 		serializer.serializeArraySize(mData);
-		if (serializer.isReading())
-		{
-			switch (mElementDataType->mBytes)
-			{
-				case 1:
-				{
-					for (uint64& value : mData)
-						value = (uint64)serializer.read<uint8>();
-					break;
-				}
-				case 2:
-				{
-					for (uint64& value : mData)
-						value = (uint64)serializer.read<uint16>();
-					break;
-				}
-				case 4:
-				{
-					for (uint64& value : mData)
-						value = (uint64)serializer.read<uint32>();
-					break;
-				}
-				case 8:
-				{
-					for (uint64& value : mData)
-						value = serializer.read<uint64>();
-					break;
-				}
-			}
-		}
-		else
+		if (mData.empty())
+			return;
+
+		switch (mElementDataType->mBytes)
 		{
-			switch (mElementDataType->mBytes)
-			{
-				case 1:
-				{
-					for (uint64& value : mData)
-						serializer.write<uint8>((uint8)value);
-					break;
-				}
-				case 2:
-				{
-					for (uint64& value : mData)
-						serializer.write<uint16>((uint16)value);
-					break;
-				}
-				case 4:
-				{
-					for (uint64& value : mData)
-						serializer.write<uint32>((uint32)value);
-					break;
-				}
-				case 8:
-				{
-					for (uint64& value : mData)
-						serializer.write(value);
-					break;
-				}
-			}
+			case 1:  serializer.serializeArrayAs<uint8>(&mData[0], mData.size());		break;
+			case 2:  serializer.serializeArrayAs<uint16>(&mData[0], mData.size());	break;
+			case 4:  serializer.serializeArrayAs<uint32>(&mData[0], mData.size());	break;
+			case 8:  serializer.serializeArray(&mData[0], mData.size());			break;
 		}
 	}
 }
@@ -133,6 +133,7 @@ namespace lemon
 		mRuntimeFunctionsBySignature.clear();
 		mRuntimeOpcodesPool.clear();
 		mStrings.clear();
+		mRuntimeStrings.clear();
 
 		if (nullptr != mProgram)
 		{
@@ -232,19 +233,55 @@ namespace lemon
 
 	bool Runtime::hasStringWithKey(uint64 key) const
 	{
-		return (nullptr != mStrings.getStringByHash(key));
+		return (nullptr != resolveStringByKey(key));
 	}
 
 	const FlyweightString* Runtime::resolveStringByKey(uint64 key) const
 	{
-		return mStrings.getStringByHash(key);
+		const FlyweightString* str = mStrings.getStringByHash(key);
+		return (nullptr != str) ? str : mRuntimeStrings.getStringByHash(key);
 	}
 
 	uint64 Runtime::addString(std::string_view str)
 	{
-		const FlyweightString flyweightString(str);
-		mStrings.addString(flyweightString);
-		return flyweightString.getHash();
+		// No need to store a copy if it's one of the literals anyways
+		const uint64 hash = str.empty() ? 0 : rmx::getMurmur2_64(str);
+		if (nullptr == mStrings.getStringByHash(hash))
+		{
+			mRuntimeStrings.addString(hash, str);
+		}
+		return hash;
+	}
+
+	template<typename FUNCTION>
+	void Runtime::forEachPotentialStringReference(FUNCTION function) const
+	{
+		// Strings are only represented by their hashes in script variables, so any value that matches a string's hash counts as a reference to it
+		function((const uint64*)mGlobalVariables.data(), mGlobalVariables.size());
+		for (const ControlFlow* controlFlow : mControlFlows)
+		{
+			function((const uint64*)controlFlow->mValueStackStart, controlFlow->getValueStackSize());
+			function((const uint64*)controlFlow->mLocalVariablesBuffer, controlFlow->mLocalVariablesSize);
+		}
+		if (nullptr != mProgram)
+		{
+			for (const Variable* variable : mProgram->getGlobalVariables())
+			{
+				if (variable->getType() == Variable::Type::EXTERNAL && variable->getDataType()->mBytes == 8)
+				{
+					function((const uint64*)static_cast<const ExternalVariable*>(variable)->mPointer, 1);
+				}
+			}
+		}
+	}
+
+	void Runtime::collectUnusedStrings()
+	{
+		if (!mRuntimeStrings.shouldCollectGarbage())
+			return;
+
+		forEachPotentialStringReference([&](const uint64* values, size_t count) { mRuntimeStrings.markReferenced(values, count); });
+		mRuntimeStrings.collectGarbage();
 	}
 
 	int64 Runtime::getGlobalVariableValue(const Variable& variable)
@@ -593,6 +630,7 @@ namespace lemon
 		// Format version history:
 		//  - 0x00 = First version, no signature yet
 		//  - 0x01 = Added signature and version number + serialize global variable names
+		//  - 0x02 = Added strings created at runtime that are referenced by the state
 
 		if (nullptr == mProgram)
 		{
@@ -613,7 +651,7 @@ namespace lemon
 
 		// Signature and version number
 		const uint32 SIGNATURE = *(uint32*)"LMN|";
-		uint16 version = 0x01;
+		uint16 version = 0x02;
 		if (serializer.isReading())
 		{
 			const uint32 signature = *(const uint32*)serializer.peek();
@@ -676,7 +714,7 @@ namespace lemon
 				}
 
 				// Make corrections to the program counters for the case that the call points changed
-				for (uint16 i = 0; i < controlFlow.mCallStack.count - 1; ++i)
+				for (uint16 i = 0; (size_t)(i+1) < controlFlow.mCallStack.count; ++i)
 				{
 					const size_t opcodeIndex = (size_t)matchCallerProgramCounter(*mProgram, controlFlow.mCallStack[i], controlFlow.mCallStack[i + 1]);
 					controlFlow.mCallStack[i].mProgramCounter = controlFlow.mCallStack[i].mRuntimeFunction->translateToRuntimeProgramCounter(opcodeIndex);
@@ -780,6 +818,40 @@ namespace lemon
 			}
 		}
 
+		// Serialize referenced runtime strings, as they might have been reclaimed in the meantime when loading this state again
+		if (version >= 0x02)
+		{
+			if (serializer.isReading())
+			{
+				const size_t numStrings = (size_t)serializer.read<uint32>();
+				for (size_t i = 0; i < numStrings; ++i)
+				{
+					addString(serializer.readStringView());
+				}
+			}
+			else
+			{
+				std::vector<const FlyweightString*> referencedStrings;
+				forEachPotentialStringReference([&](const uint64* values, size_t count)
+				{
+					for (size_t k = 0; k < count; ++k)
+					{
+						const FlyweightString* str = mRuntimeStrings.getStringByHash(values[k]);
+						if (nullptr != str && std::find(referencedStrings.begin(), referencedStrings.end(), str) == referencedStrings.end())
+						{
+							referencedStrings.push_back(str);
+						}
+					}
+				});
+
+				serializer.writeAs<uint32>(referencedStrings.size());
+				for (const FlyweightString* str : referencedStrings)
+				{
+					serializer.write(str->getString());
+				}
+			}
+		}
+
 		// Done
 		return true;
 	}
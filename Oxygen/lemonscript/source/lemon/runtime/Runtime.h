@@ -10,6 +10,7 @@
 
 #include "lemon/program/StringRef.h"
 #include "lemon/runtime/ControlFlow.h"
+#include "lemon/runtime/RuntimeStringPool.h"
 
 
 namespace lemon
@@ -132,10 +133,15 @@ namespace lemon
 		bool hasStringWithKey(uint64 key) const;
 		const FlyweightString* resolveStringByKey(uint64 key) const;
 		uint64 addString(std::string_view str);
+		inline const RuntimeStringPool& getRuntimeStrings() const  { return mRuntimeStrings; }
+
+		// Reclaims memory of strings created at runtime that are not referenced any more; call this only in between frames, when script execution yielded
+		void collectUnusedStrings();
 
 		int64 getGlobalVariableValue(const Variable& variable);
 		void setGlobalVariableValue(const Variable& variable, int64 value);
 		int64* accessGlobalVariableValue(const Variable& variable);
+		inline const std::vector<int64>& getGlobalVariableValues() const  { return mGlobalVariables; }
 
 		inline const ControlFlow& getMainControlFlow() const  { return *mControlFlows[0]; }
 		inline const ControlFlow& getSelectedControlFlow() const  { return *mSelectedControlFlow; }
@@ -153,6 +159,9 @@ namespace lemon
 
 		bool serializeState(VectorBinarySerializer& serializer, std::string* outError = nullptr);
 
+	private:
+		template<typename FUNCTION> void forEachPotentialStringReference(FUNCTION function) const;
+
 	private:
 		inline static ControlFlow* mActiveControlFlow = nullptr;
 		inline static const Environment* mActiveEnvironment = nullptr;
@@ -169,7 +178,8 @@ namespace lemon
 
 		std::vector<int64> mGlobalVariables;
 
-		StringLookup mStrings;
+		StringLookup mStrings;				// String literals, these stay valid all the time
+		RuntimeStringPool mRuntimeStrings;	// Strings created at runtime
 
 		// TODO: Add functions to create / destroy control flows, otherwise we're stuck with just the main control flow
 		std::vector<ControlFlow*> mControlFlows;		// Contains at least one control flow at all times = the main control flow at index 0
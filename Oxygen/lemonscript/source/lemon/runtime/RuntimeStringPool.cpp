@@ -0,0 +1,191 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "lemon/pch.h"
+#include "lemon/runtime/RuntimeStringPool.h"
+
+
+namespace lemon
+{
+	namespace
+	{
+		const size_t PAGE_SIZE = 0x10000;
+		const size_t MIN_BYTES_FOR_COLLECTION = 0x20000;	// Don't bother collecting below this
+	}
+
+
+	uint8* RuntimeStringPool::Arena::allocateMemory(size_t bytes)
+	{
+		while (mCurrentPage < mPages.size() && mPageOffset + bytes > mPages[mCurrentPage].size())
+		{
+			++mCurrentPage;
+			mPageOffset = 0;
+		}
+		if (mCurrentPage >= mPages.size())
+		{
+			// Very long strings get a page of their own
+			mPages.emplace_back(std::max(bytes, PAGE_SIZE));
+			mCurrentPage = mPages.size() - 1;
+			mPageOffset = 0;
+		}
+
+		uint8* pointer = &mPages[mCurrentPage][mPageOffset];
+		mPageOffset += bytes;
+		mUsedBytes += bytes;
+		return pointer;
+	}
+
+	void RuntimeStringPool::Arena::reset()
+	{
+		mCurrentPage = 0;
+		mPageOffset = 0;
+		mUsedBytes = 0;
+	}
+
+
+	void RuntimeStringPool::clear()
+	{
+		mArenas[0].reset();
+		mArenas[1].reset();
+		mActiveArena = 0;
+		mSurvivingBytes = 0;
+		std::fill(mTable.begin(), mTable.end(), nullptr);
+		mNumEntries = 0;
+	}
+
+	const FlyweightString* RuntimeStringPool::getStringByHash(uint64 hash) const
+	{
+		const Entry* entry = findEntry(hash);
+		if (nullptr == entry)
+			return nullptr;
+
+		entry->mLastUsedGeneration = mGeneration;
+		return &entry->mString;
+	}
+
+	void RuntimeStringPool::addString(uint64 hash, std::string_view str)
+	{
+		Entry* entry = findEntry(hash);
+		if (nullptr == entry)
+		{
+			// Grow the table to keep the load factor at 50% at most
+			if ((mNumEntries + 1) * 2 > mTable.size())
+			{
+				std::vector<Entry*> oldTable;
+				oldTable.swap(mTable);
+				mTable.resize(std::max<size_t>(oldTable.size() * 2, 0x100), nullptr);
+				mNumEntries = 0;
+				for (Entry* oldEntry : oldTable)
+				{
+					if (nullptr != oldEntry)
+						insertEntry(*oldEntry);
+				}
+			}
+
+			entry = &createEntry(mArenas[mActiveArena], hash, str);
+			insertEntry(*entry);
+		}
+		entry->mLastUsedGeneration = mGeneration;
+	}
+
+	bool RuntimeStringPool::shouldCollectGarbage() const
+	{
+		// Collect only once the strings created since the last collection outweigh the ones that survived it, so the effort stays proportional to the garbage
+		const size_t usedBytes = mArenas[mActiveArena].mUsedBytes;
+		return (usedBytes >= MIN_BYTES_FOR_COLLECTION && usedBytes >= mSurvivingBytes * 2);
+	}
+
+	void RuntimeStringPool::markReferenced(const uint64* values, size_t count)
+	{
+		if (mNumEntries == 0)
+			return;
+
+		for (size_t k = 0; k < count; ++k)
+		{
+			const Entry* entry = findEntry(values[k]);
+			if (nullptr != entry)
+				entry->mLastUsedGeneration = mGeneration;
+		}
+	}
+
+	void RuntimeStringPool::collectGarbage()
+	{
+		// Copy all entries of the current generation over to the other arena, the rest gets dropped
+		Arena& oldArena = mArenas[mActiveArena];
+		mActiveArena = 1 - mActiveArena;
+		Arena& newArena = mArenas[mActiveArena];
+		newArena.reset();
+
+		mSurvivors.clear();
+		for (Entry*& entry : mTable)
+		{
+			if (nullptr != entry)
+			{
+				if (entry->mLastUsedGeneration == mGeneration)
+				{
+					mSurvivors.push_back(&createEntry(newArena, entry->mFlyweightEntry.mHash, entry->mFlyweightEntry.mString));
+				}
+				entry = nullptr;
+			}
+		}
+
+		mNumEntries = 0;
+		for (Entry* entry : mSurvivors)
+		{
+			entry->mLastUsedGeneration = mGeneration;
+			insertEntry(*entry);
+		}
+		oldArena.reset();
+		mSurvivingBytes = newArena.mUsedBytes;
+
+		// Entries only survive the next collection if they get used or referenced again until then
+		++mGeneration;
+	}
+
+	RuntimeStringPool::Entry* RuntimeStringPool::findEntry(uint64 hash) const
+	{
+		if (mTable.empty())
+			return nullptr;
+
+		const size_t mask = mTable.size() - 1;
+		for (size_t index = (size_t)hash & mask; nullptr != mTable[index]; index = (index + 1) & mask)
+		{
+			if (mTable[index]->mFlyweightEntry.mHash == hash)
+				return mTable[index];
+		}
+		return nullptr;
+	}
+
+	RuntimeStringPool::Entry& RuntimeStringPool::createEntry(Arena& arena, uint64 hash, std::string_view str)
+	{
+		// Allocate enough memory to hold both the Entry struct and the string content, rounded up to keep the next entry aligned
+		const size_t requiredSize = (sizeof(Entry) + str.length() + 7) & ~(size_t)0x07;
+		uint8* entryPointer = arena.allocateMemory(requiredSize);
+		Entry* entry = new (static_cast<void*>(entryPointer)) Entry();
+		char* contentPointer = (char*)(entryPointer + sizeof(Entry));
+		memcpy(contentPointer, str.data(), str.length());
+
+		entry->mFlyweightEntry.mHash = hash;
+		entry->mFlyweightEntry.mString = std::string_view(contentPointer, str.length());
+		entry->mString = FlyweightString(entry->mFlyweightEntry);
+		return *entry;
+	}
+
+	void RuntimeStringPool::insertEntry(Entry& entry)
+	{
+		const size_t mask = mTable.size() - 1;
+		size_t index = (size_t)entry.mFlyweightEntry.mHash & mask;
+		while (nullptr != mTable[index])
+		{
+			index = (index + 1) & mask;
+		}
+		mTable[index] = &entry;
+		++mNumEntries;
+	}
+
+}
@@ -0,0 +1,76 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "lemon/utility/FlyweightString.h"
+
+
+namespace lemon
+{
+
+	// Storage for strings created at runtime, e.g. by "stringformat", "substring" or string concatenation
+	//  - Unlike string literals, these are not added to the global flyweight strings, as that would never free them again
+	//  - Strings that were neither used nor referenced since the last garbage collection get reclaimed by it
+	//  - Pointers returned by "getStringByHash" are only valid until the next garbage collection
+	//  - Hashes of reclaimed strings resolve to null, callers have to handle that like any other unknown string
+	//    -> This can happen for hashes stored outside of what the runtime scans, e.g. in emulated RAM of an older save state
+	class API_EXPORT RuntimeStringPool
+	{
+	public:
+		inline size_t size() const  { return mNumEntries; }
+		inline size_t getUsedMemory() const  { return mArenas[0].mUsedBytes + mArenas[1].mUsedBytes; }
+
+		void clear();
+
+		const FlyweightString* getStringByHash(uint64 hash) const;
+		void addString(uint64 hash, std::string_view str);
+
+		// Garbage collection in three steps: check if it's needed at all, then mark all referenced strings, and finally reclaim everything else
+		bool shouldCollectGarbage() const;
+		void markReferenced(const uint64* values, size_t count);
+		void collectGarbage();
+
+	private:
+		struct Entry
+		{
+			detail::FlyweightStringManager::Entry mFlyweightEntry;	// The string's characters directly follow the entry in memory
+			FlyweightString mString;
+			mutable uint32 mLastUsedGeneration = 0;
+		};
+
+		// Memory for entries and their strings; pages are kept when resetting, so that there's no reallocations in the long run
+		struct Arena
+		{
+			std::vector<std::vector<uint8>> mPages;
+			size_t mCurrentPage = 0;
+			size_t mPageOffset = 0;
+			size_t mUsedBytes = 0;
+
+			uint8* allocateMemory(size_t bytes);
+			void reset();
+		};
+
+	private:
+		Entry* findEntry(uint64 hash) const;
+		Entry& createEntry(Arena& arena, uint64 hash, std::string_view str);
+		void insertEntry(Entry& entry);
+
+	private:
+		Arena mArenas[2];		// Strings get copied between the two on garbage collection
+		size_t mActiveArena = 0;
+		size_t mSurvivingBytes = 0;
+
+		std::vector<Entry*> mTable;		// Open addressing hash table with linear probing, size is always a power of two
+		size_t mNumEntries = 0;
+		std::vector<Entry*> mSurvivors;	// Only used during garbage collection, kept as a member to avoid reallocations
+
+		uint32 mGeneration = 1;
+	};
+
+}
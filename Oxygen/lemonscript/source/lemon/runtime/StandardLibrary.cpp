@@ -110,6 +110,13 @@ namespace
 		char mBuffer[0x100] = { 0 };
 		int mLength = 0;
 	};
+
+	lemon::StringRef createRuntimeString(lemon::Runtime& runtime, std::string_view str)
+	{
+		// Strings created at runtime are not part of the global flyweight strings, so the result has to use the runtime's own entry
+		const lemon::FlyweightString* storedString = runtime.resolveStringByKey(runtime.addString(str));
+		return (nullptr == storedString) ? lemon::StringRef() : lemon::StringRef(*storedString);
+	}
 }
 
 
@@ -148,7 +155,7 @@ namespace lemon
 			result.clear();
 			result.addString(str1.getStringRef());
 			result.addString(str2.getStringRef());
-			return StringRef(runtime->addString(std::string_view(result.mBuffer, result.mLength)));
+			return createRuntimeString(*runtime, std::string_view(result.mBuffer, result.mLength));
 		}
 
 		bool string_operator_less(StringRef str1, StringRef str2)
@@ -349,7 +356,7 @@ namespace lemon
 				}
 			}
 
-			return StringRef(runtime->addString(std::string_view(result.mBuffer, result.mLength)));
+			return createRuntimeString(*runtime, std::string_view(result.mBuffer, result.mLength));
 		}
 
 		StringRef stringformat1(StringRef format, uint64 arg1)
@@ -43,6 +43,7 @@ namespace lemon
 		inline FlyweightString(std::string_view str) { set(str); }
 		inline FlyweightString(const std::string& str) { set(str); }
 		inline FlyweightString(const FlyweightString& other) : mEntry(other.mEntry) {}
+		inline explicit FlyweightString(detail::FlyweightStringManager::Entry& entry) : mEntry(&entry) {}	// For entries not owned by the manager, see "RuntimeStringPool"
 
 		inline bool isValid() const  { return (nullptr != mEntry); }
 		inline uint64 getHash() const  { return (nullptr != mEntry) ? mEntry->mHash : 0; }
@@ -0,0 +1,180 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "netcorebench/pch.h"
+#include "netcorebench/BenchClient.h"
+
+
+BenchClient::BenchClient(const BenchSettings& settings, int clientIndex, bool useTCP) :
+	mSettings(settings),
+	mClientIndex(clientIndex),
+	mConnectionManager(useTCP ? nullptr : &mUDPSocket, nullptr, *this, network::HIGHLEVEL_PROTOCOL_VERSION_RANGE)
+{
+	mConnectionManager.mDebugSettings.mSendingPacketLoss = settings.mPacketLoss;
+	mConnectionManager.mDebugSettings.mReceivingPacketLoss = settings.mPacketLoss;
+	mDownloadFilename = settings.mDownloadDirectory + String(0, "/client_%d.bin", clientIndex).toStdWString();
+}
+
+bool BenchClient::startup(const SocketAddress& serverAddress)
+{
+	if (mConnectionManager.hasUDPSocket())
+	{
+		if (!mUDPSocket.bindToAnyPort())
+			RMX_ERROR("Socket bind to any port failed", return false);
+	}
+	return mServerConnection.startConnectTo(mConnectionManager, serverAddress, getCurrentTimestamp());
+}
+
+void BenchClient::startMeasurement(size_t expectedLatencies)
+{
+	// Reserve space for the latencies upfront, so that collecting them does not distort the allocation count
+	mResults = Results();
+	mResults.mLatencies.reserve(expectedLatencies);
+	mDownloadsEnabled = true;
+}
+
+void BenchClient::update()
+{
+	updateReceivePackets(mConnectionManager);
+
+	const uint64 currentTimestamp = getCurrentTimestamp();
+	mConnectionManager.updateConnections(currentTimestamp);
+
+	if (mServerConnection.getState() != NetConnection::State::CONNECTED)
+		return;
+
+	updateGhostSync(currentTimestamp);
+	updateDownload(currentTimestamp);
+}
+
+bool BenchClient::onReceivedPacket(ReceivedPacketEvaluation& evaluation)
+{
+	switch (evaluation.mPacketType)
+	{
+		case network::ChannelMessagePacket::PACKET_TYPE:
+		{
+			network::ChannelMessagePacket packet;
+			if (!evaluation.readPacket(packet))
+				return false;
+
+			if (packet.mMessageType != bench::GHOSTSYNC_MESSAGE_TYPE || packet.mMessageVersion != bench::GHOSTSYNC_MESSAGE_VERSION)
+				return false;
+
+			// All clients run in the same process, so the sending client's timestamp can be compared directly
+			VectorBinarySerializer serializer(true, packet.mMessage);
+			const uint64 sendTimestamp = serializer.read<uint64>();
+			if (serializer.hasError())
+				return false;
+
+			++mResults.mMessagesReceived;
+			mResults.mLatencies.push_back((uint32)std::min<uint64>(bench::getMicroseconds() - sendTimestamp, 0xffffffff));
+			return true;
+		}
+
+		case network::FileTransferPiecePacket::PACKET_TYPE:
+		{
+			return mFileDownloader.onReceivedPacket(evaluation);
+		}
+	}
+	return false;
+}
+
+void BenchClient::updateGhostSync(uint64 currentTimestamp)
+{
+	if (!mJoinedChannel)
+	{
+		switch (mJoinChannelRequest.getState())
+		{
+			case highlevel::RequestBase::State::NONE:
+			{
+				mJoinChannelRequest.mQuery.mChannelHash = bench::getChannelHash(mClientIndex % std::max(mSettings.mNumChannels, 1));
+				mJoinChannelRequest.mQuery.mChannelName = String(0, "netcorebench-ghostsync-%d", mClientIndex % std::max(mSettings.mNumChannels, 1)).toStdString();
+				mServerConnection.sendRequest(mJoinChannelRequest);
+				break;
+			}
+
+			case highlevel::RequestBase::State::SUCCESS:
+			{
+				mJoinedChannel = mJoinChannelRequest.mResponse.mSuccessful;
+				break;
+			}
+
+			default:
+				break;
+		}
+		return;
+	}
+
+	if (mSettings.mMessagesPerSecond <= 0)
+		return;
+	if (currentTimestamp < mLastMessageTimestamp + 1000 / mSettings.mMessagesPerSecond)
+		return;
+	mLastMessageTimestamp = currentTimestamp;
+
+	// Build a message of the same size as the one sent by the game's ghost sync
+	network::BroadcastChannelMessagePacket& packet = mBroadcastChannelMessagePacket;
+	packet.mMessage.clear();
+	VectorBinarySerializer serializer(false, packet.mMessage);
+	serializer.write(bench::getMicroseconds());
+	serializer.writeAs<uint8>(bench::GHOSTSYNC_FRAMES_PER_MESSAGE);
+	for (size_t k = 0; k < bench::GHOSTSYNC_FRAMES_PER_MESSAGE * bench::GHOSTSYNC_BYTES_PER_FRAME; ++k)
+	{
+		serializer.writeAs<uint8>(k + mResults.mMessagesSent);
+	}
+
+	packet.mIsReplicatedData = false;
+	packet.mChannelHash = mJoinChannelRequest.mQuery.mChannelHash;
+	packet.mMessageType = bench::GHOSTSYNC_MESSAGE_TYPE;
+	packet.mMessageVersion = bench::GHOSTSYNC_MESSAGE_VERSION;
+	if (mServerConnection.sendPacket(packet, NetConnection::SendFlags::UNRELIABLE))
+	{
+		++mResults.mMessagesSent;
+	}
+}
+
+void BenchClient::updateDownload(uint64 currentTimestamp)
+{
+	mFileDownloader.updateDownload(currentTimestamp);
+	if (mFileDownloader.isRunning())
+		return;
+
+	if (mDownloadsStarted > mDownloadsFinished)
+	{
+		++mDownloadsFinished;
+		if (mFileDownloader.getState() == FileDownloader::State::COMPLETED && verifyDownloadedFile())
+		{
+			++mResults.mDownloadsCompleted;
+			mResults.mBytesDownloaded += mFileDownloader.getFileSize();
+		}
+		else
+		{
+			++mResults.mDownloadErrors;
+		}
+		rmx::FileIO::removeFile(mDownloadFilename);
+	}
+
+	if (!mDownloadsEnabled || mDownloadsStarted >= (uint32)mSettings.mNumDownloads)
+		return;
+
+	++mDownloadsStarted;
+	mFileDownloader.startDownload(mServerConnection, "netcorebench/download.bin", mDownloadFilename, currentTimestamp);
+}
+
+bool BenchClient::verifyDownloadedFile() const
+{
+	std::vector<uint8> content;
+	if (!rmx::FileIO::readFile(mDownloadFilename, content) || content.size() != (size_t)mSettings.mDownloadSize)
+		return false;
+
+	for (uint32 offset = 0; offset < (uint32)content.size(); ++offset)
+	{
+		if (content[offset] != bench::getFileByte(offset))
+			return false;
+	}
+	return true;
+}
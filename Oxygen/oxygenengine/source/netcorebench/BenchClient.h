@@ -0,0 +1,73 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "netcorebench/BenchShared.h"
+
+
+// Simulated game client, sending ghost sync messages and downloading files
+class BenchClient : public ServerClientBase
+{
+public:
+	struct Results
+	{
+		uint64 mMessagesSent = 0;
+		uint64 mMessagesReceived = 0;
+		std::vector<uint32> mLatencies;		// Ghost sync message latencies from sending client to receiving client, in microseconds
+		uint64 mBytesDownloaded = 0;
+		uint32 mDownloadsCompleted = 0;
+		uint32 mDownloadErrors = 0;
+	};
+
+public:
+	BenchClient(const BenchSettings& settings, int clientIndex, bool useTCP);
+
+	bool startup(const SocketAddress& serverAddress);
+	void startMeasurement(size_t expectedLatencies);
+	void update();
+
+	inline bool isReady() const  { return mServerConnection.getState() == NetConnection::State::CONNECTED && mJoinedChannel; }
+	inline const NetConnection& getServerConnection() const  { return mServerConnection; }
+
+	inline Results& getResults()  { return mResults; }
+
+protected:
+	NetConnection* createNetConnection(ConnectionManager& connectionManager, const SocketAddress& senderAddress) override  { return nullptr; }
+	void destroyNetConnection(NetConnection& connection) override {}
+
+	bool onReceivedPacket(ReceivedPacketEvaluation& evaluation) override;
+
+private:
+	void updateGhostSync(uint64 currentTimestamp);
+	void updateDownload(uint64 currentTimestamp);
+	bool verifyDownloadedFile() const;
+
+private:
+	const BenchSettings& mSettings;
+	const int mClientIndex;
+
+	UDPSocket mUDPSocket;
+	ConnectionManager mConnectionManager;
+	NetConnection mServerConnection;
+
+	// Ghost sync
+	network::JoinChannelRequest mJoinChannelRequest;
+	bool mJoinedChannel = false;
+	uint64 mLastMessageTimestamp = 0;
+	network::BroadcastChannelMessagePacket mBroadcastChannelMessagePacket;
+
+	// Downloads
+	bool mDownloadsEnabled = false;		// Downloads only start with the measurement
+	uint32 mDownloadsStarted = 0;
+	uint32 mDownloadsFinished = 0;
+	std::wstring mDownloadFilename;
+	FileDownloader mFileDownloader;
+
+	Results mResults;
+};
@@ -0,0 +1,187 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "netcorebench/pch.h"
+#include "netcorebench/BenchServer.h"
+
+
+BenchServer::BenchServer(const BenchSettings& settings) :
+	mSettings(settings),
+	mConnectionManager(&mUDPSocket, &mTCPListenSocket, *this, network::HIGHLEVEL_PROTOCOL_VERSION_RANGE)
+{
+	mConnectionManager.mDebugSettings.mSendingPacketLoss = settings.mPacketLoss;
+	mConnectionManager.mDebugSettings.mReceivingPacketLoss = settings.mPacketLoss;
+}
+
+BenchServer::~BenchServer()
+{
+	// Connections need to be destroyed while the connection manager still exists
+	while (!mConnections.empty())
+	{
+		NetConnection* connection = mConnections.back();
+		mConnections.pop_back();
+		delete connection;
+	}
+}
+
+bool BenchServer::startup()
+{
+	if (!mUDPSocket.bindToPort(mSettings.mPort))
+		RMX_ERROR("Failed to bind UDP socket to port " << mSettings.mPort, return false);
+	if (!mTCPListenSocket.setupServer(mSettings.mPort))
+		RMX_ERROR("Failed to setup TCP listen socket on port " << mSettings.mPort, return false);
+
+	// Prepare the file to download
+	mFileContent.resize(mSettings.mDownloadSize);
+	for (uint32 offset = 0; offset < mSettings.mDownloadSize; ++offset)
+	{
+		mFileContent[offset] = bench::getFileByte(offset);
+	}
+
+	network::FileDownloadRequest::Response& response = mFileDownloadResponse;
+	response.mFileAvailable = true;
+	response.mFileSize = mSettings.mDownloadSize;
+	response.mFileHash = rmx::getMurmur2_64(mFileContent.data(), mFileContent.size());
+	for (uint32 chunkStart = 0; chunkStart < mSettings.mDownloadSize; chunkStart += bench::DOWNLOAD_CHUNK_SIZE)
+	{
+		network::FileDownloadRequest::Response::ChunkInfo& chunk = vectorAdd(response.mChunks);
+		chunk.mChunkSize = std::min(bench::DOWNLOAD_CHUNK_SIZE, mSettings.mDownloadSize - chunkStart);
+		chunk.mChunkHash = rmx::getMurmur2_64(&mFileContent[chunkStart], chunk.mChunkSize);
+	}
+	return true;
+}
+
+void BenchServer::update()
+{
+	updateReceivePackets(mConnectionManager);
+	mConnectionManager.updateConnections(getCurrentTimestamp());
+}
+
+void BenchServer::collectStatistics(NetConnection::Statistics& outStatistics) const
+{
+	for (const NetConnection* connection : mConnections)
+	{
+		const NetConnection::Statistics& statistics = connection->getStatistics();
+		outStatistics.mPacketsSent += statistics.mPacketsSent;
+		outStatistics.mPacketsResent += statistics.mPacketsResent;
+		outStatistics.mPacketsReceived += statistics.mPacketsReceived;
+	}
+}
+
+NetConnection* BenchServer::createNetConnection(ConnectionManager& connectionManager, const SocketAddress& senderAddress)
+{
+	NetConnection* connection = new NetConnection();
+	mConnections.push_back(connection);
+	return connection;
+}
+
+void BenchServer::destroyNetConnection(NetConnection& connection)
+{
+	for (auto& pair : mChannels)
+	{
+		std::vector<NetConnection*>& members = pair.second;
+		members.erase(std::remove(members.begin(), members.end(), &connection), members.end());
+	}
+	mConnections.erase(std::remove(mConnections.begin(), mConnections.end(), &connection), mConnections.end());
+	delete &connection;
+}
+
+bool BenchServer::onReceivedPacket(ReceivedPacketEvaluation& evaluation)
+{
+	switch (evaluation.mPacketType)
+	{
+		case network::BroadcastChannelMessagePacket::PACKET_TYPE:
+		{
+			network::BroadcastChannelMessagePacket packet;
+			if (!evaluation.readPacket(packet))
+				return false;
+
+			const auto it = mChannels.find(packet.mChannelHash);
+			if (it == mChannels.end())
+				return true;
+
+			// Forward to all other channel members
+			network::ChannelMessagePacket& channelMessagePacket = mChannelMessagePacket;
+			channelMessagePacket.mIsReplicatedData = packet.mIsReplicatedData;
+			channelMessagePacket.mChannelHash = packet.mChannelHash;
+			channelMessagePacket.mMessageType = packet.mMessageType;
+			channelMessagePacket.mMessageVersion = packet.mMessageVersion;
+			channelMessagePacket.mMessage.swap(packet.mMessage);
+			channelMessagePacket.mSendingPlayerID = evaluation.mConnection.getLocalConnectionID();
+
+			for (NetConnection* connection : it->second)
+			{
+				if (connection != &evaluation.mConnection)
+				{
+					connection->sendPacket(channelMessagePacket, NetConnection::SendFlags::UNRELIABLE);
+				}
+			}
+			return true;
+		}
+
+		case network::FileTransferRequestPiecesPacket::PACKET_TYPE:
+		{
+			network::FileTransferRequestPiecesPacket packet;
+			if (!evaluation.readPacket(packet))
+				return false;
+
+			if (packet.mTransferComplete)
+				return true;
+
+			bench::FileTransferPieceWithDataPacket& piecePacket = mPiecePacket;
+			piecePacket.mTransferHandle = packet.mTransferHandle;
+			for (const network::FileTransferRequestPiecesPacket::PieceInfo& pieceInfo : packet.mRequestedPieces)
+			{
+				const uint32 offset = (uint32)pieceInfo.mChunkIndex * bench::DOWNLOAD_CHUNK_SIZE + pieceInfo.mStartOffset;
+				if (pieceInfo.mSize > bench::DOWNLOAD_PIECE_SIZE || offset + pieceInfo.mSize > (uint32)mFileContent.size())
+					continue;
+
+				piecePacket.mChunkIndex = pieceInfo.mChunkIndex;
+				piecePacket.mStartOffset = pieceInfo.mStartOffset;
+				piecePacket.mSize = (uint16)pieceInfo.mSize;
+				piecePacket.mData.assign(&mFileContent[offset], &mFileContent[offset] + pieceInfo.mSize);
+				evaluation.mConnection.sendPacket(piecePacket);
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BenchServer::onReceivedRequestQuery(ReceivedQueryEvaluation& evaluation)
+{
+	switch (evaluation.mPacketType)
+	{
+		case network::JoinChannelRequest::Query::PACKET_TYPE:
+		{
+			network::JoinChannelRequest request;
+			if (!evaluation.readQuery(request))
+				return false;
+
+			std::vector<NetConnection*>& members = mChannels[request.mQuery.mChannelHash];
+			if (std::find(members.begin(), members.end(), &evaluation.mConnection) == members.end())
+				members.push_back(&evaluation.mConnection);
+
+			request.mResponse.mSuccessful = true;
+			return evaluation.respond(request);
+		}
+
+		case network::FileDownloadRequest::Query::PACKET_TYPE:
+		{
+			network::FileDownloadRequest request;
+			if (!evaluation.readQuery(request))
+				return false;
+
+			request.mResponse = mFileDownloadResponse;
+			request.mResponse.mTransferHandle = mNextTransferHandle;
+			++mNextTransferHandle;
+			return evaluation.respond(request);
+		}
+	}
+	return false;
+}
@@ -0,0 +1,50 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "netcorebench/BenchShared.h"
+
+
+// Stand-in for the actual server, implementing just enough of ghost sync channels and file downloads to drive the clients
+class BenchServer : public ServerClientBase
+{
+public:
+	explicit BenchServer(const BenchSettings& settings);
+	~BenchServer();
+
+	bool startup();
+	void update();
+
+	void collectStatistics(NetConnection::Statistics& outStatistics) const;
+
+protected:
+	NetConnection* createNetConnection(ConnectionManager& connectionManager, const SocketAddress& senderAddress) override;
+	void destroyNetConnection(NetConnection& connection) override;
+
+	bool onReceivedPacket(ReceivedPacketEvaluation& evaluation) override;
+	bool onReceivedRequestQuery(ReceivedQueryEvaluation& evaluation) override;
+
+private:
+	const BenchSettings& mSettings;
+
+	UDPSocket mUDPSocket;
+	TCPSocket mTCPListenSocket;
+	ConnectionManager mConnectionManager;
+
+	std::vector<NetConnection*> mConnections;
+	std::unordered_map<uint32, std::vector<NetConnection*>> mChannels;	// Using the channel hash as key
+
+	std::vector<uint8> mFileContent;
+	network::FileDownloadRequest::Response mFileDownloadResponse;	// Prepared once, only the transfer handle changes
+	uint32 mNextTransferHandle = 1;
+
+	// For temporary use (these are members to avoid frequent reallocations)
+	network::ChannelMessagePacket mChannelMessagePacket;
+	bench::FileTransferPieceWithDataPacket mPiecePacket;
+};
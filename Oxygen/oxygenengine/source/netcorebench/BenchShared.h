@@ -0,0 +1,76 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <chrono>
+
+
+struct BenchSettings
+{
+	uint16 mPort = 21100;
+	int mNumUDPClients = 16;
+	int mNumTCPClients = 4;
+	int mNumChannels = 4;			// Clients get distributed evenly among the ghost sync channels
+	float mDurationSeconds = 10.0f;
+	int mMessagesPerSecond = 10;	// Per client; the game sends ghost data every 6 frames, i.e. 10 times per second
+	int mNumDownloads = 1;			// Per client, executed one after the other
+	uint32 mDownloadSize = 0x40000;
+	std::wstring mDownloadDirectory = L"netcorebench_downloads";
+	float mPacketLoss = 0.0f;		// Simulated for both sending and receiving, on client and server side
+};
+
+
+namespace bench
+{
+	static const constexpr uint32 GHOSTSYNC_MESSAGE_TYPE = rmx::compileTimeFNV_32("S3AIR_GhostSync");
+	static const constexpr uint8 GHOSTSYNC_MESSAGE_VERSION = 1;
+	static const constexpr size_t GHOSTSYNC_FRAMES_PER_MESSAGE = 6;
+	static const constexpr size_t GHOSTSYNC_BYTES_PER_FRAME = 14;
+
+	static const constexpr uint32 DOWNLOAD_CHUNK_SIZE = 0x10000;
+	static const constexpr uint32 DOWNLOAD_PIECE_SIZE = (uint32)network::FileTransferPiecePacket::MAX_PIECE_SIZE;
+
+	inline uint64 getMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// The downloaded file is generated, so that clients can verify the received content without having a copy of the file
+	inline uint8 getFileByte(uint32 offset)
+	{
+		return (uint8)((offset * 0x9e3779b1u) >> 24);
+	}
+
+	inline uint32 getChannelHash(int channelIndex)
+	{
+		return (uint32)rmx::getMurmur2_64(String(0, "netcorebench-ghostsync-%d", channelIndex));
+	}
+
+
+	// The "FileTransferPiecePacket" leaves writing and reading the actual data to the user
+	struct FileTransferPieceWithDataPacket : public network::FileTransferPiecePacket
+	{
+		std::vector<uint8> mData;
+
+		virtual void serializeContent(VectorBinarySerializer& serializer, uint8 protocolVersion) override
+		{
+			network::FileTransferPiecePacket::serializeContent(serializer, protocolVersion);
+			if (serializer.isReading())
+			{
+				if (serializer.getRemaining() < mSize)
+				{
+					serializer.setError();
+					return;
+				}
+				mData.resize(mSize);
+			}
+			serializer.serialize(mData.data(), mSize);
+		}
+	};
+}
@@ -0,0 +1,244 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#define RMX_LIB
+#include "netcorebench/pch.h"
+#include "netcorebench/BenchClient.h"
+#include "netcorebench/BenchServer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+
+// Count all heap allocations, to get the number of allocations per packet
+namespace
+{
+	std::atomic<uint64> gNumAllocations { 0 };
+}
+
+void* operator new(size_t size)
+{
+	++gNumAllocations;
+	void* pointer = std::malloc(size == 0 ? 1 : size);
+	if (nullptr == pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+
+namespace
+{
+	void printUsage()
+	{
+		printf("Usage: netcorebench [options]\n");
+		printf("  --port <port>          Server port for UDP and TCP (default 21100)\n");
+		printf("  --clients <n>          Number of clients using UDP (default 16)\n");
+		printf("  --tcpclients <n>       Number of clients using TCP (default 4)\n");
+		printf("  --channels <n>         Number of ghost sync channels (default 4)\n");
+		printf("  --duration <seconds>   Duration of the measurement (default 10)\n");
+		printf("  --rate <n>             Ghost sync messages per second and client (default 10)\n");
+		printf("  --downloads <n>        File downloads per client (default 1)\n");
+		printf("  --filesize <bytes>     Size of the downloaded file (default 262144)\n");
+		printf("  --downloaddir <path>   Directory for downloaded files, gets created if needed (default netcorebench_downloads)\n");
+		printf("  --loss <fraction>      Simulated packet loss for sending and receiving (default 0)\n");
+	}
+
+	bool parseArguments(int argc, char** argv, BenchSettings& settings)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string argument = argv[i];
+			if (argument == "--help" || i + 1 >= argc)
+				return false;
+
+			const char* value = argv[++i];
+			if (argument == "--port")			 { settings.mPort = (uint16)atoi(value); }
+			else if (argument == "--clients")	 { settings.mNumUDPClients = std::max(atoi(value), 0); }
+			else if (argument == "--tcpclients") { settings.mNumTCPClients = std::max(atoi(value), 0); }
+			else if (argument == "--channels")	 { settings.mNumChannels = std::max(atoi(value), 1); }
+			else if (argument == "--duration")	 { settings.mDurationSeconds = (float)atof(value); }
+			else if (argument == "--rate")		 { settings.mMessagesPerSecond = std::max(atoi(value), 0); }
+			else if (argument == "--downloads")	 { settings.mNumDownloads = std::max(atoi(value), 0); }
+			else if (argument == "--filesize")	 { settings.mDownloadSize = (uint32)std::max(atoi(value), 1); }
+			else if (argument == "--downloaddir") { settings.mDownloadDirectory = String(value).toStdWString(); }
+			else if (argument == "--loss")		 { settings.mPacketLoss = clamp((float)atof(value), 0.0f, 0.9f); }
+			else
+				return false;
+		}
+		return true;
+	}
+
+	void collectStatistics(const BenchServer& server, const std::vector<BenchClient*>& clients, NetConnection::Statistics& outStatistics)
+	{
+		outStatistics = NetConnection::Statistics();
+		server.collectStatistics(outStatistics);
+		for (const BenchClient* client : clients)
+		{
+			const NetConnection::Statistics& statistics = client->getServerConnection().getStatistics();
+			outStatistics.mPacketsSent += statistics.mPacketsSent;
+			outStatistics.mPacketsResent += statistics.mPacketsResent;
+			outStatistics.mPacketsReceived += statistics.mPacketsReceived;
+		}
+	}
+
+	void updateAll(BenchServer& server, const std::vector<BenchClient*>& clients)
+	{
+		server.update();
+		for (BenchClient* client : clients)
+		{
+			client->update();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	BenchSettings settings;
+	if (!parseArguments(argc, argv, settings))
+	{
+		printUsage();
+		return 1;
+	}
+
+	if (settings.mNumDownloads > 0)
+		rmx::FileIO::createDirectory(settings.mDownloadDirectory);
+
+	Sockets::startupSockets();
+	int result = 0;
+	{
+		BenchServer server(settings);
+		if (!server.startup())
+			return 1;
+
+		SocketAddress serverAddress;
+		serverAddress.set("127.0.0.1", settings.mPort);
+
+		std::vector<BenchClient*> clients;
+		const int numClients = settings.mNumUDPClients + settings.mNumTCPClients;
+		for (int index = 0; index < numClients; ++index)
+		{
+			BenchClient* client = new BenchClient(settings, index, index >= settings.mNumUDPClients);
+			clients.push_back(client);
+			if (!client->startup(serverAddress))
+				printf("Client %d failed to start connecting\n", index);
+		}
+
+		// Wait until all clients are connected and joined their channels
+		const uint64 setupStart = ServerClientBase::getCurrentTimestamp();
+		while (true)
+		{
+			updateAll(server, clients);
+
+			size_t numReady = 0;
+			for (const BenchClient* client : clients)
+			{
+				if (client->isReady())
+					++numReady;
+			}
+			if (numReady == clients.size())
+				break;
+
+			if (ServerClientBase::getCurrentTimestamp() > setupStart + 10000)
+			{
+				printf("Only %d of %d clients got ready in time\n", (int)numReady, numClients);
+				result = 1;
+				break;
+			}
+		}
+
+		// Measurement
+		const size_t expectedLatencies = (size_t)(settings.mDurationSeconds * (float)settings.mMessagesPerSecond * (float)numClients / (float)settings.mNumChannels) + 0x100;
+		for (BenchClient* client : clients)
+		{
+			client->startMeasurement(expectedLatencies);
+		}
+		NetConnection::Statistics startStatistics;
+		collectStatistics(server, clients, startStatistics);
+		const uint64 startAllocations = gNumAllocations;
+		const uint64 startTime = bench::getMicroseconds();
+		const uint64 endTime = startTime + (uint64)(settings.mDurationSeconds * 1000000.0f);
+
+		while (bench::getMicroseconds() < endTime)
+		{
+			updateAll(server, clients);
+		}
+
+		const uint64 numAllocations = gNumAllocations - startAllocations;
+		const double seconds = (double)(bench::getMicroseconds() - startTime) / 1000000.0;
+		NetConnection::Statistics statistics;
+		collectStatistics(server, clients, statistics);
+		statistics.mPacketsSent -= startStatistics.mPacketsSent;
+		statistics.mPacketsResent -= startStatistics.mPacketsResent;
+		statistics.mPacketsReceived -= startStatistics.mPacketsReceived;
+
+		// Gather client results
+		BenchClient::Results totals;
+		for (BenchClient* client : clients)
+		{
+			BenchClient::Results& results = client->getResults();
+			totals.mMessagesSent += results.mMessagesSent;
+			totals.mMessagesReceived += results.mMessagesReceived;
+			totals.mBytesDownloaded += results.mBytesDownloaded;
+			totals.mDownloadsCompleted += results.mDownloadsCompleted;
+			totals.mDownloadErrors += results.mDownloadErrors;
+			totals.mLatencies.insert(totals.mLatencies.end(), results.mLatencies.begin(), results.mLatencies.end());
+		}
+		std::sort(totals.mLatencies.begin(), totals.mLatencies.end());
+		const auto getPercentile = [&](double percentile) -> double
+		{
+			if (totals.mLatencies.empty())
+				return 0.0;
+			const size_t index = std::min((size_t)(percentile * (double)totals.mLatencies.size()), totals.mLatencies.size() - 1);
+			return (double)totals.mLatencies[index] / 1000.0;
+		};
+
+		// Report
+		const uint64 totalPackets = statistics.mPacketsSent + statistics.mPacketsReceived;
+		printf("\n");
+		printf("Clients:             %d UDP, %d TCP in %d channels, simulated packet loss %.1f%%\n", settings.mNumUDPClients, settings.mNumTCPClients, settings.mNumChannels, settings.mPacketLoss * 100.0f);
+		printf("Duration:            %.2f s\n", seconds);
+		printf("Packets sent:        %llu (%.0f / s)\n", (unsigned long long)statistics.mPacketsSent, (double)statistics.mPacketsSent / seconds);
+		printf("Packets received:    %llu (%.0f / s)\n", (unsigned long long)statistics.mPacketsReceived, (double)statistics.mPacketsReceived / seconds);
+		printf("Resends:             %llu (%.2f%% of sent packets)\n", (unsigned long long)statistics.mPacketsResent, statistics.mPacketsSent == 0 ? 0.0 : (double)statistics.mPacketsResent * 100.0 / (double)statistics.mPacketsSent);
+		printf("Ghost sync messages: %llu sent, %llu received\n", (unsigned long long)totals.mMessagesSent, (unsigned long long)totals.mMessagesReceived);
+		printf("Message latency:     p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n", getPercentile(0.5), getPercentile(0.9), getPercentile(0.99), getPercentile(1.0));
+		printf("Downloads:           %u completed, %u errors, %.2f MB/s\n", totals.mDownloadsCompleted, totals.mDownloadErrors, (double)totals.mBytesDownloaded / seconds / 1048576.0);
+		printf("Allocations:         %llu (%.2f per packet)\n", (unsigned long long)numAllocations, totalPackets == 0 ? 0.0 : (double)numAllocations / (double)totalPackets);
+		printf("\n");
+
+		if (totals.mDownloadErrors > 0)
+			result = 1;
+
+		for (BenchClient* client : clients)
+		{
+			delete client;
+		}
+	}
+	Sockets::shutdownSockets();
+	return result;
+}
@@ -0,0 +1,18 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+// Include relevant RMX libraries
+#include <rmxbase.h>
+
+// Network core
+#include "oxygen_netcore/network/ConnectionManager.h"
+#include "oxygen_netcore/network/NetConnection.h"
+#include "oxygen_netcore/network/ServerClientBase.h"
+#include "oxygen_netcore/serverclient/FileDownloader.h"
+#include "oxygen_netcore/serverclient/Packets.h"
+#include "oxygen_netcore/serverclient/ProtocolVersion.h"
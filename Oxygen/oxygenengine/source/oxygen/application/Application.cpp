@@ -39,7 +39,7 @@ static const float MOUSE_HIDE_TIME = 1.0f;	// Seconds until mouse cursor gets hi
 
 
 Application::Application() :
-	mGameLoader(new GameLoader()),
+	mGameLoader(&GameLoader::instance()),
 	mSimulation(new Simulation()),
 	mSaveStateMenu(new SaveStateMenu())
 {
@@ -55,6 +55,16 @@ Application::Application() :
 	Profiling::registerRegion(ProfilingRegion::AUDIO,				 "Audio",		Color::RED);
 	Profiling::registerRegion(ProfilingRegion::RENDERING,			 "Rendering",	Color::BLUE);
 	Profiling::registerRegion(ProfilingRegion::FRAMESYNC,			 "Frame Sync",	Color(0.3f, 0.3f, 0.3f));
+	if (!Configuration::instance().mFrameTimeStatisticsOutput.empty())
+	{
+		Profiling::enableStatistics((uint32)std::max(Configuration::instance().mFrameTimeStatisticsWindow, 1));
+	}
+
+	rmx::Tracing::setThreadName("Main thread");
+	if (Configuration::instance().mTraceCaptureOnStartup)
+	{
+		rmx::Tracing::startCapture(Configuration::instance().mTraceCaptureOutput, (uint32)std::max(Configuration::instance().mTraceCaptureFrames, 1));
+	}
 
 	mApplicationTimer.start();
 }
@@ -63,7 +73,6 @@ Application::~Application()
 {
 	delete mGameApp;
 	delete mGameView;
-	delete mGameLoader;
 	delete mSaveStateMenu;
 	delete mSimulation;
 	delete mTouchControlsOverlay;
@@ -113,6 +122,15 @@ void Application::deinitialize()
 	RMX_LOG_INFO("");
 	RMX_LOG_INFO("--- SHUTDOWN ---");
 
+	// Write out a trace capture that did not finish yet
+	rmx::Tracing::stopCapture();
+
+	if (!Configuration::instance().mFrameTimeStatisticsOutput.empty())
+	{
+		RMX_LOG_INFO("Writing frame time statistics");
+		Profiling::saveStatistics(Configuration::instance().mFrameTimeStatisticsOutput);
+	}
+
 	// Remove all children, as they must not get deleted automatically (which would be the case if they stay added as children)
 	while (!mChildren.empty())
 	{
@@ -243,6 +261,17 @@ void Application::keyboard(const rmx::KeyboardEvent& ev)
 						break;
 					}
 
+					case 't':
+					{
+						if (EngineMain::getDelegate().useDeveloperFeatures() && !rmx::Tracing::isCapturing())
+						{
+							const Configuration& config = Configuration::instance();
+							rmx::Tracing::startCapture(config.mTraceCaptureOutput, (uint32)std::max(config.mTraceCaptureFrames, 1));
+							LogDisplay::instance().setLogDisplay("Started trace capture of " + std::to_string(config.mTraceCaptureFrames) + " frames into '" + WString(config.mTraceCaptureOutput).toStdString() + "'");
+						}
+						break;
+					}
+
 					case SDLK_END:
 					{
 						if (FTX::keyState(SDLK_RSHIFT))
@@ -387,6 +416,10 @@ void Application::keyboard(const rmx::KeyboardEvent& ev)
 
 void Application::update(float timeElapsed)
 {
+	// Each update starts a new frame
+	rmx::Tracing::nextFrame();
+	RMX_TRACE_SCOPE("Application::update");
+
 	if (mIsVeryFirstFrameForLogging)
 	{
 		RMX_LOG_INFO("Start of first application update call");
@@ -478,6 +511,7 @@ void Application::update(float timeElapsed)
 void Application::render()
 {
 	Profiling::pushRegion(ProfilingRegion::RENDERING);
+	RMX_TRACE_SCOPE("Application::render");
 
 	if (mIsVeryFirstFrameForLogging)
 	{
@@ -532,6 +566,7 @@ void Application::render()
 
 		const double currentTime = mApplicationTimer.getSecondsSinceStart() * 1000.0;
 		const double tickLengthMilliseconds = 1000.0 / (double)mSimulation->getSimulationFrequency();
+		Profiling::setTargetFrameTime(tickLengthMilliseconds / 1000.0);
 		const bool usingFramecap = (drawer.getType() != Drawer::Type::OPENGL || Configuration::instance().mFrameSync != Configuration::FrameSyncType::VSYNC_ON) && (Configuration::instance().mFrameSync != Configuration::FrameSyncType::FRAME_INTERPOLATION);
 		if (usingFramecap)
 		{
@@ -562,7 +597,10 @@ void Application::render()
 			RMX_LOG_INFO("First present screen call");
 		}
 
-		drawer.presentScreen();
+		{
+			RMX_TRACE_SCOPE("Drawer::presentScreen");
+			drawer.presentScreen();
+		}
 
 	#if 0
 		// Use a glFinish or glFlush here...?
@@ -547,6 +547,7 @@ void Configuration::loadConfigurationProperties(JsonHelper& rootHelper)
 	rootHelper.tryReadInt("GameRecording", mGameRecording);
 	rootHelper.tryReadInt("GameRecPlayFrom", mGameRecPlayFrom);
 	rootHelper.tryReadBool("GameRecIgnoreKeys", mGameRecIgnoreKeys);
+	rootHelper.tryReadInt("GameRecStateHashInterval", mGameRecStateHashInterval);
 
 	if (mLoadLevel != -1 || mGameRecording == 2)
 	{
@@ -565,6 +566,7 @@ void Configuration::loadConfigurationProperties(JsonHelper& rootHelper)
 	rootHelper.tryReadInt("Scanlines", mScanlines);
 	rootHelper.tryReadInt("BackgroundBlur", mBackgroundBlur);
 	rootHelper.tryReadInt("PerformanceDisplay", mPerformanceDisplay);
+	rootHelper.tryReadBool("PipelinedRendering", mPipelinedRendering);
 	tryReadRenderMethod(rootHelper, mFailSafeMode, mRenderMethod, mAutoDetectRenderMethod);
 
 	// Audio
@@ -578,6 +580,18 @@ void Configuration::loadConfigurationProperties(JsonHelper& rootHelper)
 		jsonHelper.tryReadString("Record", mInputRecorderOutput);
 	}
 
+	// Profiling
+	{
+		JsonHelper jsonHelper(rootHelper.mJson["FrameTimeStatistics"]);
+		jsonHelper.tryReadString("Output", mFrameTimeStatisticsOutput);
+		jsonHelper.tryReadInt("WindowSize", mFrameTimeStatisticsWindow);
+	}
+	{
+		JsonHelper jsonHelper(rootHelper.mJson["TraceCapture"]);
+		jsonHelper.tryReadString("Output", mTraceCaptureOutput);
+		jsonHelper.tryReadInt("Frames", mTraceCaptureFrames);
+	}
+
 	// Script
 	rootHelper.tryReadInt("ScriptOptimizationLevel", mScriptOptimizationLevel);
 	if (mDevMode.mEnabled)
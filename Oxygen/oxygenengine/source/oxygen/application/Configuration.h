@@ -131,6 +131,7 @@ public:
 	int  mGameRecording = -1;
 	int  mGameRecPlayFrom = 0;
 	bool mGameRecIgnoreKeys = false;
+	int  mGameRecStateHashInterval = 0;		// Store state hashes in game recordings every n-th frame, for verification in playback; 0 to disable (opt-in, meant for debugging desyncs)
 
 	// Dev mode
 	DevModeSettings mDevMode;
@@ -149,6 +150,7 @@ public:
 	int   mScanlines = 0;
 	int   mBackgroundBlur = 0;
 	bool  mFullEmulationRendering = true;
+	bool  mPipelinedRendering = false;		// Software renderer only: render a frame on a separate thread while the next one gets simulated, at the cost of one frame latency
 	int   mPerformanceDisplay = 0;
 
 	// Audio
@@ -169,6 +171,13 @@ public:
 	// Misc
 	bool mMirrorMode = false;
 
+	// Profiling
+	std::wstring mFrameTimeStatisticsOutput;	// If set, frame time statistics get collected and written to this JSON file on exit
+	int mFrameTimeStatisticsWindow = 600;		// Number of frames per window in frame time statistics
+	std::wstring mTraceCaptureOutput = L"trace.json";	// Output file for trace captures, which can be started with Alt + T in dev mode
+	int mTraceCaptureFrames = 300;				// Number of frames per trace capture
+	bool mTraceCaptureOnStartup = false;		// Set by command line option "--tracecapture <file>"
+
 	// Internal
 	bool mForceCompileScripts = false;
 	int mScriptOptimizationLevel = 3;
@@ -10,6 +10,7 @@
 #include "oxygen/application/EngineMain.h"
 #include "oxygen/application/Application.h"
 #include "oxygen/application/Configuration.h"
+#include "oxygen/application/GameLoader.h"
 #include "oxygen/application/GameProfile.h"
 #include "oxygen/application/audio/AudioOutBase.h"
 #include "oxygen/application/input/ControlsIn.h"
@@ -60,6 +61,7 @@ void EngineMain::earlySetup()
 EngineMain::EngineMain(EngineDelegateInterface& delegate_) :
 	mDelegate(delegate_),
 	mGameProfile(*new GameProfile()),
+	mGameLoader(*new GameLoader()),
 	mInputManager(*new InputManager()),
 	mLogDisplay(*new LogDisplay()),
 	mModManager(*new ModManager()),
@@ -76,6 +78,7 @@ EngineMain::EngineMain(EngineDelegateInterface& delegate_) :
 EngineMain::~EngineMain()
 {
 	delete &mGameProfile;
+	delete &mGameLoader;
 	delete &mInputManager;
 	delete &mLogDisplay;
 	delete &mModManager;
@@ -111,6 +114,7 @@ void EngineMain::execute(int argc, char** argv)
 void EngineMain::onActiveModsChanged()
 {
 	// Update sprites
+	mVideoOut.finishPipelinedRendering();
 	RenderResources::instance().loadSpriteCache(true);
 
 	// Update the resource cache -> palettes, raw data
@@ -202,13 +206,25 @@ bool EngineMain::startupEngine()
 		return false;
 
 	std::wstring argumentProjectPath;
+	std::wstring argumentFrameTimeStatistics;
+	std::wstring argumentTraceCapture;
 #ifndef PLATFORM_ANDROID
 	// Parse arguments
 	for (size_t i = 1; i < mArguments.size(); ++i)
 	{
 		if (mArguments[i][0] == '-')
 		{
-			// TODO: Add handling for options
+			// TODO: Add handling for more options
+			if (mArguments[i] == "--frametimestats" && i + 1 < mArguments.size())
+			{
+				++i;
+				argumentFrameTimeStatistics = String(mArguments[i]).toStdWString();
+			}
+			else if (mArguments[i] == "--tracecapture" && i + 1 < mArguments.size())
+			{
+				++i;
+				argumentTraceCapture = String(mArguments[i]).toStdWString();
+			}
 		}
 		else
 		{
@@ -287,11 +303,25 @@ bool EngineMain::startupEngine()
 	if (!initConfigAndSettings(argumentProjectPath))
 		return false;
 
+	if (!argumentFrameTimeStatistics.empty())
+	{
+		// Command line overrides the configuration
+		config.mFrameTimeStatisticsOutput = argumentFrameTimeStatistics;
+	}
+	if (!argumentTraceCapture.empty())
+	{
+		config.mTraceCaptureOutput = argumentTraceCapture;
+		config.mTraceCaptureOnStartup = true;
+	}
+
 	// Setup file system
 	RMX_LOG_INFO("File system setup");
 	if (!initFileSystem())
 		return false;
 
+	// Start loading the game data in the background, while the window and all subsystems get set up
+	mGameLoader.startBackgroundLoading();
+
 	// System
 	RMX_LOG_INFO("System initialization...");
 	if (!FTX::System->initialize())
@@ -344,6 +374,9 @@ void EngineMain::run()
 
 void EngineMain::shutdown()
 {
+	// Make sure no background loading is running any more
+	mGameLoader.shutdown();
+
 	destroyWindow();
 
 	// Shutdown subsystems
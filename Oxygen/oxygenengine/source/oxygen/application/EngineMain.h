@@ -14,6 +14,7 @@
 class AudioOutBase;
 class CodeExec;
 class Configuration;
+class GameLoader;
 class GameProfile;
 class ControlsIn;
 class InputManager;
@@ -120,6 +121,7 @@ private:
 	std::vector<std::string> mArguments;
 
 	GameProfile&	mGameProfile;
+	GameLoader&		mGameLoader;
 	InputManager&	mInputManager;
 	LogDisplay&		mLogDisplay;
 	ModManager&		mModManager;
@@ -12,7 +12,6 @@
 #include "oxygen/application/GameProfile.h"
 #include "oxygen/application/audio/AudioOutBase.h"
 #include "oxygen/application/modding/ModManager.h"
-#include "oxygen/application/video/VideoOut.h"
 #include "oxygen/base/PlatformFunctions.h"
 #include "oxygen/helper/Logging.h"
 #include "oxygen/rendering/RenderResources.h"
@@ -22,8 +21,34 @@
 	#include "oxygen/platform/AndroidJavaInterface.h"
 #endif
 
+void GameLoader::startBackgroundLoading()
+{
+	if (mStartupTasks.isStarted())
+		return;
+
+	// Everything mod-specific has to wait for the mod manager initialization
+	const size_t modManagerTask = mStartupTasks.addTask("Mod manager initialization", []() { ModManager::instance().startup(); });
+	mStartupTasks.addTask("Persistent data loading", []() { PersistentData::instance().loadFromFile(Configuration::instance().mPersistentDataFilename); });
+	mStartupTasks.addTask("Sprite cache loading", []() { RenderResources::instance().loadSpriteCache(); }, { modManagerTask });
+	mStartupTasks.addTask("Resource cache loading", []() { ResourcesCache::instance().loadAllResources(); }, { modManagerTask });
+
+	// Audio stops all playing sounds when loading the modded definitions, so this has to run on the main thread
+	mStartupTasks.addTask("Audio definitions loading", []() { EngineMain::instance().getAudioOut().handleGameLoaded(); }, { modManagerTask }, true);
+
+	mStartupTasks.start();
+}
+
+void GameLoader::shutdown()
+{
+	mStartupTasks.shutdown();
+}
+
 GameLoader::UpdateResult GameLoader::updateLoading()
 {
+	// Execute main thread startup tasks while waiting for the ROM as well
+	startBackgroundLoading();
+	const bool startupTasksDone = mStartupTasks.update();
+
 	switch (mState)
 	{
 		case State::UNLOADED:
@@ -119,24 +144,9 @@ GameLoader::UpdateResult GameLoader::updateLoading()
 
 		case State::ROM_LOADED:
 		{
-			// Initialize mods
-			RMX_LOG_INFO("Mod manager initialization...");
-			ModManager::instance().startup();
-
-			// Load sprites
-			RMX_LOG_INFO("Loading sprites");
-			VideoOut::instance().getRenderResources().loadSpriteCache();
-
-			// Load resources
-			RMX_LOG_INFO("Resource cache loading...");
-			ResourcesCache::instance().loadAllResources();
-
-			// Load persistent data
-			RMX_LOG_INFO("Persistent data loading...");
-			PersistentData::instance().loadFromFile(Configuration::instance().mPersistentDataFilename);
-
-			// Load audio definitions
-			EngineMain::instance().getAudioOut().handleGameLoaded();
+			// Mods, sprites, resources, persistent data and audio definitions get loaded by the startup tasks, they're possibly still running
+			if (!startupTasksDone)
+				return UpdateResult::CONTINUE;
 
 			// Game loaded
 			mState = State::READY;
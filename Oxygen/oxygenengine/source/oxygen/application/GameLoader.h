@@ -8,7 +8,7 @@
 
 #pragma once
 
-#include <rmxbase.h>
+#include "oxygen/application/StartupTaskGraph.h"
 
 
 class GameLoader : public SingleInstance<GameLoader>
@@ -35,8 +35,13 @@ public:
 	State getState() const  { return mState; }
 	bool isLoading() const  { return mState != State::READY; }
 
+	// Starts loading everything that does not depend on the ROM in the background, which is possible right after the file system setup
+	void startBackgroundLoading();
+	void shutdown();
+
 	UpdateResult updateLoading();
 
 private:
 	State mState = State::UNLOADED;
+	StartupTaskGraph mStartupTasks;
 };
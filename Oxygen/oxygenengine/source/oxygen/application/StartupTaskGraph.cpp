@@ -0,0 +1,196 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/application/StartupTaskGraph.h"
+
+
+StartupTaskGraph::StartupTaskGraph()
+{
+	mMutex = SDL_CreateMutex();
+	mWakeUpCondition = SDL_CreateCond();
+	mDoneCondition = SDL_CreateCond();
+}
+
+StartupTaskGraph::~StartupTaskGraph()
+{
+	shutdown();
+	SDL_DestroyCond(mDoneCondition);
+	SDL_DestroyCond(mWakeUpCondition);
+	SDL_DestroyMutex(mMutex);
+}
+
+size_t StartupTaskGraph::addTask(const char* name, const TaskFunction& function, std::initializer_list<size_t> dependencies, bool mainThreadOnly)
+{
+	RMX_ASSERT(!mStarted, "Startup tasks can't be added after the start");
+	const size_t index = mTasks.size();
+	Task& task = vectorAdd(mTasks);
+	task.mName = name;
+	task.mFunction = function;
+	task.mMainThreadOnly = mainThreadOnly;
+	for (size_t dependency : dependencies)
+	{
+		RMX_ASSERT(dependency < index, "Startup task '" << name << "' has an invalid dependency");
+		mTasks[dependency].mDependentTasks.push_back(index);
+		++task.mOpenDependencies;
+	}
+	return index;
+}
+
+void StartupTaskGraph::start()
+{
+	if (mStarted)
+		return;
+
+	mStarted = true;
+	mStartTime = rmx::Tracing::getTimestamp();
+
+	int numWorkerTasks = 0;
+	for (Task& task : mTasks)
+	{
+		if (!task.mMainThreadOnly)
+			++numWorkerTasks;
+		if (task.mOpenDependencies == 0)
+			(task.mMainThreadOnly ? mReadyMainThreadTasks : mReadyWorkerTasks).push_back(&task);
+	}
+
+	// Use at least one worker thread even on a single core, so that the loading overlaps with the main thread's work
+	const int numThreads = std::min(clamp(SDL_GetCPUCount() - 1, 1, 4), numWorkerTasks);
+	for (int k = 0; k < numThreads; ++k)
+	{
+		StartupTaskWorkerThread* thread = new StartupTaskWorkerThread(*this);
+		mThreads.push_back(thread);
+		thread->startThread();
+	}
+}
+
+bool StartupTaskGraph::update()
+{
+	if (!mStarted)
+		return false;
+
+	SDL_LockMutex(mMutex);
+	while (!mReadyMainThreadTasks.empty())
+	{
+		Task& task = *mReadyMainThreadTasks.front();
+		mReadyMainThreadTasks.pop_front();
+		SDL_UnlockMutex(mMutex);
+
+		executeTask(task);
+
+		SDL_LockMutex(mMutex);
+		onTaskDone(task);
+	}
+	const bool allDone = (mNumFinishedTasks >= mTasks.size());
+	SDL_UnlockMutex(mMutex);
+
+	if (allDone && !mThreads.empty())
+	{
+		RMX_LOG_INFO("All startup tasks done after " << (float)(rmx::Tracing::getTimestamp() - mStartTime) / 1000000.0f << " ms");
+		shutdown();
+	}
+	return allDone;
+}
+
+void StartupTaskGraph::shutdown()
+{
+	if (mThreads.empty())
+		return;
+
+	SDL_LockMutex(mMutex);
+	mStopRequested = true;
+	SDL_CondBroadcast(mWakeUpCondition);
+
+	// Joining a thread only works reliably once it is running, so wait for all of them to have started
+	while (mNumRunningWorkerTasks > 0 || mNumStartedThreads < (int)mThreads.size())
+	{
+		SDL_CondWait(mDoneCondition, mMutex);
+	}
+	SDL_UnlockMutex(mMutex);
+
+	for (StartupTaskWorkerThread* thread : mThreads)
+	{
+		thread->joinThread();
+		delete thread;
+	}
+	mThreads.clear();
+}
+
+void StartupTaskGraph::executeTask(Task& task)
+{
+	RMX_TRACE_SCOPE(task.mName);
+	const uint64 startTime = rmx::Tracing::getTimestamp();
+	task.mFunction();
+	RMX_LOG_INFO("Startup task '" << task.mName << "' done in " << (float)(rmx::Tracing::getTimestamp() - startTime) / 1000000.0f << " ms");
+}
+
+void StartupTaskGraph::onTaskDone(Task& task)
+{
+	// Mutex must be locked when calling this
+	++mNumFinishedTasks;
+	for (size_t index : task.mDependentTasks)
+	{
+		Task& dependentTask = mTasks[index];
+		--dependentTask.mOpenDependencies;
+		if (dependentTask.mOpenDependencies == 0)
+		{
+			if (dependentTask.mMainThreadOnly)
+			{
+				mReadyMainThreadTasks.push_back(&dependentTask);
+			}
+			else
+			{
+				mReadyWorkerTasks.push_back(&dependentTask);
+				SDL_CondSignal(mWakeUpCondition);
+			}
+		}
+	}
+	SDL_CondBroadcast(mDoneCondition);
+}
+
+void StartupTaskGraph::processWorkerTasks()
+{
+	SDL_LockMutex(mMutex);
+	++mNumStartedThreads;
+	SDL_CondBroadcast(mDoneCondition);
+
+	while (!mStopRequested)
+	{
+		if (!mReadyWorkerTasks.empty())
+		{
+			Task& task = *mReadyWorkerTasks.front();
+			mReadyWorkerTasks.pop_front();
+			++mNumRunningWorkerTasks;
+			SDL_UnlockMutex(mMutex);
+
+			executeTask(task);
+
+			SDL_LockMutex(mMutex);
+			--mNumRunningWorkerTasks;
+			onTaskDone(task);
+		}
+		else
+		{
+			SDL_CondWait(mWakeUpCondition, mMutex);
+		}
+	}
+	SDL_UnlockMutex(mMutex);
+}
+
+
+
+StartupTaskWorkerThread::StartupTaskWorkerThread(StartupTaskGraph& taskGraph) :
+	ThreadBase("Oxygen StartupTaskWorker"),
+	mTaskGraph(taskGraph)
+{
+}
+
+void StartupTaskWorkerThread::threadFunc()
+{
+	mTaskGraph.processWorkerTasks();
+}
@@ -0,0 +1,88 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <rmxmedia.h>
+
+class StartupTaskWorkerThread;
+
+
+// Executes the loading steps of the engine startup with dependencies between them, using a few worker threads
+//  - Each task gets started as soon as all of its dependencies are done
+//  - Tasks that must run on the main thread (e.g. because they access audio or video) get executed inside "update" instead
+//  - The duration of each task gets written to the log
+class StartupTaskGraph
+{
+friend class StartupTaskWorkerThread;
+
+public:
+	typedef std::function<void()> TaskFunction;
+
+public:
+	StartupTaskGraph();
+	~StartupTaskGraph();
+
+	// Tasks can only be added before the start; dependencies are the return values of previous calls
+	size_t addTask(const char* name, const TaskFunction& function, std::initializer_list<size_t> dependencies = {}, bool mainThreadOnly = false);
+
+	void start();
+	inline bool isStarted() const  { return mStarted; }
+
+	// Has to be called regularly by the main thread, for the execution of main thread tasks; returns true once all tasks are done
+	bool update();
+
+	// Waits for the tasks that are being executed right now, and stops all worker threads; tasks that were not started yet get skipped
+	void shutdown();
+
+private:
+	struct Task
+	{
+		const char* mName = nullptr;
+		TaskFunction mFunction;
+		std::vector<size_t> mDependentTasks;
+		int mOpenDependencies = 0;		// Protected by the mutex after the start
+		bool mMainThreadOnly = false;
+	};
+
+private:
+	void executeTask(Task& task);
+	void onTaskDone(Task& task);
+	void processWorkerTasks();
+
+private:
+	std::vector<Task> mTasks;
+	std::vector<StartupTaskWorkerThread*> mThreads;
+	bool mStarted = false;
+	uint64 mStartTime = 0;
+
+	SDL_mutex* mMutex = nullptr;
+	SDL_cond* mWakeUpCondition = nullptr;
+	SDL_cond* mDoneCondition = nullptr;
+
+	// All protected by the mutex
+	std::deque<Task*> mReadyWorkerTasks;
+	std::deque<Task*> mReadyMainThreadTasks;
+	size_t mNumFinishedTasks = 0;
+	int mNumRunningWorkerTasks = 0;
+	int mNumStartedThreads = 0;
+	bool mStopRequested = false;
+};
+
+
+class StartupTaskWorkerThread final : public rmx::ThreadBase
+{
+public:
+	StartupTaskWorkerThread(StartupTaskGraph& taskGraph);
+
+protected:
+	void threadFunc() override;
+
+private:
+	StartupTaskGraph& mTaskGraph;
+};
@@ -178,6 +178,7 @@ void EmulationAudioSource::progressInternal(float precacheTime)
 bool EmulationAudioSource::jobFunc()
 {
 	// This method is executed by a worker thread
+	RMX_TRACE_SCOPE("EmulationAudioSource::jobFunc");
 	SDL_LockMutex(mMutex);
 
 	// Update in increments of around 2 ms per "jobFunc" call, but at least 25 ms for the first update
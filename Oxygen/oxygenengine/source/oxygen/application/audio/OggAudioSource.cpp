@@ -229,6 +229,7 @@ void OggAudioSource::progressInternal(float precacheTime)
 bool OggAudioSource::jobFunc()
 {
 	// This method is executed by a worker thread
+	RMX_TRACE_SCOPE("OggAudioSource::jobFunc");
 	SDL_LockMutex(mMutex);
 	RMX_CHECK(nullptr != mOggLoader, "No ogg loader instance found", return true);
 
@@ -295,6 +295,7 @@ void GameView::keyboard(const rmx::KeyboardEvent& ev)
 
 						case SDLK_F10:
 						{
+							VideoOut::instance().finishPipelinedRendering();
 							RenderResources::instance().loadSpriteCache();
 							ResourcesCache::instance().loadAllResources();
 							setLogDisplay("Reloaded resources");
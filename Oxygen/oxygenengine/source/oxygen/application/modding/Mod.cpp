@@ -111,3 +111,39 @@ void Mod::loadFromJson(const Json::Value& json)
 		}
 	}
 }
+
+void Mod::serializeMetadata(VectorBinarySerializer& serializer)
+{
+	serializer.serialize(mDisplayName);
+	serializer.serialize(mModVersion);
+	serializer.serialize(mAuthor);
+	serializer.serialize(mDescription);
+	serializer.serialize(mURL);
+
+	serializer.serializeArraySize(mSettingCategories);
+	for (SettingCategory& settingCategory : mSettingCategories)
+	{
+		serializer.serialize(settingCategory.mDisplayName);
+		serializer.serialize(settingCategory.mNameHash);
+
+		serializer.serializeArraySize(settingCategory.mSettings);
+		for (Setting& setting : settingCategory.mSettings)
+		{
+			serializer.serialize(setting.mIdentifier);
+			serializer.serialize(setting.mDisplayName);
+			serializer.serialize(setting.mBinding);
+			serializer.serialize(setting.mDefaultValue);
+			if (serializer.isReading())
+			{
+				setting.mCurrentValue = setting.mDefaultValue;
+			}
+
+			serializer.serializeArraySize(setting.mOptions);
+			for (Setting::Option& option : setting.mOptions)
+			{
+				serializer.serialize(option.mDisplayName);
+				serializer.serialize(option.mValue);
+			}
+		}
+	}
+}
@@ -50,6 +50,7 @@ public:
 	std::wstring mLocalDirectory;		// Local path inside mods directory, excluding the trailing slash, e.g. "my-sample-mod" or "modfolder/my-sample-mod"
 	std::wstring mFullPath;				// Complete path, now including the trailing slash, e.g. "<savedatadir>/mods/modfolder/my-sample-mod/"
 	uint64 mLocalDirectoryHash = 0;
+	uint64 mContainerKey = 0;			// Hash of the containing zip file's time and size, or 0 if the mod is not inside a zip file
 	State mState = State::INACTIVE;
 	std::string mFailedMessage;
 	uint32 mActivePriority = 0;			// Priority in mod loading, starting at 0 for lowest priority; this is also the index in mActiveMods, and is not valid for inactive mods
@@ -66,6 +67,7 @@ public:
 
 public:
 	void loadFromJson(const Json::Value& json);
+	void serializeMetadata(VectorBinarySerializer& serializer);		// Meta data and settings, i.e. everything read in "loadFromJson"
 
 private:
 	bool mDirty = false;			// Only temporarily used by ModManager
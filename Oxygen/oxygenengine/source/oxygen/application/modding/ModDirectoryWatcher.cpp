@@ -0,0 +1,127 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/application/modding/ModDirectoryWatcher.h"
+
+#if defined(PLATFORM_LINUX)
+	#include <sys/inotify.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#define USE_INOTIFY
+#endif
+
+
+ModDirectoryWatcher::~ModDirectoryWatcher()
+{
+	stopWatching();
+}
+
+bool ModDirectoryWatcher::startWatching(const std::wstring& basePath)
+{
+	stopWatching();
+	mBasePath = basePath;
+
+#if defined(USE_INOTIFY)
+	mInotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mInotifyFD < 0)
+	{
+		RMX_LOG_WARNING("Failed to initialize inotify for watching the mods directory, error " << errno);
+		return false;
+	}
+
+	addDirectory(L"");
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ModDirectoryWatcher::stopWatching()
+{
+#if defined(USE_INOTIFY)
+	if (mInotifyFD >= 0)
+	{
+		// This removes all watches as well
+		close(mInotifyFD);
+		mInotifyFD = -1;
+	}
+#endif
+	mLocalPathByWatch.clear();
+	mWatchedLocalPaths.clear();
+}
+
+void ModDirectoryWatcher::addDirectory(const std::wstring& localPath)
+{
+#if defined(USE_INOTIFY)
+	if (mInotifyFD < 0 || mWatchedLocalPaths.count(localPath) != 0)
+		return;
+
+	// Zip files are mounted like directories, but these can't be watched like this, which is fine (their parent directory gets watched anyways)
+	const uint32 mask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+	const int watch = inotify_add_watch(mInotifyFD, *WString(mBasePath + localPath).toUTF8(), mask);
+	if (watch < 0)
+		return;
+
+	mLocalPathByWatch[watch] = localPath;
+	mWatchedLocalPaths.insert(localPath);
+#endif
+}
+
+void ModDirectoryWatcher::fetchChangedDirectories(std::vector<std::wstring>& outLocalPaths)
+{
+#if defined(USE_INOTIFY)
+	if (mInotifyFD < 0)
+		return;
+
+	std::set<std::wstring> changedLocalPaths;
+	bool rescanAll = false;
+
+	alignas(struct inotify_event) char buffer[0x1000];
+	while (true)
+	{
+		const ssize_t length = read(mInotifyFD, buffer, sizeof(buffer));
+		if (length <= 0)
+			break;	// Usually EAGAIN, meaning there's no more events right now
+
+		for (ssize_t offset = 0; offset < length; )
+		{
+			const struct inotify_event& event = *(const struct inotify_event*)&buffer[offset];
+			offset += sizeof(struct inotify_event) + event.len;
+
+			if (event.mask & IN_Q_OVERFLOW)
+			{
+				// Some events got lost
+				rescanAll = true;
+				continue;
+			}
+
+			const auto it = mLocalPathByWatch.find(event.wd);
+			if (it == mLocalPathByWatch.end())
+				continue;
+
+			changedLocalPaths.insert(it->second);
+			if (event.mask & IN_IGNORED)
+			{
+				// Watch got removed, because the directory got deleted or moved away; it gets added again if the directory shows up again in a rescan
+				mWatchedLocalPaths.erase(it->second);
+				mLocalPathByWatch.erase(it);
+			}
+		}
+	}
+
+	if (rescanAll)
+	{
+		outLocalPaths.emplace_back();
+	}
+	else
+	{
+		outLocalPaths.insert(outLocalPaths.end(), changedLocalPaths.begin(), changedLocalPaths.end());
+	}
+#endif
+}
@@ -0,0 +1,37 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <rmxbase.h>
+
+
+// Watches directories inside the mods directory for changes, so that a rescan only needs to look at the directories that actually changed
+//  - Only implemented on Linux (using inotify); on other platforms, it's never active and each rescan has to be a complete one
+//  - Directories are not watched recursively, the mod manager adds each directory it looks into while scanning
+class ModDirectoryWatcher
+{
+public:
+	~ModDirectoryWatcher();
+
+	bool startWatching(const std::wstring& basePath);
+	void stopWatching();
+	inline bool isActive() const  { return (mInotifyFD >= 0); }
+
+	// Local path relative to the base path, either empty or with a trailing slash
+	void addDirectory(const std::wstring& localPath);
+
+	// Get local paths of all directories that had changes since the last call; an empty path means that everything needs to be rescanned
+	void fetchChangedDirectories(std::vector<std::wstring>& outLocalPaths);
+
+private:
+	int mInotifyFD = -1;
+	std::wstring mBasePath;
+	std::map<int, std::wstring> mLocalPathByWatch;
+	std::set<std::wstring> mWatchedLocalPaths;
+};
@@ -35,8 +35,12 @@ void ModManager::startup()
 	// Update base path (actually only needs to be done once, it shouldn't change afterwards anyways)
 	mBasePath = Configuration::instance().mAppDataPath + L"mods/";
 
+	// Load the cached mod manifests, and start watching for changes before the initial scan, so that nothing gets missed
+	mManifestCache.loadCacheFile(Configuration::instance().mAppDataPath + L"modcache.bin");
+	mDirectoryWatcher.startWatching(mBasePath);
+
 	// First go through all mod directories recursively to gather all installed mods
-	scanMods();
+	scanMods({ L"" });
 
 	// Now get the list of active mods
 	//  -> Check if there's an "active-mods.json" file and read it
@@ -84,7 +88,19 @@ void ModManager::clear()
 
 bool ModManager::rescanMods()
 {
-	return scanMods();
+	if (!mDirectoryWatcher.isActive())
+	{
+		// No way to tell what changed, so do a complete rescan
+		return scanMods({ L"" });
+	}
+
+	// Only rescan the directories that actually changed
+	std::vector<std::wstring> changedLocalPaths;
+	mDirectoryWatcher.fetchChangedDirectories(changedLocalPaths);
+	if (changedLocalPaths.empty())
+		return false;
+
+	return scanMods(changedLocalPaths);
 }
 
 void ModManager::saveActiveMods()
@@ -195,94 +211,209 @@ void ModManager::copyModSettingsToConfig()
 	}
 }
 
-bool ModManager::scanMods()
+bool ModManager::scanMods(std::vector<std::wstring> localPaths)
 {
-	// Mark all existing mods as dirty first
+	// Only keep the outermost of the directories to scan, everything inside them gets scanned anyways
+	//  -> Note that an empty local path stands for the whole mods directory, i.e. a complete rescan
+	{
+		std::sort(localPaths.begin(), localPaths.end());
+		std::vector<std::wstring> outermostPaths;
+		for (const std::wstring& localPath : localPaths)
+		{
+			if (outermostPaths.empty() || localPath.compare(0, outermostPaths.back().length(), outermostPaths.back()) != 0)
+				outermostPaths.push_back(localPath);
+		}
+		localPaths.swap(outermostPaths);
+	}
+	const bool isCompleteScan = (!localPaths.empty() && localPaths[0].empty());
+
+	const auto isInsideScannedPaths = [&](const std::wstring& localPath)
+	{
+		for (const std::wstring& scannedPath : localPaths)
+		{
+			if (localPath.compare(0, scannedPath.length(), scannedPath) == 0)
+				return true;
+		}
+		return false;
+	};
+	const auto isInsideKnownMod = [&](const std::wstring& localPath)
+	{
+		for (Mod* mod : mAllMods)
+		{
+			if (localPath.length() > mod->mLocalDirectory.length() && localPath[mod->mLocalDirectory.length()] == L'/' && localPath.compare(0, mod->mLocalDirectory.length(), mod->mLocalDirectory) == 0)
+				return true;
+		}
+		return false;
+	};
+
+	// Mark all existing mods inside the scanned directories as dirty first
 	for (Mod* existingMod : mAllMods)
 	{
-		existingMod->mDirty = true;
+		existingMod->mDirty = isInsideScannedPaths(existingMod->mLocalDirectory + L'/');
 	}
 
-	// Check for zip files in the mods directory
+	// Check for zip files in the scanned directories, up to a depth of 3 inside the mods directory
 	{
 		std::vector<std::wstring> zipPaths;
-		findZipsRecursively(zipPaths, L"", 3);
-		for (const std::wstring& zipPath : zipPaths)
+		for (const std::wstring& localPath : localPaths)
 		{
-			processModZipFile(zipPath);
+			const int depth = (int)std::count(localPath.begin(), localPath.end(), L'/');
+			if (depth <= 3 && !isInsideKnownMod(localPath))
+			{
+				findZipsRecursively(zipPaths, localPath, 3 - depth);
+			}
+		}
+
+		// Zip files that were already added before don't need to be loaded again
+		for (auto it = zipPaths.begin(); it != zipPaths.end(); )
+		{
+			if (mZipFileProviders.count(*it) != 0)
+				it = zipPaths.erase(it);
+			else
+				++it;
+		}
+
+		// Creating the zip file providers means indexing each zip file's contents, which is done in parallel
+		std::vector<ZipFileProvider*> providers(zipPaths.size(), nullptr);
+		FTX::ParallelFor->execute((int)zipPaths.size(), 1, [&](int firstIndex, int endIndex)
+		{
+			for (int index = firstIndex; index < endIndex; ++index)
+			{
+				providers[index] = new ZipFileProvider(mBasePath + zipPaths[index]);
+			}
+		});
+
+		// Mounting on the other hand is done in a fixed order
+		for (size_t index = 0; index < zipPaths.size(); ++index)
+		{
+			processModZipFile(zipPaths[index], *providers[index]);
 		}
 	}
 
-	// Scan mod directory
+	// Scan the directories
 	std::vector<FoundMod> foundMods;
 	foundMods.reserve(0x100);		// We can be generous here to avoid reallocations
-	scanDirectoryRecursive(foundMods, L"");
+	for (const std::wstring& localPath : localPaths)
+	{
+		if (!localPath.empty())
+		{
+			// The directory might be a mod itself, e.g. when its "mod.json" got changed
+			const size_t slashPosition = (localPath.length() >= 2) ? localPath.find_last_of(L'/', localPath.length() - 2) : std::wstring::npos;
+			const std::wstring parentPath = (slashPosition == std::wstring::npos) ? std::wstring() : localPath.substr(0, slashPosition + 1);
+			const std::wstring directoryName = localPath.substr(parentPath.length(), localPath.length() - parentPath.length() - 1);
+			if (checkModDirectory(foundMods, parentPath, directoryName))
+				continue;
+		}
+
+		mDirectoryWatcher.addDirectory(localPath);
+		scanDirectoryRecursive(foundMods, localPath, (uint64)rmx::FileIO::getModificationTime(mBasePath + localPath));
+	}
 
 	// Have a closer look at the mods found
+	const std::string& buildVersion = EngineMain::getDelegate().getAppMetaData().mBuildVersion;
 	bool anyChange = false;
-	for (const FoundMod& foundMod : foundMods)
+	bool anyModReloaded = false;
+	for (FoundMod& foundMod : foundMods)
 	{
 		const std::string name = WString(foundMod.mModName).toStdString();
-		const Json::Value& root = foundMod.mModJson;
-
-		std::string errorMessage;
-		{
-			Json::Value metadataJson = root["Metadata"];
-			if (metadataJson.isObject())
-			{
-				Json::Value value = metadataJson["GameVersion"];
-				if (value.isString())
-				{
-					if (value.asString() > EngineMain::getDelegate().getAppMetaData().mBuildVersion)
-					{
-						errorMessage = "Mod '" + name + "' requires newer game version " + value.asString().c_str();
-					}
-				}
-			}
-		}
-
 		const std::wstring localDirectory = foundMod.mLocalPath + foundMod.mModName;
 		const uint64 hash = rmx::getMurmur2_64(localDirectory);
+
+		Mod* mod = nullptr;
 		const auto it = mModsByLocalDirectoryHash.find(hash);
 		if (it != mModsByLocalDirectoryHash.end())
 		{
 			// It's an already known mod, mark as still present
-			Mod* mod = it->second;
+			mod = it->second;
 			mod->mDirty = false;
-
-			// TODO: Check if mod got changed since last scan
-			//  -> Having a different modification date of "mod.json" should be a good enough lightweight test
-			//  -> If changed, reload mod; and if it's active, reload content as well
-
+			mod->mContainerKey = foundMod.mContainerKey;
+
+			// Reload its meta data only if its "mod.json" changed since the last scan
+			//  -> Without a file time, there's no way to tell, so assume it did not change
+			//  -> If the mod is active, its content does not get reloaded here, that requires the active mods to change
+			const bool manifestChanged = (nullptr == foundMod.mCacheEntry) && (foundMod.mFileTime != 0 || foundMod.mContainerKey != 0);
+			if (!manifestChanged)
+				continue;
+
+			RMX_LOG_INFO("Reloading changed mod: '" << name << "'");
+			mod->mDisplayName.clear();
+			mod->mModVersion.clear();
+			mod->mAuthor.clear();
+			mod->mDescription.clear();
+			mod->mURL.clear();
+			mod->mSettingCategories.clear();
+			anyModReloaded = true;
 		}
 		else
 		{
 			// Add as a new mod
-			Mod* mod = new Mod();
+			mod = new Mod();
 			mod->mName = name;
 			mod->mLocalDirectory = localDirectory;
 			mod->mFullPath = mBasePath + localDirectory + L'/';
 			mod->mLocalDirectoryHash = hash;
+			mod->mContainerKey = foundMod.mContainerKey;
 
 			mAllMods.emplace_back(mod);
 			mModsByLocalDirectoryHash[hash] = mod;
-			anyChange = true;
+		}
+		anyChange = true;
 
-			if (errorMessage.empty())
+		// Load mod meta data, preferably from the manifest cache, otherwise from JSON
+		std::string requiredGameVersion;
+		bool loadedFromCache = false;
+		if (nullptr != foundMod.mCacheEntry)
+		{
+			requiredGameVersion = foundMod.mCacheEntry->mRequiredGameVersion;
+			loadedFromCache = mManifestCache.loadModFromEntry(*foundMod.mCacheEntry, *mod);
+		}
+		if (!loadedFromCache)
+		{
+			if (nullptr != foundMod.mCacheEntry)
 			{
-				RMX_LOG_INFO("Found mod: '" << name << "'");
-				mod->mState = Mod::State::INACTIVE;
+				// Cache entry turned out to be broken after all, so load the JSON now
+				foundMod.mModJson = JsonHelper::loadFile(mBasePath + localDirectory + L"/mod.json");
+			}
 
-				// Load mod meta data from JSON
-				mod->loadFromJson(root);
+			const Json::Value& root = foundMod.mModJson;
+			Json::Value metadataJson = root["Metadata"];
+			if (metadataJson.isObject())
+			{
+				Json::Value value = metadataJson["GameVersion"];
+				if (value.isString())
+				{
+					requiredGameVersion = value.asString();
+				}
 			}
-			else
+
+			mod->loadFromJson(root);
+			mManifestCache.updateEntry(localDirectory, foundMod.mFileTime, foundMod.mFileSize, foundMod.mContainerKey, requiredGameVersion, *mod);
+		}
+
+		if (!requiredGameVersion.empty() && requiredGameVersion > buildVersion)
+		{
+			RMX_LOG_INFO("Could not load mod: '" << name << "'");
+			if (mod->mState != Mod::State::ACTIVE)
 			{
-				RMX_LOG_INFO("Could not load mod: '" << name << "'");
 				mod->mState = Mod::State::FAILED;
-				mod->mFailedMessage = errorMessage;
 			}
+			mod->mFailedMessage = "Mod '" + name + "' requires newer game version " + requiredGameVersion;
 		}
+		else
+		{
+			RMX_LOG_INFO("Found mod: '" << name << "'");
+			if (mod->mState == Mod::State::FAILED)
+			{
+				mod->mState = Mod::State::INACTIVE;
+			}
+			mod->mFailedMessage.clear();
+		}
+	}
+
+	if (anyModReloaded)
+	{
+		// Settings of reloaded mods got reset to their defaults
+		copyModSettingsFromConfig();
 	}
 
 	// Check for mods still marked dirty, those got deleted
@@ -303,6 +434,7 @@ bool ModManager::scanMods()
 					}
 				}
 				mModsByLocalDirectoryHash.erase(mod->mLocalDirectoryHash);
+				mManifestCache.removeEntry(mod->mLocalDirectory);
 				it = mAllMods.erase(it);
 				delete mod;
 				anyChange = true;
@@ -322,38 +454,98 @@ bool ModManager::scanMods()
 	// Sort mod list
 	std::sort(mAllMods.begin(), mAllMods.end(), &detail::CompareMods);
 
+	// Update the manifest cache file
+	if (isCompleteScan)
+	{
+		mManifestCache.removeEntriesExcept(mModsByLocalDirectoryHash);
+		mManifestCache.removeUnusedDirectoryEntries();
+	}
+	mManifestCache.saveCacheFile();
+
 	return anyChange;
 }
 
-void ModManager::scanDirectoryRecursive(std::vector<FoundMod>& outFoundMods, const std::wstring& localPath)
+void ModManager::scanDirectoryRecursive(std::vector<FoundMod>& outFoundMods, const std::wstring& localPath, uint64 directoryTime)
 {
+	// The list of subdirectories only needs to be read again if any directory entries were added, removed or renamed since the last scan
 	std::vector<std::wstring> subDirectories;
-	FTX::FileSystem->listDirectories(mBasePath + localPath, subDirectories);
+	const ModManifestCache::DirectoryEntry* cachedDirectory = mManifestCache.findDirectoryEntry(localPath, directoryTime);
+	if (nullptr != cachedDirectory)
+	{
+		subDirectories = cachedDirectory->mSubDirectories;
+	}
+	else
+	{
+		FTX::FileSystem->listDirectories(mBasePath + localPath, subDirectories);
+
+		// Completely ignore directory names starting with #
+		subDirectories.erase(std::remove_if(subDirectories.begin(), subDirectories.end(), [](const std::wstring& name) { return name[0] == L'#'; }), subDirectories.end());
+		mManifestCache.updateDirectoryEntry(localPath, directoryTime, subDirectories);
+	}
 
 	for (const std::wstring& modName : subDirectories)
 	{
-		// Completely ignore directory names starting with #
-		if (modName[0] != L'#')
+		// A subdirectory that was cached as no mod and did not change since can't have gotten a "mod.json" in the meantime
+		const std::wstring subPath = localPath + modName + L'/';
+		const uint64 subDirectoryTime = (uint64)rmx::FileIO::getModificationTime(mBasePath + subPath);
+		const bool isUnchangedNonModDirectory = (nullptr != mManifestCache.findDirectoryEntry(subPath, subDirectoryTime));
+
+		// Check if this directory is itself a mod
+		if (isUnchangedNonModDirectory || !checkModDirectory(outFoundMods, localPath, modName))
 		{
-			// Check if this directory is itself a mod
-			Json::Value root = JsonHelper::loadFile(mBasePath + localPath + modName + L"/mod.json");
-			if (root.isObject())
-			{
-				// Looks like this directory is meant to be a mod
-				FoundMod& foundMod = vectorAdd(outFoundMods);
-				foundMod.mLocalPath = localPath;
-				foundMod.mModName = modName;
-				foundMod.mModJson = root;
-			}
-			else
-			{
-				// No "mod.json" found, scan subdirectories
-				scanDirectoryRecursive(outFoundMods, localPath + modName + L'/');
-			}
+			// No "mod.json" found, scan subdirectories
+			mDirectoryWatcher.addDirectory(subPath);
+			scanDirectoryRecursive(outFoundMods, subPath, subDirectoryTime);
 		}
 	}
 }
 
+bool ModManager::checkModDirectory(std::vector<FoundMod>& outFoundMods, const std::wstring& localPath, const std::wstring& directoryName)
+{
+	const std::wstring localDirectory = localPath + directoryName;
+	const std::wstring manifestPath = mBasePath + localDirectory + L"/mod.json";
+
+	// Get file time and size of the "mod.json", if there is one
+	std::vector<rmx::FileIO::FileEntry> fileEntries;
+	FTX::FileSystem->listFilesByMask(manifestPath, false, fileEntries);
+	if (fileEntries.empty())
+		return false;
+
+	FoundMod foundMod;
+	foundMod.mLocalPath = localPath;
+	foundMod.mModName = directoryName;
+	foundMod.mFileTime = (uint64)fileEntries[0].mTime;
+	foundMod.mFileSize = (uint64)fileEntries[0].mSize;
+	foundMod.mContainerKey = getContainerKey(localDirectory);
+
+	// Only load the JSON if there's no valid cached manifest
+	foundMod.mCacheEntry = mManifestCache.findEntry(localDirectory, foundMod.mFileTime, foundMod.mFileSize, foundMod.mContainerKey);
+	if (nullptr == foundMod.mCacheEntry)
+	{
+		foundMod.mModJson = JsonHelper::loadFile(manifestPath);
+		if (!foundMod.mModJson.isObject())
+			return false;
+	}
+
+	// Looks like this directory is meant to be a mod
+	outFoundMods.emplace_back(std::move(foundMod));
+
+	// Watch the mod directory as well, for changes of its "mod.json"
+	mDirectoryWatcher.addDirectory(localDirectory + L'/');
+	return true;
+}
+
+uint64 ModManager::getContainerKey(const std::wstring& localDirectory) const
+{
+	for (const auto& pair : mZipFileKeys)
+	{
+		const std::wstring& zipLocalPath = pair.first;
+		if (localDirectory.compare(0, zipLocalPath.length(), zipLocalPath) == 0 && (localDirectory.length() == zipLocalPath.length() || localDirectory[zipLocalPath.length()] == L'/'))
+			return pair.second;
+	}
+	return 0;
+}
+
 void ModManager::findZipsRecursively(std::vector<std::wstring>& outZipPaths, const std::wstring& localPath, int maxDepth)
 {
 	std::vector<rmx::FileIO::FileEntry> zipFileEntries;
@@ -361,6 +553,10 @@ void ModManager::findZipsRecursively(std::vector<std::wstring>& outZipPaths, con
 	for (const rmx::FileIO::FileEntry& zipFileEntry : zipFileEntries)
 	{
 		outZipPaths.push_back(localPath + zipFileEntry.mFilename);
+
+		// Remember time and size of the zip file as it was when first found, as zip files don't get reloaded later on
+		const uint64 data[2] = { (uint64)zipFileEntry.mTime, (uint64)zipFileEntry.mSize };
+		mZipFileKeys.emplace(outZipPaths.back(), std::max<uint64>(rmx::getMurmur2_64((const uint8*)data, sizeof(data)), 1));
 	}
 
 	if (maxDepth > 0)
@@ -382,22 +578,13 @@ void ModManager::findZipsRecursively(std::vector<std::wstring>& outZipPaths, con
 	}
 }
 
-bool ModManager::processModZipFile(const std::wstring& zipLocalPath)
+bool ModManager::processModZipFile(const std::wstring& zipLocalPath, ZipFileProvider& provider)
 {
-	const auto it = mZipFileProviders.find(zipLocalPath);
-	if (it != mZipFileProviders.end())
-	{
-		// Already added, nothing else to do
-		return true;
-	}
-
-	// Create a new zip file provider
-	ZipFileProvider* provider = new ZipFileProvider(mBasePath + zipLocalPath);
-	if (provider->isLoaded())
+	if (provider.isLoaded())
 	{
 		// Mount using the zip file name as a virtual folder name
-		FTX::FileSystem->addMountPoint(*provider, mBasePath + zipLocalPath + L"/", L"", 0x100);
-		mZipFileProviders[zipLocalPath] = provider;
+		FTX::FileSystem->addMountPoint(provider, mBasePath + zipLocalPath + L"/", L"", 0x100);
+		mZipFileProviders[zipLocalPath] = &provider;
 
 		// Done
 		RMX_LOG_INFO("Loaded mod zip file: " << WString(zipLocalPath).toStdString());
@@ -407,7 +594,7 @@ bool ModManager::processModZipFile(const std::wstring& zipLocalPath)
 	{
 		// Failure
 		RMX_LOG_INFO("Failed to load mod zip file: " << WString(zipLocalPath).toStdString());
-		delete provider;
+		delete &provider;
 		return false;
 	}
 }
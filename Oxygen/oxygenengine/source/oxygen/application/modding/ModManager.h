@@ -9,6 +9,8 @@
 #pragma once
 
 #include "oxygen/application/modding/Mod.h"
+#include "oxygen/application/modding/ModDirectoryWatcher.h"
+#include "oxygen/application/modding/ModManifestCache.h"
 #include <functional>
 
 class ZipFileProvider;
@@ -38,14 +40,20 @@ private:
 	{
 		std::wstring mLocalPath;
 		std::wstring mModName;
+		uint64 mFileTime = 0;
+		uint64 mFileSize = 0;
+		uint64 mContainerKey = 0;
+		const ModManifestCache::Entry* mCacheEntry = nullptr;	// Only set if the cached manifest is still valid, otherwise the JSON got loaded
 		Json::Value mModJson;
 	};
 
 private:
-	bool scanMods();
-	void scanDirectoryRecursive(std::vector<FoundMod>& outFoundMods, const std::wstring& localPath);
+	bool scanMods(std::vector<std::wstring> localPaths);
+	void scanDirectoryRecursive(std::vector<FoundMod>& outFoundMods, const std::wstring& localPath, uint64 directoryTime);
+	bool checkModDirectory(std::vector<FoundMod>& outFoundMods, const std::wstring& localPath, const std::wstring& directoryName);
+	uint64 getContainerKey(const std::wstring& localDirectory) const;
 	void findZipsRecursively(std::vector<std::wstring>& outZipPaths, const std::wstring& localPath, int maxDepth);
-	bool processModZipFile(const std::wstring& zipLocalPath);
+	bool processModZipFile(const std::wstring& zipLocalPath, ZipFileProvider& provider);
 	void onActiveModsChanged(bool duringStartup = false);
 
 private:
@@ -55,4 +63,7 @@ private:
 	std::unordered_map<uint64, Mod*> mActiveModsByNameHash;		// Each mod is registered by both its internal name and display name
 	std::unordered_map<uint64, Mod*> mModsByLocalDirectoryHash;
 	std::map<std::wstring, ZipFileProvider*> mZipFileProviders;
+	std::map<std::wstring, uint64> mZipFileKeys;		// Combination of file time and size of each zip file, used to validate cached manifests of mods inside zips
+	ModManifestCache mManifestCache;
+	ModDirectoryWatcher mDirectoryWatcher;
 };
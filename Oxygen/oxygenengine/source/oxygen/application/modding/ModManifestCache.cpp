@@ -0,0 +1,251 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/application/modding/ModManifestCache.h"
+#include "oxygen/application/modding/Mod.h"
+
+
+namespace
+{
+	const char* FORMAT_IDENTIFIER = "OXY.MODCACHE";
+	const uint16 FORMAT_VERSION = 0x0101;		// Added directory entries
+
+	// Directories changed this recently might still change within the same second, which the directory time can't tell apart
+	const time_t MIN_DIRECTORY_AGE = 2;
+}
+
+
+void ModManifestCache::loadCacheFile(const std::wstring& filename)
+{
+	mCacheFilename = filename;
+	mEntries.clear();
+	mDirectoryEntries.clear();
+	mCacheChanged = false;
+
+	std::vector<uint8> content;
+	if (!FTX::FileSystem->readFile(filename, content))
+		return;
+
+	VectorBinarySerializer serializer(true, content);
+	if (!serialize(serializer) || serializer.hasError())
+	{
+		// Ignore a broken or outdated cache, it will simply get rebuilt
+		mEntries.clear();
+		mDirectoryEntries.clear();
+		mCacheChanged = true;
+	}
+}
+
+void ModManifestCache::saveCacheFile()
+{
+	if (!mCacheChanged || mCacheFilename.empty())
+		return;
+
+	std::vector<uint8> content;
+	VectorBinarySerializer serializer(false, content);
+	if (!serialize(serializer))
+		return;
+
+	FTX::FileSystem->saveFile(mCacheFilename, content);
+	mCacheChanged = false;
+}
+
+const ModManifestCache::Entry* ModManifestCache::findEntry(const std::wstring& localDirectory, uint64 fileTime, uint64 fileSize, uint64 containerKey) const
+{
+	// Without any file time, there's no way to tell whether the manifest changed
+	if (fileTime == 0 && containerKey == 0)
+		return nullptr;
+
+	const auto it = mEntries.find(rmx::getMurmur2_64(localDirectory));
+	if (it == mEntries.end())
+		return nullptr;
+
+	const Entry& entry = it->second;
+	if (entry.mLocalDirectory != localDirectory || entry.mFileTime != fileTime || entry.mFileSize != fileSize || entry.mContainerKey != containerKey)
+		return nullptr;
+
+	return &entry;
+}
+
+void ModManifestCache::updateEntry(const std::wstring& localDirectory, uint64 fileTime, uint64 fileSize, uint64 containerKey, const std::string& requiredGameVersion, Mod& mod)
+{
+	Entry& entry = mEntries[rmx::getMurmur2_64(localDirectory)];
+	entry.mLocalDirectory = localDirectory;
+	entry.mFileTime = fileTime;
+	entry.mFileSize = fileSize;
+	entry.mContainerKey = containerKey;
+	entry.mRequiredGameVersion = requiredGameVersion;
+	entry.mMetadata.clear();
+
+	VectorBinarySerializer serializer(false, entry.mMetadata);
+	mod.serializeMetadata(serializer);
+	mCacheChanged = true;
+}
+
+void ModManifestCache::removeEntry(const std::wstring& localDirectory)
+{
+	if (mEntries.erase(rmx::getMurmur2_64(localDirectory)) != 0)
+	{
+		mCacheChanged = true;
+	}
+}
+
+void ModManifestCache::removeEntriesExcept(const std::unordered_map<uint64, Mod*>& modsByLocalDirectoryHash)
+{
+	for (auto it = mEntries.begin(); it != mEntries.end(); )
+	{
+		if (modsByLocalDirectoryHash.count(it->first) == 0)
+		{
+			it = mEntries.erase(it);
+			mCacheChanged = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+bool ModManifestCache::loadModFromEntry(const Entry& entry, Mod& mod) const
+{
+	VectorBinarySerializer serializer(true, entry.mMetadata);
+	mod.serializeMetadata(serializer);
+	return !serializer.hasError();
+}
+
+const ModManifestCache::DirectoryEntry* ModManifestCache::findDirectoryEntry(const std::wstring& localPath, uint64 directoryTime)
+{
+	if (directoryTime == 0)
+		return nullptr;
+
+	const auto it = mDirectoryEntries.find(rmx::getMurmur2_64(localPath));
+	if (it == mDirectoryEntries.end())
+		return nullptr;
+
+	DirectoryEntry& entry = it->second;
+	if (entry.mLocalPath != localPath || entry.mDirectoryTime != directoryTime)
+		return nullptr;
+
+	entry.mUsed = true;
+	return &entry;
+}
+
+void ModManifestCache::updateDirectoryEntry(const std::wstring& localPath, uint64 directoryTime, const std::vector<std::wstring>& subDirectories)
+{
+	DirectoryEntry& entry = mDirectoryEntries[rmx::getMurmur2_64(localPath)];
+	entry.mLocalPath = localPath;
+	entry.mDirectoryTime = ((time_t)directoryTime + MIN_DIRECTORY_AGE <= time(nullptr)) ? directoryTime : 0;
+	entry.mSubDirectories = subDirectories;
+	entry.mUsed = true;
+	mCacheChanged = true;
+}
+
+void ModManifestCache::removeUnusedDirectoryEntries()
+{
+	for (auto it = mDirectoryEntries.begin(); it != mDirectoryEntries.end(); )
+	{
+		if (it->second.mUsed)
+		{
+			it->second.mUsed = false;
+			++it;
+		}
+		else
+		{
+			it = mDirectoryEntries.erase(it);
+			mCacheChanged = true;
+		}
+	}
+}
+
+bool ModManifestCache::serialize(VectorBinarySerializer& serializer)
+{
+	// Identifier
+	if (serializer.isReading())
+	{
+		char identifier[13];
+		serializer.read(identifier, 12);
+		if (memcmp(identifier, FORMAT_IDENTIFIER, 12) != 0)
+			return false;
+	}
+	else
+	{
+		serializer.write(FORMAT_IDENTIFIER, 12);
+	}
+
+	// Format version
+	uint16 formatVersion = FORMAT_VERSION;
+	serializer& formatVersion;
+	if (serializer.isReading() && formatVersion != FORMAT_VERSION)
+		return false;
+
+	// Cache entries
+	if (serializer.isReading())
+	{
+		const size_t count = (size_t)serializer.read<uint32>();
+		for (size_t i = 0; i < count && !serializer.hasError(); ++i)
+		{
+			Entry entry;
+			serializer.serialize(entry.mLocalDirectory);
+			serializer.serialize(entry.mFileTime);
+			serializer.serialize(entry.mFileSize);
+			serializer.serialize(entry.mContainerKey);
+			serializer.serialize(entry.mRequiredGameVersion);
+			serializer.serializeData(entry.mMetadata);
+			mEntries[rmx::getMurmur2_64(entry.mLocalDirectory)] = std::move(entry);
+		}
+	}
+	else
+	{
+		serializer.writeAs<uint32>(mEntries.size());
+		for (auto& pair : mEntries)
+		{
+			Entry& entry = pair.second;
+			serializer.serialize(entry.mLocalDirectory);
+			serializer.serialize(entry.mFileTime);
+			serializer.serialize(entry.mFileSize);
+			serializer.serialize(entry.mContainerKey);
+			serializer.serialize(entry.mRequiredGameVersion);
+			serializer.serializeData(entry.mMetadata);
+		}
+	}
+
+	// Directory entries
+	if (serializer.isReading())
+	{
+		const size_t count = (size_t)serializer.read<uint32>();
+		for (size_t i = 0; i < count && !serializer.hasError(); ++i)
+		{
+			DirectoryEntry entry;
+			serializer.serialize(entry.mLocalPath);
+			serializer.serialize(entry.mDirectoryTime);
+			serializer.serializeArraySize(entry.mSubDirectories);
+			for (std::wstring& subDirectory : entry.mSubDirectories)
+			{
+				serializer.serialize(subDirectory);
+			}
+			mDirectoryEntries[rmx::getMurmur2_64(entry.mLocalPath)] = std::move(entry);
+		}
+	}
+	else
+	{
+		serializer.writeAs<uint32>(mDirectoryEntries.size());
+		for (auto& pair : mDirectoryEntries)
+		{
+			DirectoryEntry& entry = pair.second;
+			serializer.serialize(entry.mLocalPath);
+			serializer.serialize(entry.mDirectoryTime);
+			serializer.serializeArraySize(entry.mSubDirectories);
+			for (std::wstring& subDirectory : entry.mSubDirectories)
+			{
+				serializer.serialize(subDirectory);
+			}
+		}
+	}
+	return !serializer.hasError();
+}
@@ -0,0 +1,67 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <rmxbase.h>
+
+class Mod;
+
+
+// Persisted cache of the parsed "mod.json" manifests, so that unchanged mods don't need their manifest to be read and parsed again on each start
+//  - An entry is valid as long as the manifest's file time and size stay the same, plus the time and size of the containing zip file for mods inside zips
+//  - Directories in the mods tree that are no mods themselves get cached as well, so that unchanged ones don't need to be listed again
+class ModManifestCache
+{
+public:
+	struct Entry
+	{
+		std::wstring mLocalDirectory;
+		uint64 mFileTime = 0;
+		uint64 mFileSize = 0;
+		uint64 mContainerKey = 0;		// Zero for mods that are not inside a zip file
+		std::string mRequiredGameVersion;
+		std::vector<uint8> mMetadata;	// Serialized using "Mod::serializeMetadata"
+	};
+
+	struct DirectoryEntry
+	{
+		std::wstring mLocalPath;
+		uint64 mDirectoryTime = 0;
+		std::vector<std::wstring> mSubDirectories;
+		bool mUsed = false;				// Not serialized, only used to find out which entries are outdated
+	};
+
+public:
+	void loadCacheFile(const std::wstring& filename);
+	void saveCacheFile();
+
+	// Returns the entry only if it is still valid
+	const Entry* findEntry(const std::wstring& localDirectory, uint64 fileTime, uint64 fileSize, uint64 containerKey) const;
+
+	void updateEntry(const std::wstring& localDirectory, uint64 fileTime, uint64 fileSize, uint64 containerKey, const std::string& requiredGameVersion, Mod& mod);
+	void removeEntry(const std::wstring& localDirectory);
+	void removeEntriesExcept(const std::unordered_map<uint64, Mod*>& modsByLocalDirectoryHash);
+
+	bool loadModFromEntry(const Entry& entry, Mod& mod) const;
+
+	// Returns the entry only if the directory did not change since it was cached
+	const DirectoryEntry* findDirectoryEntry(const std::wstring& localPath, uint64 directoryTime);
+
+	void updateDirectoryEntry(const std::wstring& localPath, uint64 directoryTime, const std::vector<std::wstring>& subDirectories);
+	void removeUnusedDirectoryEntries();
+
+private:
+	bool serialize(VectorBinarySerializer& serializer);
+
+private:
+	std::wstring mCacheFilename;
+	std::map<uint64, Entry> mEntries;		// Using the hash of the local directory as key, same as in the mod manager
+	std::map<uint64, DirectoryEntry> mDirectoryEntries;		// Using the hash of the local path as key
+	bool mCacheChanged = false;
+};
@@ -0,0 +1,113 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/application/video/RenderThread.h"
+#include "oxygen/rendering/software/SoftwareRenderer.h"
+
+
+RenderThread::RenderThread() :
+	ThreadBase("Oxygen RenderThread")
+{
+	mMutex = SDL_CreateMutex();
+	mWakeUpCondition = SDL_CreateCond();
+	mDoneCondition = SDL_CreateCond();
+}
+
+RenderThread::~RenderThread()
+{
+	stop();
+	SDL_DestroyCond(mDoneCondition);
+	SDL_DestroyCond(mWakeUpCondition);
+	SDL_DestroyMutex(mMutex);
+}
+
+void RenderThread::startRendering(SoftwareRenderer& renderer, const std::vector<Geometry*>& geometries)
+{
+	if (!mThreadStarted)
+	{
+		mThreadStarted = true;
+		startThread();
+	}
+
+	SDL_LockMutex(mMutex);
+	RMX_ASSERT(!mRendering, "Render thread is still busy with the last frame");
+	mRenderer = &renderer;
+	mGeometries = &geometries;
+	mRendering = true;
+	SDL_CondSignal(mWakeUpCondition);
+	SDL_UnlockMutex(mMutex);
+}
+
+bool RenderThread::isBusy()
+{
+	SDL_LockMutex(mMutex);
+	const bool rendering = mRendering;
+	SDL_UnlockMutex(mMutex);
+	return rendering;
+}
+
+bool RenderThread::waitUntilDone()
+{
+	SDL_LockMutex(mMutex);
+	while (mRendering)
+	{
+		SDL_CondWait(mDoneCondition, mMutex);
+	}
+	const bool hasRenderedFrame = mHasRenderedFrame;
+	mHasRenderedFrame = false;
+	SDL_UnlockMutex(mMutex);
+	return hasRenderedFrame;
+}
+
+void RenderThread::stop()
+{
+	if (!mThreadStarted)
+		return;
+
+	// The thread is surely running at this point, as it had to render at least one frame already
+	waitUntilDone();
+
+	SDL_LockMutex(mMutex);
+	mStopRequested = true;
+	SDL_CondSignal(mWakeUpCondition);
+	SDL_UnlockMutex(mMutex);
+
+	joinThread();
+	mThreadStarted = false;
+	mStopRequested = false;
+}
+
+void RenderThread::threadFunc()
+{
+	SDL_LockMutex(mMutex);
+	while (mShouldBeRunning && !mStopRequested)
+	{
+		if (mRendering)
+		{
+			SoftwareRenderer& renderer = *mRenderer;
+			const std::vector<Geometry*>& geometries = *mGeometries;
+			SDL_UnlockMutex(mMutex);
+
+			{
+				RMX_TRACE_SCOPE("SoftwareRenderer::renderGameScreenToBitmap");
+				renderer.renderGameScreenToBitmap(geometries);
+			}
+
+			SDL_LockMutex(mMutex);
+			mRendering = false;
+			mHasRenderedFrame = true;
+			SDL_CondSignal(mDoneCondition);
+		}
+		else
+		{
+			SDL_CondWait(mWakeUpCondition, mMutex);
+		}
+	}
+	SDL_UnlockMutex(mMutex);
+}
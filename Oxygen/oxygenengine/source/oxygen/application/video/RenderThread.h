@@ -0,0 +1,44 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <rmxmedia.h>
+
+class Geometry;
+class SoftwareRenderer;
+
+
+// Worker thread for pipelined rendering, see "VideoOut": renders one frame with the software renderer while the main thread continues
+class RenderThread final : public rmx::ThreadBase
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	void startRendering(SoftwareRenderer& renderer, const std::vector<Geometry*>& geometries);
+	bool isBusy();
+	bool waitUntilDone();		// Returns true if a frame was rendered since the last call
+	void stop();
+
+protected:
+	void threadFunc() override;
+
+private:
+	SDL_mutex* mMutex = nullptr;
+	SDL_cond* mWakeUpCondition = nullptr;
+	SDL_cond* mDoneCondition = nullptr;
+
+	// All protected by the mutex
+	SoftwareRenderer* mRenderer = nullptr;
+	const std::vector<Geometry*>* mGeometries = nullptr;
+	bool mThreadStarted = false;
+	bool mStopRequested = false;
+	bool mRendering = false;
+	bool mHasRenderedFrame = false;
+};
@@ -8,6 +8,7 @@
 
 #include "oxygen/pch.h"
 #include "oxygen/application/video/VideoOut.h"
+#include "oxygen/application/video/RenderThread.h"
 #include "oxygen/application/Configuration.h"
 #include "oxygen/application/EngineMain.h"
 #include "oxygen/drawing/DrawerTexture.h"
@@ -31,6 +32,9 @@ VideoOut::VideoOut() :
 
 VideoOut::~VideoOut()
 {
+	delete mRenderThread;
+	delete mPipelinedRenderer;
+	delete mPipelinedRenderParts;
 	delete mHardwareRenderer;
 	delete mSoftwareRenderer;
 	delete mRenderParts;
@@ -57,11 +61,19 @@ void VideoOut::startup()
 
 void VideoOut::shutdown()
 {
+	if (nullptr != mRenderThread)
+	{
+		mRenderThread->stop();
+	}
 	clearGeometries();
 }
 
 void VideoOut::reset()
 {
+	finishPipelinedRendering();
+	mPipelinedSnapshotValid = false;
+	mPipelinedFrameAvailable = false;
+
 	mRenderParts->reset();
 	mActiveRenderer->reset();
 
@@ -82,12 +94,15 @@ void VideoOut::createRenderer(bool reset)
 
 void VideoOut::destroyRenderer()
 {
+	finishPipelinedRendering();
 	SAFE_DELETE(mHardwareRenderer);
 	SAFE_DELETE(mSoftwareRenderer);
 }
 
 void VideoOut::setActiveRenderer(bool useSoftwareRenderer, bool reset)
 {
+	finishPipelinedRendering();
+
 	if (useSoftwareRenderer)
 	{
 		if (nullptr == mSoftwareRenderer)
@@ -122,12 +137,20 @@ void VideoOut::setActiveRenderer(bool useSoftwareRenderer, bool reset)
 
 void VideoOut::setScreenSize(uint32 width, uint32 height)
 {
+	finishPipelinedRendering();
+	mPipelinedFrameAvailable = false;
+
 	mGameResolution.x = width;
 	mGameResolution.y = height;
 
 	mGameScreenTexture.setupAsRenderTarget(mGameResolution.x, mGameResolution.y);
 
 	mActiveRenderer->setGameResolution(mGameResolution);
+
+	if (nullptr != mPipelinedRenderer)
+	{
+		mPipelinedRenderer->setGameResolution(mGameResolution);
+	}
 }
 
 Vec2i VideoOut::getInterpolatedWorldSpaceOffset() const
@@ -141,10 +164,15 @@ Vec2i VideoOut::getInterpolatedWorldSpaceOffset() const
 	return offset;
 }
 
-void VideoOut::preFrameUpdate()
+void VideoOut::preFrameUpdate(bool willBeDisplayed)
 {
-	mRenderParts->preFrameUpdate();
-	mLastWorldSpaceOffset = mRenderParts->getSpacesManager().getWorldSpaceOffset();
+	// Frames that won't be displayed skip what's only needed for frame interpolation
+	//  -> Everything else has to be done for each frame, as scripts rely on these resets, and sprites of the skipped frame must not show up in the next one
+	mRenderParts->preFrameUpdate(willBeDisplayed);
+	if (willBeDisplayed)
+	{
+		mLastWorldSpaceOffset = mRenderParts->getSpacesManager().getWorldSpaceOffset();
+	}
 
 	// Skipped frames without rendering?
 	if (mFrameState == FrameState::FRAME_READY)
@@ -159,12 +187,27 @@ void VideoOut::preFrameUpdate()
 	mDebugDrawRenderingRequested = false;
 }
 
-void VideoOut::postFrameUpdate()
+void VideoOut::postFrameUpdate(bool willBeDisplayed)
 {
 	mRenderParts->postFrameUpdate();
 
-	// Signal for rendering
-	mFrameState = FrameState::FRAME_READY;
+	mUsingPipelinedRendering = shouldUsePipelinedRendering();
+	if (mUsingPipelinedRendering && willBeDisplayed)
+	{
+		// Take over the last frame from the render thread, and let it start rendering this one
+		finishPipelinedRendering();
+		startPipelinedRendering();
+		mFrameState = FrameState::OUTSIDE_FRAME;
+	}
+	else
+	{
+		// Signal for rendering
+		//  -> If this frame won't be displayed anyways, the next "preFrameUpdate" just does the minimal processing for it
+		mFrameState = FrameState::FRAME_READY;
+
+		// The snapshot misses the changes of frames that did not get refreshed for rendering
+		mPipelinedSnapshotValid = false;
+	}
 	mLastFrameTicks = SDL_GetTicks();
 	mDebugDrawRenderingRequested = false;
 }
@@ -178,6 +221,35 @@ bool VideoOut::updateGameScreen()
 {
 	mUsingFrameInterpolation = (Configuration::instance().mFrameSync == Configuration::FrameSyncType::FRAME_INTERPOLATION);
 
+	if (mUsingPipelinedRendering)
+	{
+		// If the simulation stopped early with a frame that was not meant to be displayed, render that one instead
+		if (mFrameState == FrameState::FRAME_READY)
+		{
+			finishPipelinedRendering();
+			startPipelinedRendering();
+			mFrameState = FrameState::OUTSIDE_FRAME;
+		}
+
+		// The game screen bitmap usually got updated in "postFrameUpdate" already, only the texture is missing
+		//  -> If the simulation does not continue (e.g. when paused), take over the last frame here as soon as it's done
+		if (!mPipelinedFrameAvailable && !mRenderThread->isBusy())
+		{
+			finishPipelinedRendering();
+		}
+		if (!mPipelinedFrameAvailable)
+			return false;
+
+		mPipelinedFrameAvailable = false;
+		mGameScreenTexture.bitmapUpdated();
+		return true;
+	}
+
+	// Pipelined rendering might just have been disabled, and the render thread can't be used any more for now
+	finishPipelinedRendering();
+	mPipelinedSnapshotValid = false;
+	mPipelinedFrameAvailable = false;
+
 	// Only render something if a frame simulation was completed in the meantime
 	const bool hasNewSimulationFrame = (mFrameState == FrameState::FRAME_READY);
 	if (!hasNewSimulationFrame && !mUsingFrameInterpolation && !mDebugDrawRenderingRequested)
@@ -243,11 +315,11 @@ void VideoOut::clearGeometries()
 	RenderResources::instance().mPrintedTextCache.regularCleanup();
 }
 
-void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
+void VideoOut::collectGeometries(RenderParts& renderParts, std::vector<Geometry*>& geometries)
 {
 	// Add plane geometries
 	{
-		const PlaneManager& pm = mRenderParts->getPlaneManager();
+		const PlaneManager& pm = renderParts.getPlaneManager();
 		const Recti fullscreenRect(0, 0, mGameResolution.x, mGameResolution.y);
 		Recti rectForPlaneB = fullscreenRect;
 		Recti rectForPlaneA = fullscreenRect;
@@ -265,13 +337,13 @@ void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
 		}
 
 		// Plane B non-prio
-		if (mRenderParts->mLayerRendering[0] && pm.isDefaultPlaneEnabled(0))
+		if (renderParts.mLayerRendering[0] && pm.isDefaultPlaneEnabled(0))
 		{
 			geometries.push_back(&mGeometryFactory.createPlaneGeometry(rectForPlaneB, PlaneManager::PLANE_B, false, PlaneManager::PLANE_B, 0x1000));
 		}
 
 		// Plane A (and possibly plane W) non-prio
-		if (mRenderParts->mLayerRendering[1] && pm.isDefaultPlaneEnabled(1))
+		if (renderParts.mLayerRendering[1] && pm.isDefaultPlaneEnabled(1))
 		{
 			if (rectForPlaneA.height > 0)
 			{
@@ -284,13 +356,13 @@ void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
 		}
 
 		// Plane B prio
-		if (mRenderParts->mLayerRendering[4] && pm.isDefaultPlaneEnabled(2))
+		if (renderParts.mLayerRendering[4] && pm.isDefaultPlaneEnabled(2))
 		{
 			geometries.push_back(&mGeometryFactory.createPlaneGeometry(rectForPlaneB, PlaneManager::PLANE_B, true, PlaneManager::PLANE_B, 0x3000));
 		}
 
 		// Plane A (and possibly plane W) prio
-		if (mRenderParts->mLayerRendering[5] && pm.isDefaultPlaneEnabled(3))
+		if (renderParts.mLayerRendering[5] && pm.isDefaultPlaneEnabled(3))
 		{
 			if (rectForPlaneA.height > 0)
 			{
@@ -312,9 +384,9 @@ void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
 	}
 
 	// Add sprite geometries
-	SpriteManager& spriteManager = mRenderParts->getSpriteManager();
+	SpriteManager& spriteManager = renderParts.getSpriteManager();
 	{
-		const Vec2i worldSpaceOffset = mRenderParts->getSpacesManager().getWorldSpaceOffset();
+		const Vec2i worldSpaceOffset = renderParts.getSpacesManager().getWorldSpaceOffset();
 		const auto& sprites = spriteManager.getSprites();
 		for (auto spriteIterator = sprites.begin(); spriteIterator != sprites.end(); ++spriteIterator)
 		{
@@ -324,14 +396,14 @@ void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
 			{
 				case SpriteManager::SpriteInfo::Type::VDP:
 				{
-					accept = (mRenderParts->mLayerRendering[sprite.mPriorityFlag ? 6 : 2]);
+					accept = (renderParts.mLayerRendering[sprite.mPriorityFlag ? 6 : 2]);
 					break;
 				}
 
 				case SpriteManager::SpriteInfo::Type::PALETTE:
 				case SpriteManager::SpriteInfo::Type::COMPONENT:
 				{
-					accept = (mRenderParts->mLayerRendering[sprite.mPriorityFlag ? 7 : 3]);
+					accept = (renderParts.mLayerRendering[sprite.mPriorityFlag ? 7 : 3]);
 					break;
 				}
 
@@ -400,7 +472,7 @@ void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
 	}
 
 	// Insert viewports
-	for (const RenderParts::Viewport& viewport : mRenderParts->getViewports())
+	for (const RenderParts::Viewport& viewport : renderParts.getViewports())
 	{
 		Geometry& geometry = mGeometryFactory.createViewportGeometry(viewport.mRect);
 		geometry.mRenderQueue = viewport.mRenderQueue;
@@ -466,17 +538,68 @@ void VideoOut::collectGeometries(std::vector<Geometry*>& geometries)
 
 void VideoOut::renderGameScreen()
 {
+	RMX_TRACE_SCOPE("VideoOut::renderGameScreen");
 	// Collect geometries to render
 	clearGeometries();
 	if (mRenderParts->getActiveDisplay())
 	{
-		collectGeometries(mGeometries);
+		collectGeometries(*mRenderParts, mGeometries);
 	}
 
 	// Render them
 	mActiveRenderer->renderGameScreen(mGeometries);
 }
 
+bool VideoOut::shouldUsePipelinedRendering() const
+{
+	// Frame interpolation needs a refresh for each rendered frame, so it can't be combined with pipelined rendering
+	const Configuration& config = Configuration::instance();
+	return config.mPipelinedRendering && nullptr != mActiveRenderer && mActiveRenderer == mSoftwareRenderer && config.mFrameSync != Configuration::FrameSyncType::FRAME_INTERPOLATION;
+}
+
+void VideoOut::startPipelinedRendering()
+{
+	if (nullptr == mPipelinedRenderParts)
+	{
+		RMX_LOG_INFO("VideoOut: Setup of pipelined rendering");
+		mPipelinedRenderParts = new RenderParts();
+		mPipelinedRenderer = new SoftwareRenderer(*mPipelinedRenderParts, mPipelinedOutputTexture);
+		mPipelinedRenderer->initialize();
+		mPipelinedRenderer->setGameResolution(mGameResolution);
+		mRenderThread = new RenderThread();
+	}
+
+	// Refresh right away, as the simulation will continue with the next frame before this one gets rendered
+	RefreshParameters refreshParameters;
+	refreshParameters.mHasNewSimulationFrame = true;
+	mRenderParts->refresh(refreshParameters);
+
+	// Take a snapshot for the render thread
+	mPipelinedRenderParts->copyForRendering(*mRenderParts, mPipelinedSnapshotValid);
+	mPipelinedSnapshotValid = true;
+
+	clearGeometries();
+	if (mPipelinedRenderParts->getActiveDisplay())
+	{
+		collectGeometries(*mPipelinedRenderParts, mGeometries);
+	}
+
+	mRenderThread->startRendering(*mPipelinedRenderer, mGeometries);
+}
+
+void VideoOut::finishPipelinedRendering()
+{
+	if (nullptr == mRenderThread)
+		return;
+
+	if (mRenderThread->waitUntilDone())
+	{
+		// Copy the image, as the render thread is going to reuse its bitmap for the next frame
+		mGameScreenTexture.accessBitmap() = mPipelinedOutputTexture.accessBitmap();
+		mPipelinedFrameAvailable = true;
+	}
+}
+
 void VideoOut::preRefreshDebugging()
 {
 	mRenderParts->getOverlayManager().clearContext(OverlayManager::Context::OUTSIDE_FRAME);
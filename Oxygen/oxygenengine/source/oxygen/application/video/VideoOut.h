@@ -16,6 +16,7 @@ class HardwareRenderer;
 class SoftwareRenderer;
 class RenderParts;
 class RenderResources;
+class RenderThread;
 
 
 class VideoOut : public SingleInstance<VideoOut>
@@ -42,11 +43,14 @@ public:
 
 	Vec2i getInterpolatedWorldSpaceOffset() const;
 
-	void preFrameUpdate();
-	void postFrameUpdate();
+	void preFrameUpdate(bool willBeDisplayed = true);
+	void postFrameUpdate(bool willBeDisplayed = true);
 	void setInterFramePosition(float position);
 	bool updateGameScreen();
 
+	// Wait for the render thread to finish its frame; this must be called before changing or deleting sprites in the sprite cache, as the render thread reads their pixel data
+	void finishPipelinedRendering();
+
 	void blurGameScreen();
 
 	void preRefreshDebugging();
@@ -67,10 +71,13 @@ public:
 
 private:
 	void clearGeometries();
-	void collectGeometries(std::vector<Geometry*>& geometries);
+	void collectGeometries(RenderParts& renderParts, std::vector<Geometry*>& geometries);
 
 	void renderGameScreen();
 
+	bool shouldUsePipelinedRendering() const;
+	void startPipelinedRendering();
+
 private:
 	enum class FrameState
 	{
@@ -101,4 +108,13 @@ private:
 
 	bool mDebugDrawRenderingRequested = false;
 	bool mPreviouslyHadOutsideFrameDebugDraws = false;
+
+	// Pipelined rendering: the render thread renders a snapshot of the render parts, while the simulation continues with the next frame
+	bool mUsingPipelinedRendering = false;
+	RenderParts* mPipelinedRenderParts = nullptr;
+	SoftwareRenderer* mPipelinedRenderer = nullptr;
+	DrawerTexture mPipelinedOutputTexture;		// Not registered at the drawer, only its bitmap gets used
+	RenderThread* mRenderThread = nullptr;
+	bool mPipelinedSnapshotValid = false;		// Set if the snapshot was kept up-to-date, so only changed patterns need to be copied
+	bool mPipelinedFrameAvailable = false;		// Set if the game screen bitmap got a new frame from the render thread, which is not yet shown
 };
@@ -14,6 +14,8 @@
 #ifdef PLATFORM_WINDOWS
 	#include <windows.h>
 	#include <dbghelp.h>
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+	#include <signal.h>
 #endif
 
 
@@ -53,6 +55,9 @@ namespace
 		}
 	#endif
 
+		// Make sure the log contains everything up to this point
+		rmx::Logging::flushAfterCrash();
+
 		WString crashDumpPath = L"crashdump.dmp";
 
 		String text;
@@ -102,6 +107,30 @@ namespace
 		SetUnhandledExceptionFilter(MyCrashHandlerExceptionFilter);
 	}
 
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+
+	static void handleCrashSignal(int signalNumber)
+	{
+		// Make sure the log contains everything up to this point, as the async log writer won't get to it any more
+		//  -> This is not async-signal-safe, but it's only a last attempt before the application terminates anyways
+		rmx::Logging::flushAfterCrash();
+
+		// The default handler is restored already, so this terminates the application as it would have without this handler
+		raise(signalNumber);
+	}
+
+	void InstallCrashSignalHandlers()
+	{
+		struct sigaction action = {};
+		action.sa_handler = &handleCrashSignal;
+		action.sa_flags = SA_RESETHAND | SA_NODEFER;
+		sigemptyset(&action.sa_mask);
+		for (int signalNumber : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT })
+		{
+			sigaction(signalNumber, &action, nullptr);
+		}
+	}
+
 #endif
 }
 
@@ -110,6 +139,8 @@ void CrashHandler::initializeCrashHandler()
 {
 #ifdef PLATFORM_WINDOWS
 	InitMiniDumpWriter();
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+	InstallCrashSignalHandlers();
 #endif
 }
 
@@ -34,3 +34,12 @@ void DrawCollection::addDrawCommand(DrawCommand* drawCommand)
 {
 	mDrawCommands.push_back(drawCommand);
 }
+
+void DrawCollection::addCopyOfDrawCommand(const DrawCommand& drawCommand)
+{
+	DrawCommand* copy = DrawCommand::mFactory.createCopy(drawCommand);
+	if (nullptr != copy)
+	{
+		mDrawCommands.push_back(copy);
+	}
+}
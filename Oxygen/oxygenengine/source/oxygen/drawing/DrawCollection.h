@@ -23,6 +23,7 @@ public:
 	void clear();
 	void addDrawCommand(DrawCommand& drawCommand);
 	void addDrawCommand(DrawCommand* drawCommand);
+	void addCopyOfDrawCommand(const DrawCommand& drawCommand);
 
 private:
 	std::vector<DrawCommand*> mDrawCommands;
@@ -292,6 +292,28 @@ public:
 	ObjectPool<PopScissorDrawCommand>			 mPopScissorDrawCommands;
 
 public:
+	DrawCommand* createCopy(const DrawCommand& drawCommand)
+	{
+		switch (drawCommand.getType())
+		{
+			case DrawCommand::Type::UNDEFINED:					return nullptr;
+			case DrawCommand::Type::SET_WINDOW_RENDER_TARGET:	return &mSetWindowRenderTargetDrawCommands.createObject(drawCommand.as<SetWindowRenderTargetDrawCommand>());
+			case DrawCommand::Type::SET_RENDER_TARGET:			return &mSetRenderTargetDrawCommands.createObject(drawCommand.as<SetRenderTargetDrawCommand>());
+			case DrawCommand::Type::RECT:						return &mRectDrawCommands.createObject(drawCommand.as<RectDrawCommand>());
+			case DrawCommand::Type::UPSCALED_RECT:				return &mUpscaledRectDrawCommands.createObject(drawCommand.as<UpscaledRectDrawCommand>());
+			case DrawCommand::Type::MESH:						return &mMeshDrawCommands.createObject(drawCommand.as<MeshDrawCommand>());
+			case DrawCommand::Type::MESH_VERTEX_COLOR:			return &mMeshVertexColorDrawCommands.createObject(drawCommand.as<MeshVertexColorDrawCommand>());
+			case DrawCommand::Type::SET_BLEND_MODE:				return &mSetBlendModeDrawCommands.createObject(drawCommand.as<SetBlendModeDrawCommand>());
+			case DrawCommand::Type::SET_SAMPLING_MODE:			return &mSetSamplingModeDrawCommands.createObject(drawCommand.as<SetSamplingModeDrawCommand>());
+			case DrawCommand::Type::SET_WRAP_MODE:				return &mSetWrapModeDrawCommands.createObject(drawCommand.as<SetWrapModeDrawCommand>());
+			case DrawCommand::Type::PRINT_TEXT:					return &mPrintTextDrawCommands.createObject(drawCommand.as<PrintTextDrawCommand>());
+			case DrawCommand::Type::PRINT_TEXT_W:				return &mPrintTextWDrawCommands.createObject(drawCommand.as<PrintTextWDrawCommand>());
+			case DrawCommand::Type::PUSH_SCISSOR:				return &mPushScissorDrawCommands.createObject(drawCommand.as<PushScissorDrawCommand>());
+			case DrawCommand::Type::POP_SCISSOR:				return &mPopScissorDrawCommands.createObject(drawCommand.as<PopScissorDrawCommand>());
+		}
+		return nullptr;
+	}
+
 	void destroy(DrawCommand& drawCommand)
 	{
 		switch (drawCommand.getType())
@@ -34,13 +34,13 @@ Drawer::Type Drawer::getType() const
 
 void Drawer::destroyDrawer()
 {
-	SAFE_DELETE(mActiveDrawer);
-
-	// Invalidate drawer textures
+	// Invalidate drawer textures, while their implementations can still access the drawer
 	for (DrawerTexture* texture : mDrawerTextures)
 	{
 		texture->invalidate();
 	}
+
+	SAFE_DELETE(mActiveDrawer);
 }
 
 void Drawer::shutdown()
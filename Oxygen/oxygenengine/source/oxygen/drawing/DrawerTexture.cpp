@@ -11,6 +11,9 @@
 #include "oxygen/drawing/Drawer.h"
 
 
+uint32 DrawerTexture::mGlobalChangeCounter = 0;
+
+
 DrawerTexture::~DrawerTexture()
 {
 	invalidate();
@@ -41,8 +44,10 @@ void DrawerTexture::setImplementation(DrawerTextureImplementation* implementatio
 
 void DrawerTexture::clearBitmap()
 {
-	mBitmap.clear();
+	// Invalidate first, so the implementation can still access the old content while being destroyed
 	invalidate();
+	mBitmap.clear();
+	markAsChanged();
 }
 
 Bitmap& DrawerTexture::accessBitmap()
@@ -53,6 +58,7 @@ Bitmap& DrawerTexture::accessBitmap()
 void DrawerTexture::bitmapUpdated()
 {
 	mSize.set(mBitmap.getWidth(), mBitmap.getHeight());
+	markAsChanged();
 
 	if (nullptr != mImplementation)
 	{
@@ -73,6 +79,7 @@ void DrawerTexture::setupAsRenderTarget(uint32 width, uint32 height)
 	{
 		mImplementation->setupAsRenderTarget(mSize, *this);
 	}
+	markAsChanged();
 }
 
 void DrawerTexture::writeContentToBitmap(Bitmap& outBitmap)
@@ -88,4 +95,15 @@ void DrawerTexture::swap(DrawerTexture& other)
 	mBitmap.swap(other.mBitmap);
 	std::swap(mSize, other.mSize);
 	std::swap(mImplementation, other.mImplementation);
+	markAsChanged();
+	other.markAsChanged();
+
+	if (nullptr != mImplementation)
+	{
+		mImplementation->ownerChanged(*this);
+	}
+	if (nullptr != other.mImplementation)
+	{
+		other.mImplementation->ownerChanged(other);
+	}
 }
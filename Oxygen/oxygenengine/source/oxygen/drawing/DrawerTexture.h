@@ -23,6 +23,7 @@ public:
 	virtual void setupAsRenderTarget(const Vec2i& size, DrawerTexture& owner) = 0;
 	virtual void writeContentToBitmap(Bitmap& outBitmap) = 0;
 	virtual void refreshImplementation(DrawerTexture& owner, bool setupRenderTarget, const Vec2i& size) = 0;
+	virtual void ownerChanged(DrawerTexture& owner) {}
 };
 
 
@@ -44,6 +45,9 @@ public:
 	int getWidth() const			{ return mSize.x; }
 	int getHeight() const			{ return mSize.y; }
 
+	// Change counter gets a new, globally unique value whenever the texture content might have changed
+	inline uint32 getChangeCounter() const  { return mChangeCounter; }
+
 	void clearBitmap();
 
 	Bitmap& accessBitmap();
@@ -54,12 +58,18 @@ public:
 	void swap(DrawerTexture& other);
 
 private:
+	inline void markAsChanged()  { mChangeCounter = ++mGlobalChangeCounter; }
+
+private:
+	static uint32 mGlobalChangeCounter;
+
 	Drawer* mRegisteredOwner = nullptr;
 	size_t mRegisteredIndex = 0;
 
 	Bitmap mBitmap;		// Holding the texture content, except if this is a hardware render target
 	Vec2i mSize;		// Resolution of the texture -- either the size of the bitmap or of a hardware render target
 	bool mSetupAsRenderTarget = false;
+	uint32 mChangeCounter = 0;
 
 	DrawerTextureImplementation* mImplementation = nullptr;
 };
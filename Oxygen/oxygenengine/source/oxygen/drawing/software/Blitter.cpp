@@ -179,33 +179,42 @@ namespace blitterinternal
 	}
 
 	template<bool SWAP_RED_BLUE, bool ALPHA_BLENDING, bool USE_TINT_COLOR>
-	void blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, const BitmapWrapper& sourceBitmap, Recti sourceRect, uint32 tintColor)
+	void blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, const Recti& clipRect, const BitmapWrapper& sourceBitmap, Recti sourceRect, uint32 tintColor)
 	{
 		if (destBitmap.empty())
 			return;
 
+		// Only the visible part gets drawn, but the sampling positions are the same as for the whole dest rect
+		//  -> This way, partial redraws of the same scaled bitmap fit seamlessly to what's already on the screen
+		Recti visibleRect;
+		visibleRect.intersect(destRect, clipRect);
+		if (visibleRect.empty())
+			return;
+
 		int lastSourceY = -1;
 		uint32* lastDestData = nullptr;
 
 		uint32 positionExact = 0;	// This is used as a 16.16 fixed point number
 		uint16& position = getFixedPoint1616_Int<IS_LITTLE_ENDIAN>(positionExact);
 		const uint32 advance = (sourceRect.width << 16) / destRect.width;
+		const uint32 startPosition = (uint32)(visibleRect.x - destRect.x) * advance;
 
-		for (int lineIndex = 0; lineIndex < destRect.height; ++lineIndex)
+		const int firstLineIndex = visibleRect.y - destRect.y;
+		for (int lineIndex = firstLineIndex; lineIndex < firstLineIndex + visibleRect.height; ++lineIndex)
 		{
 			const int destY = destRect.y + lineIndex;
 			const int sourceY = sourceRect.y + lineIndex * sourceRect.height / destRect.height;
-			uint32* destData = destBitmap.getPixelPointer(destRect.x, destY);
+			uint32* destData = destBitmap.getPixelPointer(visibleRect.x, destY);
 
 			if (sourceY == lastSourceY && nullptr != lastDestData)
 			{
 				// Just copy the content from the last line, as it's the contents again
-				memcpy(destData, lastDestData, destRect.width * 4);
+				memcpy(destData, lastDestData, visibleRect.width * 4);
 			}
 			else
 			{
 				const uint32* sourceData = sourceBitmap.getPixelPointer(sourceRect.x, sourceY);
-				positionExact = 0;
+				positionExact = startPosition;
 
 				if (SWAP_RED_BLUE || USE_TINT_COLOR)
 				{
@@ -247,7 +256,7 @@ namespace blitterinternal
 
 					if (ALPHA_BLENDING)
 					{
-						for (int destX = 0; destX < destRect.width; ++destX)
+						for (int destX = 0; destX < visibleRect.width; ++destX)
 						{
 							blendColors<false>((uint8*)&destData[destX], (uint8*)&buffer[position]);
 							positionExact += advance;
@@ -255,7 +264,7 @@ namespace blitterinternal
 					}
 					else
 					{
-						for (int destX = 0; destX < destRect.width; ++destX)
+						for (int destX = 0; destX < visibleRect.width; ++destX)
 						{
 							destData[destX] = buffer[position];
 							positionExact += advance;
@@ -266,7 +275,7 @@ namespace blitterinternal
 				{
 					if (ALPHA_BLENDING)
 					{
-						for (int destX = 0; destX < destRect.width; ++destX)
+						for (int destX = 0; destX < visibleRect.width; ++destX)
 						{
 							blendColors<false>((uint8*)&destData[destX], (uint8*)&sourceData[position]);
 							positionExact += advance;
@@ -274,7 +283,7 @@ namespace blitterinternal
 					}
 					else
 					{
-						for (int destX = 0; destX < destRect.width; ++destX)
+						for (int destX = 0; destX < visibleRect.width; ++destX)
 						{
 							destData[destX] = sourceData[position];
 							positionExact += advance;
@@ -451,6 +460,11 @@ void Blitter::blitBitmap(BitmapWrapper& destBitmap, Vec2i destPosition, const Bi
 }
 
 void Blitter::blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, const BitmapWrapper& sourceBitmap, Recti sourceRect, const Options& options)
+{
+	blitBitmapWithScaling(destBitmap, destRect, destRect, sourceBitmap, sourceRect, options);
+}
+
+void Blitter::blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, const Recti& clipRect, const BitmapWrapper& sourceBitmap, Recti sourceRect, const Options& options)
 {
 	if (destBitmap.empty())
 		return;
@@ -462,11 +476,11 @@ void Blitter::blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, c
 			// No blending
 			if (options.mSwapRedBlue)
 			{
-				blitterinternal::blitBitmapWithScaling<true, false, false>(destBitmap, destRect, sourceBitmap, sourceRect, 0xffffffff);
+				blitterinternal::blitBitmapWithScaling<true, false, false>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, 0xffffffff);
 			}
 			else
 			{
-				blitterinternal::blitBitmapWithScaling<false, false, false>(destBitmap, destRect, sourceBitmap, sourceRect, 0xffffffff);
+				blitterinternal::blitBitmapWithScaling<false, false, false>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, 0xffffffff);
 			}
 		}
 		else
@@ -474,11 +488,11 @@ void Blitter::blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, c
 			// Alpha blending
 			if (options.mSwapRedBlue)
 			{
-				blitterinternal::blitBitmapWithScaling<true, true, false>(destBitmap, destRect, sourceBitmap, sourceRect, 0xffffffff);
+				blitterinternal::blitBitmapWithScaling<true, true, false>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, 0xffffffff);
 			}
 			else
 			{
-				blitterinternal::blitBitmapWithScaling<false, true, false>(destBitmap, destRect, sourceBitmap, sourceRect, 0xffffffff);
+				blitterinternal::blitBitmapWithScaling<false, true, false>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, 0xffffffff);
 			}
 		}
 	}
@@ -489,11 +503,11 @@ void Blitter::blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, c
 			// No blending
 			if (options.mSwapRedBlue)
 			{
-				blitterinternal::blitBitmapWithScaling<true, false, true>(destBitmap, destRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
+				blitterinternal::blitBitmapWithScaling<true, false, true>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
 			}
 			else
 			{
-				blitterinternal::blitBitmapWithScaling<false, false, true>(destBitmap, destRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
+				blitterinternal::blitBitmapWithScaling<false, false, true>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
 			}
 		}
 		else
@@ -501,11 +515,11 @@ void Blitter::blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, c
 			// Alpha blending
 			if (options.mSwapRedBlue)
 			{
-				blitterinternal::blitBitmapWithScaling<true, true, true>(destBitmap, destRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
+				blitterinternal::blitBitmapWithScaling<true, true, true>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
 			}
 			else
 			{
-				blitterinternal::blitBitmapWithScaling<false, true, true>(destBitmap, destRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
+				blitterinternal::blitBitmapWithScaling<false, true, true>(destBitmap, destRect, clipRect, sourceBitmap, sourceRect, options.mTintColor.getABGR32());
 			}
 		}
 	}
@@ -45,4 +45,7 @@ public:
 	static void blitColor(BitmapWrapper& destBitmap, Recti destRect, const Color& color, const Options& options);
 	static void blitBitmap(BitmapWrapper& destBitmap, Vec2i destPosition, const BitmapWrapper& sourceBitmap, Recti sourceRect, const Options& options);
 	static void blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, const BitmapWrapper& sourceBitmap, Recti sourceRect, const Options& options);
+
+	// Draws only the part of the scaled bitmap inside the clip rect, but samples it exactly like an unclipped blit would
+	static void blitBitmapWithScaling(BitmapWrapper& destBitmap, Recti destRect, const Recti& clipRect, const BitmapWrapper& sourceBitmap, Recti sourceRect, const Options& options);
 };
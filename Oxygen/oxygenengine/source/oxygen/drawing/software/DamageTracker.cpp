@@ -0,0 +1,356 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/drawing/software/DamageTracker.h"
+#include "oxygen/drawing/DrawerTexture.h"
+
+
+namespace damagetracker
+{
+	template<typename T>
+	inline uint64 addToHash(uint64 hash, const T& value)
+	{
+		return rmx::addToFNV1a_64(hash, (const uint8*)&value, sizeof(T));
+	}
+
+	template<typename T>
+	inline uint64 addVectorToHash(uint64 hash, const std::vector<T>& data)
+	{
+		hash = addToHash(hash, data.size());
+		return data.empty() ? hash : rmx::addToFNV1a_64(hash, (const uint8*)&data[0], data.size() * sizeof(T));
+	}
+
+	template<typename STRING>
+	inline uint64 addTextToHash(uint64 hash, const Font* font, const STRING& text, const rmx::Painter::PrintOptions& printOptions)
+	{
+		hash = addToHash(hash, font);
+		hash = addToHash(hash, text.length());
+		hash = rmx::addToFNV1a_64(hash, (const uint8*)text.getData(), text.length() * sizeof(*text.getData()));
+		hash = addToHash(hash, printOptions.mAlignment);
+		hash = addToHash(hash, printOptions.mSpacing);
+		return addToHash(hash, printOptions.mTintColor);
+	}
+
+	template<typename STRING>
+	inline Recti getTextBounds(Font* font, const Recti& rect, const STRING& text, const rmx::Painter::PrintOptions& printOptions)
+	{
+		// Same layout as the software drawer uses for printing, see "Font::printBitmap"
+		return (nullptr == font) ? Recti() : font->getPrintBounds(rect, text, printOptions.mAlignment, printOptions.mSpacing);
+	}
+
+	template<typename VERTEX>
+	Recti getMeshBounds(const std::vector<VERTEX>& triangles)
+	{
+		if (triangles.empty())
+			return Recti();
+
+		Vec2f minPosition = triangles[0].mPosition;
+		Vec2f maxPosition = triangles[0].mPosition;
+		for (const VERTEX& vertex : triangles)
+		{
+			minPosition.x = std::min(minPosition.x, vertex.mPosition.x);
+			minPosition.y = std::min(minPosition.y, vertex.mPosition.y);
+			maxPosition.x = std::max(maxPosition.x, vertex.mPosition.x);
+			maxPosition.y = std::max(maxPosition.y, vertex.mPosition.y);
+		}
+		const int minX = (int)std::floor(minPosition.x);
+		const int minY = (int)std::floor(minPosition.y);
+		return Recti(minX, minY, (int)std::ceil(maxPosition.x) - minX + 1, (int)std::ceil(maxPosition.y) - minY + 1);
+	}
+
+	inline bool touches(const Recti& a, const Recti& b)
+	{
+		return (a.x <= b.x + b.width && b.x <= a.x + a.width && a.y <= b.y + b.height && b.y <= a.y + a.height);
+	}
+
+	inline Recti getUnion(const Recti& a, const Recti& b)
+	{
+		const int minX = std::min(a.x, b.x);
+		const int minY = std::min(a.y, b.y);
+		return Recti(minX, minY, std::max(a.x + a.width, b.x + b.width) - minX, std::max(a.y + a.height, b.y + b.height) - minY);
+	}
+}
+
+
+void DamageTracker::invalidate()
+{
+	mInvalidated = true;
+}
+
+void DamageTracker::beginFrame(const Vec2i& screenSize)
+{
+	if (mScreenSize != screenSize)
+	{
+		mScreenSize = screenSize;
+		mInvalidated = true;
+	}
+
+	mCurrentRecords.clear();
+	for (auto& pair : mTextureStates)
+	{
+		pair.second.mUsedThisFrame = false;
+	}
+}
+
+void DamageTracker::addDrawCommand(const DrawCommand& drawCommand, const Recti& scissorRect)
+{
+	CommandRecord& record = vectorAdd(mCurrentRecords);
+	record.mType = drawCommand.getType();
+
+	uint64 hash = rmx::startFNV1a_64();
+	switch (drawCommand.getType())
+	{
+		case DrawCommand::Type::UNDEFINED:
+			break;
+
+		case DrawCommand::Type::SET_WINDOW_RENDER_TARGET:
+		{
+			hash = damagetracker::addToHash(hash, drawCommand.as<SetWindowRenderTargetDrawCommand>().mViewport);
+			break;
+		}
+
+		case DrawCommand::Type::SET_RENDER_TARGET:
+		{
+			const SetRenderTargetDrawCommand& dc = drawCommand.as<SetRenderTargetDrawCommand>();
+			hash = damagetracker::addToHash(hash, dc.mTexture);
+			hash = damagetracker::addToHash(hash, dc.mViewport);
+			break;
+		}
+
+		case DrawCommand::Type::RECT:
+		{
+			const RectDrawCommand& dc = drawCommand.as<RectDrawCommand>();
+			hash = damagetracker::addToHash(hash, dc.mRect);
+			hash = damagetracker::addToHash(hash, getTextureHash(dc.mTexture));
+			hash = damagetracker::addToHash(hash, dc.mColor);
+			hash = damagetracker::addToHash(hash, dc.mUV0);
+			hash = damagetracker::addToHash(hash, dc.mUV1);
+
+			Recti rect = dc.mRect;
+			if (rect.width < 0)
+			{
+				rect.x += rect.width;
+				rect.width = -rect.width;
+			}
+			record.mBounds.intersect(rect, scissorRect);
+			record.mHasBounds = true;
+			break;
+		}
+
+		case DrawCommand::Type::UPSCALED_RECT:
+		{
+			const UpscaledRectDrawCommand& dc = drawCommand.as<UpscaledRectDrawCommand>();
+			hash = damagetracker::addToHash(hash, dc.mRect);
+			hash = damagetracker::addToHash(hash, getTextureHash(dc.mTexture));
+			hash = damagetracker::addToHash(hash, Configuration::instance().mFiltering);
+			hash = damagetracker::addToHash(hash, Configuration::instance().mScanlines);
+
+			record.mBounds.intersect(dc.mRect, scissorRect);
+			record.mHasBounds = true;
+			break;
+		}
+
+		case DrawCommand::Type::MESH:
+		{
+			const MeshDrawCommand& dc = drawCommand.as<MeshDrawCommand>();
+			hash = damagetracker::addVectorToHash(hash, dc.mTriangles);
+			hash = damagetracker::addToHash(hash, getTextureHash(dc.mTexture));
+
+			record.mBounds = damagetracker::getMeshBounds(dc.mTriangles);
+			record.mHasBounds = true;
+			record.mIsClipped = false;
+			break;
+		}
+
+		case DrawCommand::Type::MESH_VERTEX_COLOR:
+		{
+			const MeshVertexColorDrawCommand& dc = drawCommand.as<MeshVertexColorDrawCommand>();
+			hash = damagetracker::addVectorToHash(hash, dc.mTriangles);
+
+			record.mBounds = damagetracker::getMeshBounds(dc.mTriangles);
+			record.mHasBounds = true;
+			record.mIsClipped = false;
+			break;
+		}
+
+		case DrawCommand::Type::SET_BLEND_MODE:
+		{
+			hash = damagetracker::addToHash(hash, drawCommand.as<SetBlendModeDrawCommand>().mBlendMode);
+			break;
+		}
+
+		case DrawCommand::Type::SET_SAMPLING_MODE:
+		{
+			hash = damagetracker::addToHash(hash, drawCommand.as<SetSamplingModeDrawCommand>().mSamplingMode);
+			break;
+		}
+
+		case DrawCommand::Type::SET_WRAP_MODE:
+		{
+			hash = damagetracker::addToHash(hash, drawCommand.as<SetWrapModeDrawCommand>().mWrapMode);
+			break;
+		}
+
+		case DrawCommand::Type::PRINT_TEXT:
+		{
+			const PrintTextDrawCommand& dc = drawCommand.as<PrintTextDrawCommand>();
+			hash = damagetracker::addToHash(hash, dc.mRect);
+			hash = damagetracker::addTextToHash(hash, dc.mFont, dc.mText, dc.mPrintOptions);
+
+			record.mBounds.intersect(damagetracker::getTextBounds(dc.mFont, dc.mRect, dc.mText, dc.mPrintOptions), scissorRect);
+			record.mHasBounds = true;
+			break;
+		}
+
+		case DrawCommand::Type::PRINT_TEXT_W:
+		{
+			const PrintTextWDrawCommand& dc = drawCommand.as<PrintTextWDrawCommand>();
+			hash = damagetracker::addToHash(hash, dc.mRect);
+			hash = damagetracker::addTextToHash(hash, dc.mFont, dc.mText, dc.mPrintOptions);
+
+			record.mBounds.intersect(damagetracker::getTextBounds(dc.mFont, dc.mRect, dc.mText, dc.mPrintOptions), scissorRect);
+			record.mHasBounds = true;
+			break;
+		}
+
+		case DrawCommand::Type::PUSH_SCISSOR:
+		{
+			hash = damagetracker::addToHash(hash, drawCommand.as<PushScissorDrawCommand>().mRect);
+			break;
+		}
+
+		case DrawCommand::Type::POP_SCISSOR:
+			break;
+	}
+	record.mHash = hash;
+}
+
+void DamageTracker::endFrame()
+{
+	mPreviousRecords.swap(mCurrentRecords);
+	mCurrentRecords.clear();
+	mInvalidated = false;
+
+	// Forget about textures that were not used in this frame, they might not even exist any more
+	if (mTextureStates.size() > 64)
+	{
+		for (auto it = mTextureStates.begin(); it != mTextureStates.end(); )
+		{
+			if (it->second.mUsedThisFrame)
+				++it;
+			else
+				it = mTextureStates.erase(it);
+		}
+	}
+}
+
+void DamageTracker::forgetTexture(const DrawerTexture& texture)
+{
+	mTextureStates.erase(&texture);
+}
+
+bool DamageTracker::getDamageRects(std::vector<Recti>& outDamageRects) const
+{
+	outDamageRects.clear();
+	if (mInvalidated || mPreviousRecords.size() != mCurrentRecords.size())
+		return false;
+
+	const Recti screenRect(0, 0, mScreenSize.x, mScreenSize.y);
+	bool allClipped = true;
+	for (size_t i = 0; i < mCurrentRecords.size(); ++i)
+	{
+		const CommandRecord& previous = mPreviousRecords[i];
+		const CommandRecord& current = mCurrentRecords[i];
+		allClipped = allClipped && current.mIsClipped;
+
+		if (previous.mType != current.mType)
+			return false;
+		if (previous.mHash == current.mHash && previous.mBounds == current.mBounds)
+			continue;
+		if (!previous.mHasBounds || !current.mHasBounds)
+			return false;
+
+		// Both the previously and the now covered regions need an update
+		for (const Recti* bounds : { &previous.mBounds, &current.mBounds })
+		{
+			Recti rect;
+			rect.intersect(*bounds, screenRect);
+			if (!rect.empty())
+			{
+				outDamageRects.push_back(rect);
+			}
+		}
+	}
+
+	if (outDamageRects.empty())
+		return true;
+
+	// Partial redraws rely on all commands respecting the scissor rect
+	if (!allClipped)
+		return false;
+
+	// Merge touching rects, so no region gets redrawn twice
+	for (size_t i = 0; i < outDamageRects.size(); ++i)
+	{
+		for (size_t k = i + 1; k < outDamageRects.size(); )
+		{
+			if (damagetracker::touches(outDamageRects[i], outDamageRects[k]))
+			{
+				outDamageRects[i] = damagetracker::getUnion(outDamageRects[i], outDamageRects[k]);
+				outDamageRects.erase(outDamageRects.begin() + k);
+				k = i + 1;
+			}
+			else
+			{
+				++k;
+			}
+		}
+	}
+
+	if (outDamageRects.size() > MAX_DAMAGE_RECTS)
+	{
+		Recti boundingRect = outDamageRects[0];
+		for (const Recti& rect : outDamageRects)
+		{
+			boundingRect = damagetracker::getUnion(boundingRect, rect);
+		}
+		outDamageRects.clear();
+		outDamageRects.push_back(boundingRect);
+	}
+
+	// Redrawing most of the screen in parts is not worth it
+	int totalArea = 0;
+	for (const Recti& rect : outDamageRects)
+	{
+		totalArea += rect.width * rect.height;
+	}
+	return (totalArea < screenRect.width * screenRect.height * 3 / 4);
+}
+
+uint64 DamageTracker::getTextureHash(DrawerTexture* texture)
+{
+	if (nullptr == texture)
+		return 0;
+
+	// Only hash the texture content again if it was changed since the last check
+	//  -> Render targets get updated each frame even if their content stays the same, e.g. the game screen in menus
+	TextureState& state = mTextureStates[texture];
+	if (state.mChangeCounter != texture->getChangeCounter() || state.mContentHash == 0)
+	{
+		const Bitmap& bitmap = texture->accessBitmap();
+		uint64 hash = rmx::startFNV1a_64();
+		hash = damagetracker::addToHash(hash, bitmap.getSize());
+		hash = damagetracker::addToHash(hash, bitmap.empty() ? 0 : rmx::getMurmur2_64((const uint8*)bitmap.mData, (size_t)bitmap.getPixelCount() * 4));
+
+		state.mChangeCounter = texture->getChangeCounter();
+		state.mContentHash = hash;
+	}
+	state.mUsedThisFrame = true;
+	return state.mContentHash;
+}
@@ -0,0 +1,59 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "oxygen/drawing/DrawCommand.h"
+
+class DrawerTexture;
+
+
+// Compares the draw commands going to the window with the ones of the previous frame, to find out which screen regions actually changed
+class DamageTracker
+{
+public:
+	static const constexpr size_t MAX_DAMAGE_RECTS = 8;
+
+public:
+	void invalidate();
+
+	void beginFrame(const Vec2i& screenSize);
+	void addDrawCommand(const DrawCommand& drawCommand, const Recti& scissorRect);
+	void endFrame();
+	void forgetTexture(const DrawerTexture& texture);
+
+	// Returns false if the whole screen needs to be redrawn, otherwise fills the list of changed regions (which is empty if nothing changed)
+	bool getDamageRects(std::vector<Recti>& outDamageRects) const;
+
+private:
+	struct CommandRecord
+	{
+		DrawCommand::Type mType = DrawCommand::Type::UNDEFINED;
+		uint64 mHash = 0;
+		Recti mBounds;
+		bool mHasBounds = false;	// If false, any change to this command affects the whole screen
+		bool mIsClipped = true;		// If false, the command ignores the scissor rect and can't be drawn partially
+	};
+
+	struct TextureState
+	{
+		uint32 mChangeCounter = 0;
+		uint64 mContentHash = 0;
+		bool mUsedThisFrame = false;
+	};
+
+private:
+	uint64 getTextureHash(DrawerTexture* texture);
+
+private:
+	Vec2i mScreenSize;
+	bool mInvalidated = true;
+	std::vector<CommandRecord> mPreviousRecords;
+	std::vector<CommandRecord> mCurrentRecords;
+	std::unordered_map<const DrawerTexture*, TextureState> mTextureStates;
+};
@@ -9,7 +9,9 @@
 #include "oxygen/pch.h"
 #include "oxygen/drawing/software/SoftwareDrawer.h"
 #include "oxygen/drawing/software/SoftwareDrawerTexture.h"
+#include "oxygen/drawing/software/DamageTracker.h"
 #include "oxygen/drawing/software/SoftwareRasterizer.h"
+#include "oxygen/drawing/software/SoftwareUpscaler.h"
 #include "oxygen/drawing/software/Blitter.h"
 #include "oxygen/drawing/DrawCollection.h"
 #include "oxygen/drawing/DrawCommand.h"
@@ -105,22 +107,110 @@ namespace softwaredrawer
 	}
 
 
+	struct RenderState
+	{
+		DrawerBlendMode mBlendMode = DrawerBlendMode::NONE;
+		DrawerSamplingMode mSamplingMode = DrawerSamplingMode::POINT;
+		DrawerWrapMode mWrapMode = DrawerWrapMode::CLAMP;
+		Recti mScissorRect;
+		std::vector<Recti> mScissorStack;
+	};
+
+
 	struct Internal
 	{
 	public:
 		Internal()
 		{
+			SDL_AddEventWatch(&Internal::onSDLEvent, this);
 		}
 
 		~Internal()
 		{
+			SDL_DelEventWatch(&Internal::onSDLEvent, this);
+		}
+
+		static int onSDLEvent(void* userData, SDL_Event* ev)
+		{
+			// When (parts of) the window got visible again, its whole content has to be presented again, not only the changed regions
+			if (ev->type == SDL_WINDOWEVENT && ev->window.event == SDL_WINDOWEVENT_EXPOSED)
+			{
+				static_cast<Internal*>(userData)->mWindowExposed = true;
+			}
+			return 0;
+		}
+
+		void beginFrameIfNeeded()
+		{
+			if (mFrameStarted)
+				return;
+
+			mFrameStarted = true;
+			mHasWindowCommands = false;
+			mIsDeferringWindowRendering = true;
+			mDamageTracker.beginFrame((nullptr == mScreenSurface) ? Vec2i() : Vec2i(mScreenSurface->w, mScreenSurface->h));
+		}
+
+		void addWindowDrawCommand(const DrawCommand& drawCommand)
+		{
+			if (!mHasWindowCommands)
+			{
+				mHasWindowCommands = true;
+				mDeferredStartState = getRenderState();
+			}
+
+			mDamageTracker.addDrawCommand(drawCommand, mScissorRect);
+			if (mIsDeferringWindowRendering)
+			{
+				mDeferredDrawCommands.addCopyOfDrawCommand(drawCommand);
+			}
+		}
+
+		bool isUsedByDeferredDrawCommands(const DrawerTexture& texture) const
+		{
+			for (const DrawCommand* drawCommand : mDeferredDrawCommands.getDrawCommands())
+			{
+				switch (drawCommand->getType())
+				{
+					case DrawCommand::Type::RECT:			if (drawCommand->as<RectDrawCommand>().mTexture == &texture)  return true;  break;
+					case DrawCommand::Type::UPSCALED_RECT:	if (drawCommand->as<UpscaledRectDrawCommand>().mTexture == &texture)  return true;  break;
+					case DrawCommand::Type::MESH:			if (drawCommand->as<MeshDrawCommand>().mTexture == &texture)  return true;  break;
+					default:  break;
+				}
+			}
+			return false;
+		}
+
+		RenderState getRenderState() const
+		{
+			RenderState state;
+			state.mBlendMode = mCurrentBlendMode;
+			state.mSamplingMode = mCurrentSamplingMode;
+			state.mWrapMode = mCurrentWrapMode;
+			state.mScissorRect = mScissorRect;
+			state.mScissorStack = mScissorStack;
+			return state;
+		}
+
+		void setRenderState(const RenderState& state)
+		{
+			mCurrentBlendMode = state.mBlendMode;
+			mCurrentSamplingMode = state.mSamplingMode;
+			mCurrentWrapMode = state.mWrapMode;
+			mScissorRect = state.mScissorRect;
+			mScissorStack = state.mScissorStack;
 		}
 
 		void setupScreenSurface(SDL_Window* window)
 		{
 			mOutputWindow = window;
 
+			SDL_Surface* oldScreenSurface = mScreenSurface;
 			mScreenSurface = SDL_GetWindowSurface(window);
+			if (mScreenSurface != oldScreenSurface)
+			{
+				mDamageTracker.invalidate();
+			}
 			RMX_CHECK(nullptr != mScreenSurface, "Could not get SDL screen surface", return);
 
 			bool formatSupported = false;
@@ -148,7 +238,8 @@ namespace softwaredrawer
 			if (formatSupported)
 			{
 				// Success, format is supported
-				mScissorRect.set(0, 0, mScreenSurface->w, mScreenSurface->h);
+				mScissorBaseRect.set(0, 0, mScreenSurface->w, mScreenSurface->h);
+				mScissorRect = mScissorBaseRect;
 			}
 			else
 			{
@@ -164,9 +255,9 @@ namespace softwaredrawer
 			}
 		}
 
-		SoftwareDrawerTexture* createTexture()
+		SoftwareDrawerTexture* createTexture(SoftwareDrawer& drawer)
 		{
-			SoftwareDrawerTexture* texture = new SoftwareDrawerTexture();
+			SoftwareDrawerTexture* texture = new SoftwareDrawerTexture(drawer);
 			return texture;
 		}
 
@@ -283,9 +374,23 @@ namespace softwaredrawer
 		DrawerWrapMode mCurrentWrapMode = DrawerWrapMode::CLAMP;
 
 		Recti mScissorRect;
+		Recti mScissorBaseRect;		// Scissor rect when the stack is empty; this is the full screen, or the currently redrawn region
 		std::vector<Recti> mScissorStack;
 
 		Bitmap mTempBuffer;
+		SoftwareUpscaler mUpscaler;
+
+		// Damage tracking: Draw commands going to the window get deferred until "presentScreen", so only changed regions need to be drawn
+		DamageTracker mDamageTracker;
+		DrawCollection mDeferredDrawCommands;
+		RenderState mDeferredStartState;
+		std::vector<Recti> mDamageRects;
+		std::vector<SDL_Rect> mUpdateRects;
+		bool mFrameStarted = false;
+		bool mHasWindowCommands = false;
+		bool mIsDeferringWindowRendering = true;
+		bool mNeedsFullPresent = false;
+		std::atomic<bool> mWindowExposed { false };	// Set by the SDL event watch, which can get called from other threads
 
 	private:
 		DrawerTexture* mCurrentRenderTarget = nullptr;
@@ -308,7 +413,7 @@ SoftwareDrawer::~SoftwareDrawer()
 
 void SoftwareDrawer::createTexture(DrawerTexture& outTexture)
 {
-	outTexture.setImplementation(mInternal.createTexture());
+	outTexture.setImplementation(mInternal.createTexture(*this));
 }
 
 void SoftwareDrawer::refreshTexture(DrawerTexture& texture)
@@ -319,255 +424,382 @@ void SoftwareDrawer::refreshTexture(DrawerTexture& texture)
 void SoftwareDrawer::setupRenderWindow(SDL_Window* window)
 {
 	mInternal.setupScreenSurface(window);
+	mInternal.beginFrameIfNeeded();
 }
 
 void SoftwareDrawer::performRendering(const DrawCollection& drawCollection)
 {
+	mInternal.beginFrameIfNeeded();
+
 	for (DrawCommand* drawCommand : drawCollection.getDrawCommands())
 	{
 		switch (drawCommand->getType())
 		{
-			case DrawCommand::Type::UNDEFINED:
+			case DrawCommand::Type::SET_WINDOW_RENDER_TARGET:
+				break;
+
+			case DrawCommand::Type::SET_RENDER_TARGET:
 			{
-				RMX_ERROR("Got invalid draw command", );
-				continue;
+				// Deferred draw commands reading from this texture need to be executed before it gets overwritten
+				flushDeferredRendering(*drawCommand->as<SetRenderTargetDrawCommand>().mTexture);
+				break;
 			}
 
-			case DrawCommand::Type::SET_WINDOW_RENDER_TARGET:
+			case DrawCommand::Type::SET_BLEND_MODE:
+			case DrawCommand::Type::SET_SAMPLING_MODE:
+			case DrawCommand::Type::SET_WRAP_MODE:
+			case DrawCommand::Type::PUSH_SCISSOR:
+			case DrawCommand::Type::POP_SCISSOR:
 			{
-				//SetWindowRenderTargetDrawCommand& dc = drawCommand->as<SetWindowRenderTargetDrawCommand>();
-				if (nullptr != mInternal.getCurrentRenderTarget())
+				// State changes get executed immediately, but are part of the window rendering as well once that started
+				if (mInternal.mHasWindowCommands)
 				{
-					mInternal.getCurrentRenderTarget()->bitmapUpdated();
-					mInternal.setCurrentRenderTarget(nullptr);
+					mInternal.addWindowDrawCommand(*drawCommand);
 				}
 				break;
 			}
 
-			case DrawCommand::Type::SET_RENDER_TARGET:
+			default:
 			{
-				SetRenderTargetDrawCommand& dc = drawCommand->as<SetRenderTargetDrawCommand>();
-				if (nullptr != mInternal.getCurrentRenderTarget())
+				if (nullptr == mInternal.getCurrentRenderTarget())
 				{
-					mInternal.getCurrentRenderTarget()->bitmapUpdated();
+					mInternal.addWindowDrawCommand(*drawCommand);
+					if (mInternal.mIsDeferringWindowRendering)
+						continue;
 				}
-				mInternal.setCurrentRenderTarget(dc.mTexture);
 				break;
 			}
+		}
+
+		executeDrawCommand(*drawCommand);
+	}
+}
+
+void SoftwareDrawer::presentScreen()
+{
+	mInternal.beginFrameIfNeeded();
 
-			case DrawCommand::Type::RECT:
+	bool fullPresent = mInternal.mWindowExposed.exchange(false) || mInternal.mNeedsFullPresent;
+	mInternal.mDamageRects.clear();
+	if (mInternal.mIsDeferringWindowRendering && nullptr != mInternal.mScreenSurface)
+	{
+		if (!mInternal.mDamageTracker.getDamageRects(mInternal.mDamageRects))
+		{
+			executeDeferredDrawCommands(nullptr);
+			fullPresent = true;
+		}
+		else
+		{
+			// Redraw only the changed regions -- if there's none, there's nothing to do at all
+			for (const Recti& rect : mInternal.mDamageRects)
 			{
-				RectDrawCommand& dc = drawCommand->as<RectDrawCommand>();
-				BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
+				executeDeferredDrawCommands(&rect);
+			}
+		}
+	}
 
-				bool mirrorX = false;
-				Recti rect = dc.mRect;
-				if (rect.width < 0)
-				{
-					// Mirror horizontally
-					mirrorX = true;
-					rect.x += rect.width;
-					rect.width = -rect.width;
-				}
-				const Recti uncroppedRect = rect;
-				rect.intersect(rect, mInternal.getScissorRect());
+	mInternal.mDeferredDrawCommands.clear();
+	mInternal.mDamageTracker.endFrame();
+	mInternal.mNeedsFullPresent = false;
+	mInternal.mFrameStarted = false;
 
-				if (!rect.empty())
-				{
-					Blitter::Options options;
-					options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
-					options.mUseAlphaBlending = mInternal.useAlphaBlending();
+	if (nullptr == mInternal.mScreenSurface)
+		return;
 
-					if (nullptr != dc.mTexture)
-					{
-						Bitmap* inputBitmap = &dc.mTexture->accessBitmap();
+	mInternal.unlockScreenSurface();
+	if (fullPresent)
+	{
+		SDL_UpdateWindowSurface(mInternal.mOutputWindow);
+	}
+	else if (!mInternal.mDamageRects.empty())
+	{
+		mInternal.mUpdateRects.resize(mInternal.mDamageRects.size());
+		for (size_t i = 0; i < mInternal.mDamageRects.size(); ++i)
+		{
+			const Recti& rect = mInternal.mDamageRects[i];
+			mInternal.mUpdateRects[i] = { rect.x, rect.y, rect.width, rect.height };
+		}
+		SDL_UpdateWindowSurfaceRects(mInternal.mOutputWindow, &mInternal.mUpdateRects[0], (int)mInternal.mUpdateRects.size());
+	}
+}
+
+void SoftwareDrawer::flushDeferredRendering(const DrawerTexture& texture)
+{
+	if (!mInternal.mIsDeferringWindowRendering || !mInternal.isUsedByDeferredDrawCommands(texture))
+		return;
 
-						// Consider mirroring
-						if (mirrorX)
-						{
-							softwaredrawer::mirrorBitmapX(mInternal.mTempBuffer, *inputBitmap);
-							inputBitmap = &mInternal.mTempBuffer;
-						}
+	// Draw everything now, and switch to direct rendering into the window for the rest of this frame
+	executeDeferredDrawCommands(nullptr);
+	mInternal.mDeferredDrawCommands.clear();
+	mInternal.mIsDeferringWindowRendering = false;
+	mInternal.mNeedsFullPresent = true;
+}
 
-						BitmapWrapper inputWrapper(*inputBitmap);
+void SoftwareDrawer::releaseTexture(const DrawerTexture& texture)
+{
+	flushDeferredRendering(texture);
+	mInternal.mDamageTracker.forgetTexture(texture);
+}
 
-						// Scaling?
-						const bool useScaling = (rect.getSize() != inputBitmap->getSize());
+void SoftwareDrawer::executeDeferredDrawCommands(const Recti* clipRect)
+{
+	if (mInternal.mDeferredDrawCommands.getDrawCommands().empty())
+		return;
 
-						// Consider cropping
-						Recti inputRect(rect.getPos() - uncroppedRect.getPos(), rect.getSize());
-						if (useScaling)
-						{
-							const float scaleX = (float)inputBitmap->getWidth() / (float)uncroppedRect.width;
-							const float scaleY = (float)inputBitmap->getHeight() / (float)uncroppedRect.height;
-							inputRect.x = roundToInt((float)inputRect.x * scaleX);
-							inputRect.y = roundToInt((float)inputRect.y * scaleY);
-							inputRect.width = roundToInt((float)inputRect.width * scaleX);
-							inputRect.height = roundToInt((float)inputRect.height * scaleY);
-						}
-
-						// TODO: Support tint color everywhere
-						options.mTintColor = dc.mColor;
-
-						if (useScaling)
-						{
-							Blitter::blitBitmapWithScaling(outputWrapper, rect, inputWrapper, inputRect, options);
-						}
-						else
-						{
-							Blitter::blitBitmap(outputWrapper, rect.getPos(), inputWrapper, inputRect, options);
-						}
-					}
-					else
-					{
-						Blitter::blitColor(outputWrapper, rect, dc.mColor, options);
-					}
-				}
-				break;
+	DrawerTexture* oldRenderTarget = mInternal.getCurrentRenderTarget();
+	const softwaredrawer::RenderState oldState = mInternal.getRenderState();
+	const Recti oldScissorBaseRect = mInternal.mScissorBaseRect;
+
+	// Restore the state from when the first window draw command came in, and restrict everything to the clip rect
+	mInternal.setCurrentRenderTarget(nullptr);
+	mInternal.setRenderState(mInternal.mDeferredStartState);
+	if (nullptr != clipRect)
+	{
+		mInternal.mScissorBaseRect.intersect(*clipRect);
+		mInternal.mScissorRect.intersect(*clipRect);
+		for (Recti& rect : mInternal.mScissorStack)
+		{
+			rect.intersect(*clipRect);
+		}
+	}
+
+	for (DrawCommand* drawCommand : mInternal.mDeferredDrawCommands.getDrawCommands())
+	{
+		executeDrawCommand(*drawCommand);
+	}
+
+	mInternal.setRenderState(oldState);
+	mInternal.mScissorBaseRect = oldScissorBaseRect;
+	if (nullptr != oldRenderTarget)
+	{
+		mInternal.setCurrentRenderTarget(oldRenderTarget);
+	}
+}
+
+void SoftwareDrawer::executeDrawCommand(DrawCommand& drawCommand)
+{
+	switch (drawCommand.getType())
+	{
+		case DrawCommand::Type::UNDEFINED:
+		{
+			RMX_ERROR("Got invalid draw command", );
+			return;
+		}
+
+		case DrawCommand::Type::SET_WINDOW_RENDER_TARGET:
+		{
+			//SetWindowRenderTargetDrawCommand& dc = drawCommand.as<SetWindowRenderTargetDrawCommand>();
+			if (nullptr != mInternal.getCurrentRenderTarget())
+			{
+				mInternal.getCurrentRenderTarget()->bitmapUpdated();
+				mInternal.setCurrentRenderTarget(nullptr);
 			}
+			break;
+		}
 
-			case DrawCommand::Type::UPSCALED_RECT:
+		case DrawCommand::Type::SET_RENDER_TARGET:
+		{
+			SetRenderTargetDrawCommand& dc = drawCommand.as<SetRenderTargetDrawCommand>();
+			if (nullptr != mInternal.getCurrentRenderTarget())
 			{
-				UpscaledRectDrawCommand& dc = drawCommand->as<UpscaledRectDrawCommand>();
-				if (nullptr != dc.mTexture)
-				{
-					BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
-					BitmapWrapper inputWrapper(dc.mTexture->accessBitmap());
+				mInternal.getCurrentRenderTarget()->bitmapUpdated();
+			}
+			mInternal.setCurrentRenderTarget(dc.mTexture);
+			break;
+		}
 
-					Blitter::Options options;
-					options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
+		case DrawCommand::Type::RECT:
+		{
+			RectDrawCommand& dc = drawCommand.as<RectDrawCommand>();
+			BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
 
-					Blitter::blitBitmapWithScaling(outputWrapper, dc.mRect, inputWrapper, Recti(0, 0, inputWrapper.mSize.x, inputWrapper.mSize.y), options);
-				}
-				break;
+			bool mirrorX = false;
+			Recti rect = dc.mRect;
+			if (rect.width < 0)
+			{
+				// Mirror horizontally
+				mirrorX = true;
+				rect.x += rect.width;
+				rect.width = -rect.width;
 			}
+			const Recti uncroppedRect = rect;
+			rect.intersect(rect, mInternal.getScissorRect());
 
-			case DrawCommand::Type::MESH:
+			if (!rect.empty())
 			{
-				MeshDrawCommand& dc = drawCommand->as<MeshDrawCommand>();
+				Blitter::Options options;
+				options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
+				options.mUseAlphaBlending = mInternal.useAlphaBlending();
+
 				if (nullptr != dc.mTexture)
 				{
-					BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
-					Bitmap& inputBitmap = dc.mTexture->accessBitmap();
+					Bitmap* inputBitmap = &dc.mTexture->accessBitmap();
 
-					Blitter::Options options;
-					options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
-					options.mUseAlphaBlending = mInternal.useAlphaBlending();
-					options.mUseBilinearSampling = (mInternal.mCurrentSamplingMode == DrawerSamplingMode::BILINEAR);
+					// Consider mirroring
+					if (mirrorX)
+					{
+						softwaredrawer::mirrorBitmapX(mInternal.mTempBuffer, *inputBitmap);
+						inputBitmap = &mInternal.mTempBuffer;
+					}
+
+					BitmapWrapper inputWrapper(*inputBitmap);
 
-					SoftwareRasterizer rasterizer(outputWrapper, options);
-					SoftwareRasterizer::Vertex_P2_T2 triangle[3];
+					// Scaling?
+					const bool useScaling = (uncroppedRect.getSize() != inputBitmap->getSize());
 
-					const int numTriangles = (int)dc.mTriangles.size() / 3;
-					for (int i = 0; i < numTriangles; ++i)
+					// TODO: Support tint color everywhere
+					options.mTintColor = dc.mColor;
+
+					if (useScaling)
+					{
+						// Cropping is done by the blitter, so that a partial redraw samples the very same source pixels as a full one
+						const Recti inputRect(0, 0, inputBitmap->getWidth(), inputBitmap->getHeight());
+						Blitter::blitBitmapWithScaling(outputWrapper, uncroppedRect, rect, inputWrapper, inputRect, options);
+					}
+					else
 					{
-						DrawerMeshVertex* input = &dc.mTriangles[i * 3];
-						for (int k = 0; k < 3; ++k)
-						{
-							triangle[k].mPosition = input[k].mPosition;
-							triangle[k].mUV = input[k].mTexcoords;
-						}
-						rasterizer.drawTriangle(triangle, inputBitmap);
+						// Consider cropping
+						const Recti inputRect(rect.getPos() - uncroppedRect.getPos(), rect.getSize());
+						Blitter::blitBitmap(outputWrapper, rect.getPos(), inputWrapper, inputRect, options);
 					}
 				}
-				break;
+				else
+				{
+					Blitter::blitColor(outputWrapper, rect, dc.mColor, options);
+				}
 			}
+			break;
+		}
 
-			case DrawCommand::Type::MESH_VERTEX_COLOR:
+		case DrawCommand::Type::UPSCALED_RECT:
+		{
+			UpscaledRectDrawCommand& dc = drawCommand.as<UpscaledRectDrawCommand>();
+			if (nullptr != dc.mTexture)
 			{
-				MeshVertexColorDrawCommand& dc = drawCommand->as<MeshVertexColorDrawCommand>();
 				BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
+				BitmapWrapper inputWrapper(dc.mTexture->accessBitmap());
+
+				Blitter::Options options;
+				options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
+
+				mInternal.mUpscaler.renderImage(outputWrapper, dc.mRect, mInternal.getScissorRect(), inputWrapper, options);
+			}
+			break;
+		}
+
+		case DrawCommand::Type::MESH:
+		{
+			MeshDrawCommand& dc = drawCommand.as<MeshDrawCommand>();
+			if (nullptr != dc.mTexture)
+			{
+				BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
+				Bitmap& inputBitmap = dc.mTexture->accessBitmap();
 
 				Blitter::Options options;
 				options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
 				options.mUseAlphaBlending = mInternal.useAlphaBlending();
+				options.mUseBilinearSampling = (mInternal.mCurrentSamplingMode == DrawerSamplingMode::BILINEAR);
 
 				SoftwareRasterizer rasterizer(outputWrapper, options);
-				SoftwareRasterizer::Vertex_P2_C4 triangle[3];
+				SoftwareRasterizer::Vertex_P2_T2 triangle[3];
 
 				const int numTriangles = (int)dc.mTriangles.size() / 3;
 				for (int i = 0; i < numTriangles; ++i)
 				{
-					DrawerMeshVertex_P2_C4* input = &dc.mTriangles[i * 3];
+					DrawerMeshVertex* input = &dc.mTriangles[i * 3];
 					for (int k = 0; k < 3; ++k)
 					{
 						triangle[k].mPosition = input[k].mPosition;
-						triangle[k].mColor = input[k].mColor;
+						triangle[k].mUV = input[k].mTexcoords;
 					}
-					rasterizer.drawTriangle(triangle);
+					rasterizer.drawTriangle(triangle, inputBitmap);
 				}
-				break;
 			}
+			break;
+		}
 
-			case DrawCommand::Type::SET_BLEND_MODE:
-			{
-				SetBlendModeDrawCommand& dc = drawCommand->as<SetBlendModeDrawCommand>();
-				mInternal.mCurrentBlendMode = dc.mBlendMode;
-				break;
-			}
+		case DrawCommand::Type::MESH_VERTEX_COLOR:
+		{
+			MeshVertexColorDrawCommand& dc = drawCommand.as<MeshVertexColorDrawCommand>();
+			BitmapWrapper& outputWrapper = mInternal.getOutputWrapper();
 
-			case DrawCommand::Type::SET_SAMPLING_MODE:
-			{
-				SetSamplingModeDrawCommand& dc = drawCommand->as<SetSamplingModeDrawCommand>();
-				mInternal.mCurrentSamplingMode = dc.mSamplingMode;
-				break;
-			}
+			Blitter::Options options;
+			options.mSwapRedBlue = mInternal.needSwapRedBlueChannels();
+			options.mUseAlphaBlending = mInternal.useAlphaBlending();
 
-			case DrawCommand::Type::SET_WRAP_MODE:
-			{
-				SetWrapModeDrawCommand& dc = drawCommand->as<SetWrapModeDrawCommand>();
-				mInternal.mCurrentWrapMode = dc.mWrapMode;
-				break;
-			}
+			SoftwareRasterizer rasterizer(outputWrapper, options);
+			SoftwareRasterizer::Vertex_P2_C4 triangle[3];
 
-			case DrawCommand::Type::PRINT_TEXT:
+			const int numTriangles = (int)dc.mTriangles.size() / 3;
+			for (int i = 0; i < numTriangles; ++i)
 			{
-				PrintTextDrawCommand& dc = drawCommand->as<PrintTextDrawCommand>();
-				mInternal.printText(*dc.mFont, dc.mText, dc.mRect, dc.mPrintOptions);
-				break;
+				DrawerMeshVertex_P2_C4* input = &dc.mTriangles[i * 3];
+				for (int k = 0; k < 3; ++k)
+				{
+					triangle[k].mPosition = input[k].mPosition;
+					triangle[k].mColor = input[k].mColor;
+				}
+				rasterizer.drawTriangle(triangle);
 			}
+			break;
+		}
 
-			case DrawCommand::Type::PRINT_TEXT_W:
-			{
-				PrintTextWDrawCommand& dc = drawCommand->as<PrintTextWDrawCommand>();
-				mInternal.printText(*dc.mFont, dc.mText, dc.mRect, dc.mPrintOptions);
-				break;
-			}
+		case DrawCommand::Type::SET_BLEND_MODE:
+		{
+			SetBlendModeDrawCommand& dc = drawCommand.as<SetBlendModeDrawCommand>();
+			mInternal.mCurrentBlendMode = dc.mBlendMode;
+			break;
+		}
 
-			case DrawCommand::Type::PUSH_SCISSOR:
-			{
-				PushScissorDrawCommand& dc = drawCommand->as<PushScissorDrawCommand>();
+		case DrawCommand::Type::SET_SAMPLING_MODE:
+		{
+			SetSamplingModeDrawCommand& dc = drawCommand.as<SetSamplingModeDrawCommand>();
+			mInternal.mCurrentSamplingMode = dc.mSamplingMode;
+			break;
+		}
 
-				mInternal.mScissorRect.intersect(dc.mRect);
-				mInternal.mScissorStack.emplace_back(mInternal.mScissorRect);
-				break;
-			}
+		case DrawCommand::Type::SET_WRAP_MODE:
+		{
+			SetWrapModeDrawCommand& dc = drawCommand.as<SetWrapModeDrawCommand>();
+			mInternal.mCurrentWrapMode = dc.mWrapMode;
+			break;
+		}
 
-			case DrawCommand::Type::POP_SCISSOR:
+		case DrawCommand::Type::PRINT_TEXT:
+		{
+			PrintTextDrawCommand& dc = drawCommand.as<PrintTextDrawCommand>();
+			mInternal.printText(*dc.mFont, dc.mText, dc.mRect, dc.mPrintOptions);
+			break;
+		}
+
+		case DrawCommand::Type::PRINT_TEXT_W:
+		{
+			PrintTextWDrawCommand& dc = drawCommand.as<PrintTextWDrawCommand>();
+			mInternal.printText(*dc.mFont, dc.mText, dc.mRect, dc.mPrintOptions);
+			break;
+		}
+
+		case DrawCommand::Type::PUSH_SCISSOR:
+		{
+			PushScissorDrawCommand& dc = drawCommand.as<PushScissorDrawCommand>();
+
+			mInternal.mScissorRect.intersect(dc.mRect);
+			mInternal.mScissorStack.emplace_back(mInternal.mScissorRect);
+			break;
+		}
+
+		case DrawCommand::Type::POP_SCISSOR:
+		{
+			mInternal.mScissorStack.pop_back();
+			if (mInternal.mScissorStack.empty())
 			{
-				mInternal.mScissorStack.pop_back();
-				if (mInternal.mScissorStack.empty())
-				{
-					if (nullptr != mInternal.mScreenSurface)
-					{
-						mInternal.mScissorRect.set(0, 0, mInternal.mScreenSurface->w, mInternal.mScreenSurface->h);
-					}
-				}
-				else
-				{
-					mInternal.mScissorRect = mInternal.mScissorStack.back();
-				}
-				break;
+				mInternal.mScissorRect = mInternal.mScissorBaseRect;
 			}
+			else
+			{
+				mInternal.mScissorRect = mInternal.mScissorStack.back();
+			}
+			break;
 		}
 	}
 }
-
-void SoftwareDrawer::presentScreen()
-{
-	if (nullptr == mInternal.mScreenSurface)
-		return;
-
-	mInternal.unlockScreenSurface();
-	SDL_UpdateWindowSurface(mInternal.mOutputWindow);
-}
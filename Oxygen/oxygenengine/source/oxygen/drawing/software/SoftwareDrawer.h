@@ -32,6 +32,16 @@ public:
 	void performRendering(const DrawCollection& drawCollection) override;
 	void presentScreen() override;
 
+	// Execute deferred draw commands that use the given texture, before it gets changed
+	void flushDeferredRendering(const DrawerTexture& texture);
+
+	// Remove all references to the given texture, before it gets destroyed
+	void releaseTexture(const DrawerTexture& texture);
+
+private:
+	void executeDeferredDrawCommands(const Recti* clipRect);
+	void executeDrawCommand(DrawCommand& drawCommand);
+
 private:
 	softwaredrawer::Internal& mInternal;
 };
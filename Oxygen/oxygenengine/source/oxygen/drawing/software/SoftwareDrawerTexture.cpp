@@ -8,15 +8,34 @@
 
 #include "oxygen/pch.h"
 #include "oxygen/drawing/software/SoftwareDrawerTexture.h"
+#include "oxygen/drawing/software/SoftwareDrawer.h"
 
 
+SoftwareDrawerTexture::~SoftwareDrawerTexture()
+{
+	// Deferred draw commands must not access the texture any more afterwards
+	if (nullptr != mOwner)
+	{
+		mDrawer.releaseTexture(*mOwner);
+	}
+}
+
 void SoftwareDrawerTexture::updateFromBitmap(const Bitmap& bitmap)
 {
-	// Nothing to do
+	// Execute deferred draw commands using this texture now, so they don't pick up any further changes
+	if (nullptr != mOwner)
+	{
+		mDrawer.flushDeferredRendering(*mOwner);
+	}
 }
 
 void SoftwareDrawerTexture::setupAsRenderTarget(const Vec2i& size, DrawerTexture& owner)
 {
+	mOwner = &owner;
+
+	// Make sure the old content is not needed any more
+	mDrawer.flushDeferredRendering(owner);
+
 	// Set owner's bitmap to the correct size, as we will use that for rendering into
 	owner.accessBitmap().create(size.x, size.y);
 }
@@ -28,5 +47,10 @@ void SoftwareDrawerTexture::writeContentToBitmap(Bitmap& outBitmap)
 
 void SoftwareDrawerTexture::refreshImplementation(DrawerTexture& owner, bool setupRenderTarget, const Vec2i& size)
 {
-	// Nothing to do
+	mOwner = &owner;
+}
+
+void SoftwareDrawerTexture::ownerChanged(DrawerTexture& owner)
+{
+	mOwner = &owner;
 }
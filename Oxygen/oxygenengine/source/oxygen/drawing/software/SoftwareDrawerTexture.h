@@ -11,11 +11,21 @@
 #include "oxygen/drawing/DrawerTexture.h"
 
 
+class SoftwareDrawer;
+
 class SoftwareDrawerTexture final : public DrawerTextureImplementation
 {
 public:
+	inline explicit SoftwareDrawerTexture(SoftwareDrawer& drawer) : mDrawer(drawer) {}
+	~SoftwareDrawerTexture();
+
 	void updateFromBitmap(const Bitmap& bitmap) override;
 	void setupAsRenderTarget(const Vec2i& size, DrawerTexture& owner) override;
 	void writeContentToBitmap(Bitmap& outBitmap) override;
 	void refreshImplementation(DrawerTexture& owner, bool setupRenderTarget, const Vec2i& size) override;
+	void ownerChanged(DrawerTexture& owner) override;
+
+private:
+	SoftwareDrawer& mDrawer;
+	DrawerTexture* mOwner = nullptr;
 };
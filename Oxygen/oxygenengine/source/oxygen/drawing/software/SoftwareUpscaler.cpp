@@ -0,0 +1,723 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/drawing/software/SoftwareUpscaler.h"
+#include "oxygen/helper/FileHelper.h"
+
+
+namespace softwareupscaler
+{
+	// Minimum number of rows processed by one task of the parallel for
+	const constexpr int MIN_ROWS_PER_TASK = 8;
+
+	inline uint32 makeOutputPixel(uint32 r, uint32 g, uint32 b, bool swapRedBlue)
+	{
+		return swapRedBlue ? (b | (g << 8) | (r << 16) | 0xff000000) : (r | (g << 8) | (b << 16) | 0xff000000);
+	}
+
+	inline uint32 makeOutputPixel(const float* rgb, bool swapRedBlue)
+	{
+		return makeOutputPixel((uint32)roundToInt(saturate(rgb[0]) * 255.0f), (uint32)roundToInt(saturate(rgb[1]) * 255.0f), (uint32)roundToInt(saturate(rgb[2]) * 255.0f), swapRedBlue);
+	}
+
+	inline float smoothstep(float edge0, float edge1, float x)
+	{
+		const float t = saturate((x - edge0) / (edge1 - edge0));
+		return t * t * (3.0f - 2.0f * t);
+	}
+
+
+	// This is a direct port of the xBRZ freescale multipass shaders in "data/shader", see there for the original license info
+	namespace xbrz
+	{
+		const constexpr float EQUAL_COLOR_TOLERANCE = 30.0f / 255.0f;
+		const constexpr float STEEP_DIRECTION_THRESHOLD = 2.2f;
+		const constexpr float DOMINANT_DIRECTION_THRESHOLD = 3.6f;
+		const constexpr float INV_SQRT2 = 0.70710678f;
+
+		struct SourceAccess
+		{
+			const uint32* mPixels;
+			const float* mColors;
+			int mWidth;
+			int mHeight;
+
+			inline int getIndex(int x, int y) const
+			{
+				return clamp(x, 0, mWidth - 1) + clamp(y, 0, mHeight - 1) * mWidth;
+			}
+
+			inline bool eq(int indexA, int indexB) const
+			{
+				return ((mPixels[indexA] ^ mPixels[indexB]) & 0x00ffffff) == 0;
+			}
+
+			inline float dist(int indexA, int indexB) const
+			{
+				const float wR = 0.2627f;
+				const float wG = 0.6780f;
+				const float wB = 0.0593f;
+				const float scaleB = 0.5f / (1.0f - wB);
+				const float scaleR = 0.5f / (1.0f - wR);
+				const float* pixA = &mColors[indexA * 3];
+				const float* pixB = &mColors[indexB * 3];
+				const float diffR = pixA[0] - pixB[0];
+				const float diffG = pixA[1] - pixB[1];
+				const float diffB = pixA[2] - pixB[2];
+				const float Y = diffR * wR + diffG * wG + diffB * wB;
+				const float Cb = scaleB * (diffB - Y);
+				const float Cr = scaleR * (diffR - Y);
+				return std::sqrt(Y * Y + Cb * Cb + Cr * Cr);
+			}
+
+			inline bool isPixEqual(int indexA, int indexB) const
+			{
+				return dist(indexA, indexB) < EQUAL_COLOR_TOLERANCE;
+			}
+		};
+
+		// First pass: Get blend info for a single source pixel, with one byte each for the four corners
+		uint32 getBlendInfo(const SourceAccess& src, int x, int y)
+		{
+			//---------------------------------------
+			// Input Pixel Mapping:  -|x|x|x|-
+			//                       x|A|B|C|x
+			//                       x|D|E|F|x
+			//                       x|G|H|I|x
+			//                       -|x|x|x|-
+			#define P(dx, dy) src.getIndex(x + (dx), y + (dy))
+			const int A = P(-1,-1);
+			const int B = P( 0,-1);
+			const int C = P( 1,-1);
+			const int D = P(-1, 0);
+			const int E = P( 0, 0);
+			const int F = P( 1, 0);
+			const int G = P(-1, 1);
+			const int H = P( 0, 1);
+			const int I = P( 1, 1);
+
+			// blendResult Mapping: x|y|
+			//                      w|z|
+			int blendX = 0;
+			int blendY = 0;
+			int blendZ = 0;
+			int blendW = 0;
+
+			if (!((src.eq(E,F) && src.eq(H,I)) || (src.eq(E,H) && src.eq(F,I))))
+			{
+				const float dist_H_F = src.dist(G, E) + src.dist(E, C) + src.dist(P(0,2), I) + src.dist(I, P(2,0)) + (4.0f * src.dist(H, F));
+				const float dist_E_I = src.dist(D, H) + src.dist(H, P(1,2)) + src.dist(B, F) + src.dist(F, P(2,1)) + (4.0f * src.dist(E, I));
+				const bool dominantGradient = (DOMINANT_DIRECTION_THRESHOLD * dist_H_F) < dist_E_I;
+				blendZ = ((dist_H_F < dist_E_I) && !src.eq(E,F) && !src.eq(E,H)) ? (dominantGradient ? 2 : 1) : 0;
+			}
+
+			if (!((src.eq(D,E) && src.eq(G,H)) || (src.eq(D,G) && src.eq(E,H))))
+			{
+				const float dist_G_E = src.dist(P(-2,1), D) + src.dist(D, B) + src.dist(P(-1,2), H) + src.dist(H, F) + (4.0f * src.dist(G, E));
+				const float dist_D_H = src.dist(P(-2,0), G) + src.dist(G, P(0,2)) + src.dist(A, E) + src.dist(E, I) + (4.0f * src.dist(D, H));
+				const bool dominantGradient = (DOMINANT_DIRECTION_THRESHOLD * dist_D_H) < dist_G_E;
+				blendW = ((dist_G_E > dist_D_H) && !src.eq(E,D) && !src.eq(E,H)) ? (dominantGradient ? 2 : 1) : 0;
+			}
+
+			if (!((src.eq(B,C) && src.eq(E,F)) || (src.eq(B,E) && src.eq(C,F))))
+			{
+				const float dist_E_C = src.dist(D, B) + src.dist(B, P(1,-2)) + src.dist(H, F) + src.dist(F, P(2,-1)) + (4.0f * src.dist(E, C));
+				const float dist_B_F = src.dist(A, E) + src.dist(E, I) + src.dist(P(0,-2), C) + src.dist(C, P(2,0)) + (4.0f * src.dist(B, F));
+				const bool dominantGradient = (DOMINANT_DIRECTION_THRESHOLD * dist_B_F) < dist_E_C;
+				blendY = ((dist_E_C > dist_B_F) && !src.eq(E,B) && !src.eq(E,F)) ? (dominantGradient ? 2 : 1) : 0;
+			}
+
+			if (!((src.eq(A,B) && src.eq(D,E)) || (src.eq(A,D) && src.eq(B,E))))
+			{
+				const float dist_D_B = src.dist(P(-2,0), A) + src.dist(A, P(0,-2)) + src.dist(G, E) + src.dist(E, C) + (4.0f * src.dist(D, B));
+				const float dist_A_E = src.dist(P(-2,-1), D) + src.dist(D, H) + src.dist(P(-1,-2), B) + src.dist(B, F) + (4.0f * src.dist(A, E));
+				const bool dominantGradient = (DOMINANT_DIRECTION_THRESHOLD * dist_D_B) < dist_A_E;
+				blendX = ((dist_D_B < dist_A_E) && !src.eq(E,D) && !src.eq(E,B)) ? (dominantGradient ? 2 : 1) : 0;
+			}
+			#undef P
+
+			int infoX = blendX;
+			int infoY = blendY;
+			int infoZ = blendZ;
+			int infoW = blendW;
+
+			if (blendZ == 2 || (blendZ == 1 &&
+				!((blendY != 0 && !src.isPixEqual(E, G)) || (blendW != 0 && !src.isPixEqual(E, C)) ||
+				 (src.isPixEqual(G, H) && src.isPixEqual(H, I) && src.isPixEqual(I, F) && src.isPixEqual(F, C) && !src.isPixEqual(E, I)))))
+			{
+				infoZ += 4;
+				const float dist_F_G = src.dist(F, G);
+				const float dist_H_C = src.dist(H, C);
+				if ((STEEP_DIRECTION_THRESHOLD * dist_F_G <= dist_H_C) && !src.eq(E,G) && !src.eq(D,G))
+					infoZ += 16;
+				if ((STEEP_DIRECTION_THRESHOLD * dist_H_C <= dist_F_G) && !src.eq(E,C) && !src.eq(B,C))
+					infoZ += 64;
+			}
+
+			if (blendW == 2 || (blendW == 1 &&
+				!((blendZ != 0 && !src.isPixEqual(E, A)) || (blendX != 0 && !src.isPixEqual(E, I)) ||
+				 (src.isPixEqual(A, D) && src.isPixEqual(D, G) && src.isPixEqual(G, H) && src.isPixEqual(H, I) && !src.isPixEqual(E, G)))))
+			{
+				infoW += 4;
+				const float dist_H_A = src.dist(H, A);
+				const float dist_D_I = src.dist(D, I);
+				if ((STEEP_DIRECTION_THRESHOLD * dist_H_A <= dist_D_I) && !src.eq(E,A) && !src.eq(B,A))
+					infoW += 16;
+				if ((STEEP_DIRECTION_THRESHOLD * dist_D_I <= dist_H_A) && !src.eq(E,I) && !src.eq(F,I))
+					infoW += 64;
+			}
+
+			if (blendY == 2 || (blendY == 1 &&
+				!((blendX != 0 && !src.isPixEqual(E, I)) || (blendZ != 0 && !src.isPixEqual(E, A)) ||
+				 (src.isPixEqual(I, F) && src.isPixEqual(F, C) && src.isPixEqual(C, B) && src.isPixEqual(B, A) && !src.isPixEqual(E, C)))))
+			{
+				infoY += 4;
+				const float dist_B_I = src.dist(B, I);
+				const float dist_F_A = src.dist(F, A);
+				if ((STEEP_DIRECTION_THRESHOLD * dist_B_I <= dist_F_A) && !src.eq(E,I) && !src.eq(H,I))
+					infoY += 16;
+				if ((STEEP_DIRECTION_THRESHOLD * dist_F_A <= dist_B_I) && !src.eq(E,A) && !src.eq(D,A))
+					infoY += 64;
+			}
+
+			if (blendX == 2 || (blendX == 1 &&
+				!((blendW != 0 && !src.isPixEqual(E, C)) || (blendY != 0 && !src.isPixEqual(E, G)) ||
+				 (src.isPixEqual(C, B) && src.isPixEqual(B, A) && src.isPixEqual(A, D) && src.isPixEqual(D, G) && !src.isPixEqual(E, A)))))
+			{
+				infoX += 4;
+				const float dist_D_C = src.dist(D, C);
+				const float dist_B_G = src.dist(B, G);
+				if ((STEEP_DIRECTION_THRESHOLD * dist_D_C <= dist_B_G) && !src.eq(E,C) && !src.eq(F,C))
+					infoX += 16;
+				if ((STEEP_DIRECTION_THRESHOLD * dist_B_G <= dist_D_C) && !src.eq(E,G) && !src.eq(H,G))
+					infoX += 64;
+			}
+
+			return (uint32)infoX | ((uint32)infoY << 8) | ((uint32)infoZ << 16) | ((uint32)infoW << 24);
+		}
+
+		inline float getLeftRatio(float posX, float posY, float originX, float originY, float directionX, float directionY, float scaleX, float scaleY)
+		{
+			const float p0x = posX - originX;
+			const float p0y = posY - originY;
+			const float projFactor = (p0x * directionX + p0y * directionY) / (directionX * directionX + directionY * directionY);
+			const float distX = (p0x - directionX * projFactor) * scaleX;
+			const float distY = (p0y - directionY * projFactor) * scaleY;
+			const float side = p0x * -directionY + p0y * directionX;
+			const float length = std::sqrt(distX * distX + distY * distY);
+			const float v = (side > 0.0f) ? length : (side < 0.0f) ? -length : 0.0f;
+			return smoothstep(-INV_SQRT2, INV_SQRT2, v);
+		}
+
+		inline void mixColor(float* result, const float* blendPix, float ratio)
+		{
+			result[0] += (blendPix[0] - result[0]) * ratio;
+			result[1] += (blendPix[1] - result[1]) * ratio;
+			result[2] += (blendPix[2] - result[2]) * ratio;
+		}
+
+		// Second pass: Get the output color for a position inside a source pixel
+		void getOutputColor(float* result, const SourceAccess& src, int x, int y, uint32 info, float posX, float posY, float scaleX, float scaleY)
+		{
+			//---------------------------------------
+			// Input Pixel Mapping: -|B|-
+			//                      D|E|F
+			//                      -|H|-
+			const int B = src.getIndex(x, y - 1);
+			const int D = src.getIndex(x - 1, y);
+			const int E = src.getIndex(x, y);
+			const int F = src.getIndex(x + 1, y);
+			const int H = src.getIndex(x, y + 1);
+
+			const float* colorE = &src.mColors[E * 3];
+			result[0] = colorE[0];
+			result[1] = colorE[1];
+			result[2] = colorE[2];
+
+			// info Mapping: x|y|
+			//               w|z|
+			const int infoX = (info & 0xff);
+			const int infoY = (info >> 8) & 0xff;
+			const int infoZ = (info >> 16) & 0xff;
+			const int infoW = (info >> 24);
+
+			if ((infoZ & 0x03) != 0)
+			{
+				float originX = 0.0f;
+				float originY = INV_SQRT2;
+				float directionX = 1.0f;
+				float directionY = -1.0f;
+				if ((infoZ & 0x0c) != 0)
+				{
+					const int haveShallowLine = (infoZ >> 4) & 0x03;
+					originY = (haveShallowLine > 0) ? 0.25f : 0.5f;
+					directionX += (float)haveShallowLine;
+					directionY -= (float)((infoZ >> 6) & 0x03);
+				}
+				const int blendPix = (src.dist(E, F) <= src.dist(E, H)) ? F : H;
+				mixColor(result, &src.mColors[blendPix * 3], getLeftRatio(posX, posY, originX, originY, directionX, directionY, scaleX, scaleY));
+			}
+
+			if ((infoW & 0x03) != 0)
+			{
+				float originX = -INV_SQRT2;
+				float originY = 0.0f;
+				float directionX = 1.0f;
+				float directionY = 1.0f;
+				if ((infoW & 0x0c) != 0)
+				{
+					const int haveShallowLine = (infoW >> 4) & 0x03;
+					originX = (haveShallowLine > 0) ? -0.25f : -0.5f;
+					directionY += (float)haveShallowLine;
+					directionX += (float)((infoW >> 6) & 0x03);
+				}
+				const int blendPix = (src.dist(E, D) <= src.dist(E, H)) ? D : H;
+				mixColor(result, &src.mColors[blendPix * 3], getLeftRatio(posX, posY, originX, originY, directionX, directionY, scaleX, scaleY));
+			}
+
+			if ((infoY & 0x03) != 0)
+			{
+				float originX = INV_SQRT2;
+				float originY = 0.0f;
+				float directionX = -1.0f;
+				float directionY = -1.0f;
+				if ((infoY & 0x0c) != 0)
+				{
+					const int haveShallowLine = (infoY >> 4) & 0x03;
+					originX = (haveShallowLine > 0) ? 0.25f : 0.5f;
+					directionY -= (float)haveShallowLine;
+					directionX -= (float)((infoY >> 6) & 0x03);
+				}
+				const int blendPix = (src.dist(E, B) <= src.dist(E, F)) ? B : F;
+				mixColor(result, &src.mColors[blendPix * 3], getLeftRatio(posX, posY, originX, originY, directionX, directionY, scaleX, scaleY));
+			}
+
+			if ((infoX & 0x03) != 0)
+			{
+				float originX = 0.0f;
+				float originY = -INV_SQRT2;
+				float directionX = -1.0f;
+				float directionY = 1.0f;
+				if ((infoX & 0x0c) != 0)
+				{
+					const int haveShallowLine = (infoX >> 4) & 0x03;
+					originY = (haveShallowLine > 0) ? -0.25f : -0.5f;
+					directionX -= (float)haveShallowLine;
+					directionY += (float)((infoX >> 6) & 0x03);
+				}
+				const int blendPix = (src.dist(E, B) <= src.dist(E, D)) ? B : D;
+				mixColor(result, &src.mColors[blendPix * 3], getLeftRatio(posX, posY, originX, originY, directionX, directionY, scaleX, scaleY));
+			}
+		}
+	}
+
+
+	// This is a port of the HQx shader in "data/shader", see there for the original license info
+	namespace hqx
+	{
+		inline bool diff(const float* yuv1, const float* yuv2)
+		{
+			return (std::fabs(yuv1[0] - yuv2[0]) > 48.0f || std::fabs(yuv1[1] - yuv2[1]) > 7.0f || std::fabs(yuv1[2] - yuv2[2]) > 6.0f);
+		}
+
+		// Get pattern (lower 8 bits) and cross (next 4 bits) for the lookup table
+		uint32 getLookupIndex(const float* yuv, int x, int y, int width, int height)
+		{
+			//   +----+----+----+
+			//   | w1 | w2 | w3 |
+			//   +----+----+----+
+			//   | w4 | w5 | w6 |
+			//   +----+----+----+
+			//   | w7 | w8 | w9 |
+			//   +----+----+----+
+			const int x0 = std::max(x - 1, 0);
+			const int x2 = std::min(x + 1, width - 1);
+			const int y0 = std::max(y - 1, 0) * width;
+			const int y1 = y * width;
+			const int y2 = std::min(y + 1, height - 1) * width;
+			const float* w1 = &yuv[(x0 + y0) * 3];
+			const float* w2 = &yuv[(x  + y0) * 3];
+			const float* w3 = &yuv[(x2 + y0) * 3];
+			const float* w4 = &yuv[(x0 + y1) * 3];
+			const float* w5 = &yuv[(x  + y1) * 3];
+			const float* w6 = &yuv[(x2 + y1) * 3];
+			const float* w7 = &yuv[(x0 + y2) * 3];
+			const float* w8 = &yuv[(x  + y2) * 3];
+			const float* w9 = &yuv[(x2 + y2) * 3];
+
+			uint32 pattern = 0;
+			pattern |= diff(w5, w1) ? 0x01 : 0;
+			pattern |= diff(w5, w2) ? 0x02 : 0;
+			pattern |= diff(w5, w3) ? 0x04 : 0;
+			pattern |= diff(w5, w4) ? 0x08 : 0;
+			pattern |= diff(w5, w6) ? 0x10 : 0;
+			pattern |= diff(w5, w7) ? 0x20 : 0;
+			pattern |= diff(w5, w8) ? 0x40 : 0;
+			pattern |= diff(w5, w9) ? 0x80 : 0;
+
+			uint32 cross = 0;
+			cross |= diff(w4, w2) ? 0x01 : 0;
+			cross |= diff(w2, w6) ? 0x02 : 0;
+			cross |= diff(w8, w4) ? 0x04 : 0;
+			cross |= diff(w6, w8) ? 0x08 : 0;
+
+			return pattern | (cross << 8);
+		}
+	}
+}
+
+
+void SoftwareUpscaler::renderImage(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& clipRect, const BitmapWrapper& sourceBitmap, const Blitter::Options& options)
+{
+	if (destBitmap.empty() || sourceBitmap.empty() || destRect.empty())
+		return;
+
+	Recti visibleRect;
+	visibleRect.intersect(destRect, clipRect);
+	visibleRect.intersect(Recti(0, 0, destBitmap.mSize.x, destBitmap.mSize.y));
+	if (visibleRect.empty())
+		return;
+
+	const int filtering = Configuration::instance().mFiltering;
+	const int scanlines = Configuration::instance().mScanlines;
+
+	// Select upscaler, same as in the OpenGL upscaler
+	if (scanlines > 0 && filtering < 3)
+	{
+		renderSoft(destBitmap, destRect, visibleRect, sourceBitmap, (filtering == 1) ? 2.0f : 1.0f, (float)scanlines * 0.25f, options.mSwapRedBlue);
+		return;
+	}
+
+	switch (filtering)
+	{
+		case 1:
+		case 2:
+			renderSoft(destBitmap, destRect, visibleRect, sourceBitmap, (filtering == 1) ? 2.0f : 1.0f, 0.0f, options.mSwapRedBlue);
+			return;
+
+		case 3:
+			renderXBRZ(destBitmap, destRect, visibleRect, sourceBitmap, options.mSwapRedBlue);
+			return;
+
+		case 4:
+		case 5:
+		case 6:
+		{
+			const int index = filtering - 4;
+			if (!mLookupBitmapLoaded[index])
+			{
+				const wchar_t* textureFilename = (index == 0) ? L"hq2x.png" : (index == 1) ? L"hq3x.png" : L"hq4x.png";
+				FileHelper::loadBitmap(mLookupBitmap[index], std::wstring(L"data/shader/") + textureFilename);
+				mLookupBitmapLoaded[index] = true;
+
+				// Check if the lookup table has the size expected by "renderHQx", otherwise fall back to point sampling
+				const int scale = index + 2;
+				if (mLookupBitmap[index].getWidth() < 256 || mLookupBitmap[index].getHeight() < 16 * scale * scale)
+				{
+					RMX_LOG_WARNING("Lookup texture '" << WString(textureFilename).toStdString() << "' for HQ" << scale << "x upscaling is missing or has an invalid size, using simple upscaling instead");
+					mLookupBitmap[index].clear();
+				}
+			}
+			if (!mLookupBitmap[index].empty())
+			{
+				renderHQx(destBitmap, destRect, visibleRect, sourceBitmap, index + 2, options.mSwapRedBlue);
+				return;
+			}
+			break;
+		}
+	}
+
+	// Fallback: Simple rendering with point sampling
+	renderPoint(destBitmap, destRect, visibleRect, sourceBitmap, options.mSwapRedBlue);
+}
+
+void SoftwareUpscaler::renderPoint(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, bool swapRedBlue)
+{
+	buildPixelSamples(mPixelSamplesX, visibleRect.x, visibleRect.x + visibleRect.width, destRect.x, destRect.width, sourceBitmap.mSize.x, 1, 1.0f);
+	buildPixelSamples(mPixelSamplesY, visibleRect.y, visibleRect.y + visibleRect.height, destRect.y, destRect.height, sourceBitmap.mSize.y, 1, 1.0f);
+
+	FTX::ParallelFor->execute(visibleRect.height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int row = firstRow; row < endRow; ++row)
+		{
+			const uint32* src = sourceBitmap.getPixelPointer(0, mPixelSamplesY[row].mIndex);
+			uint32* dst = destBitmap.getPixelPointer(visibleRect.x, visibleRect.y + row);
+			for (const PixelSample& sampleX : mPixelSamplesX)
+			{
+				const uint8* rgb = (const uint8*)&src[sampleX.mIndex];
+				*dst = softwareupscaler::makeOutputPixel(rgb[0], rgb[1], rgb[2], swapRedBlue);
+				++dst;
+			}
+		}
+	});
+}
+
+void SoftwareUpscaler::renderSoft(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, float pixelFactor, float scanlinesIntensity, bool swapRedBlue)
+{
+	// PixelFactor is at least 1.0f, which is basically bilinear sampling, infinity would be point sampling
+	pixelFactor = clamp(pixelFactor * (float)destRect.height / (float)sourceBitmap.mSize.y, 1.0f, 1000.0f);
+
+	buildAxisSamples(mAxisSamplesX, visibleRect.x, visibleRect.x + visibleRect.width, destRect.x, destRect.width, sourceBitmap.mSize.x, pixelFactor, 0.0f);
+	buildAxisSamples(mAxisSamplesY, visibleRect.y, visibleRect.y + visibleRect.height, destRect.y, destRect.height, sourceBitmap.mSize.y, pixelFactor, scanlinesIntensity);
+
+	// Horizontal pass: Filter each source row to the output width, with the color channels as 8.8 fixed point values
+	const int rowLength = visibleRect.width * 4;
+	mRowBuffer.resize((size_t)(rowLength * sourceBitmap.mSize.y));
+	FTX::ParallelFor->execute(sourceBitmap.mSize.y, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int y = firstRow; y < endRow; ++y)
+		{
+			const uint8* src = (const uint8*)&sourceBitmap.mData[y * sourceBitmap.mSize.x];
+			uint16* dst = &mRowBuffer[y * rowLength];
+			for (const AxisSample& sample : mAxisSamplesX)
+			{
+				const uint8* src0 = &src[sample.mIndex0 * 4];
+				const uint8* src1 = &src[sample.mIndex1 * 4];
+				const uint16 weight1 = sample.mWeight1;
+				const uint16 weight0 = 256 - weight1;
+				dst[0] = src0[0] * weight0 + src1[0] * weight1;
+				dst[1] = src0[1] * weight0 + src1[1] * weight1;
+				dst[2] = src0[2] * weight0 + src1[2] * weight1;
+				dst[3] = 0;
+				dst += 4;
+			}
+		}
+	});
+
+	// Vertical pass: Blend two of the filtered rows and apply scanlines
+	FTX::ParallelFor->execute(visibleRect.height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int row = firstRow; row < endRow; ++row)
+		{
+			const AxisSample& sample = mAxisSamplesY[row];
+			const uint16* src0 = &mRowBuffer[sample.mIndex0 * rowLength];
+			const uint16* src1 = &mRowBuffer[sample.mIndex1 * rowLength];
+			const uint32 weight1 = sample.mWeight1;
+			const uint32 weight0 = 256 - weight1;
+			const uint32 multiplier = sample.mMultiplier;
+
+			uint8* dst = (uint8*)destBitmap.getPixelPointer(visibleRect.x, visibleRect.y + row);
+			for (int k = 0; k < rowLength; ++k)
+			{
+				uint32 value = (src0[k] * weight0 + src1[k] * weight1) >> 8;
+				value = (value * multiplier) >> 8;
+				dst[k] = (uint8)((value + 0x80) >> 8);
+			}
+
+			// Fix alpha and color channel order
+			uint32* pixels = destBitmap.getPixelPointer(visibleRect.x, visibleRect.y + row);
+			if (swapRedBlue)
+			{
+				for (int x = 0; x < visibleRect.width; ++x)
+				{
+					pixels[x] = ((pixels[x] & 0x00ff0000) >> 16) | (pixels[x] & 0x0000ff00) | ((pixels[x] & 0x000000ff) << 16) | 0xff000000;
+				}
+			}
+			else
+			{
+				for (int x = 0; x < visibleRect.width; ++x)
+				{
+					pixels[x] |= 0xff000000;
+				}
+			}
+		}
+	});
+}
+
+void SoftwareUpscaler::renderHQx(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, int scale, bool swapRedBlue)
+{
+	const int width = sourceBitmap.mSize.x;
+	const int height = sourceBitmap.mSize.y;
+	const Bitmap& lookupBitmap = mLookupBitmap[scale - 2];
+	RMX_ASSERT(lookupBitmap.getWidth() >= 256 && lookupBitmap.getHeight() >= 16 * scale * scale, "Invalid HQx lookup bitmap size");
+
+	// Convert source pixels to YUV
+	mSourceColors.resize((size_t)(width * height * 3));
+	FTX::ParallelFor->execute(height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int index = firstRow * width; index < endRow * width; ++index)
+		{
+			const uint8* rgb = (const uint8*)&sourceBitmap.mData[index];
+			float* yuv = &mSourceColors[index * 3];
+			yuv[0] =  0.299f * rgb[0] + 0.587f * rgb[1] + 0.114f * rgb[2];
+			yuv[1] = -0.169f * rgb[0] - 0.331f * rgb[1] + 0.5f   * rgb[2];
+			yuv[2] =  0.5f   * rgb[0] - 0.419f * rgb[1] - 0.081f * rgb[2];
+		}
+	});
+
+	// Get lookup indices for each source pixel
+	mPixelInfo.resize((size_t)(width * height));
+	FTX::ParallelFor->execute(height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int y = firstRow; y < endRow; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				mPixelInfo[x + y * width] = softwareupscaler::hqx::getLookupIndex(&mSourceColors[0], x, y, width, height);
+			}
+		}
+	});
+
+	// Output pixels using the weights from the lookup table
+	buildPixelSamples(mPixelSamplesX, visibleRect.x, visibleRect.x + visibleRect.width, destRect.x, destRect.width, width, scale, 1.0f);
+	buildPixelSamples(mPixelSamplesY, visibleRect.y, visibleRect.y + visibleRect.height, destRect.y, destRect.height, height, scale, 1.0f);
+
+	FTX::ParallelFor->execute(visibleRect.height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int row = firstRow; row < endRow; ++row)
+		{
+			const PixelSample& sampleY = mPixelSamplesY[row];
+			const int y1 = sampleY.mIndex;
+			const int y2 = clamp(y1 + sampleY.mQuadrant, 0, height - 1);
+			uint32* dst = destBitmap.getPixelPointer(visibleRect.x, visibleRect.y + row);
+
+			for (const PixelSample& sampleX : mPixelSamplesX)
+			{
+				const int x1 = sampleX.mIndex;
+				const int x2 = clamp(x1 + sampleX.mQuadrant, 0, width - 1);
+
+				const uint32 lookupIndex = mPixelInfo[x1 + y1 * width];
+				const int lookupRow = (int)(lookupIndex >> 8) * scale * scale + sampleX.mSubPixel + sampleY.mSubPixel * scale;
+				const uint8* weights = (const uint8*)lookupBitmap.getPixelPointer(lookupIndex & 0xff, lookupRow);
+				const uint32 sum = weights[0] + weights[1] + weights[2] + weights[3];
+
+				const uint8* p1 = (const uint8*)&sourceBitmap.mData[x1 + y1 * width];
+				if (sum == 0)
+				{
+					*dst = softwareupscaler::makeOutputPixel(p1[0], p1[1], p1[2], swapRedBlue);
+				}
+				else
+				{
+					const uint8* p2 = (const uint8*)&sourceBitmap.mData[x2 + y2 * width];
+					const uint8* p3 = (const uint8*)&sourceBitmap.mData[x2 + y1 * width];
+					const uint8* p4 = (const uint8*)&sourceBitmap.mData[x1 + y2 * width];
+					uint32 color[3];
+					for (int k = 0; k < 3; ++k)
+					{
+						color[k] = (p1[k] * weights[0] + p2[k] * weights[1] + p3[k] * weights[2] + p4[k] * weights[3] + sum / 2) / sum;
+					}
+					*dst = softwareupscaler::makeOutputPixel(color[0], color[1], color[2], swapRedBlue);
+				}
+				++dst;
+			}
+		}
+	});
+}
+
+void SoftwareUpscaler::renderXBRZ(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, bool swapRedBlue)
+{
+	const int width = sourceBitmap.mSize.x;
+	const int height = sourceBitmap.mSize.y;
+
+	// Convert source pixels to floats
+	mSourceColors.resize((size_t)(width * height * 3));
+	FTX::ParallelFor->execute(height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int index = firstRow * width; index < endRow * width; ++index)
+		{
+			const uint8* rgb = (const uint8*)&sourceBitmap.mData[index];
+			float* color = &mSourceColors[index * 3];
+			color[0] = (float)rgb[0] / 255.0f;
+			color[1] = (float)rgb[1] / 255.0f;
+			color[2] = (float)rgb[2] / 255.0f;
+		}
+	});
+
+	softwareupscaler::xbrz::SourceAccess src;
+	src.mPixels = sourceBitmap.mData;
+	src.mColors = &mSourceColors[0];
+	src.mWidth = width;
+	src.mHeight = height;
+
+	// First pass: Blend info for each source pixel
+	mPixelInfo.resize((size_t)(width * height));
+	FTX::ParallelFor->execute(height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int y = firstRow; y < endRow; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				mPixelInfo[x + y * width] = softwareupscaler::xbrz::getBlendInfo(src, x, y);
+			}
+		}
+	});
+
+	// Second pass: Output pixels
+	//  -> Note that the shader slightly scales texture coordinates, which gets replicated here
+	buildPixelSamples(mPixelSamplesX, visibleRect.x, visibleRect.x + visibleRect.width, destRect.x, destRect.width, width, 1, 1.0001f);
+	buildPixelSamples(mPixelSamplesY, visibleRect.y, visibleRect.y + visibleRect.height, destRect.y, destRect.height, height, 1, 1.0001f);
+	const float scaleX = (float)destRect.width / (float)width;
+	const float scaleY = (float)destRect.height / (float)height;
+
+	FTX::ParallelFor->execute(visibleRect.height, softwareupscaler::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int row = firstRow; row < endRow; ++row)
+		{
+			const PixelSample& sampleY = mPixelSamplesY[row];
+			const int y = sampleY.mIndex;
+			uint32* dst = destBitmap.getPixelPointer(visibleRect.x, visibleRect.y + row);
+
+			for (const PixelSample& sampleX : mPixelSamplesX)
+			{
+				const int x = sampleX.mIndex;
+				const uint32 info = mPixelInfo[x + y * width];
+				if (info == 0)
+				{
+					// Fast path for pixels without any blending
+					const uint8* rgb = (const uint8*)&sourceBitmap.mData[x + y * width];
+					*dst = softwareupscaler::makeOutputPixel(rgb[0], rgb[1], rgb[2], swapRedBlue);
+				}
+				else
+				{
+					float color[3];
+					softwareupscaler::xbrz::getOutputColor(color, src, x, y, info, sampleX.mPosition, sampleY.mPosition, scaleX, scaleY);
+					*dst = softwareupscaler::makeOutputPixel(color, swapRedBlue);
+				}
+				++dst;
+			}
+		}
+	});
+}
+
+void SoftwareUpscaler::buildAxisSamples(std::vector<AxisSample>& output, int destStart, int destEnd, int destOffset, int destSize, int sourceSize, float pixelFactor, float scanlinesIntensity)
+{
+	// This replicates the texture coordinate calculation in the soft upscaler shader, followed by bilinear sampling
+	output.resize((size_t)(destEnd - destStart));
+	for (int d = destStart; d < destEnd; ++d)
+	{
+		const float t = ((float)(d - destOffset) + 0.5f) / (float)destSize * (float)sourceSize;
+		const float it = std::floor(t + 0.5f);
+		float ft = t - it;
+		const float colorMultiplier = 1.0f - (0.5f - std::fabs(ft)) * scanlinesIntensity;
+		ft = clamp(ft * pixelFactor, -0.5f, 0.5f);
+
+		AxisSample& sample = output[d - destStart];
+		sample.mIndex0 = clamp((int)it - 1, 0, sourceSize - 1);
+		sample.mIndex1 = clamp((int)it, 0, sourceSize - 1);
+		sample.mWeight1 = (uint16)roundToInt((ft + 0.5f) * 256.0f);
+		sample.mMultiplier = (uint16)roundToInt(saturate(colorMultiplier) * 256.0f);
+	}
+}
+
+void SoftwareUpscaler::buildPixelSamples(std::vector<PixelSample>& output, int destStart, int destEnd, int destOffset, int destSize, int sourceSize, int scale, float coordinateFactor)
+{
+	output.resize((size_t)(destEnd - destStart));
+	for (int d = destStart; d < destEnd; ++d)
+	{
+		const float t = ((float)(d - destOffset) + 0.5f) / (float)destSize * coordinateFactor * (float)sourceSize;
+		const float it = std::floor(t);
+		const float fp = t - it;
+
+		PixelSample& sample = output[d - destStart];
+		sample.mIndex = clamp((int)it, 0, sourceSize - 1);
+		sample.mQuadrant = (fp > 0.5f) ? 1 : (fp < 0.5f) ? -1 : 0;
+		sample.mSubPixel = std::min((int)(fp * (float)scale), scale - 1);
+		sample.mPosition = fp - 0.5f;
+	}
+}
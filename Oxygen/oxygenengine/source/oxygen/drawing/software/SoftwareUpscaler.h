@@ -0,0 +1,56 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "oxygen/drawing/software/Blitter.h"
+
+
+// CPU implementation of the upscaling filters in "drawing/opengl/Upscaler", for use by the software drawer
+class SoftwareUpscaler
+{
+public:
+	void renderImage(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& clipRect, const BitmapWrapper& sourceBitmap, const Blitter::Options& options);
+
+private:
+	struct AxisSample
+	{
+		int mIndex0 = 0;
+		int mIndex1 = 0;
+		uint16 mWeight1 = 0;		// Weight of the second sample, in range 0..256
+		uint16 mMultiplier = 256;	// Brightness multiplier for scanlines, in range 0..256
+	};
+
+	struct PixelSample
+	{
+		int mIndex = 0;				// Source pixel index
+		int mQuadrant = 0;			// Direction of the nearest neighbor: -1, 0 or 1
+		int mSubPixel = 0;			// Sub-pixel index for HQx lookup
+		float mPosition = 0.0f;		// Position relative to source pixel center, in range -0.5..0.5
+	};
+
+private:
+	void renderPoint(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, bool swapRedBlue);
+	void renderSoft(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, float pixelFactor, float scanlinesIntensity, bool swapRedBlue);
+	void renderHQx(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, int scale, bool swapRedBlue);
+	void renderXBRZ(BitmapWrapper& destBitmap, const Recti& destRect, const Recti& visibleRect, const BitmapWrapper& sourceBitmap, bool swapRedBlue);
+
+	static void buildAxisSamples(std::vector<AxisSample>& output, int destStart, int destEnd, int destOffset, int destSize, int sourceSize, float pixelFactor, float scanlinesIntensity);
+	static void buildPixelSamples(std::vector<PixelSample>& output, int destStart, int destEnd, int destOffset, int destSize, int sourceSize, int scale, float coordinateFactor);
+
+private:
+	Bitmap mLookupBitmap[3];				// Lookup tables for HQ2x, HQ3x, HQ4x
+	bool mLookupBitmapLoaded[3] = { false, false, false };
+	std::vector<float> mSourceColors;		// Source pixels as RGB in range 0..1 (xBRZ) or as YUV in range 0..255 (HQx)
+	std::vector<uint32> mPixelInfo;			// Per source pixel: xBRZ blend info or HQx pattern bits
+	std::vector<uint16> mRowBuffer;			// Horizontally filtered source rows with 8 bits of fraction, used by the soft filter
+	std::vector<AxisSample> mAxisSamplesX;
+	std::vector<AxisSample> mAxisSamplesY;
+	std::vector<PixelSample> mPixelSamplesX;
+	std::vector<PixelSample> mPixelSamplesY;
+};
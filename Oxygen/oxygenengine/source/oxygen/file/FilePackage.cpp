@@ -11,63 +11,211 @@
 #include "oxygen/helper/Utils.h"
 
 
-bool FilePackage::loadPackage(const std::wstring& packageFilename, std::map<std::wstring, PackedFile>& outPackedFiles, InputStream*& inputStream, bool forceLoadAll)
+FilePackage::LoadedPackage::~LoadedPackage()
 {
-	// Try to load the package
-	RMX_ASSERT(nullptr == inputStream, "Input stream was already opened");
-	inputStream = FTX::FileSystem->createInputStream(packageFilename);
-	if (nullptr == inputStream)
-		return false;
+	delete mInputStream;
+}
+
+const FilePackage::PackedFile* FilePackage::LoadedPackage::findPackedFile(std::wstring_view path) const
+{
+	if (mHashIndex.empty())
+		return nullptr;
+
+	// Probe sequences end at an empty bucket; "loadPackage" makes sure there is at least one, but don't rely on that
+	const uint64 hash = getPathHash(path);
+	const size_t mask = mHashIndex.size() - 1;
+	size_t bucket = (size_t)hash & mask;
+	for (size_t probes = 0; probes < mHashIndex.size() && mHashIndex[bucket] != 0; ++probes, bucket = (bucket + 1) & mask)
+	{
+		const PackedFile& packedFile = mPackedFiles[mHashIndex[bucket] - 1];
+		if (packedFile.mPathHash == hash && packedFile.mPath == path)
+			return &packedFile;
+	}
+	return nullptr;
+}
+
+FilePackage::PackedFile* FilePackage::LoadedPackage::findPackedFile(std::wstring_view path)
+{
+	return const_cast<PackedFile*>(static_cast<const LoadedPackage*>(this)->findPackedFile(path));
+}
+
+const uint8* FilePackage::LoadedPackage::getMappedContent(const PackedFile& packedFile) const
+{
+	if (!mMappedFile.isOpen() || packedFile.mCompression != Compression::NONE)
+		return nullptr;
+	if ((size_t)packedFile.mPositionInFile + (size_t)packedFile.mSizeInFile > mMappedFile.getSize())
+		return nullptr;
+	return mMappedFile.getData() + packedFile.mPositionInFile;
+}
+
+uint64 FilePackage::getPathHash(std::wstring_view path)
+{
+	// FNV-1a over the path's UTF-16 characters, as that's how paths are stored in the package -- this way, the hash does not depend on the platform's wchar_t size
+	uint64 hash = rmx::FNV1a_64_START_VALUE;
+	for (wchar_t ch : path)
+	{
+		hash = (hash ^ (uint64)(ch & 0xff)) * rmx::FNV1a_64_MAGIC_PRIME;
+		hash = (hash ^ (uint64)((ch >> 8) & 0xff)) * rmx::FNV1a_64_MAGIC_PRIME;
+	}
+	return hash;
+}
+
+bool FilePackage::loadPackage(const std::wstring& packageFilename, LoadedPackage& outPackage, bool forceLoadAll)
+{
+	// Try to load the package, preferably via memory mapping, so that entry contents don't need to be copied
+	RMX_ASSERT(nullptr == outPackage.mInputStream && !outPackage.mMappedFile.isOpen(), "Package was already loaded");
+	if (!outPackage.mMappedFile.open(packageFilename))
+	{
+		outPackage.mInputStream = FTX::FileSystem->createInputStream(packageFilename);
+		if (nullptr == outPackage.mInputStream)
+			return false;
+	}
+
+	auto readData = [&](size_t position, void* output, size_t size)
+	{
+		if (outPackage.mMappedFile.isOpen())
+		{
+			if (position + size > outPackage.mMappedFile.getSize())
+				return false;
+			memcpy(output, outPackage.mMappedFile.getData() + position, size);
+			return true;
+		}
+		outPackage.mInputStream->setPosition(position);
+		return (outPackage.mInputStream->read(output, size) == size);
+	};
 
 	std::vector<uint8> content;
 	content.resize(PackageHeader::HEADER_SIZE);
-	if (inputStream->read(&content[0], PackageHeader::HEADER_SIZE) != PackageHeader::HEADER_SIZE)
+	if (!readData(0, &content[0], PackageHeader::HEADER_SIZE))
 		return false;
 
 	VectorBinarySerializer serializer(true, content);
 	PackageHeader header;
 	if (!readPackageHeader(header, serializer))
 	{
-		RMX_CHECK(header.mFormatVersion == PackageHeader::CURRENT_FORMAT_VERSION, "Unsupported format version " << header.mFormatVersion << " of file '" << WString(packageFilename).toStdString() << "'", return false);
+		RMX_CHECK(header.mFormatVersion >= 2 && header.mFormatVersion <= PackageHeader::CURRENT_FORMAT_VERSION, "Unsupported format version " << header.mFormatVersion << " of file '" << WString(packageFilename).toStdString() << "'", return false);
 		RMX_ERROR("Invalid signature of file '" << WString(packageFilename).toStdString() << "'", );
 		return false;
 	}
 
 	// Load table of contents
 	content.resize(PackageHeader::HEADER_SIZE + header.mEntryHeaderSize);
-	if (inputStream->read(&content[PackageHeader::HEADER_SIZE], header.mEntryHeaderSize) != header.mEntryHeaderSize)
+	if (!readData(PackageHeader::HEADER_SIZE, &content[PackageHeader::HEADER_SIZE], header.mEntryHeaderSize))
 		return false;
 
 	// Read entry headers
+	outPackage.mPackedFiles.resize(header.mNumEntries);
 	for (size_t i = 0; i < header.mNumEntries; ++i)
 	{
-		const std::wstring key = serializer.read<std::wstring>();
-		PackedFile& packedFile = outPackedFiles[key];
-		packedFile.mPath = key;
-		packedFile.mPositionInFile = serializer.read<uint32>();
-		packedFile.mSizeInFile = serializer.read<uint32>();
+		PackedFile& packedFile = outPackage.mPackedFiles[i];
+		packedFile.mPath = serializer.read<std::wstring>();
+		if (header.mFormatVersion >= 3)
+		{
+			packedFile.mPathHash = serializer.read<uint64>();
+			packedFile.mPositionInFile = serializer.read<uint32>();
+			packedFile.mSizeInFile = serializer.read<uint32>();
+			packedFile.mUncompressedSize = serializer.read<uint32>();
+			packedFile.mCompression = (Compression)serializer.read<uint8>();
+		}
+		else
+		{
+			packedFile.mPathHash = getPathHash(packedFile.mPath);
+			packedFile.mPositionInFile = serializer.read<uint32>();
+			packedFile.mSizeInFile = serializer.read<uint32>();
+			packedFile.mUncompressedSize = packedFile.mSizeInFile;
+		}
+	}
+
+	// Read the hash index, or build it for older packages
+	if (header.mFormatVersion >= 3)
+	{
+		const size_t numBuckets = (size_t)serializer.read<uint32>();
+		RMX_CHECK(numBuckets > header.mNumEntries && (numBuckets & (numBuckets - 1)) == 0 && serializer.getRemaining() >= numBuckets * 4, "Invalid hash index in file '" << WString(packageFilename).toStdString() << "'", return false);
+		outPackage.mHashIndex.resize(numBuckets);
+		serializer.read(&outPackage.mHashIndex[0], numBuckets * 4);
+		size_t numEmptyBuckets = 0;
+		for (uint32 index : outPackage.mHashIndex)
+		{
+			RMX_CHECK(index <= header.mNumEntries, "Invalid hash index in file '" << WString(packageFilename).toStdString() << "'", return false);
+			if (index == 0)
+				++numEmptyBuckets;
+		}
+		RMX_CHECK(numEmptyBuckets > 0, "Invalid hash index without empty buckets in file '" << WString(packageFilename).toStdString() << "'", return false);
+	}
+	else
+	{
+		buildHashIndex(outPackage.mHashIndex, outPackage.mPackedFiles);
 	}
 
 	if (forceLoadAll)
 	{
 		// Read entry contents
-		for (auto& pair : outPackedFiles)
+		for (PackedFile& packedFile : outPackage.mPackedFiles)
 		{
-			pair.second.mContent.resize((size_t)pair.second.mSizeInFile);
-			inputStream->setPosition(pair.second.mPositionInFile);
-			const size_t bytesRead = inputStream->read(&pair.second.mContent[0], (size_t)pair.second.mSizeInFile);
-			RMX_CHECK(pair.second.mSizeInFile == bytesRead, "Failed to load entry '" << WString(pair.first).toStdString() << "' from package", continue);
-			pair.second.mLoadedContent = true;
+			const bool success = readPackedFile(outPackage, packedFile, packedFile.mContent);
+			RMX_CHECK(success, "Failed to load entry '" << WString(packedFile.mPath).toStdString() << "' from package", continue);
+			packedFile.mLoadedContent = true;
 		}
 	}
 	return true;
 }
 
+bool FilePackage::readPackedFile(LoadedPackage& package, PackedFile& packedFile, std::vector<uint8>& outContent)
+{
+	if (packedFile.mLoadedContent)
+	{
+		if (&outContent != &packedFile.mContent)
+			outContent = packedFile.mContent;
+		return true;
+	}
+
+	// Get the raw data
+	const uint8* rawData = nullptr;
+	std::vector<uint8> buffer;
+	if (package.mMappedFile.isOpen())
+	{
+		if ((size_t)packedFile.mPositionInFile + (size_t)packedFile.mSizeInFile > package.mMappedFile.getSize())
+			return false;
+		rawData = package.mMappedFile.getData() + packedFile.mPositionInFile;
+	}
+	else
+	{
+		RMX_ASSERT(nullptr != package.mInputStream, "Input stream is not opened");
+		buffer.resize((size_t)packedFile.mSizeInFile);
+		std::lock_guard<std::mutex> lock(package.mInputStreamMutex);
+		package.mInputStream->setPosition(packedFile.mPositionInFile);
+		if (packedFile.mSizeInFile > 0 && package.mInputStream->read(&buffer[0], buffer.size()) != buffer.size())
+			return false;
+		rawData = buffer.data();
+	}
+
+	switch (packedFile.mCompression)
+	{
+		case Compression::NONE:
+		{
+			if (buffer.empty())
+				outContent.assign(rawData, rawData + packedFile.mSizeInFile);
+			else
+				outContent.swap(buffer);
+			return true;
+		}
+
+		case Compression::ZLIB:
+		{
+			outContent.clear();
+			outContent.reserve((size_t)packedFile.mUncompressedSize);
+			return ZlibDeflate::decode(outContent, rawData, (size_t)packedFile.mSizeInFile) && outContent.size() == (size_t)packedFile.mUncompressedSize;
+		}
+	}
+	return false;
+}
+
 void FilePackage::createFilePackage(const std::wstring& packageFilename, const std::vector<std::wstring>& includedPaths, const std::vector<std::wstring>& excludedPaths, const std::wstring& comparisonPath, uint32 contentVersion, bool forceReplace)
 {
 	// Collect file contents
-	std::map<std::wstring, PackedFile> packedFiles;
+	std::vector<PackedFile> packedFiles;
 	{
+		std::map<std::wstring, std::vector<uint8>> fileContents;
 		FileCrawler fc;
 		for (const std::wstring& includedPath : includedPaths)
 		{
@@ -95,30 +243,36 @@ void FilePackage::createFilePackage(const std::wstring& packageFilename, const s
 				std::vector<uint8> content;
 				if (FTX::FileSystem->readFile(path, content))
 				{
-					PackedFile& packedFile = packedFiles[path];
-					packedFile.mContent.swap(content);
+					fileContents[path].swap(content);
 				}
 			}
 		}
+
+		packedFiles.reserve(fileContents.size());
+		for (auto& pair : fileContents)
+		{
+			PackedFile& packedFile = vectorAdd(packedFiles);
+			packedFile.mPath = pair.first;
+			packedFile.mPathHash = getPathHash(packedFile.mPath);
+			packedFile.mUncompressedSize = (uint32)pair.second.size();
+			packedFile.mContent.swap(pair.second);
+		}
 	}
 
 	// Check against existing file, if there is one already
 	if (!forceReplace && !comparisonPath.empty())
 	{
-		std::map<std::wstring, PackedFile> existingPackedFiles;
-		InputStream* inputStream = nullptr;
-		if (loadPackage(comparisonPath + packageFilename, existingPackedFiles, inputStream, true))
+		LoadedPackage existingPackage;
+		if (loadPackage(comparisonPath + packageFilename, existingPackage, true))
 		{
-			delete inputStream;
-
 			// Compare
-			bool isEqual = (existingPackedFiles.size() == packedFiles.size());
+			bool isEqual = (existingPackage.mPackedFiles.size() == packedFiles.size());
 			if (isEqual)
 			{
-				for (const auto& pair : packedFiles)
+				for (const PackedFile& packedFile : packedFiles)
 				{
-					PackedFile* packedFile = mapFind(existingPackedFiles, pair.first);
-					if (nullptr == packedFile || packedFile->mContent != pair.second.mContent)
+					const PackedFile* existingPackedFile = existingPackage.findPackedFile(packedFile.mPath);
+					if (nullptr == existingPackedFile || existingPackedFile->mContent != packedFile.mContent)
 					{
 						isEqual = false;
 						break;
@@ -134,6 +288,23 @@ void FilePackage::createFilePackage(const std::wstring& packageFilename, const s
 		}
 	}
 
+	// Compress entries where it's worth it; already compressed file formats like PNG or OGG will just stay uncompressed, and can then be accessed without any copying
+	std::vector<std::vector<uint8>> compressedContents(packedFiles.size());
+	for (size_t i = 0; i < packedFiles.size(); ++i)
+	{
+		PackedFile& packedFile = packedFiles[i];
+		std::vector<uint8>& compressed = compressedContents[i];
+		if (packedFile.mContent.size() >= 0x100 && ZlibDeflate::encode(compressed, &packedFile.mContent[0], packedFile.mContent.size(), 9) && compressed.size() < packedFile.mContent.size() * 7 / 8)
+		{
+			packedFile.mCompression = Compression::ZLIB;
+		}
+		else
+		{
+			compressed.clear();
+			packedFile.mCompression = Compression::NONE;
+		}
+	}
+
 	// Collect output content
 	std::vector<uint8> output;
 	size_t entryHeaderSize = 0;
@@ -149,24 +320,38 @@ void FilePackage::createFilePackage(const std::wstring& packageFilename, const s
 		serializer.writeAs<uint32>(0);		// Will get overwritten
 
 		serializer.writeAs<uint32>(packedFiles.size());
-		for (auto& pair : packedFiles)
+		for (size_t i = 0; i < packedFiles.size(); ++i)
 		{
-			serializer.write(pair.first);
-			pair.second.mPositionInFile = (uint32)output.size();	// Temporarily misusing this variable to store the position where to write the content's position in file when it got determined
+			PackedFile& packedFile = packedFiles[i];
+			const std::vector<uint8>& data = (packedFile.mCompression == Compression::NONE) ? packedFile.mContent : compressedContents[i];
+			serializer.write(packedFile.mPath);
+			serializer.write(packedFile.mPathHash);
+			packedFile.mPositionInFile = (uint32)output.size();	// Temporarily misusing this variable to store the position where to write the content's position in file when it got determined
 			serializer.writeAs<uint32>(0);							// Will get overwritten
-			serializer.writeAs<uint32>(pair.second.mContent.size());
+			serializer.writeAs<uint32>(data.size());
+			serializer.write(packedFile.mUncompressedSize);
+			serializer.writeAs<uint8>(packedFile.mCompression);
 		}
 
+		// Write the hash index
+		std::vector<uint32> hashIndex;
+		buildHashIndex(hashIndex, packedFiles);
+		serializer.writeAs<uint32>(hashIndex.size());
+		serializer.write(&hashIndex[0], hashIndex.size() * 4);
+
 		// Write entry header size
 		entryHeaderSize = output.size() - PackageHeader::HEADER_SIZE;
 		*(uint32*)&output[headerSizePosition] = (uint32)entryHeaderSize;
 
-		for (auto& pair : packedFiles)
+		for (size_t i = 0; i < packedFiles.size(); ++i)
 		{
+			PackedFile& packedFile = packedFiles[i];
+			const std::vector<uint8>& data = (packedFile.mCompression == Compression::NONE) ? packedFile.mContent : compressedContents[i];
 			const uint32 position = (uint32)output.size();
-			serializer.write(&pair.second.mContent[0], pair.second.mContent.size());
-			*(uint32*)&output[pair.second.mPositionInFile] = position;
-			pair.second.mPositionInFile = position;
+			if (!data.empty())
+				serializer.write(&data[0], data.size());
+			*(uint32*)&output[packedFile.mPositionInFile] = position;
+			packedFile.mPositionInFile = position;
 		}
 	}
 
@@ -182,8 +367,9 @@ bool FilePackage::readPackageHeader(PackageHeader& outHeader, VectorBinarySerial
 	if (memcmp(signature, PackageHeader::SIGNATURE, 4) != 0)
 		return false;
 
+	// Format version 2 is still supported for reading, it's just missing compression and the hash index
 	outHeader.mFormatVersion = serializer.read<uint32>();
-	if (outHeader.mFormatVersion != PackageHeader::CURRENT_FORMAT_VERSION)
+	if (outHeader.mFormatVersion < 2 || outHeader.mFormatVersion > PackageHeader::CURRENT_FORMAT_VERSION)
 		return false;
 
 	outHeader.mContentVersion = serializer.read<uint32>();
@@ -193,3 +379,22 @@ bool FilePackage::readPackageHeader(PackageHeader& outHeader, VectorBinarySerial
 	RMX_ASSERT(serializer.getReadPosition() == PackageHeader::HEADER_SIZE, "Got wrong package header size");
 	return true;
 }
+
+void FilePackage::buildHashIndex(std::vector<uint32>& outHashIndex, const std::vector<PackedFile>& packedFiles)
+{
+	// Use at most 50% of the buckets, so that probe sequences stay short
+	size_t numBuckets = 16;
+	while (numBuckets < packedFiles.size() * 2)
+		numBuckets *= 2;
+
+	outHashIndex.clear();
+	outHashIndex.resize(numBuckets, 0);
+	const size_t mask = numBuckets - 1;
+	for (size_t i = 0; i < packedFiles.size(); ++i)
+	{
+		size_t bucket = (size_t)packedFiles[i].mPathHash & mask;
+		while (outHashIndex[bucket] != 0)
+			bucket = (bucket + 1) & mask;
+		outHashIndex[bucket] = (uint32)(i + 1);
+	}
+}
@@ -14,31 +14,58 @@
 class FilePackage
 {
 public:
+	enum class Compression : uint8
+	{
+		NONE = 0,
+		ZLIB = 1
+	};
+
 	struct PackedFile
 	{
 		std::wstring mPath;
+		uint64 mPathHash = 0;
 		uint32 mPositionInFile = 0;
 		uint32 mSizeInFile = 0;
+		uint32 mUncompressedSize = 0;
+		Compression mCompression = Compression::NONE;
 		bool mLoadedContent = false;
-		std::vector<uint8> mContent;
+		std::vector<uint8> mContent;		// Uncompressed content, only filled if it got loaded explicitly
 	};
 
 	struct PackageHeader
 	{
 		static const constexpr char SIGNATURE[] = "OPCK";
-		static const constexpr uint32 CURRENT_FORMAT_VERSION = 2;
+		static const constexpr uint32 CURRENT_FORMAT_VERSION = 3;
 		static const constexpr size_t HEADER_SIZE = 20;
 
 		uint32 mFormatVersion = CURRENT_FORMAT_VERSION;
 		uint32 mContentVersion = 0;
-		uint32 mEntryHeaderSize = 0;		// Including the meta data for entries, but excluding their contents
+		uint32 mEntryHeaderSize = 0;		// Including the meta data for entries and the hash index, but excluding their contents
 		size_t mNumEntries = 0;
 	};
 
+	struct LoadedPackage
+	{
+		std::vector<PackedFile> mPackedFiles;
+		std::vector<uint32> mHashIndex;		// Open addressing hash table with size being a power of two, each holding an index into "mPackedFiles" plus one, or zero if empty
+		MemoryMappedFile mMappedFile;		// Used if the package file could be mapped into memory
+		InputStream* mInputStream = nullptr;	// Used otherwise
+		std::mutex mInputStreamMutex;			// Guards the input stream's read position, as entries may get read from multiple threads
+
+		~LoadedPackage();
+		const PackedFile* findPackedFile(std::wstring_view path) const;
+		PackedFile* findPackedFile(std::wstring_view path);
+		const uint8* getMappedContent(const PackedFile& packedFile) const;	// Only for uncompressed entries in a memory mapped package, otherwise returns a null pointer
+	};
+
 public:
-	static bool loadPackage(const std::wstring& packageFilename, std::map<std::wstring, PackedFile>& outPackedFiles, InputStream*& inputStream, bool forceLoadAll);
+	static uint64 getPathHash(std::wstring_view path);
+
+	static bool loadPackage(const std::wstring& packageFilename, LoadedPackage& outPackage, bool forceLoadAll);
+	static bool readPackedFile(LoadedPackage& package, PackedFile& packedFile, std::vector<uint8>& outContent);
 	static void createFilePackage(const std::wstring& packageFilename, const std::vector<std::wstring>& includedPaths, const std::vector<std::wstring>& excludedPaths, const std::wstring& comparisonPath, uint32 contentVersion, bool forceReplace = false);
 
 private:
 	static bool readPackageHeader(PackageHeader& outHeader, VectorBinarySerializer& serializer);
+	static void buildHashIndex(std::vector<uint32>& outHashIndex, const std::vector<PackedFile>& packedFiles);
 };
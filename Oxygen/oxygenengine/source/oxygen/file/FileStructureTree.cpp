@@ -227,16 +227,16 @@ bool FileStructureTree::listDirectories(std::vector<const Entry*>& outDirectorie
 
 bool FileStructureTree::listDirectories(std::vector<std::wstring>& outDirectories, const std::wstring& directoryPath) const
 {
-	mTempBuffer.clear();
-	if (!listEntriesInternal(mTempBuffer, directoryPath, false))
+	std::vector<const Entry*> entries;
+	if (!listEntriesInternal(entries, directoryPath, false))
 		return false;
 
-	if (!mTempBuffer.empty())
+	if (!entries.empty())
 	{
-		outDirectories.reserve(outDirectories.size() + mTempBuffer.size());
-		for (size_t k = 0; k < mTempBuffer.size(); ++k)
+		outDirectories.reserve(outDirectories.size() + entries.size());
+		for (size_t k = 0; k < entries.size(); ++k)
 		{
-			outDirectories.emplace_back(mTempBuffer[k]->mName);
+			outDirectories.emplace_back(entries[k]->mName);
 		}
 	}
 	return true;
@@ -55,6 +55,4 @@ private:
 		int mChildFileIndex = -1;			// Only if this is a directory: Index of first child file, forming a linked list; -1 if there's none
 	};
 	std::vector<Node> mNodes;
-
-	mutable std::vector<const Entry*> mTempBuffer;		// For temporary internal use
 };
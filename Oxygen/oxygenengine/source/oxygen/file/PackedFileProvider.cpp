@@ -29,7 +29,7 @@ struct PackedFileProvDetail
 					const size_t slashPosition = packedFile.mPath.find_last_of(L"/\\");
 					fileEntry.mFilename = (slashPosition == std::wstring::npos) ? packedFile.mPath : packedFile.mPath.substr(slashPosition + 1);
 					fileEntry.mPath = (slashPosition == std::wstring::npos) ? L"" : packedFile.mPath.substr(0, slashPosition + 1);
-					fileEntry.mSize = packedFile.mContent.size();
+					fileEntry.mSize = (size_t)packedFile.mUncompressedSize;
 				}
 			}
 		}
@@ -37,13 +37,26 @@ struct PackedFileProvDetail
 };
 
 
-// At the moment, this class is not really necessary, as the provider never invalidates its created input streams.
-// But maybe it will get more useful when implementing actual file streaming.
-class PackedFileInputStream : public MemInputStream
+namespace
+{
+	const uint8 EMPTY_CONTENT = 0;
+
+	// Content owned by an input stream; this is a base class of "PackedFileInputStream", so that it gets constructed before the "MemInputStream" base
+	struct PackedFileContent
+	{
+		std::vector<uint8> mContent;
+	};
+}
+
+
+// Input stream either referencing the memory mapped package directly, or owning a copy of the (decompressed) content.
+// The provider invalidates its input streams when it gets destroyed, as the memory mapping gets released then.
+class PackedFileInputStream : private PackedFileContent, public MemInputStream
 {
 public:
-	inline PackedFileInputStream(PackedFileProvider& provider, const void* data, size_t size) : MemInputStream(data, size), mProvider(provider) {}
-	inline ~PackedFileInputStream() { mProvider.unregisterPackedFileInputStream(*this); }
+	inline PackedFileInputStream(PackedFileProvider& provider, const void* data, size_t size) : MemInputStream((size == 0) ? &EMPTY_CONTENT : data, size), mProvider(provider) {}
+	inline PackedFileInputStream(PackedFileProvider& provider, std::vector<uint8>&& content) : PackedFileContent{ std::move(content) }, MemInputStream(mContent.empty() ? &EMPTY_CONTENT : &mContent[0], mContent.size()), mProvider(provider) {}
+	inline ~PackedFileInputStream() { if (mIsValid) mProvider.unregisterPackedFileInputStream(*this); }
 
 	inline bool valid() const override				{ return mIsValid && MemInputStream::valid(); }
 	inline const char* getType() const override		{ return "packed"; }
@@ -67,8 +80,7 @@ public:
 
 struct PackedFileProvider::Internal
 {
-	FileStructureTree mFileStructureTree;
-	std::vector<const FileStructureTree::Entry*> mEntriesBuffer;
+	FileStructureTree mFileStructureTree;	// Not changed after construction, so it can be read by multiple threads
 };
 
 
@@ -76,16 +88,15 @@ struct PackedFileProvider::Internal
 PackedFileProvider::PackedFileProvider(const std::wstring& packageFilename) :
 	mInternal(*new Internal())
 {
-	// Load the package if there is one
-	mLoaded = FilePackage::loadPackage(packageFilename, mPackedFiles, mInputStream, true);	// TODO: Use streaming instead of loading all content right away
+	// Load the package if there is one -- file contents get loaded only when accessed, and are not kept in memory
+	mLoaded = FilePackage::loadPackage(packageFilename, mPackage, false);
 	if (mLoaded)
 	{
-		RMX_LOG_INFO("Loaded file package '" << WString(packageFilename).toStdString() << "' with " << mPackedFiles.size() << " entries");
+		RMX_LOG_INFO("Loaded file package '" << WString(packageFilename).toStdString() << "' with " << mPackage.mPackedFiles.size() << " entries" << (mPackage.mMappedFile.isOpen() ? " (memory mapped)" : ""));
 
 		// Setup file structure tree
-		for (const auto& pair : mPackedFiles)
+		for (const PackedFile& packedFile : mPackage.mPackedFiles)
 		{
-			const PackedFile& packedFile = pair.second;
 			mInternal.mFileStructureTree.insertPath(packedFile.mPath, (void*)&packedFile);
 		}
 		mInternal.mFileStructureTree.sortTreeNodes();
@@ -98,12 +109,13 @@ PackedFileProvider::PackedFileProvider(const std::wstring& packageFilename) :
 
 PackedFileProvider::~PackedFileProvider()
 {
+	invalidateAllPackedFileInputStreams();
 	delete &mInternal;
-	delete mInputStream;
 }
 
 void PackedFileProvider::unregisterPackedFileInputStream(PackedFileInputStream& packedFileInputStream)
 {
+	std::lock_guard<std::mutex> lock(mPackedFileInputStreamsMutex);
 	mPackedFileInputStreams.erase(&packedFileInputStream);
 }
 
@@ -112,48 +124,56 @@ bool PackedFileProvider::exists(const std::wstring& filename)
 	return (nullptr != findPackedFile(filename));
 }
 
+bool PackedFileProvider::getFileSize(const std::wstring& filename, uint64& outFileSize)
+{
+	const PackedFile* packedFile = findPackedFile(filename);
+	if (nullptr == packedFile)
+		return false;
+
+	outFileSize = packedFile->mUncompressedSize;
+	return true;
+}
+
 bool PackedFileProvider::readFile(const std::wstring& filename, std::vector<uint8>& outData)
 {
 	PackedFile* packedFile = findPackedFile(filename);
-	if (nullptr != packedFile)
-	{
-		loadPackedFile(*packedFile);
-		outData.resize(packedFile->mContent.size());
-		memcpy(&outData[0], &packedFile->mContent[0], packedFile->mContent.size());
-		return true;
-	}
-	return false;
+	if (nullptr == packedFile)
+		return false;
+
+	const bool success = FilePackage::readPackedFile(mPackage, *packedFile, outData);
+	RMX_CHECK(success, "Failed to load entry '" << WString(packedFile->mPath).toStdString() << "' from package", return false);
+	return true;
 }
 
 bool PackedFileProvider::listFiles(const std::wstring& path, bool recursive, std::vector<rmx::FileIO::FileEntry>& outFileEntries)
 {
-	if (mPackedFiles.empty())
+	if (mPackage.mPackedFiles.empty())
 		return false;
 
-	mInternal.mEntriesBuffer.clear();
-	if (!mInternal.mFileStructureTree.listFiles(mInternal.mEntriesBuffer, path))
+	std::vector<const FileStructureTree::Entry*> entries;
+	if (!mInternal.mFileStructureTree.listFiles(entries, path))
 		return false;
 
-	PackedFileProvDetail::buildFileEntries(outFileEntries, mInternal.mEntriesBuffer);
+	PackedFileProvDetail::buildFileEntries(outFileEntries, entries);
 	return true;
 }
 
 bool PackedFileProvider::listFilesByMask(const std::wstring& filemask, bool recursive, std::vector<rmx::FileIO::FileEntry>& outFileEntries)
 {
-	if (mPackedFiles.empty())
+	if (mPackage.mPackedFiles.empty())
 		return false;
 
-	mInternal.mEntriesBuffer.clear();
-	if (!mInternal.mFileStructureTree.listFilesByMask(mInternal.mEntriesBuffer, filemask, recursive))
+	std::vector<const FileStructureTree::Entry*> entries;
+	if (!mInternal.mFileStructureTree.listFilesByMask(entries, filemask, recursive))
 		return false;
 
-	PackedFileProvDetail::buildFileEntries(outFileEntries, mInternal.mEntriesBuffer);
+	PackedFileProvDetail::buildFileEntries(outFileEntries, entries);
 	return true;
 }
 
 bool PackedFileProvider::listDirectories(const std::wstring& path, std::vector<std::wstring>& outDirectories)
 {
-	if (mPackedFiles.empty())
+	if (mPackage.mPackedFiles.empty())
 		return false;
 
 	return mInternal.mFileStructureTree.listDirectories(outDirectories, path);
@@ -163,45 +183,37 @@ InputStream* PackedFileProvider::createInputStream(const std::wstring& filename)
 {
 	// Try to first read from package
 	PackedFile* packedFile = findPackedFile(filename);
-	if (nullptr != packedFile)
+	if (nullptr == packedFile)
+		return nullptr;
+
+	PackedFileInputStream* inputStream = nullptr;
+	const uint8* mappedContent = mPackage.getMappedContent(*packedFile);
+	if (nullptr != mappedContent)
 	{
-		loadPackedFile(*packedFile);
-		PackedFileInputStream* inputStream = new PackedFileInputStream(*this, &packedFile->mContent[0], packedFile->mContent.size());
-		mPackedFileInputStreams.insert(inputStream);
-		return inputStream;
+		// No copy needed, read directly from the mapped memory
+		inputStream = new PackedFileInputStream(*this, mappedContent, (size_t)packedFile->mSizeInFile);
 	}
-
-	return nullptr;
-}
-
-PackedFileProvider::PackedFile* PackedFileProvider::findPackedFile(const std::wstring& filename)
-{
-	if (!mPackedFiles.empty())
+	else
 	{
-		const auto it = mPackedFiles.find(filename);
-		if (it != mPackedFiles.end())
-		{
-			return &it->second;
-		}
+		std::vector<uint8> content;
+		const bool success = FilePackage::readPackedFile(mPackage, *packedFile, content);
+		RMX_CHECK(success, "Failed to load entry '" << WString(packedFile->mPath).toStdString() << "' from package", return nullptr);
+		inputStream = new PackedFileInputStream(*this, std::move(content));
 	}
-	return nullptr;
+
+	std::lock_guard<std::mutex> lock(mPackedFileInputStreamsMutex);
+	mPackedFileInputStreams.insert(inputStream);
+	return inputStream;
 }
 
-void PackedFileProvider::loadPackedFile(PackedFile& packedFile)
+PackedFileProvider::PackedFile* PackedFileProvider::findPackedFile(const std::wstring& filename)
 {
-	if (!packedFile.mLoadedContent)
-	{
-		RMX_ASSERT(nullptr != mInputStream, "Input stream is not opened");
-		packedFile.mContent.resize((size_t)packedFile.mSizeInFile);
-		mInputStream->setPosition(packedFile.mPositionInFile);
-		const size_t bytesRead = mInputStream->read(&packedFile.mContent[0], (size_t)packedFile.mSizeInFile);
-		RMX_CHECK(packedFile.mSizeInFile == bytesRead, "Failed to load entry '" << WString(packedFile.mPath).toStdString() << "' from package", return);
-		packedFile.mLoadedContent = true;
-	}
+	return mPackage.findPackedFile(filename);
 }
 
 void PackedFileProvider::invalidateAllPackedFileInputStreams()
 {
+	std::lock_guard<std::mutex> lock(mPackedFileInputStreamsMutex);
 	for (PackedFileInputStream* packedFileInputStream : mPackedFileInputStreams)
 	{
 		packedFileInputStream->mIsValid = false;
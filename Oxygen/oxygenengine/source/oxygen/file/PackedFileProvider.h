@@ -28,6 +28,7 @@ public:
 	void unregisterPackedFileInputStream(PackedFileInputStream& inputStream);
 
 	bool exists(const std::wstring& filename) override;
+	bool getFileSize(const std::wstring& filename, uint64& outFileSize) override;
 	bool readFile(const std::wstring& filename, std::vector<uint8>& outData) override;
 	bool listFiles(const std::wstring& path, bool recursive, std::vector<rmx::FileIO::FileEntry>& outFileEntries) override;
 	bool listFilesByMask(const std::wstring& filemask, bool recursive, std::vector<rmx::FileIO::FileEntry>& outFileEntries) override;
@@ -36,15 +37,14 @@ public:
 
 private:
 	PackedFile* findPackedFile(const std::wstring& filename);
-	void loadPackedFile(PackedFile& packedFile);
 	void invalidateAllPackedFileInputStreams();
 
 private:
 	struct Internal;
 	Internal& mInternal;
 
-	std::map<std::wstring, PackedFile> mPackedFiles;
+	FilePackage::LoadedPackage mPackage;
 	bool mLoaded = false;
-	InputStream* mInputStream = nullptr;
 	std::set<PackedFileInputStream*> mPackedFileInputStreams;	// Managed input streams created in "createInputStream" calls
+	std::mutex mPackedFileInputStreamsMutex;
 };
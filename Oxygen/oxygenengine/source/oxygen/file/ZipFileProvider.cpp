@@ -22,11 +22,28 @@
 
 namespace detail
 {
+	// Stored entries from this size on get streamed by "createInputStream", instead of being copied as a whole
+	//  -> Compressed entries are always decompressed as a whole, as seeking backwards would mean decompressing from the start again, e.g. for each loop of a music track
+	const constexpr size_t STREAMING_MIN_SIZE = 0x40000;
+
+	// Maximum total size of decompressed content kept in the cache, over all zip file providers
+	const constexpr size_t CONTENT_CACHE_BUDGET = 0x2000000;
+
+	// Larger entries don't get cached at all, so that they can't push out lots of smaller ones
+	const constexpr size_t CONTENT_CACHE_MAX_ENTRY_SIZE = CONTENT_CACHE_BUDGET / 8;
+
 	voidpf openFile(voidpf opaque, const void* filename, int mode)
 	{
 		return FTX::FileSystem->createInputStream((const wchar_t*)filename);
 	}
 
+	voidpf openMappedFile(voidpf opaque, const void* filename, int mode)
+	{
+		// The opaque pointer is the memory mapped zip file here
+		const MemoryMappedFile& mappedFile = *(const MemoryMappedFile*)opaque;
+		return new MemInputStream(mappedFile.getData(), mappedFile.getSize());
+	}
+
 	int closeFile(voidpf opaque, voidpf stream)
 	{
 		delete (InputStream*)stream;
@@ -79,6 +96,76 @@ namespace detail
 
 struct ZipFileProvDetail
 {
+	// Cache for decompressed content of all zip file providers, evicting the least recently used entries when getting over budget
+	struct ContentCache
+	{
+		std::mutex mMutex;
+		std::list<ZipFileProvider::ContainedFile*> mEntries;	// Most recently used entries first
+		size_t mTotalSize = 0;
+	};
+	static ContentCache mContentCache;
+
+	// Protects the managed input streams of all zip file providers, and the streams' provider pointers
+	//  -> It's not owned by a provider, so a stream getting destroyed can still lock it while its provider gets destroyed at the same time
+	static std::mutex mInputStreamsMutex;
+
+	static bool getCachedContent(ZipFileProvider::ContainedFile& containedFile, std::vector<uint8>& outData)
+	{
+		std::lock_guard<std::mutex> lock(mContentCache.mMutex);
+		if (!containedFile.mIsCached)
+			return false;
+
+		mContentCache.mEntries.splice(mContentCache.mEntries.begin(), mContentCache.mEntries, containedFile.mCacheIterator);
+		outData = containedFile.mContent;
+		return true;
+	}
+
+	static void addCachedContent(ZipFileProvider::ContainedFile& containedFile, const std::vector<uint8>& content)
+	{
+		if (content.size() > detail::CONTENT_CACHE_MAX_ENTRY_SIZE)
+			return;
+
+		std::lock_guard<std::mutex> lock(mContentCache.mMutex);
+		if (containedFile.mIsCached)
+			return;
+
+		containedFile.mContent = content;
+		containedFile.mIsCached = true;
+		containedFile.mCacheIterator = mContentCache.mEntries.insert(mContentCache.mEntries.begin(), &containedFile);
+		mContentCache.mTotalSize += content.size();
+
+		while (mContentCache.mTotalSize > detail::CONTENT_CACHE_BUDGET)
+		{
+			removeCachedContentInternal(*mContentCache.mEntries.back());
+		}
+	}
+
+	static void removeCachedContent(ZipFileProvider::ContainedFile& containedFile)
+	{
+		std::lock_guard<std::mutex> lock(mContentCache.mMutex);
+		removeCachedContentInternal(containedFile);
+	}
+
+	static void removeCachedContentInternal(ZipFileProvider::ContainedFile& containedFile)
+	{
+		// Cache mutex must be locked when calling this
+		if (!containedFile.mIsCached)
+			return;
+
+		mContentCache.mTotalSize -= containedFile.mContent.size();
+		mContentCache.mEntries.erase(containedFile.mCacheIterator);
+		containedFile.mContent = std::vector<uint8>();		// Release the memory
+		containedFile.mIsCached = false;
+	}
+
+	static bool goToContainedFile(unzFile zipFile, const ZipFileProvider::ContainedFile& containedFile)
+	{
+		unz64_file_pos filePos;
+		filePos.pos_in_zip_directory = (ZPOS64_T)containedFile.mPositionInCentralDir;
+		filePos.num_of_file = (ZPOS64_T)containedFile.mFileNumber;
+		return (unzGoToFilePos64(zipFile, &filePos) == UNZ_OK);
+	}
+
 	static void buildFileEntries(std::vector<rmx::FileIO::FileEntry>& outFileEntries, const std::vector<const FileStructureTree::Entry*>& fileStructureEntries)
 	{
 		if (!fileStructureEntries.empty())
@@ -97,13 +184,98 @@ struct ZipFileProvDetail
 	}
 };
 
+ZipFileProvDetail::ContentCache ZipFileProvDetail::mContentCache;
+std::mutex ZipFileProvDetail::mInputStreamsMutex;
+
+
+// Input stream for a single stored zip entry, reading directly from the memory mapped zip file.
+// The provider invalidates its input streams when it gets destroyed, as the memory mapping gets released then.
+class ZipEntryInputStream : public InputStream
+{
+public:
+	inline ZipEntryInputStream(ZipFileProvider& provider, const uint8* mappedData, size_t size) : mProvider(&provider), mMappedData(mappedData), mSize(size) {}
+	~ZipEntryInputStream()
+	{
+		close();
+		std::lock_guard<std::mutex> lock(ZipFileProvDetail::mInputStreamsMutex);
+		if (nullptr != mProvider)
+			mProvider->unregisterZipEntryInputStream(*this);
+	}
+
+	inline bool valid() const override				{ return (nullptr != mMappedData); }
+	inline const char* getType() const override		{ return "zip"; }
+
+	inline void close() override					{ mMappedData = nullptr; }
+	inline void setPosition(size_t pos) override	{ mPosition = std::min(pos, mSize); }
+	inline size_t getPosition() const override		{ return mPosition; }
+	inline size_t getSize() const override			{ return mSize; }
+
+	using InputStream::read;
+	size_t read(void* dst, size_t len) override
+	{
+		if (nullptr == mMappedData)
+			return 0;
+
+		len = std::min(len, mSize - mPosition);
+		memcpy(dst, mMappedData + mPosition, len);
+		mPosition += len;
+		return len;
+	}
+
+	inline void skip(size_t len) override  { setPosition(mPosition + std::min(len, mSize - mPosition)); }
+
+	bool tryRead(const void* data, size_t len) override
+	{
+		if (nullptr == mMappedData || len > mSize - mPosition || memcmp(mMappedData + mPosition, data, len) != 0)
+			return false;
+
+		mPosition += len;
+		return true;
+	}
+
+	inline StreamingState getStreamingState() override  { return (valid() && mPosition < mSize) ? StreamingState::STREAMING : StreamingState::COMPLETED; }
+
+public:
+	ZipFileProvider* mProvider = nullptr;	// Gets reset when the provider is destroyed; only access with the input streams mutex locked
+
+private:
+	const uint8* mMappedData = nullptr;
+	size_t mSize = 0;
+	size_t mPosition = 0;
+};
+
 
 struct ZipFileProvider::Internal
 {
-	unzFile mZipFile;
+	std::wstring mZipFilename;
+	MemoryMappedFile mMappedFile;		// Used if the zip file could be mapped into memory
+	zlib_filefunc64_def mFileFuncs;
+	unzFile mZipFile = nullptr;			// Only used for scanning the zip file, it then becomes the first of the free zip file handles
 	unz_global_info64 mGlobalInfo;
-	FileStructureTree mFileStructureTree;
-	std::vector<const FileStructureTree::Entry*> mEntriesBuffer;
+	FileStructureTree mFileStructureTree;	// Not changed after construction, so it can be read by multiple threads
+
+	std::mutex mMutex;					// Protects the free zip file handles
+	std::vector<unzFile> mFreeZipFiles;	// Zip file handles not in use at the moment; more get opened if multiple threads need one at the same time
+
+	unzFile acquireZipFile()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!mFreeZipFiles.empty())
+			{
+				const unzFile zipFile = mFreeZipFiles.back();
+				mFreeZipFiles.pop_back();
+				return zipFile;
+			}
+		}
+		return unzOpen2_64(mZipFilename.c_str(), &mFileFuncs);
+	}
+
+	void releaseZipFile(unzFile zipFile)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mFreeZipFiles.push_back(zipFile);
+	}
 };
 
 
@@ -111,25 +283,44 @@ struct ZipFileProvider::Internal
 ZipFileProvider::ZipFileProvider(const std::wstring& zipFilename) :
 	mInternal(*new Internal())
 {
-	zlib_filefunc64_def filefunc;
+	mInternal.mZipFilename = zipFilename;
+
+	zlib_filefunc64_def& filefunc = mInternal.mFileFuncs;
 	filefunc.zopen64_file = &detail::openFile;
 	filefunc.zread_file = &detail::readFile;
 	filefunc.ztell64_file = &detail::tellFile;
 	filefunc.zseek64_file = &detail::seekFile;
 	filefunc.zclose_file = &detail::closeFile;
 	filefunc.zerror_file = &detail::testFileError;
+	filefunc.opaque = nullptr;
 	// Ignoring	"filefunc.zwrite_file", it's not needed here
 
+	// Prefer memory mapping, so that all reads (including those of streaming input streams) don't need to go through file accesses
+	if (mInternal.mMappedFile.open(zipFilename))
+	{
+		filefunc.zopen64_file = &detail::openMappedFile;
+		filefunc.opaque = &mInternal.mMappedFile;
+	}
+
 	mInternal.mZipFile = unzOpen2_64(zipFilename.c_str(), &filefunc);
-	const int result = unzGetGlobalInfo64(mInternal.mZipFile, &mInternal.mGlobalInfo);
-	if (result == UNZ_OK)
+	if (nullptr != mInternal.mZipFile)
+	{
+		const int result = unzGetGlobalInfo64(mInternal.mZipFile, &mInternal.mGlobalInfo);
+		if (result == UNZ_OK)
+		{
+			mLoaded = scanZipFile();
+		}
+	}
+
+	if (nullptr != mInternal.mZipFile)
 	{
-		mLoaded = scanZipFile(zipFilename);
+		mInternal.mFreeZipFiles.push_back(mInternal.mZipFile);
+		mInternal.mZipFile = nullptr;
 	}
 
 	if (mLoaded)
 	{
-		RMX_LOG_INFO("Loaded ZIP file '" << WString(zipFilename).toStdString() << "' with " << (uint32)mContainedFiles.size() << " entries");
+		RMX_LOG_INFO("Loaded ZIP file '" << WString(zipFilename).toStdString() << "' with " << (uint32)mContainedFiles.size() << " entries" << (mInternal.mMappedFile.isOpen() ? " (memory mapped)" : ""));
 	}
 	else
 	{
@@ -139,21 +330,58 @@ ZipFileProvider::ZipFileProvider(const std::wstring& zipFilename) :
 
 ZipFileProvider::~ZipFileProvider()
 {
+	invalidateAllZipEntryInputStreams();
+	for (auto& pair : mContainedFiles)
+	{
+		ZipFileProvDetail::removeCachedContent(pair.second);
+	}
+	for (unzFile zipFile : mInternal.mFreeZipFiles)
+	{
+		unzClose(zipFile);
+	}
 	delete &mInternal;
 }
 
+void ZipFileProvider::unregisterZipEntryInputStream(ZipEntryInputStream& inputStream)
+{
+	// Input streams mutex must be locked when calling this
+	mZipEntryInputStreams.erase(&inputStream);
+}
+
 bool ZipFileProvider::exists(const std::wstring& filename)
 {
 	return (nullptr != findContainedFile(filename));
 }
 
+bool ZipFileProvider::getFileSize(const std::wstring& filename, uint64& outFileSize)
+{
+	const ContainedFile* containedFile = findContainedFile(filename);
+	if (nullptr == containedFile)
+		return false;
+
+	outFileSize = (uint64)containedFile->mFileEntry.mSize;
+	return true;
+}
+
 bool ZipFileProvider::readFile(const std::wstring& filename, std::vector<uint8>& outData)
 {
-	const ContainedFile* containedFile = readFile(filename);
+	ContainedFile* containedFile = findContainedFile(filename);
 	if (nullptr == containedFile)
 		return false;
 
-	outData = containedFile->mContent;
+	if (containedFile->mFileEntry.mSize == 0)
+	{
+		outData.clear();
+		return true;
+	}
+
+	if (ZipFileProvDetail::getCachedContent(*containedFile, outData))
+		return true;
+
+	if (!decompressContainedFile(*containedFile, outData))
+		return false;
+
+	ZipFileProvDetail::addCachedContent(*containedFile, outData);
 	return true;
 }
 
@@ -162,11 +390,11 @@ bool ZipFileProvider::listFiles(const std::wstring& path, bool recursive, std::v
 	if (mContainedFiles.empty())
 		return false;
 
-	mInternal.mEntriesBuffer.clear();
-	if (!mInternal.mFileStructureTree.listFiles(mInternal.mEntriesBuffer, path))
+	std::vector<const FileStructureTree::Entry*> entries;
+	if (!mInternal.mFileStructureTree.listFiles(entries, path))
 		return false;
 
-	ZipFileProvDetail::buildFileEntries(outFileEntries, mInternal.mEntriesBuffer);
+	ZipFileProvDetail::buildFileEntries(outFileEntries, entries);
 	return true;
 }
 
@@ -175,11 +403,11 @@ bool ZipFileProvider::listFilesByMask(const std::wstring& filemask, bool recursi
 	if (mContainedFiles.empty())
 		return false;
 
-	mInternal.mEntriesBuffer.clear();
-	if (!mInternal.mFileStructureTree.listFilesByMask(mInternal.mEntriesBuffer, filemask, recursive))
+	std::vector<const FileStructureTree::Entry*> entries;
+	if (!mInternal.mFileStructureTree.listFilesByMask(entries, filemask, recursive))
 		return false;
 
-	ZipFileProvDetail::buildFileEntries(outFileEntries, mInternal.mEntriesBuffer);
+	ZipFileProvDetail::buildFileEntries(outFileEntries, entries);
 	return true;
 }
 
@@ -193,14 +421,34 @@ bool ZipFileProvider::listDirectories(const std::wstring& path, std::vector<std:
 
 InputStream* ZipFileProvider::createInputStream(const std::wstring& filename)
 {
-	const ContainedFile* containedFile = readFile(filename);
+	ContainedFile* containedFile = findContainedFile(filename);
 	if (nullptr == containedFile)
 		return nullptr;
 
-	return new MemInputStream(&containedFile->mContent[0], containedFile->mContent.size());
+	// Stream larger stored entries, like music, instead of copying and caching them completely
+	if (containedFile->mFileEntry.mSize >= detail::STREAMING_MIN_SIZE)
+	{
+		ZipEntryInputStream* inputStream = createStreamingInputStream(*containedFile);
+		if (nullptr != inputStream)
+		{
+			std::lock_guard<std::mutex> lock(ZipFileProvDetail::mInputStreamsMutex);
+			mZipEntryInputStreams.insert(inputStream);
+			return inputStream;
+		}
+	}
+
+	std::vector<uint8> content;
+	if (!readFile(filename, content))
+		return nullptr;
+
+	// The input stream gets its own copy, as cached content may get evicted any time
+	uint8* buffer = new uint8[std::max<size_t>(content.size(), 1)];
+	if (!content.empty())
+		memcpy(buffer, &content[0], content.size());
+	return new MemInputStream(buffer, content.size(), true);
 }
 
-bool ZipFileProvider::scanZipFile(const std::wstring& zipFilename)
+bool ZipFileProvider::scanZipFile()
 {
 	mContainedFiles.clear();
 	mInternal.mFileStructureTree.clear();
@@ -233,11 +481,20 @@ bool ZipFileProvider::scanZipFile(const std::wstring& zipFilename)
 		// Create a file entry, unless it's a directory
 		if (!localName.empty())
 		{
+			// Remember the entry's position, so it can be accessed directly later on
+			unz64_file_pos filePos;
+			result = unzGetFilePos64(mInternal.mZipFile, &filePos);
+			if (result != UNZ_OK)
+				return false;
+
 			ContainedFile& containedFile = mContainedFiles[FileStructureTree::getLowercaseStringHash(localPath)];
 			containedFile.mFileEntry.mFilename = localName;
 			containedFile.mFileEntry.mPath = localBasePath.empty() ? L"" : (localBasePath + L'/');
 			containedFile.mFileEntry.mSize = (size_t)fileInfo.uncompressed_size;
 			//containedFile.mFileEntry.mTime = ...;	// Meh, forget about the date/time, we don't need it anyways
+			containedFile.mPositionInCentralDir = (uint64)filePos.pos_in_zip_directory;
+			containedFile.mFileNumber = (uint64)filePos.num_of_file;
+			containedFile.mIsStored = (fileInfo.compression_method == 0) && ((fileInfo.flag & 1) == 0);
 		}
 		else
 		{
@@ -264,43 +521,69 @@ bool ZipFileProvider::scanZipFile(const std::wstring& zipFilename)
 	return true;
 }
 
-const ZipFileProvider::ContainedFile* ZipFileProvider::readFile(const std::wstring& filename)
+bool ZipFileProvider::decompressContainedFile(ContainedFile& containedFile, std::vector<uint8>& outData)
 {
-	ContainedFile* containedFile = findContainedFile(filename);
-	if (nullptr == containedFile)
-		return nullptr;
+	const unzFile zipFile = mInternal.acquireZipFile();
+	if (nullptr == zipFile)
+		return false;
 
-	const rmx::FileIO::FileEntry& fileEntry = containedFile->mFileEntry;
-	if (!containedFile->mContent.empty() || fileEntry.mSize == 0)
+	bool success = false;
+	if (ZipFileProvDetail::goToContainedFile(zipFile, containedFile) && unzOpenCurrentFile(zipFile) == UNZ_OK)
 	{
-		// Cached file is loaded already (or empty)
-		return containedFile;
+		outData.resize(containedFile.mFileEntry.mSize);
+		const int readResult = unzReadCurrentFile(zipFile, &outData[0], (unsigned int)outData.size());
+		if (readResult == (int)outData.size())
+		{
+			success = (unzCloseCurrentFile(zipFile) == UNZ_OK);
+		}
+		else
+		{
+			unzCloseCurrentFile(zipFile);
+		}
 	}
+	mInternal.releaseZipFile(zipFile);
 
-	int result = unzLocateFile(mInternal.mZipFile, *WString(fileEntry.mPath + fileEntry.mFilename).toString(), 1);
-	if (result != UNZ_OK)
-		return nullptr;
+	if (!success)
+		outData.clear();
+	return success;
+}
 
-	containedFile->mContent.resize(fileEntry.mSize);
+ZipEntryInputStream* ZipFileProvider::createStreamingInputStream(ContainedFile& containedFile)
+{
+	// This is only meant for stored entries in a memory mapped zip file, so no decompression is needed
+	if (!containedFile.mIsStored || !mInternal.mMappedFile.isOpen())
+		return nullptr;
 
-	result = unzOpenCurrentFile(mInternal.mZipFile);
-	if (result != UNZ_OK)
+	const unzFile zipFile = mInternal.acquireZipFile();
+	if (nullptr == zipFile)
 		return nullptr;
 
-	const int readResult = unzReadCurrentFile(mInternal.mZipFile, &containedFile->mContent[0], (int)containedFile->mContent.capacity());
-	if (readResult == (int)containedFile->mContent.capacity())
+	// Get the entry's position in the zip file
+	size_t position = 0;
+	const bool success = ZipFileProvDetail::goToContainedFile(zipFile, containedFile) && unzOpenCurrentFile(zipFile) == UNZ_OK;
+	if (success)
 	{
-		if (unzCloseCurrentFile(mInternal.mZipFile) == UNZ_OK)
-		{
-			// Success
-			return containedFile;
-		}
+		position = (size_t)unzGetCurrentFileZStreamPos64(zipFile);
+		unzCloseCurrentFile(zipFile);
 	}
-	else
+	mInternal.releaseZipFile(zipFile);
+
+	const size_t size = containedFile.mFileEntry.mSize;
+	if (!success || position + size > mInternal.mMappedFile.getSize())
+		return nullptr;
+
+	return new ZipEntryInputStream(*this, mInternal.mMappedFile.getData() + position, size);
+}
+
+void ZipFileProvider::invalidateAllZipEntryInputStreams()
+{
+	std::lock_guard<std::mutex> lock(ZipFileProvDetail::mInputStreamsMutex);
+	for (ZipEntryInputStream* zipEntryInputStream : mZipEntryInputStreams)
 	{
-		unzCloseCurrentFile(mInternal.mZipFile);
+		zipEntryInputStream->close();
+		zipEntryInputStream->mProvider = nullptr;
 	}
-	return nullptr;
+	mZipEntryInputStreams.clear();
 }
 
 ZipFileProvider::ContainedFile* ZipFileProvider::findContainedFile(const std::wstring& filePath)
@@ -10,7 +10,14 @@
 
 #include "oxygen/file/FilePackage.h"
 
+class ZipEntryInputStream;
 
+
+// File provider for the contents of a zip file
+//  - The zip file gets memory mapped if possible, otherwise it's read via the file system
+//  - Larger stored (uncompressed) entries are streamed by "createInputStream" directly from the memory mapped zip file, instead of getting copied as a whole
+//  - Decompressed content of smaller entries is cached, with a total size limit shared by all zip file providers
+//  - Multiple threads can read from the same zip file provider, each one using its own zip file handle
 class ZipFileProvider : public rmx::FileProvider
 {
 friend struct ZipFileProvDetail;
@@ -20,8 +27,10 @@ public:
 	~ZipFileProvider();
 
 	const bool isLoaded() const  { return mLoaded; }
+	void unregisterZipEntryInputStream(ZipEntryInputStream& inputStream);
 
 	bool exists(const std::wstring& filename) override;
+	bool getFileSize(const std::wstring& filename, uint64& outFileSize) override;
 	bool readFile(const std::wstring& filename, std::vector<uint8>& outData) override;
 	bool listFiles(const std::wstring& path, bool recursive, std::vector<rmx::FileIO::FileEntry>& outFileEntries) override;
 	bool listFilesByMask(const std::wstring& filemask, bool recursive, std::vector<rmx::FileIO::FileEntry>& outFileEntries) override;
@@ -32,12 +41,21 @@ private:
 	struct ContainedFile
 	{
 		rmx::FileIO::FileEntry mFileEntry;
-		std::vector<uint8> mContent;		// Cached content
+		uint64 mPositionInCentralDir = 0;	// Together with the file number, this allows for direct access to the entry, without searching for it
+		uint64 mFileNumber = 0;
+		bool mIsStored = false;				// Entry is neither compressed nor encrypted
+
+		// Cached content, see "ZipFileProvDetail::ContentCache"
+		std::vector<uint8> mContent;
+		bool mIsCached = false;
+		std::list<ContainedFile*>::iterator mCacheIterator;
 	};
 
 private:
-	bool scanZipFile(const std::wstring& zipFilename);
-	const ContainedFile* readFile(const std::wstring& filename);
+	bool scanZipFile();
+	bool decompressContainedFile(ContainedFile& containedFile, std::vector<uint8>& outData);
+	ZipEntryInputStream* createStreamingInputStream(ContainedFile& containedFile);
+	void invalidateAllZipEntryInputStreams();
 
 	ContainedFile* findContainedFile(const std::wstring& filePath);
 	const ContainedFile* findContainedFile(const std::wstring& filePath) const;
@@ -48,4 +66,5 @@ private:
 
 	std::map<uint64, ContainedFile> mContainedFiles;
 	bool mLoaded = false;
+	std::set<ZipEntryInputStream*> mZipEntryInputStreams;	// Managed input streams created in "createInputStream" calls
 };
@@ -86,6 +86,10 @@ namespace oxygen
 	{
 		rmx::Logging::addLogger(*new rmx::StdCoutLogger());
 		rmx::Logging::addLogger(*new rmx::FileLogger(filename, true));
+	#if !defined(PLATFORM_WEB)
+		// Don't let the main thread wait for file and console output
+		rmx::Logging::startAsyncWriter();
+	#endif
 
 		// Register as logger and message box callback for rmx error handling
 		rmx::ErrorHandling::mLogger = &mErrorLogger;
@@ -8,6 +8,7 @@
 
 #include "oxygen/pch.h"
 #include "oxygen/helper/Profiling.h"
+#include "oxygen/helper/JsonHelper.h"
 
 
 namespace profiling
@@ -17,6 +18,7 @@ namespace profiling
 	std::vector<Profiling::Region*> mAllRegions;
 	std::vector<Profiling::Region*> mRegionStack;
 	Profiling::AdditionalData mAdditionalData;
+	Profiling::Statistics mStatistics;
 	int mAccumulatedFrames = 0;
 
 	Profiling::Region* getRegionByID(uint16 id)
@@ -24,11 +26,94 @@ namespace profiling
 		const auto it = mRegionsByID.find(id);
 		return (it == mRegionsByID.end()) ? nullptr : &it->second;
 	}
+
+	Profiling::TimeSummary getTimeSummary(const Profiling::Histogram& histogram)
+	{
+		Profiling::TimeSummary summary;
+		if (histogram.mCount > 0)
+		{
+			summary.mAverageTime = histogram.mTotalTime / (double)histogram.mCount;
+			summary.mPercentile50 = histogram.getPercentile(0.5);
+			summary.mPercentile95 = histogram.getPercentile(0.95);
+			summary.mPercentile99 = histogram.getPercentile(0.99);
+			summary.mMaxTime = histogram.mMaxTime;
+		}
+		return summary;
+	}
+
+	Json::Value timeSummaryToJson(const Profiling::TimeSummary& summary)
+	{
+		// Using milliseconds in the output, that's easier to read
+		Json::Value json;
+		json["AverageMs"] = summary.mAverageTime * 1000.0;
+		json["P50Ms"] = summary.mPercentile50 * 1000.0;
+		json["P95Ms"] = summary.mPercentile95 * 1000.0;
+		json["P99Ms"] = summary.mPercentile99 * 1000.0;
+		json["MaxMs"] = summary.mMaxTime * 1000.0;
+		return json;
+	}
+
+	Json::Value frameCountersToJson(const Profiling::FrameCounters& counters)
+	{
+		Json::Value json;
+		json["Frames"] = counters.mNumFrames;
+		json["LateFrames"] = counters.mLateFrames;
+		json["DroppedFrames"] = counters.mDroppedFrames;
+		return json;
+	}
 }
 
 using namespace profiling;
 
 
+void Profiling::Histogram::addTime(double seconds)
+{
+	int bucket = 0;
+	const double microseconds = seconds * 1000000.0;
+	if (microseconds >= 1.0)
+	{
+		// Mantissa is in [0.5, 1.0), so that exponent 1 stands for times between 1 and 2 microseconds
+		int exponent;
+		const double mantissa = std::frexp(microseconds, &exponent);
+		bucket = std::min((exponent - 1) * SUBDIVISIONS + (int)((mantissa * 2.0 - 1.0) * (double)SUBDIVISIONS), NUM_BUCKETS - 1);
+	}
+
+	++mBuckets[bucket];
+	++mCount;
+	mTotalTime += seconds;
+	mMaxTime = std::max(mMaxTime, seconds);
+}
+
+double Profiling::Histogram::getPercentile(double fraction) const
+{
+	if (mCount == 0)
+		return 0.0;
+
+	const uint32 rank = std::max((uint32)std::ceil(fraction * (double)mCount), 1u);
+	uint32 count = 0;
+	for (int bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+	{
+		count += mBuckets[bucket];
+		if (count >= rank && bucket < NUM_BUCKETS - 1)		// Last bucket also holds everything longer, so its upper bound is the maximum
+		{
+			// Return the bucket's upper bound, but never more than the actual maximum
+			const double upperBound = std::ldexp(1.0 + (double)(bucket % SUBDIVISIONS + 1) / (double)SUBDIVISIONS, bucket / SUBDIVISIONS) / 1000000.0;
+			return std::min(upperBound, mMaxTime);
+		}
+	}
+	return mMaxTime;
+}
+
+void Profiling::Histogram::reset()
+{
+	memset(mBuckets, 0, sizeof(mBuckets));
+	mCount = 0;
+	mTotalTime = 0.0;
+	mMaxTime = 0.0;
+}
+
+
+
 void Profiling::startup()
 {
 	// No need to do things twice
@@ -109,6 +194,11 @@ void Profiling::nextFrame(int simulationFrameNumber)
 	}
 	mRootRegion.mTimer.resumeTiming();		// Needed for first frame to start timing
 
+	if (mStatistics.mEnabled)
+	{
+		updateStatistics();
+	}
+
 	static const PerFrameData dummy;
 	const PerFrameData& oldData = mAdditionalData.mFrames.empty() ? dummy : mAdditionalData.mFrames.back();
 	while (mAdditionalData.mFrames.size() >= MAX_FRAMES)
@@ -158,6 +248,66 @@ Profiling::AdditionalData& Profiling::getAdditionalData()
 	return mAdditionalData;
 }
 
+void Profiling::enableStatistics(uint32 windowSize)
+{
+	mStatistics.mEnabled = true;
+	mStatistics.mWindowSize = std::max<uint32>(windowSize, 1);
+}
+
+void Profiling::setTargetFrameTime(double seconds)
+{
+	mStatistics.mTargetFrameTime = seconds;
+}
+
+const Profiling::Statistics& Profiling::getStatistics()
+{
+	return mStatistics;
+}
+
+bool Profiling::saveStatistics(const std::wstring& filename)
+{
+	if (!mStatistics.mEnabled)
+		return false;
+
+	// Include the last window even if it's incomplete
+	if (mStatistics.mWindowCounters.mNumFrames > 0)
+	{
+		finishStatisticsWindow();
+	}
+
+	Json::Value root;
+	root["WindowSize"] = mStatistics.mWindowSize;
+	root["TargetFrameTimeMs"] = mStatistics.mTargetFrameTime * 1000.0;
+	root["Total"] = frameCountersToJson(mStatistics.mTotalCounters);
+	{
+		Json::Value windowsJson(Json::arrayValue);
+		for (const FrameCounters& counters : mStatistics.mWindows)
+		{
+			windowsJson.append(frameCountersToJson(counters));
+		}
+		root["Windows"] = windowsJson;
+	}
+
+	Json::Value regionsJson(Json::arrayValue);
+	for (const Region* region : mAllRegions)
+	{
+		Json::Value regionJson;
+		regionJson["Name"] = region->mName;
+		regionJson["Total"] = timeSummaryToJson(getTimeSummary(region->mTotalHistogram));
+
+		Json::Value windowsJson(Json::arrayValue);
+		for (const TimeSummary& summary : region->mWindowSummaries)
+		{
+			windowsJson.append(timeSummaryToJson(summary));
+		}
+		regionJson["Windows"] = windowsJson;
+		regionsJson.append(regionJson);
+	}
+	root["Regions"] = regionsJson;
+
+	return JsonHelper::saveFile(filename, root);
+}
+
 void Profiling::listRegionsRecursiveInternal(std::vector<std::pair<Region*, int>>& outRegions, Region& parent, int level)
 {
 	for (Region* child : parent.mChildren)
@@ -166,3 +316,44 @@ void Profiling::listRegionsRecursiveInternal(std::vector<std::pair<Region*, int>
 		listRegionsRecursiveInternal(outRegions, *child, level + 1);
 	}
 }
+
+void Profiling::updateStatistics()
+{
+	for (Region* region : mAllRegions)
+	{
+		const double time = region->mFrameTimes.back().mInclusiveTime;
+		region->mTotalHistogram.addTime(time);
+		region->mWindowHistogram.addTime(time);
+	}
+
+	// The root region's time is the full frame time, including frame sync
+	const double frameTime = mRootRegion.mFrameTimes.back().mInclusiveTime;
+	const double targetFrameTime = mStatistics.mTargetFrameTime;
+	for (FrameCounters* counters : { &mStatistics.mTotalCounters, &mStatistics.mWindowCounters })
+	{
+		++counters->mNumFrames;
+		if (targetFrameTime > 0.0)
+		{
+			if (frameTime >= targetFrameTime * 2.0)
+				++counters->mDroppedFrames;
+			else if (frameTime > targetFrameTime * 1.1)
+				++counters->mLateFrames;
+		}
+	}
+
+	if (mStatistics.mWindowCounters.mNumFrames >= mStatistics.mWindowSize)
+	{
+		finishStatisticsWindow();
+	}
+}
+
+void Profiling::finishStatisticsWindow()
+{
+	for (Region* region : mAllRegions)
+	{
+		region->mWindowSummaries.push_back(getTimeSummary(region->mWindowHistogram));
+		region->mWindowHistogram.reset();
+	}
+	mStatistics.mWindows.push_back(mStatistics.mWindowCounters);
+	mStatistics.mWindowCounters = FrameCounters();
+}
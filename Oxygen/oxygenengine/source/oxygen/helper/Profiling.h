@@ -35,6 +35,34 @@ public:
 	static const constexpr size_t MAX_FRAMES = 240;
 #endif
 
+	// Histogram of times with logarithmic buckets, for percentiles with a fixed amount of memory
+	struct Histogram
+	{
+	public:
+		static const constexpr int SUBDIVISIONS = 8;					// Buckets per doubling of time, for a resolution of about 9%
+		static const constexpr int NUM_BUCKETS = 24 * SUBDIVISIONS;		// Covers times from 1 microsecond up to about 16 seconds
+
+	public:
+		uint32 mBuckets[NUM_BUCKETS] = { 0 };
+		uint32 mCount = 0;
+		double mTotalTime = 0.0;
+		double mMaxTime = 0.0;
+
+	public:
+		void addTime(double seconds);
+		double getPercentile(double fraction) const;
+		void reset();
+	};
+
+	struct TimeSummary
+	{
+		double mAverageTime = 0.0;
+		double mPercentile50 = 0.0;
+		double mPercentile95 = 0.0;
+		double mPercentile99 = 0.0;
+		double mMaxTime = 0.0;
+	};
+
 	struct Region
 	{
 	friend class Profiling;
@@ -57,6 +85,11 @@ public:
 		Region* mParent = nullptr;
 		std::vector<Region*> mChildren;
 
+		// Inclusive times, only collected while statistics are enabled
+		Histogram mTotalHistogram;
+		Histogram mWindowHistogram;
+		std::vector<TimeSummary> mWindowSummaries;
+
 	private:
 		double mAccumulatedTime = 0.0;
 		bool mOnStack = false;
@@ -76,6 +109,22 @@ public:
 		std::deque<float> mSimulationsPerSecondDeque;
 	};
 
+	struct FrameCounters
+	{
+		uint32 mNumFrames = 0;
+		uint32 mLateFrames = 0;		// Frames that took more than 10% longer than the target frame time, but less than twice as long
+		uint32 mDroppedFrames = 0;	// Frames that took at least twice the target frame time, so at least one refresh got missed
+	};
+	struct Statistics
+	{
+		bool mEnabled = false;
+		uint32 mWindowSize = 0;			// In frames
+		double mTargetFrameTime = 0.0;	// In seconds, zero if there is none
+		FrameCounters mTotalCounters;
+		FrameCounters mWindowCounters;
+		std::vector<FrameCounters> mWindows;
+	};
+
 public:
 	static void startup();
 	static void registerRegion(uint16 id, const char* name, const Color& color);
@@ -89,6 +138,14 @@ public:
 
 	static AdditionalData& getAdditionalData();
 
+	// Statistics are disabled by default, as they are not needed for the profiling view
+	static void enableStatistics(uint32 windowSize);
+	static void setTargetFrameTime(double seconds);
+	static const Statistics& getStatistics();
+	static bool saveStatistics(const std::wstring& filename);
+
 private:
 	static void listRegionsRecursiveInternal(std::vector<std::pair<Region*,int>>& outRegions, Region& parent, int level);
+	static void updateStatistics();
+	static void finishStatisticsWindow();
 };
@@ -53,6 +53,19 @@ void PatternManager::refresh()
 	}
 }
 
+void PatternManager::copyForRendering(const PatternManager& source, bool onlyChangedPatterns)
+{
+	// If this copy was kept up-to-date before, only the patterns changed in the source's last refresh need to be copied
+	for (int name = 0; name < 0x800; ++name)
+	{
+		const CacheItem& sourceItem = source.mPatternCache[name];
+		if (sourceItem.mChanged || !onlyChangedPatterns)
+		{
+			mPatternCache[name] = sourceItem;
+		}
+	}
+}
+
 uint8 PatternManager::getLastUsedAtex(uint16 patternIndex) const
 {
 	return mPatternCache[patternIndex & 0x07ff].mLastUsedAtex;
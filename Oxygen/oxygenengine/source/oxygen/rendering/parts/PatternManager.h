@@ -30,6 +30,7 @@ public:
 
 public:
 	void refresh();
+	void copyForRendering(const PatternManager& source, bool onlyChangedPatterns);
 
 	uint8 getLastUsedAtex(uint16 patternIndex) const;
 	void setLastUsedAtex(uint16 patternIndex, uint8 atex);
@@ -151,6 +151,36 @@ void PlaneManager::resetCustomPlanes()
 	mCustomPlanes.clear();
 }
 
+void PlaneManager::copyForRendering(const PlaneManager& source)
+{
+	mNameTableBaseA = source.mNameTableBaseA;
+	mNameTableBaseB = source.mNameTableBaseB;
+	mNameTableBaseW = source.mNameTableBaseW;
+	mPlayfieldSize = source.mPlayfieldSize;
+	mUsingPlaneW = source.mUsingPlaneW;
+	mPlaneAWSplit = source.mPlaneAWSplit;
+	memcpy(mDisabledDefaultPlane, source.mDisabledDefaultPlane, sizeof(mDisabledDefaultPlane));
+	mCustomPlanes = source.mCustomPlanes;
+	mAbstractionModeForPlaneA = source.mAbstractionModeForPlaneA;
+
+	// Copy the name tables themselves, as VRAM will change while the copy gets rendered
+	//  -> Note that plane W always uses 64 patterns per line
+	const uint8* vram = EmulatorInterface::instance().getVRam();
+	for (int planeIndex = PLANE_B; planeIndex <= PLANE_W; ++planeIndex)
+	{
+		const uint32 baseAddress = getPlaneBaseVRAMAddress(planeIndex);
+		const size_t numPatterns = (size_t)(((planeIndex == PLANE_W) ? 64 : mPlayfieldSize.x) * mPlayfieldSize.y);
+		const size_t bytesToCopy = std::min(numPatterns * 2, (size_t)(0x10000 - baseAddress));
+
+		std::vector<uint16>& nameTable = mNameTableCopies[planeIndex];
+		nameTable.resize(numPatterns);
+		if (bytesToCopy > 0)
+		{
+			memcpy(&nameTable[0], &vram[baseAddress], bytesToCopy);
+		}
+	}
+}
+
 bool PlaneManager::isPlaneUsed(int index) const
 {
 	if (EngineMain::getDelegate().useDeveloperFeatures())
@@ -217,6 +247,8 @@ uint16 PlaneManager::getPlaneBaseVRAMAddress(int planeIndex) const
 
 const uint16* PlaneManager::getPlaneDataInVRAM(int planeIndex) const
 {
+	if (planeIndex >= PLANE_B && planeIndex <= PLANE_W && !mNameTableCopies[planeIndex].empty())
+		return &mNameTableCopies[planeIndex][0];
 	return (const uint16*)(EmulatorInterface::instance().getVRam() + getPlaneBaseVRAMAddress(planeIndex));
 }
 
@@ -36,6 +36,7 @@ public:
 
 	void reset();
 	void refresh();
+	void copyForRendering(const PlaneManager& source);
 
 	void resetCustomPlanes();
 	bool isPlaneUsed(int index) const;
@@ -96,4 +97,6 @@ private:
 
 	bool mDisabledDefaultPlane[4];
 	std::vector<CustomPlane> mCustomPlanes;
+
+	std::vector<uint16> mNameTableCopies[3];	// Only used in copies for rendering, replacing the name tables in VRAM for planes B, A and W
 };
@@ -47,14 +47,14 @@ void RenderParts::reset()
 	mScrollOffsetsManager.reset();
 }
 
-void RenderParts::preFrameUpdate()
+void RenderParts::preFrameUpdate(bool willBeDisplayed)
 {
 	// TODO: It could make sense to require an explicit script call for these as well, see "Renderer.resetCustomPlaneConfigurations()"
 	mViewports.clear();
 	mOverlayManager.preFrameUpdate();
 	mPaletteManager.preFrameUpdate();
 	mSpriteManager.preFrameUpdate();
-	mScrollOffsetsManager.preFrameUpdate();
+	mScrollOffsetsManager.preFrameUpdate(willBeDisplayed);
 	mEnforceClearScreen = false;
 }
 
@@ -75,6 +75,22 @@ void RenderParts::refresh(const RefreshParameters& refreshParameters)
 	mSpriteManager.refresh();
 }
 
+void RenderParts::copyForRendering(const RenderParts& source, bool onlyChangedPatterns)
+{
+	mPaletteManager = source.mPaletteManager;
+	mPatternManager.copyForRendering(source.mPatternManager, onlyChangedPatterns);
+	mPlaneManager.copyForRendering(source.mPlaneManager);
+	mScrollOffsetsManager.copyForRendering(source.mScrollOffsetsManager);
+	mSpacesManager = source.mSpacesManager;
+	mSpriteManager.copyForRendering(source.mSpriteManager);
+
+	mActiveDisplay = source.mActiveDisplay;
+	mEnforceClearScreen = source.mEnforceClearScreen;
+	mFullEmulation = source.mFullEmulation;
+	mViewports = source.mViewports;
+	memcpy(mLayerRendering, source.mLayerRendering, sizeof(mLayerRendering));
+}
+
 void RenderParts::dumpPatternsContent()
 {
 	PaletteBitmap bmp;
@@ -50,10 +50,13 @@ public:
 	inline const std::vector<Viewport>& getViewports() const  { return mViewports; }
 
 	void reset();
-	void preFrameUpdate();
+	void preFrameUpdate(bool willBeDisplayed = true);
 	void postFrameUpdate();
 	void refresh(const RefreshParameters& refreshParameters);
 
+	// Copy everything the software renderer needs, so that this instance can get rendered while the simulation continues on the source
+	void copyForRendering(const RenderParts& source, bool onlyChangedPatterns);
+
 	void dumpPatternsContent();
 	void dumpPlaneContent(int planeIndex);
 
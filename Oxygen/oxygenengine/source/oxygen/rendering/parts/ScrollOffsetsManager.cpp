@@ -36,6 +36,22 @@ void ScrollOffsetsManager::reset()
 	}
 }
 
+void ScrollOffsetsManager::copyForRendering(const ScrollOffsetsManager& source)
+{
+	mVerticalScrolling = source.mVerticalScrolling;
+	mHorizontalScrollMask = source.mHorizontalScrollMask;
+	mHorizontalScrollTableBase = source.mHorizontalScrollTableBase;
+	mScrollOffsetW = source.mScrollOffsetW;
+	mVerticalScrollOffsetBias = source.mVerticalScrollOffsetBias;
+	mAbstractionModeForPlaneA = source.mAbstractionModeForPlaneA;
+
+	for (int index = 0; index < 4; ++index)
+	{
+		mSets[index] = source.mSets[index];
+		mInterpolatedSets[index] = source.mInterpolatedSets[index];
+	}
+}
+
 void ScrollOffsetsManager::refresh(const RefreshParameters& refreshParameters)
 {
 	if (refreshParameters.mHasNewSimulationFrame)
@@ -182,13 +198,17 @@ void ScrollOffsetsManager::refresh(const RefreshParameters& refreshParameters)
 	}
 }
 
-void ScrollOffsetsManager::preFrameUpdate()
+void ScrollOffsetsManager::preFrameUpdate(bool willBeDisplayed)
 {
 	// Reset this again on each frame
 	for (int index = 0; index < 4; ++index)
 		mSets[index].mHorizontalScrollNoRepeat = false;
 
 	// Backup scroll offsets before frame update
+	//  -> These are only used for frame interpolation, which only needs the backup from right before the displayed frame
+	if (!willBeDisplayed)
+		return;
+
 	for (int index = 0; index < 4; ++index)
 	{
 		InterpolatedScrollOffsetSet& interpolatedSet = mInterpolatedSets[index];
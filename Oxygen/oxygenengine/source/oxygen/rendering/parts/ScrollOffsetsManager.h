@@ -20,7 +20,8 @@ public:
 
 	void reset();
 	void refresh(const RefreshParameters& refreshParameters);
-	void preFrameUpdate();
+	void copyForRendering(const ScrollOffsetsManager& source);
+	void preFrameUpdate(bool willBeDisplayed);
 	void postFrameUpdate();
 
 	inline bool getVerticalScrolling() const				{ return mVerticalScrolling; }
@@ -162,6 +162,26 @@ void SpriteManager::refresh()
 	}
 }
 
+void SpriteManager::copyForRendering(const SpriteManager& source)
+{
+	mCurrSpriteSets = source.mCurrSpriteSets;
+
+	// Rebuild the sorted list of sprites, pointing into the copied sprite sets
+	mSprites.clear();
+	mSprites.reserve(source.mSprites.size());
+	for (const SpriteInfo* sprite : source.mSprites)
+	{
+		switch (sprite->getType())
+		{
+			case SpriteInfo::Type::VDP:		  mSprites.push_back(&mCurrSpriteSets.mVdpSprites[static_cast<const VdpSpriteInfo*>(sprite) - &source.mCurrSpriteSets.mVdpSprites[0]]);					  break;
+			case SpriteInfo::Type::PALETTE:	  mSprites.push_back(&mCurrSpriteSets.mPaletteSprites[static_cast<const PaletteSpriteInfo*>(sprite) - &source.mCurrSpriteSets.mPaletteSprites[0]]);		  break;
+			case SpriteInfo::Type::COMPONENT: mSprites.push_back(&mCurrSpriteSets.mComponentSprites[static_cast<const ComponentSpriteInfo*>(sprite) - &source.mCurrSpriteSets.mComponentSprites[0]]); break;
+			case SpriteInfo::Type::MASK:	  mSprites.push_back(&mCurrSpriteSets.mSpriteMasks[static_cast<const SpriteMaskInfo*>(sprite) - &source.mCurrSpriteSets.mSpriteMasks[0]]);				  break;
+			default: break;
+		}
+	}
+}
+
 void SpriteManager::drawVdpSprite(const Vec2i& position, uint8 encodedSize, uint16 patternIndex, uint16 renderQueue, const Color& tintColor, const Color& addedColor)
 {
 	if (mNextSpriteSets.mVdpSprites.size() >= 0x400)
@@ -0,0 +1,177 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/rendering/software/SoftwareBlur.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define USE_SSE2_BLUR
+#endif
+
+
+namespace softwareblur
+{
+	// Minimum number of rows processed by one task of the parallel for
+	const constexpr int MIN_ROWS_PER_TASK = 16;
+
+	// Same kernels as "BLUR_KERNELS" in the hardware renderer, scaled by 200 to get integers
+	//  -> Weights are for the center pixel, the left and right neighbors, the upper and lower neighbors, and the diagonal neighbors
+	//  -> Each kernel's weights sum up to exactly 200, so the result is divided by 200 in the end
+	struct Kernel
+	{
+		uint16 mCenter;
+		uint16 mHorizontal;
+		uint16 mVertical;
+		uint16 mDiagonal;
+	};
+	static const Kernel KERNELS[] =
+	{
+		{ 200,  0,  0,  0 },
+		{ 160,  8,  8,  2 },
+		{ 120, 16, 16,  4 },
+		{  80, 24, 24,  6 },
+		{  40, 30, 30, 10 }
+	};
+
+	// The intermediate results use two uint32 values per pixel, one with the first and third color channel in its 16-bit halves, and one with the second channel and alpha
+	//  -> The weighted sums never exceed 16 bits, so the halves can be processed together without overflows
+	FORCE_INLINE void horizontalPassPixel(uint32 c, uint32 l, uint32 r, uint32* center, uint32* outer, int x, int width, const Kernel& kernel)
+	{
+		const uint32 center02 = (c & 0x00ff00ff);
+		const uint32 center13 = (c >> 8) & 0x00ff00ff;
+		const uint32 sides02 = (l & 0x00ff00ff) + (r & 0x00ff00ff);
+		const uint32 sides13 = ((l >> 8) & 0x00ff00ff) + ((r >> 8) & 0x00ff00ff);
+
+		center[x]		  = center02 * kernel.mCenter + sides02 * kernel.mHorizontal;
+		center[x + width] = center13 * kernel.mCenter + sides13 * kernel.mHorizontal;
+		outer[x]		  = center02 * kernel.mVertical + sides02 * kernel.mDiagonal;
+		outer[x + width]  = center13 * kernel.mVertical + sides13 * kernel.mDiagonal;
+	}
+
+	void horizontalPass(const uint32* src, uint32* center, uint32* outer, int width, const Kernel& kernel)
+	{
+		// Pixels at the left and right border use themselves as neighbors, just like texture sampling with clamp to edge
+		if (width <= 1)
+		{
+			horizontalPassPixel(src[0], src[0], src[0], center, outer, 0, width, kernel);
+			return;
+		}
+		horizontalPassPixel(src[0], src[0], src[1], center, outer, 0, width, kernel);
+		int x = 1;
+
+	#ifdef USE_SSE2_BLUR
+		{
+			const __m128i lowByteMask = _mm_set1_epi16(0x00ff);
+			const __m128i weightCenter = _mm_set1_epi16((short)kernel.mCenter);
+			const __m128i weightHorizontal = _mm_set1_epi16((short)kernel.mHorizontal);
+			const __m128i weightVertical = _mm_set1_epi16((short)kernel.mVertical);
+			const __m128i weightDiagonal = _mm_set1_epi16((short)kernel.mDiagonal);
+
+			// Four pixels at once, as long as their right neighbors are all inside
+			for (; x + 5 <= width; x += 4)
+			{
+				const __m128i c = _mm_loadu_si128((const __m128i*)&src[x]);
+				const __m128i l = _mm_loadu_si128((const __m128i*)&src[x - 1]);
+				const __m128i r = _mm_loadu_si128((const __m128i*)&src[x + 1]);
+
+				const __m128i center02 = _mm_and_si128(c, lowByteMask);
+				const __m128i center13 = _mm_srli_epi16(c, 8);
+				const __m128i sides02 = _mm_add_epi16(_mm_and_si128(l, lowByteMask), _mm_and_si128(r, lowByteMask));
+				const __m128i sides13 = _mm_add_epi16(_mm_srli_epi16(l, 8), _mm_srli_epi16(r, 8));
+
+				_mm_storeu_si128((__m128i*)&center[x],		   _mm_add_epi16(_mm_mullo_epi16(center02, weightCenter), _mm_mullo_epi16(sides02, weightHorizontal)));
+				_mm_storeu_si128((__m128i*)&center[x + width], _mm_add_epi16(_mm_mullo_epi16(center13, weightCenter), _mm_mullo_epi16(sides13, weightHorizontal)));
+				_mm_storeu_si128((__m128i*)&outer[x],		   _mm_add_epi16(_mm_mullo_epi16(center02, weightVertical), _mm_mullo_epi16(sides02, weightDiagonal)));
+				_mm_storeu_si128((__m128i*)&outer[x + width],  _mm_add_epi16(_mm_mullo_epi16(center13, weightVertical), _mm_mullo_epi16(sides13, weightDiagonal)));
+			}
+		}
+	#endif
+
+		for (; x < width - 1; ++x)
+		{
+			horizontalPassPixel(src[x], src[x - 1], src[x + 1], center, outer, x, width, kernel);
+		}
+		horizontalPassPixel(src[x], src[x - 1], src[x], center, outer, x, width, kernel);
+	}
+
+	void verticalPass(uint32* dst, const uint32* center, const uint32* above, const uint32* below, int width)
+	{
+		int x = 0;
+
+	#ifdef USE_SSE2_BLUR
+		{
+			// Division by 200 with rounding is done as a division by 8, followed by a multiplication with 5243 / 2^17, which is exact for the whole value range
+			const __m128i rounding = _mm_set1_epi16(100);
+			const __m128i factor = _mm_set1_epi16((short)5243);
+			const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+
+			for (; x + 4 <= width; x += 4)
+			{
+				const __m128i sum02 = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i*)&center[x]), rounding),
+													_mm_add_epi16(_mm_loadu_si128((const __m128i*)&above[x]), _mm_loadu_si128((const __m128i*)&below[x])));
+				const __m128i sum13 = _mm_add_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i*)&center[x + width]), rounding),
+													_mm_add_epi16(_mm_loadu_si128((const __m128i*)&above[x + width]), _mm_loadu_si128((const __m128i*)&below[x + width])));
+
+				const __m128i result02 = _mm_srli_epi16(_mm_mulhi_epu16(_mm_srli_epi16(sum02, 3), factor), 1);
+				const __m128i result13 = _mm_srli_epi16(_mm_mulhi_epu16(_mm_srli_epi16(sum13, 3), factor), 1);
+				const __m128i result = _mm_or_si128(result02, _mm_slli_epi16(result13, 8));
+
+				// Keep the original alpha
+				const __m128i original = _mm_loadu_si128((const __m128i*)&dst[x]);
+				_mm_storeu_si128((__m128i*)&dst[x], _mm_or_si128(_mm_and_si128(original, alphaMask), _mm_andnot_si128(alphaMask, result)));
+			}
+		}
+	#endif
+
+		for (; x < width; ++x)
+		{
+			// Keep the original alpha here as well
+			const uint32 sum02 = center[x] + above[x] + below[x] + 0x00640064;
+			const uint32 sum1 = (center[x + width] + above[x + width] + below[x + width] + 100) & 0xffff;
+			dst[x] = (dst[x] & 0xff000000) | ((sum02 & 0xffff) / 200) | ((sum1 / 200) << 8) | (((sum02 >> 16) / 200) << 16);
+		}
+	}
+}
+
+
+void SoftwareBlur::blurBitmap(Bitmap& bitmap, int blurValue)
+{
+	const int kernelIndex = blurValue % 5;
+	if (kernelIndex <= 0 || bitmap.empty())
+		return;
+
+	const softwareblur::Kernel& kernel = softwareblur::KERNELS[kernelIndex];
+	const int width = bitmap.getWidth();
+	const int height = bitmap.getHeight();
+	const size_t rowSize = (size_t)width * 2;
+	if (mCenterRows.size() < rowSize * height)
+	{
+		mCenterRows.resize(rowSize * height);
+		mOuterRows.resize(rowSize * height);
+	}
+
+	// Horizontal pass for all rows first, as the vertical pass needs the original content of the rows above and below
+	FTX::ParallelFor->execute(height, softwareblur::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int y = firstRow; y < endRow; ++y)
+		{
+			softwareblur::horizontalPass(bitmap.getPixelPointer(0, y), &mCenterRows[rowSize * y], &mOuterRows[rowSize * y], width, kernel);
+		}
+	});
+
+	FTX::ParallelFor->execute(height, softwareblur::MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
+	{
+		for (int y = firstRow; y < endRow; ++y)
+		{
+			const uint32* above = &mOuterRows[rowSize * std::max(y - 1, 0)];
+			const uint32* below = &mOuterRows[rowSize * std::min(y + 1, height - 1)];
+			softwareblur::verticalPass(bitmap.getPixelPointer(0, y), &mCenterRows[rowSize * y], above, below, width);
+		}
+	});
+}
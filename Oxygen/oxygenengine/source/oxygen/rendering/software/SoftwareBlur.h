@@ -0,0 +1,25 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <rmxbase.h>
+
+
+// Background blur for the software renderer, with the same result as the "postfx_blur" shader of the hardware renderer
+//  - The shader's 3x3 kernel gets split into a horizontal pass, and a vertical pass combining three rows of its output
+//  - All in integer math, using SSE2 where available, and with rows processed in parallel
+class SoftwareBlur
+{
+public:
+	void blurBitmap(Bitmap& bitmap, int blurValue);
+
+private:
+	std::vector<uint32> mCenterRows;	// Output of the horizontal pass, using the weights of the kernel's center row
+	std::vector<uint32> mOuterRows;		// Same, but using the weights of the kernel's upper and lower rows
+};
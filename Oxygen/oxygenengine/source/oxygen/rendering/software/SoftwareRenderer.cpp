@@ -138,6 +138,12 @@ void SoftwareRenderer::clearGameScreen()
 }
 
 void SoftwareRenderer::renderGameScreen(const std::vector<Geometry*>& geometries)
+{
+	renderGameScreenToBitmap(geometries);
+	mGameScreenTexture.bitmapUpdated();
+}
+
+void SoftwareRenderer::renderGameScreenToBitmap(const std::vector<Geometry*>& geometries)
 {
 	Bitmap& gameScreenBitmap = mGameScreenTexture.accessBitmap();
 
@@ -197,8 +203,6 @@ void SoftwareRenderer::renderGameScreen(const std::vector<Geometry*>& geometries
 			*ptr |= 0xff000000ff000000ull;
 		}
 	}
-
-	mGameScreenTexture.bitmapUpdated();
 }
 
 void SoftwareRenderer::renderDebugDraw(int debugDrawMode, const Recti& rect)
@@ -325,34 +329,7 @@ void SoftwareRenderer::renderGeometry(const Geometry& geometry)
 		case Geometry::Type::EFFECT_BLUR:
 		{
 			const EffectBlurGeometry& ebg = static_cast<const EffectBlurGeometry&>(geometry);
-			Bitmap& gameScreenBitmap = mGameScreenTexture.accessBitmap();
-
-			// Blur x-direction
-			if (ebg.mBlurValue >= 1)
-			{
-				for (int y = 0; y < gameScreenBitmap.mHeight; ++y)
-				{
-					uint32* data = gameScreenBitmap.getPixelPointer(0, y);
-					for (int x = gameScreenBitmap.mWidth - 1; x >= 1; --x)
-					{
-						data[x] = (data[x] & 0xff000000) + (((data[x] & 0xfefefe) + (data[x-1] & 0xfefefe)) >> 1);
-					}
-				}
-			}
-
-			// Blur y-direction
-			if (ebg.mBlurValue >= 3)
-			{
-				const int stride = gameScreenBitmap.mWidth;
-				for (int y = 0; y < gameScreenBitmap.mHeight-1; ++y)
-				{
-					uint32* data = gameScreenBitmap.getPixelPointer(0, y);
-					for (int x = 0; x < gameScreenBitmap.mWidth; ++x)
-					{
-						data[x] = (data[x] & 0xff000000) + (((data[x] & 0xfefefe) + (data[x+stride] & 0xfefefe)) >> 1);
-					}
-				}
-			}
+			mSoftwareBlur.blurBitmap(mGameScreenTexture.accessBitmap(), ebg.mBlurValue);
 			break;
 		}
 
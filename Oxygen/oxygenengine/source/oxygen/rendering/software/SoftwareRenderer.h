@@ -9,6 +9,7 @@
 #pragma once
 
 #include "oxygen/rendering/Renderer.h"
+#include "oxygen/rendering/software/SoftwareBlur.h"
 
 class PlaneGeometry;
 class SpriteGeometry;
@@ -35,6 +36,9 @@ public:
 	virtual void renderGameScreen(const std::vector<Geometry*>& geometries) override;
 	virtual void renderDebugDraw(int debugDrawMode, const Recti& rect) override;
 
+	// Same as "renderGameScreen", but only writes the output texture's bitmap without updating the texture itself, so it can be used from a different thread
+	void renderGameScreenToBitmap(const std::vector<Geometry*>& geometries);
+
 private:
 	void renderGeometry(const Geometry& geometry);
 	void renderPlane(const PlaneGeometry& geometry);
@@ -43,6 +47,7 @@ private:
 private:
 	Vec2i mGameResolution;
 	Bitmap mGameScreenCopy;
+	SoftwareBlur mSoftwareBlur;
 
 	uint8 mDepthBuffer[0x20000] = { 0 };	// 512x256 pixels
 	bool mEmptyDepthBuffer = true;			// Stays true until first non-zero depth value was written
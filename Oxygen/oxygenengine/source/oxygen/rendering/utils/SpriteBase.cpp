@@ -8,10 +8,149 @@
 
 #include "oxygen/pch.h"
 #include "oxygen/rendering/utils/SpriteBase.h"
+#include "oxygen/rendering/utils/PaletteBitmap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define USE_SSE2_TINT_ADD
+#endif
 
 
 namespace spritebaseinternal
 {
+	// Sources of sprite pixels, so that palette sprites can be blitted without converting them to RGBA first
+	struct RGBASource
+	{
+		typedef uint32 Pixel;
+		const uint32* mData;
+		int mWidth;
+		int mHeight;
+
+		inline RGBASource(const Bitmap& bitmap) : mData(bitmap.mData), mWidth(bitmap.mWidth), mHeight(bitmap.mHeight) {}
+		FORCE_INLINE uint32 getColor(uint32 pixel) const  { return pixel; }
+	};
+
+	struct PaletteSource
+	{
+		typedef uint8 Pixel;
+		const uint8* mData;
+		int mWidth;
+		int mHeight;
+		const uint32* mPalette;
+
+		inline PaletteSource(const PaletteBitmap& bitmap, const uint32* palette) : mData(bitmap.getData()), mWidth(bitmap.getWidth()), mHeight(bitmap.getHeight()), mPalette(palette) {}
+		FORCE_INLINE uint32 getColor(uint8 pixel) const  { return mPalette[pixel]; }
+	};
+
+
+	// Tint and added color, plus a fixed-point representation for the common case of values in the displayable range
+	//  - Fixed-point values use 16-bit fractions, i.e. 0xffff equals 1.0
+	//  - Results stay within 1 of the float calculation for each color channel
+	struct TintAdd
+	{
+		Color mTintColor;
+		Color mAddedColor;
+		bool mUseFixedPoint = true;
+		uint16 mFixedTint[4];
+		uint16 mFixedAddPositive[4];
+		uint16 mFixedAddNegative[4];
+		uint16 mFixedAlpha;		// Replaces the pixel's alpha when alpha gets ignored
+
+		explicit TintAdd(const SpriteBase::BlitOptions& blitOptions) :
+			mTintColor((nullptr == blitOptions.mTintColor) ? Color::WHITE : *blitOptions.mTintColor),
+			mAddedColor((nullptr == blitOptions.mAddedColor) ? Color::TRANSPARENT : *blitOptions.mAddedColor)
+		{
+			for (size_t k = 0; k < 4; ++k)
+			{
+				mUseFixedPoint = mUseFixedPoint && (mTintColor[k] >= 0.0f && mTintColor[k] <= 1.0f);
+				mFixedTint[k] = (uint16)roundToInt(saturate(mTintColor[k]) * 65535.0f);
+				mFixedAddPositive[k] = 0;
+				mFixedAddNegative[k] = 0;
+			}
+			for (size_t k = 0; k < 3; ++k)
+			{
+				mUseFixedPoint = mUseFixedPoint && (mAddedColor[k] >= -1.0f && mAddedColor[k] <= 1.0f);
+				if (mAddedColor[k] >= 0.0f)
+					mFixedAddPositive[k] = (uint16)roundToInt(saturate(mAddedColor[k]) * 65535.0f);
+				else
+					mFixedAddNegative[k] = (uint16)roundToInt(saturate(-mAddedColor[k]) * 65535.0f);
+			}
+			mFixedAlpha = mFixedTint[3];
+		}
+	};
+
+	FORCE_INLINE uint32 mulHigh(uint32 a, uint32 b)
+	{
+		return (a * b) >> 16;
+	}
+
+	template<bool USE_ALPHA>
+	FORCE_INLINE uint32 applyTintAddFixed(uint32 pixel, uint32 dst, const TintAdd& tintAdd)
+	{
+		// Exactly the same calculation as in the SIMD version
+		const uint32 alpha = USE_ALPHA ? mulHigh((pixel >> 24) * 0x101, tintAdd.mFixedTint[3]) : tintAdd.mFixedAlpha;
+		uint32 result = 0xff000000;
+		for (int k = 0; k < 3; ++k)
+		{
+			const uint32 color = ((pixel >> (k * 8)) & 0xff) * 0x101;
+			const uint32 background = ((dst >> (k * 8)) & 0xff) * 0x101;
+			const uint32 value = (uint32)clamp((int)mulHigh(color, tintAdd.mFixedTint[k]) + tintAdd.mFixedAddPositive[k] - tintAdd.mFixedAddNegative[k], 0, 0xffff);
+			const uint32 blended = std::min<uint32>(mulHigh(value, alpha) + mulHigh(background, 0xffff - alpha) + 1, 0xffff);
+			result |= (mulHigh(blended, 0xff01) >> 8) << (k * 8);	// Division by 0x101, rounding down
+		}
+		return result;
+	}
+
+#ifdef USE_SSE2_TINT_ADD
+	struct TintAddSSE2
+	{
+		__m128i mTint;
+		__m128i mAddPositive;
+		__m128i mAddNegative;
+		__m128i mAlpha;
+
+		explicit TintAddSSE2(const TintAdd& tintAdd)
+		{
+			const uint16* t = tintAdd.mFixedTint;
+			const uint16* p = tintAdd.mFixedAddPositive;
+			const uint16* n = tintAdd.mFixedAddNegative;
+			mTint = _mm_setr_epi16(t[0], t[1], t[2], t[3], t[0], t[1], t[2], t[3]);
+			mAddPositive = _mm_setr_epi16(p[0], p[1], p[2], p[3], p[0], p[1], p[2], p[3]);
+			mAddNegative = _mm_setr_epi16(n[0], n[1], n[2], n[3], n[0], n[1], n[2], n[3]);
+			mAlpha = _mm_set1_epi16((short)tintAdd.mFixedAlpha);
+		}
+	};
+
+	template<bool USE_ALPHA>
+	FORCE_INLINE __m128i applyTintAddFixedSSE2(__m128i pixels, __m128i background, const TintAddSSE2& tintAdd)
+	{
+		// Four pixels at once, in two halves with 16 bits per color channel
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i one = _mm_set1_epi16(1);
+		const __m128i allBits = _mm_set1_epi16(-1);
+		const __m128i divisor = _mm_set1_epi16((short)0xff01);
+		__m128i result[2];
+		for (int half = 0; half < 2; ++half)
+		{
+			__m128i color = (half == 0) ? _mm_unpacklo_epi8(pixels, zero) : _mm_unpackhi_epi8(pixels, zero);
+			__m128i back = (half == 0) ? _mm_unpacklo_epi8(background, zero) : _mm_unpackhi_epi8(background, zero);
+			color = _mm_or_si128(color, _mm_slli_epi16(color, 8));
+			back = _mm_or_si128(back, _mm_slli_epi16(back, 8));
+
+			// Tint all channels including alpha, then spread the tinted alpha across each pixel's channels
+			__m128i value = _mm_mulhi_epu16(color, tintAdd.mTint);
+			const __m128i alpha = USE_ALPHA ? _mm_shufflehi_epi16(_mm_shufflelo_epi16(value, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)) : tintAdd.mAlpha;
+			value = _mm_subs_epu16(_mm_adds_epu16(value, tintAdd.mAddPositive), tintAdd.mAddNegative);
+
+			__m128i blended = _mm_adds_epu16(_mm_mulhi_epu16(value, alpha), _mm_mulhi_epu16(back, _mm_xor_si128(alpha, allBits)));
+			blended = _mm_adds_epu16(blended, one);
+			result[half] = _mm_srli_epi16(_mm_mulhi_epu16(blended, divisor), 8);
+		}
+		return _mm_or_si128(_mm_packus_epi16(result[0], result[1]), _mm_set1_epi32((int)0xff000000));
+	}
+#endif
+
+
 	uint32 FORCE_INLINE blendColors(uint32 src, uint32 dst)
 	{
 		const uint8* srcPtr = (uint8*)&src;
@@ -26,12 +165,14 @@ namespace spritebaseinternal
 	}
 
 
-	template<bool USE_ALPHA, bool DEPTH_TEST>
-	void blitLine_withTintAdd(uint32* dst, const uint32* src, int numPixels, const uint8* depthBuffer, uint8 depthValue, const Color& addedColor, const Color& tintColor)
+	template<typename SOURCE, bool USE_ALPHA, bool DEPTH_TEST>
+	void blitLine_withTintAddFloat(uint32* dst, const typename SOURCE::Pixel* src, const SOURCE& source, int numPixels, const uint8* depthBuffer, uint8 depthValue, const TintAdd& tintAdd)
 	{
+		const Color& tintColor = tintAdd.mTintColor;
+		const Color& addedColor = tintAdd.mAddedColor;
 		for (int i = 0; i < numPixels; ++i)
 		{
-			uint32 pixel = *src;
+			uint32 pixel = source.getColor(*src);
 			++src;
 
 			// Check for transparency
@@ -52,7 +193,6 @@ namespace spritebaseinternal
 
 					if (color.a < 1.0f)
 					{
-						// TODO: Use "blendColors" function from above, and integer arithmetic in general here
 						color = color.blendOver(Color::fromABGR32(*dst | 0xff000000));
 						color.a = 1.0f;
 					}
@@ -65,12 +205,72 @@ namespace spritebaseinternal
 		}
 	}
 
-	template<bool USE_ALPHA, bool DEPTH_TEST>
-	void blitLine_noTintAdd(uint32* dst, const uint32* src, int numPixels, const uint8* depthBuffer, uint8 depthValue)
+	template<typename SOURCE, bool USE_ALPHA, bool DEPTH_TEST>
+	void blitLine_withTintAddFixed(uint32* dst, const typename SOURCE::Pixel* src, const SOURCE& source, int numPixels, const uint8* depthBuffer, uint8 depthValue, const TintAdd& tintAdd)
+	{
+		int i = 0;
+	#ifdef USE_SSE2_TINT_ADD
+		const TintAddSSE2 tintAddSSE2(tintAdd);
+		const __m128i depthValues = _mm_set1_epi8((char)depthValue);
+		for (; i + 4 <= numPixels; i += 4)
+		{
+			const __m128i pixels = _mm_setr_epi32((int)source.getColor(src[i]), (int)source.getColor(src[i+1]), (int)source.getColor(src[i+2]), (int)source.getColor(src[i+3]));
+
+			// Build mask of pixels passing the transparency check and depth test
+			__m128i mask = _mm_set1_epi32(-1);
+			if (USE_ALPHA)
+			{
+				mask = _mm_xor_si128(mask, _mm_cmpeq_epi32(_mm_and_si128(pixels, _mm_set1_epi32((int)0xff000000)), _mm_setzero_si128()));
+			}
+			if (DEPTH_TEST)
+			{
+				int32 depths;
+				memcpy(&depths, &depthBuffer[i], 4);
+				__m128i passed = _mm_cvtsi32_si128(depths);
+				passed = _mm_cmpeq_epi8(_mm_max_epu8(passed, depthValues), depthValues);
+				passed = _mm_unpacklo_epi8(passed, passed);
+				mask = _mm_and_si128(mask, _mm_unpacklo_epi16(passed, passed));
+			}
+			if (_mm_movemask_epi8(mask) == 0)
+				continue;
+
+			const __m128i background = _mm_loadu_si128((const __m128i*)&dst[i]);
+			const __m128i result = applyTintAddFixedSSE2<USE_ALPHA>(pixels, background, tintAddSSE2);
+			_mm_storeu_si128((__m128i*)&dst[i], _mm_or_si128(_mm_and_si128(mask, result), _mm_andnot_si128(mask, background)));
+		}
+	#endif
+
+		for (; i < numPixels; ++i)
+		{
+			const uint32 pixel = source.getColor(src[i]);
+
+			// Check for transparency and depth test
+			if ((!USE_ALPHA || (pixel & 0xff000000) != 0) && (!DEPTH_TEST || depthValue >= depthBuffer[i]))
+			{
+				dst[i] = applyTintAddFixed<USE_ALPHA>(pixel, dst[i], tintAdd);
+			}
+		}
+	}
+
+	template<typename SOURCE, bool USE_ALPHA, bool DEPTH_TEST>
+	void blitLine_withTintAdd(uint32* dst, const typename SOURCE::Pixel* src, const SOURCE& source, int numPixels, const uint8* depthBuffer, uint8 depthValue, const TintAdd& tintAdd)
+	{
+		if (tintAdd.mUseFixedPoint)
+		{
+			blitLine_withTintAddFixed<SOURCE, USE_ALPHA, DEPTH_TEST>(dst, src, source, numPixels, depthBuffer, depthValue, tintAdd);
+		}
+		else
+		{
+			blitLine_withTintAddFloat<SOURCE, USE_ALPHA, DEPTH_TEST>(dst, src, source, numPixels, depthBuffer, depthValue, tintAdd);
+		}
+	}
+
+	template<typename SOURCE, bool USE_ALPHA, bool DEPTH_TEST>
+	void blitLine_noTintAdd(uint32* dst, const typename SOURCE::Pixel* src, const SOURCE& source, int numPixels, const uint8* depthBuffer, uint8 depthValue)
 	{
 		for (int i = 0; i < numPixels; ++i)
 		{
-			uint32 pixel = *src;
+			uint32 pixel = source.getColor(*src);
 			++src;
 
 			// Check for transparency
@@ -92,28 +292,36 @@ namespace spritebaseinternal
 		}
 	}
 
-	void blitLine_simple(uint32* dst, const uint32* src, int numPixels)
+	void blitLine_simple(uint32* dst, const uint32* src, const RGBASource& source, int numPixels)
 	{
 		memcpy(dst, src, numPixels * sizeof(uint32));
 	}
 
-	void blitSpriteNoTransform(Bitmap& destBitmap, const Vec2i& destPosition, const Bitmap& sourceBitmap, const Vec2i& offset, const SpriteBase::BlitOptions& blitOptions)
+	void blitLine_simple(uint32* dst, const uint8* src, const PaletteSource& source, int numPixels)
+	{
+		for (int i = 0; i < numPixels; ++i)
+		{
+			dst[i] = source.mPalette[src[i]];
+		}
+	}
+
+	template<typename SOURCE>
+	void blitSpriteNoTransform(Bitmap& destBitmap, const Vec2i& destPosition, const SOURCE& source, const Vec2i& offset, const SpriteBase::BlitOptions& blitOptions)
 	{
 		const bool useTintAdd = (nullptr != blitOptions.mTintColor || nullptr != blitOptions.mAddedColor);
-		const Color tintColor = (nullptr == blitOptions.mTintColor) ? Color::WHITE : *blitOptions.mTintColor;
-		const Color addedColor = (nullptr == blitOptions.mAddedColor) ? Color::TRANSPARENT : *blitOptions.mAddedColor;
+		const TintAdd tintAdd(blitOptions);
 
 		const int px = destPosition.x + offset.x;
 		const int py = destPosition.y + offset.y;
 
-		Recti bbox(px, py, sourceBitmap.mWidth, sourceBitmap.mHeight);
+		Recti bbox(px, py, source.mWidth, source.mHeight);
 		bbox.intersect(Recti(0, 0, destBitmap.mWidth, destBitmap.mHeight));
 		if (nullptr != blitOptions.mTargetRect)
 		{
 			bbox.intersect(*blitOptions.mTargetRect);
-			if (bbox.empty())
-				return;
 		}
+		if (bbox.empty())
+			return;
 
 		const int minX = bbox.x;
 		const int minY = bbox.y;
@@ -122,7 +330,7 @@ namespace spritebaseinternal
 		for (int iy = minY; iy < maxY; ++iy)
 		{
 			uint32* dst = &destBitmap.mData[minX + iy * destBitmap.mWidth];
-			const uint32* src = &sourceBitmap.mData[(minX - px) + (iy - py) * sourceBitmap.mWidth];
+			const typename SOURCE::Pixel* src = &source.mData[(minX - px) + (iy - py) * source.mWidth];
 
 			if (!useTintAdd)
 			{
@@ -130,22 +338,22 @@ namespace spritebaseinternal
 				{
 					if (nullptr == blitOptions.mDepthBuffer)
 					{
-						blitLine_simple(dst, src, bbox.width);
+						blitLine_simple(dst, src, source, bbox.width);
 					}
 					else
 					{
-						blitLine_noTintAdd<false, true>(dst, src, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue);
+						blitLine_noTintAdd<SOURCE, false, true>(dst, src, source, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue);
 					}
 				}
 				else
 				{
 					if (nullptr == blitOptions.mDepthBuffer)
 					{
-						blitLine_noTintAdd<true, false>(dst, src, bbox.width, nullptr, 0);
+						blitLine_noTintAdd<SOURCE, true, false>(dst, src, source, bbox.width, nullptr, 0);
 					}
 					else
 					{
-						blitLine_noTintAdd<true, true>(dst, src, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue);
+						blitLine_noTintAdd<SOURCE, true, true>(dst, src, source, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue);
 					}
 				}
 			}
@@ -155,39 +363,39 @@ namespace spritebaseinternal
 				{
 					if (nullptr == blitOptions.mDepthBuffer)
 					{
-						blitLine_withTintAdd<false, false>(dst, src, bbox.width, nullptr, 0, addedColor, tintColor);
+						blitLine_withTintAdd<SOURCE, false, false>(dst, src, source, bbox.width, nullptr, 0, tintAdd);
 					}
 					else
 					{
-						blitLine_withTintAdd<false, true>(dst, src, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue, addedColor, tintColor);
+						blitLine_withTintAdd<SOURCE, false, true>(dst, src, source, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue, tintAdd);
 					}
 				}
 				else
 				{
 					if (nullptr == blitOptions.mDepthBuffer)
 					{
-						blitLine_withTintAdd<true, false>(dst, src, bbox.width, nullptr, 0, addedColor, tintColor);
+						blitLine_withTintAdd<SOURCE, true, false>(dst, src, source, bbox.width, nullptr, 0, tintAdd);
 					}
 					else
 					{
-						blitLine_withTintAdd<true, true>(dst, src, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue, addedColor, tintColor);
+						blitLine_withTintAdd<SOURCE, true, true>(dst, src, source, bbox.width, &blitOptions.mDepthBuffer[minX + iy * 0x200], blitOptions.mDepthValue, tintAdd);
 					}
 				}
 			}
 		}
 	}
 
-	void blitSpriteWithTransform(Bitmap& destBitmap, const Vec2i& destPosition, const Bitmap& sourceBitmap, const Vec2i& offset, const SpriteBase::BlitOptions& blitOptions)
+	template<typename SOURCE>
+	void blitSpriteWithTransform(Bitmap& destBitmap, const Vec2i& destPosition, const SOURCE& source, const Vec2i& offset, const SpriteBase::BlitOptions& blitOptions)
 	{
 		const bool useTintAdd = (nullptr != blitOptions.mTintColor || nullptr != blitOptions.mAddedColor);
-		const Color tintColor = (nullptr == blitOptions.mTintColor) ? Color::WHITE : *blitOptions.mTintColor;
-		const Color addedColor = (nullptr == blitOptions.mAddedColor) ? Color::TRANSPARENT : *blitOptions.mAddedColor;
+		const TintAdd tintAdd(blitOptions);
 
 		Recti bbox;
 		{
 			Vec2f min(1e10f, 1e10f);
 			Vec2f max(-1e10f, -1e10f);
-			const Vec2i corners[4] = { Vec2i(0, 0), Vec2i(sourceBitmap.mWidth - 1, 0), Vec2i(0, sourceBitmap.mHeight - 1), Vec2i(sourceBitmap.mWidth - 1, sourceBitmap.mHeight - 1) };
+			const Vec2i corners[4] = { Vec2i(0, 0), Vec2i(source.mWidth - 1, 0), Vec2i(0, source.mHeight - 1), Vec2i(source.mWidth - 1, source.mHeight - 1) };
 			for (int i = 0; i < 4; ++i)
 			{
 				const Vec2f localCorner((float)(corners[i].x + offset.x + 0.5f), (float)(corners[i].y + offset.y + 0.5f));
@@ -208,9 +416,9 @@ namespace spritebaseinternal
 		if (nullptr != blitOptions.mTargetRect)
 		{
 			bbox.intersect(*blitOptions.mTargetRect);
-			if (bbox.empty())
-				return;
 		}
+		if (bbox.empty())
+			return;
 
 		const int minX = bbox.x;
 		const int maxX = bbox.x + bbox.width;
@@ -221,20 +429,24 @@ namespace spritebaseinternal
 		{
 			uint32* dst = &destBitmap.mData[minX + iy * destBitmap.mWidth];
 
+			// The line's part of the transformation only needs to be calculated once
+			//  -> Apart from that, this is the same float calculation for each pixel, as any other rounding would pick different texels near their borders
+			const float dy = (float)(iy - destPosition.y) + 0.5f;
+			const float lineX = dy * blitOptions.mInvTransform[1];
+			const float lineY = dy * blitOptions.mInvTransform[3];
+
 			for (int ix = minX; ix < maxX; ++ix)
 			{
 				uint32 pixel = 0;
 				{
 					// Transform into palette sprite coordinates
 					const float dx = (float)(ix - destPosition.x) + 0.5f;
-					const float dy = (float)(iy - destPosition.y) + 0.5f;
-					const int localX = roundToInt(dx * blitOptions.mInvTransform[0] + dy * blitOptions.mInvTransform[1] - 0.5f) - offset.x;
-					const int localY = roundToInt(dx * blitOptions.mInvTransform[2] + dy * blitOptions.mInvTransform[3] - 0.5f) - offset.y;
+					const int localX = roundToInt(dx * blitOptions.mInvTransform[0] + lineX - 0.5f) - offset.x;
+					const int localY = roundToInt(dx * blitOptions.mInvTransform[2] + lineY - 0.5f) - offset.y;
 
-					if (localX >= 0 && localX < (int)sourceBitmap.mWidth &&
-						localY >= 0 && localY < (int)sourceBitmap.mHeight)
+					if ((uint32)localX < (uint32)source.mWidth && (uint32)localY < (uint32)source.mHeight)
 					{
-						pixel = sourceBitmap.mData[localX + localY * sourceBitmap.mWidth];
+						pixel = source.getColor(source.mData[localX + localY * source.mWidth]);
 					}
 				}
 
@@ -252,18 +464,21 @@ namespace spritebaseinternal
 								pixel = blendColors(pixel , *dst);
 							}
 						}
+						else if (tintAdd.mUseFixedPoint)
+						{
+							pixel = applyTintAddFixed<true>(pixel, *dst, tintAdd);
+						}
 						else
 						{
 							// Tint color and alpha transparency
 							Color color = Color::fromABGR32(pixel);
-							color.r = saturate(addedColor.r + color.r * tintColor.r);
-							color.g = saturate(addedColor.g + color.g * tintColor.g);
-							color.b = saturate(addedColor.b + color.b * tintColor.b);
-							color.a = saturate(color.a * tintColor.a);
+							color.r = saturate(tintAdd.mAddedColor.r + color.r * tintAdd.mTintColor.r);
+							color.g = saturate(tintAdd.mAddedColor.g + color.g * tintAdd.mTintColor.g);
+							color.b = saturate(tintAdd.mAddedColor.b + color.b * tintAdd.mTintColor.b);
+							color.a = saturate(color.a * tintAdd.mTintColor.a);
 
 							if (color.a < 1.0f)
 							{
-								// TODO: Use "blendColors" function from above, and integer arithmetic in general here
 								color = color.blendOver(Color::fromABGR32(*dst | 0xff000000));
 								color.a = 1.0f;
 							}
@@ -282,12 +497,27 @@ namespace spritebaseinternal
 
 void SpriteBase::blitInto(Bitmap& output, const Bitmap& input, const Vec2i& position, const BlitOptions& blitOptions) const
 {
+	const spritebaseinternal::RGBASource source(input);
+	if (nullptr == blitOptions.mTransform)
+	{
+		spritebaseinternal::blitSpriteNoTransform(output, position, source, mOffset, blitOptions);
+	}
+	else
+	{
+		spritebaseinternal::blitSpriteWithTransform(output, position, source, mOffset, blitOptions);
+	}
+}
+
+void SpriteBase::blitInto(Bitmap& output, const PaletteBitmap& input, const uint32* palette, const Vec2i& position, const BlitOptions& blitOptions) const
+{
+	// Palette indices get resolved only for the pixels actually drawn
+	const spritebaseinternal::PaletteSource source(input, palette);
 	if (nullptr == blitOptions.mTransform)
 	{
-		spritebaseinternal::blitSpriteNoTransform(output, position, input, mOffset, blitOptions);
+		spritebaseinternal::blitSpriteNoTransform(output, position, source, mOffset, blitOptions);
 	}
 	else
 	{
-		spritebaseinternal::blitSpriteWithTransform(output, position, input, mOffset, blitOptions);
+		spritebaseinternal::blitSpriteWithTransform(output, position, source, mOffset, blitOptions);
 	}
 }
@@ -10,6 +10,8 @@
 
 #include <rmxbase.h>
 
+class PaletteBitmap;
+
 
 class SpriteBase
 {
@@ -29,6 +31,7 @@ public:
 
 public:
 	void blitInto(Bitmap& output, const Bitmap& input, const Vec2i& position, const BlitOptions& blitOptions) const;
+	void blitInto(Bitmap& output, const PaletteBitmap& input, const uint32* palette, const Vec2i& position, const BlitOptions& blitOptions) const;
 
 public:
 	Vec2i mOffset;		// Offset of upper left corner relative to pivot
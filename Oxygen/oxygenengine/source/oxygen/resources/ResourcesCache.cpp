@@ -9,6 +9,7 @@
 #include "oxygen/pch.h"
 #include "oxygen/resources/ResourcesCache.h"
 #include "oxygen/application/Configuration.h"
+#include "oxygen/application/EngineMain.h"
 #include "oxygen/application/GameProfile.h"
 #include "oxygen/application/modding/ModManager.h"
 #include "oxygen/base/PlatformFunctions.h"
@@ -18,6 +19,13 @@
 #include "oxygen/helper/PackageFileCrawler.h"
 
 
+namespace
+{
+	const char* FORMAT_IDENTIFIER = "OXY.RESCACHE";
+	const uint16 FORMAT_VERSION = 0x0100;		// First version
+}
+
+
 bool ResourcesCache::loadRom()
 {
 	mRom.clear();
@@ -121,36 +129,75 @@ bool ResourcesCache::loadRomFromMemory(const std::vector<uint8>& content)
 
 void ResourcesCache::loadAllResources()
 {
-	// Load raw data incl. ROM injections
-	mRawDataMap.clear();
-	mRomInjections.clear();
-	mRawDataPool.clear();
-	loadRawData(L"data/rawdata", false);
-	for (const Mod* mod : ModManager::instance().getActiveMods())
+	clearLoadedResources();
+
+	// Collect the directories to load from, in load order, so that mods can override the base data
+	const std::vector<Mod*>& activeMods = ModManager::instance().getActiveMods();
+	mSources.clear();
+	mSources.push_back({ L"data/rawdata", false, false });
+	for (const Mod* mod : activeMods)
 	{
-		loadRawData(mod->mFullPath + L"rawdata", true);
+		mSources.push_back({ mod->mFullPath + L"rawdata", false, true, mod->mContainerKey });
+	}
+	mSources.push_back({ L"data/palettes", true, false });
+	for (const Mod* mod : activeMods)
+	{
+		mSources.push_back({ mod->mFullPath + L"palettes", true, true, mod->mContainerKey });
 	}
 
-	// Load palettes
-	mPalettes.clear();
-	loadRawData(L"data/palettes", false);
-	for (const Mod* mod : ModManager::instance().getActiveMods())
+	// Use the snapshot if none of the source files changed since it got written
+	mSnapshotFilename = Configuration::instance().mAppDataPath.empty() ? std::wstring() : (Configuration::instance().mAppDataPath + L"resourcecache.bin");
+	const uint64 sourcesHash = getSourcesHash();
+	if (loadSnapshot(sourcesHash))
+		return;
+
+	// Load raw data incl. ROM injections, and palettes
+	std::map<uint64, std::vector<const RawData*>> rawDataMap;
+	std::map<uint64, Palette> paletteMap;
+	for (const ResourceSource& source : mSources)
 	{
-		loadPalettes(mod->mFullPath + L"palettes", true);
+		if (source.mIsPalettes)
+		{
+			loadPalettes(source.mPath, source.mIsModded, paletteMap);
+		}
+		else
+		{
+			loadRawData(source.mPath, source.mIsModded, rawDataMap);
+		}
+	}
+
+	// Build the sorted arrays used for lookup
+	mRawDataEntries.reserve(rawDataMap.size());
+	for (auto& pair : rawDataMap)
+	{
+		RawDataEntry& entry = vectorAdd(mRawDataEntries);
+		entry.mKey = pair.first;
+		entry.mRawData.swap(pair.second);
+	}
+	mPalettes.reserve(paletteMap.size());
+	for (auto& pair : paletteMap)
+	{
+		mPalettes.emplace_back(pair.first, std::move(pair.second));
+	}
+
+	if (mRawDataCacheable)
+	{
+		saveSnapshot(sourcesHash);
 	}
 }
 
 const std::vector<const ResourcesCache::RawData*>& ResourcesCache::getRawData(uint64 key) const
 {
 	static const std::vector<const RawData*> EMPTY;
-	const auto it = mRawDataMap.find(key);
-	return (it == mRawDataMap.end()) ? EMPTY : it->second;
+	const auto it = std::lower_bound(mRawDataEntries.begin(), mRawDataEntries.end(), key, [](const RawDataEntry& entry, uint64 key) { return entry.mKey < key; });
+	return (it == mRawDataEntries.end() || it->mKey != key) ? EMPTY : it->mRawData;
 }
 
 const ResourcesCache::Palette* ResourcesCache::getPalette(uint64 key, uint8 line) const
 {
-	const auto it = mPalettes.find(key + line);
-	return (it == mPalettes.end()) ? nullptr : &it->second;
+	key += line;
+	const auto it = std::lower_bound(mPalettes.begin(), mPalettes.end(), key, [](const std::pair<uint64, Palette>& pair, uint64 key) { return pair.first < key; });
+	return (it == mPalettes.end() || it->first != key) ? nullptr : &it->second;
 }
 
 Font* ResourcesCache::getFontByKey(const std::string& keyString, uint64 keyHash)
@@ -187,8 +234,8 @@ void ResourcesCache::applyRomInjections(uint8* rom, uint32 romSize) const
 	for (const RawData* rawData : mRomInjections)
 	{
 		RMX_CHECK(rawData->mRomInjectAddress < romSize, "ROM injection at invalid address " << rmx::hexString(rawData->mRomInjectAddress, 6), continue);
-		const uint32 size = std::min((uint32)rawData->mContent.size(), romSize - rawData->mRomInjectAddress);
-		memcpy(&rom[rawData->mRomInjectAddress], &rawData->mContent[0], size);
+		const uint32 size = std::min(rawData->mSize, romSize - rawData->mRomInjectAddress);
+		memcpy(&rom[rawData->mRomInjectAddress], rawData->mData, size);
 	}
 }
 
@@ -244,7 +291,7 @@ void ResourcesCache::saveRomToAppData()
 	}
 }
 
-void ResourcesCache::loadRawData(const std::wstring& path, bool isModded)
+void ResourcesCache::loadRawData(const std::wstring& path, bool isModded, std::map<uint64, std::vector<const RawData*>>& rawDataMap)
 {
 	// Load raw data from the given path
 	PackageFileCrawler fc;
@@ -263,16 +310,25 @@ void ResourcesCache::loadRawData(const std::wstring& path, bool isModded)
 			RawData* rawData = nullptr;
 			if (entryJson["File"].isString())
 			{
-				const char* filename = entryJson["File"].asCString();
+				const std::wstring filename = String(entryJson["File"].asCString()).toStdWString();
 				const uint64 key = rmx::getMurmur2_64(String(it.key().asCString()));
 				rawData = &mRawDataPool.createObject();
 				rawData->mIsModded = isModded;
-				if (!FTX::FileSystem->readFile(entry.mPath + String(filename).toStdWString(), rawData->mContent))
+				if (!FTX::FileSystem->readFile(entry.mPath + filename, rawData->mContent))
 				{
 					mRawDataPool.destroyObject(*rawData);
 					continue;
 				}
-				mRawDataMap[key].push_back(rawData);
+				rawData->mData = rawData->mContent.data();
+				rawData->mSize = (uint32)rawData->mContent.size();
+				rawDataMap[key].push_back(rawData);
+				mRawDataList.push_back(rawData);
+
+				// Changes of files outside the source directory would go unnoticed by the snapshot
+				if (filename.find(L"..") != std::wstring::npos)
+				{
+					mRawDataCacheable = false;
+				}
 			}
 
 			if (nullptr == rawData)
@@ -288,7 +344,7 @@ void ResourcesCache::loadRawData(const std::wstring& path, bool isModded)
 	}
 }
 
-void ResourcesCache::loadPalettes(const std::wstring& path, bool isModded)
+void ResourcesCache::loadPalettes(const std::wstring& path, bool isModded, std::map<uint64, Palette>& paletteMap)
 {
 	// Load palettes from the given path
 	PackageFileCrawler fc;
@@ -319,7 +375,7 @@ void ResourcesCache::loadPalettes(const std::wstring& path, bool isModded)
 
 		for (int y = 0; y < numLines; ++y)
 		{
-			Palette& palette = mPalettes[key];
+			Palette& palette = paletteMap[key];
 			palette.mIsModded = isModded;
 			palette.mColors.resize(numColorsPerLine);
 
@@ -331,3 +387,226 @@ void ResourcesCache::loadPalettes(const std::wstring& path, bool isModded)
 		}
 	}
 }
+
+void ResourcesCache::clearLoadedResources()
+{
+	mRawDataEntries.clear();
+	mRawDataList.clear();
+	mRomInjections.clear();
+	mRawDataPool.clear();
+	mRawDataCacheable = true;
+	mPalettes.clear();
+
+	// Raw data might still point into the snapshot, so this needs to come last
+	mSnapshotFile.close();
+	mSnapshotContent.clear();
+}
+
+uint64 ResourcesCache::getSourcesHash() const
+{
+	// Hash the names, times and sizes of all files inside the source directories
+	//  -> The build version is included as well, as packaged files don't have file times
+	//  -> Same goes for files inside zipped mods, so the zip file's own time and size are included via the container key
+	std::vector<uint8> buffer;
+	VectorBinarySerializer serializer(false, buffer);
+	serializer.write(EngineMain::getDelegate().getAppMetaData().mBuildVersion);
+
+	std::vector<rmx::FileIO::FileEntry> fileEntries;
+	for (const ResourceSource& source : mSources)
+	{
+		serializer.write(source.mPath);
+		serializer.write(source.mIsPalettes);
+		serializer.write(source.mIsModded);
+		serializer.write(source.mContainerKey);
+
+		fileEntries.clear();
+		FTX::FileSystem->listFilesByMask(source.mPath + L"/*", true, fileEntries);
+		std::sort(fileEntries.begin(), fileEntries.end(), [](const rmx::FileIO::FileEntry& a, const rmx::FileIO::FileEntry& b) { return (a.mPath != b.mPath) ? (a.mPath < b.mPath) : (a.mFilename < b.mFilename); });
+
+		serializer.writeAs<uint32>(fileEntries.size());
+		for (const rmx::FileIO::FileEntry& fileEntry : fileEntries)
+		{
+			serializer.write(fileEntry.mPath);
+			serializer.write(fileEntry.mFilename);
+			serializer.writeAs<uint64>(fileEntry.mTime);
+			serializer.writeAs<uint64>(fileEntry.mSize);
+		}
+	}
+	return rmx::getMurmur2_64(buffer.data(), buffer.size());
+}
+
+bool ResourcesCache::loadSnapshot(uint64 sourcesHash)
+{
+	if (mSnapshotFilename.empty())
+		return false;
+
+	// Memory map the snapshot if possible, raw data can then point right into it
+	const uint8* data = nullptr;
+	size_t size = 0;
+	if (mSnapshotFile.open(mSnapshotFilename))
+	{
+		data = mSnapshotFile.getData();
+		size = mSnapshotFile.getSize();
+	}
+	else if (FTX::FileSystem->readFile(mSnapshotFilename, mSnapshotContent))
+	{
+		data = mSnapshotContent.data();
+		size = mSnapshotContent.size();
+	}
+	else
+	{
+		return false;
+	}
+
+	VectorBinarySerializer serializer(true, data, size);
+	if (!serializeSnapshot(serializer, sourcesHash))
+	{
+		// Ignore an outdated or broken snapshot, it will simply get rebuilt
+		clearLoadedResources();
+		return false;
+	}
+	return true;
+}
+
+void ResourcesCache::saveSnapshot(uint64 sourcesHash)
+{
+	if (mSnapshotFilename.empty())
+		return;
+
+	std::vector<uint8> content;
+	VectorBinarySerializer serializer(false, content);
+	if (!serializeSnapshot(serializer, sourcesHash))
+		return;
+
+	FTX::FileSystem->saveFile(mSnapshotFilename, content);
+}
+
+bool ResourcesCache::serializeSnapshot(VectorBinarySerializer& serializer, uint64 sourcesHash)
+{
+	// Identifier
+	if (serializer.isReading())
+	{
+		char identifier[13];
+		serializer.read(identifier, 12);
+		if (memcmp(identifier, FORMAT_IDENTIFIER, 12) != 0)
+			return false;
+	}
+	else
+	{
+		serializer.write(FORMAT_IDENTIFIER, 12);
+	}
+
+	// Format version
+	uint16 formatVersion = FORMAT_VERSION;
+	serializer& formatVersion;
+	if (serializer.isReading() && formatVersion != FORMAT_VERSION)
+		return false;
+
+	// The snapshot is only valid for exactly the same source files
+	uint64 hash = sourcesHash;
+	serializer& hash;
+	if (serializer.isReading() && hash != sourcesHash)
+		return false;
+
+	if (serializer.isReading())
+	{
+		// Raw data, in load order
+		const size_t numRawData = (size_t)serializer.read<uint32>();
+		for (size_t i = 0; i < numRawData && !serializer.hasError(); ++i)
+		{
+			RawData& rawData = mRawDataPool.createObject();
+			serializer.serialize(rawData.mRomInjectAddress);
+			serializer.serialize(rawData.mIsModded);
+			serializer.serialize(rawData.mSize);
+			if (serializer.getRemaining() < (size_t)rawData.mSize)
+			{
+				serializer.setError();
+				break;
+			}
+			rawData.mData = serializer.peek();
+			serializer.skip(rawData.mSize);
+
+			mRawDataList.push_back(&rawData);
+			if (rawData.mRomInjectAddress != 0xffffffff)
+			{
+				mRomInjections.push_back(&rawData);
+			}
+		}
+
+		// Raw data lookup, sorted by key
+		const size_t numEntries = (size_t)serializer.read<uint32>();
+		mRawDataEntries.reserve(std::min(numEntries, serializer.getRemaining() / 12));
+		for (size_t i = 0; i < numEntries && !serializer.hasError(); ++i)
+		{
+			RawDataEntry& entry = vectorAdd(mRawDataEntries);
+			serializer.serialize(entry.mKey);
+			const size_t count = (size_t)serializer.read<uint32>();
+			for (size_t k = 0; k < count && !serializer.hasError(); ++k)
+			{
+				const size_t index = (size_t)serializer.read<uint32>();
+				if (index >= mRawDataList.size())
+				{
+					serializer.setError();
+					break;
+				}
+				entry.mRawData.push_back(mRawDataList[index]);
+			}
+		}
+
+		// Palettes, sorted by key
+		const size_t numPalettes = (size_t)serializer.read<uint32>();
+		mPalettes.reserve(std::min(numPalettes, serializer.getRemaining() / 10));
+		for (size_t i = 0; i < numPalettes && !serializer.hasError(); ++i)
+		{
+			auto& pair = vectorAdd(mPalettes);
+			serializer.serialize(pair.first);
+			serializer.serialize(pair.second.mIsModded);
+			const uint8 numColors = serializer.read<uint8>();
+			pair.second.mColors.resize(numColors);
+			for (Color& color : pair.second.mColors)
+			{
+				color = Color::fromABGR32(serializer.read<uint32>());
+			}
+		}
+	}
+	else
+	{
+		// Raw data, in load order
+		std::unordered_map<const RawData*, uint32> rawDataIndices;
+		serializer.writeAs<uint32>(mRawDataList.size());
+		for (const RawData* rawData : mRawDataList)
+		{
+			rawDataIndices[rawData] = (uint32)rawDataIndices.size();
+			serializer.write(rawData->mRomInjectAddress);
+			serializer.write(rawData->mIsModded);
+			serializer.write(rawData->mSize);
+			serializer.write(rawData->mData, rawData->mSize);
+		}
+
+		// Raw data lookup, sorted by key
+		serializer.writeAs<uint32>(mRawDataEntries.size());
+		for (const RawDataEntry& entry : mRawDataEntries)
+		{
+			serializer.write(entry.mKey);
+			serializer.writeAs<uint32>(entry.mRawData.size());
+			for (const RawData* rawData : entry.mRawData)
+			{
+				serializer.write(rawDataIndices[rawData]);
+			}
+		}
+
+		// Palettes, sorted by key
+		serializer.writeAs<uint32>(mPalettes.size());
+		for (const auto& pair : mPalettes)
+		{
+			serializer.write(pair.first);
+			serializer.write(pair.second.mIsModded);
+			serializer.writeAs<uint8>(pair.second.mColors.size());
+			for (const Color& color : pair.second.mColors)
+			{
+				serializer.write(color.getABGR32());
+			}
+		}
+	}
+	return !serializer.hasError();
+}
@@ -14,7 +14,9 @@ class ResourcesCache : public SingleInstance<ResourcesCache>
 public:
 	struct RawData
 	{
-		std::vector<uint8> mContent;
+		const uint8* mData = nullptr;	// Points either into "mContent", or into the loaded snapshot
+		uint32 mSize = 0;
+		std::vector<uint8> mContent;	// Stays empty if loaded from the snapshot
 		uint32 mRomInjectAddress = 0xffffffff;
 		bool mIsModded = false;
 	};
@@ -53,17 +55,46 @@ private:
 	bool checkRomContent();
 	void saveRomToAppData();
 
-	void loadRawData(const std::wstring& path, bool isModded);
-	void loadPalettes(const std::wstring& path, bool isModded);
+	void loadRawData(const std::wstring& path, bool isModded, std::map<uint64, std::vector<const RawData*>>& rawDataMap);
+	void loadPalettes(const std::wstring& path, bool isModded, std::map<uint64, Palette>& paletteMap);
+
+	void clearLoadedResources();
+	uint64 getSourcesHash() const;
+	bool loadSnapshot(uint64 sourcesHash);
+	void saveSnapshot(uint64 sourcesHash);
+	bool serializeSnapshot(VectorBinarySerializer& serializer, uint64 sourcesHash);
+
+private:
+	struct RawDataEntry
+	{
+		uint64 mKey = 0;
+		std::vector<const RawData*> mRawData;
+	};
+
+	struct ResourceSource
+	{
+		std::wstring mPath;
+		bool mIsPalettes = false;
+		bool mIsModded = false;
+		uint64 mContainerKey = 0;	// For sources inside a zip file, see "Mod::mContainerKey"
+	};
 
 private:
 	std::vector<uint8> mRom;	// This is the original, unmodified ROM (i.e. without any raw data injections or ROM writes)
 
-	std::map<uint64, std::vector<const RawData*>> mRawDataMap;
+	std::vector<ResourceSource> mSources;		// Directories that raw data and palettes got loaded from, in load order
+	std::vector<RawDataEntry> mRawDataEntries;	// Sorted by key
+	std::vector<const RawData*> mRawDataList;	// All raw data in load order
 	std::vector<const RawData*> mRomInjections;
 	ObjectPool<RawData> mRawDataPool;
+	bool mRawDataCacheable = true;				// False if any raw data file is located outside of its source directory
+
+	std::vector<std::pair<uint64, Palette>> mPalettes;	// Sorted by key
 
-	std::map<uint64, Palette> mPalettes;
+	// Binary snapshot of all raw data and palettes, so that a warm start does not need to load all the single files again
+	std::wstring mSnapshotFilename;
+	MemoryMappedFile mSnapshotFile;
+	std::vector<uint8> mSnapshotContent;		// Only used as a fallback if memory mapping is not possible
 
 	std::map<uint64, CachedFont> mCachedFonts;	// Using "mKeyHash" as map key
 };
@@ -8,6 +8,7 @@
 
 #include "oxygen/pch.h"
 #include "oxygen/resources/SpriteCache.h"
+#include "oxygen/resources/SpriteSheetCache.h"
 #include "oxygen/application/Configuration.h"
 #include "oxygen/application/EngineMain.h"
 #include "oxygen/application/modding/ModManager.h"
@@ -151,6 +152,24 @@ namespace
 		return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
 	}
 
+	bool parseIntegerList(const std::string& str, int* outValues, int count)
+	{
+		// Same as splitting at commas and parsing each part, but without creating temporary strings
+		const char* ptr = str.c_str();
+		for (int i = 0; i < count; ++i)
+		{
+			const char* separator = strchr(ptr, ',');
+			if ((nullptr == separator) != (i == count - 1))
+				return false;
+
+			char* end;
+			outValues[i] = (int)strtol(ptr, &end, 0);
+			if (nullptr != separator)
+				ptr = separator + 1;
+		}
+		return true;
+	}
+
 }
 
 
@@ -183,12 +202,93 @@ void SpriteCache::clear()
 
 void SpriteCache::loadAllSpriteDefinitions()
 {
-	// Load or reload from all mods
-	loadSpriteDefinitions(L"data/sprites");
+	SpriteSheetCache sheetCache;
+	sheetCache.loadCacheFile(Configuration::instance().mAppDataPath + L"spritecache.bin");
+
+	// Load or reload from all mods, starting with collecting all definitions so that the sprite sheets can be loaded in one go
+	std::vector<SpriteDefinition> definitions;
+	collectSpriteDefinitions(L"data/sprites", sheetCache, definitions);
 	for (const Mod* mod : ModManager::instance().getActiveMods())
 	{
-		loadSpriteDefinitions(mod->mFullPath + L"sprites");
+		collectSpriteDefinitions(mod->mFullPath + L"sprites", sheetCache, definitions);
+	}
+	if (definitions.empty())
+		return;
+
+	sheetCache.loadSheets();
+	for (size_t sheetIndex = 0; sheetIndex < sheetCache.getNumSheets(); ++sheetIndex)
+	{
+		const SpriteSheetCache::Sheet& sheet = sheetCache.getSheet(sheetIndex);
+		RMX_CHECK(sheet.mLoaded, "Failed to load sprite from '" << *WString(sheet.mPath).toString() << "'", );
+	}
+
+	// Sprites can get overloaded e.g. by a mod, only the last definition for each key is relevant
+	std::vector<const SpriteDefinition*> finalDefinitions;
+	{
+		std::unordered_set<uint64> usedKeys;
+		for (auto it = definitions.rbegin(); it != definitions.rend(); ++it)
+		{
+			if (usedKeys.insert(it->mKey).second)
+				finalDefinitions.push_back(&*it);
+		}
+	}
+
+	// Extract the sprites from their sheets
+	std::vector<SpriteBase*> sprites(finalDefinitions.size(), nullptr);
+	FTX::ParallelFor->execute((int)finalDefinitions.size(), 16, [&](int first, int end)
+	{
+		for (int i = first; i < end; ++i)
+		{
+			const SpriteDefinition& definition = *finalDefinitions[i];
+			const SpriteSheetCache::Sheet& sheet = sheetCache.getSheet(definition.mSheetIndex);
+
+			// Part of a sprite sheet?
+			const bool isPartOfSheet = (definition.mRect.width != 0);
+
+			if (!sheet.mIsComponent)
+			{
+				// Palette sprite (= 8-bit palette sprite)
+				PaletteSprite* sprite = new PaletteSprite();
+				if (sheet.mLoaded)
+				{
+					if (isPartOfSheet)
+						sprite->createFromBitmap(sheet.mPaletteBitmap, definition.mRect, -definition.mCenter);
+					else
+						sprite->createFromBitmap(sheet.mPaletteBitmap, -definition.mCenter);
+				}
+				sprites[i] = sprite;
+			}
+			else
+			{
+				// Component sprite (= 32-bit RGBA sprite)
+				ComponentSprite* sprite = new ComponentSprite();
+				if (sheet.mLoaded)
+				{
+					if (isPartOfSheet)
+						sprite->accessBitmap().copy(sheet.mBitmap, definition.mRect);
+					else
+						sprite->accessBitmap().copy(sheet.mBitmap);
+				}
+				sprite->mOffset = -definition.mCenter;
+				sprites[i] = sprite;
+			}
+		}
+	});
+
+	for (size_t i = 0; i < finalDefinitions.size(); ++i)
+	{
+		const SpriteDefinition& definition = *finalDefinitions[i];
+		CacheItem& item = mCachedSprites[definition.mKey];
+
+		// In case this sprite got overloaded, remove the old version
+		SAFE_DELETE(item.mSprite);
+
+		item.mSprite = sprites[i];
+		item.mUsesComponentSprite = sheetCache.getSheet(definition.mSheetIndex).mIsComponent;
+		item.mChangeCounter = definition.mChangeCounter;
 	}
+
+	sheetCache.saveCacheFile();
 }
 
 bool SpriteCache::hasSprite(uint64 key) const
@@ -310,9 +410,8 @@ void SpriteCache::dumpSprite(uint64 key, std::string_view categoryKey, uint8 spr
 	}
 }
 
-void SpriteCache::loadSpriteDefinitions(const std::wstring& path)
+void SpriteCache::collectSpriteDefinitions(const std::wstring& path, SpriteSheetCache& sheetCache, std::vector<SpriteDefinition>& outDefinitions)
 {
-	SheetCache sheetCache;
 	PackageFileCrawler fc;
 	fc.addFiles(path + L"/*.json", true);
 	if (fc.size() == 0)
@@ -358,127 +457,37 @@ void SpriteCache::loadSpriteDefinitions(const std::wstring& path)
 
 			for (auto it = iterator->begin(); it != iterator->end(); ++it)
 			{
-				if (it.key().asString() == "File" && !it->asString().empty())
+				const std::string& name = it.key().asString();
+				if (name == "File" && !it->asString().empty())
 				{
 					filename = *String(it->asString()).toWString();
 				}
-				else if (it.key().asString() == "Center" && !it->asString().empty())
+				else if (name == "Center" && !it->asString().empty())
 				{
-					std::vector<String> parts;
-					String(it->asString()).split(parts, ',');
-					if (parts.size() == 2)
+					int values[2];
+					if (parseIntegerList(it->asString(), values, 2))
 					{
-						center.x = parts[0].parseInt();
-						center.y = parts[1].parseInt();
+						center.set(values[0], values[1]);
 					}
 				}
-				else if (it.key().asString() == "Rect" && !it->asString().empty())
+				else if (name == "Rect" && !it->asString().empty())
 				{
-					std::vector<String> parts;
-					String(it->asString()).split(parts, ',');
-					if (parts.size() == 4)
+					int values[4];
+					if (parseIntegerList(it->asString(), values, 4))
 					{
-						rect.x = parts[0].parseInt();
-						rect.y = parts[1].parseInt();
-						rect.width = parts[2].parseInt();
-						rect.height = parts[3].parseInt();
+						rect.set(values[0], values[1], values[2], values[3]);
 					}
 				}
 			}
 
 			if (!filename.empty())
 			{
-				// Check for overloading
-				{
-					const auto it = mCachedSprites.find(key);
-					if (it != mCachedSprites.end())
-					{
-						// This sprite got overloaded e.g. by a mod -- remove the old version
-						SAFE_DELETE(it->second.mSprite);
-					}
-				}
-
-				CacheItem& item = mCachedSprites[key];
-				item.mChangeCounter = mGlobalChangeCounter;
-				const std::wstring fullpath = entry.mPath + filename;
-
-				// Palette or RGBA?
-				item.mUsesComponentSprite = WString(filename).endsWith(L".png");
-
-				// Part of a sprite sheet?
-				const bool isPartOfSheet = (rect.width != 0);
-
-				bool success = false;
-				if (!item.mUsesComponentSprite)
-				{
-					// Load palette sprite (= 8-bit palette sprite)
-					PaletteSprite* sprite = new PaletteSprite();
-					item.mSprite = sprite;
-
-					if (isPartOfSheet)
-					{
-						PaletteBitmap* bitmap = nullptr;
-						const auto it = sheetCache.mPaletteSpriteSheets.find(fullpath);
-						if (it == sheetCache.mPaletteSpriteSheets.end())
-						{
-							bitmap = &sheetCache.mPaletteSpriteSheets[fullpath];
-							success = FileHelper::loadPaletteBitmap(*bitmap, fullpath);
-						}
-						else
-						{
-							bitmap = &it->second;
-							success = true;
-						}
-
-						if (success)
-						{
-							sprite->createFromBitmap(*bitmap, rect, -center);
-						}
-					}
-					else
-					{
-						PaletteBitmap bitmap;
-						success = FileHelper::loadPaletteBitmap(bitmap, fullpath);
-						if (success)
-						{
-							static_cast<PaletteSprite*>(item.mSprite)->createFromBitmap(std::move(bitmap), -center);
-						}
-					}
-				}
-				else
-				{
-					// Load component sprite (= 32-bit RGBA sprite)
-					ComponentSprite* sprite = new ComponentSprite();
-					item.mSprite = sprite;
-
-					if (isPartOfSheet)
-					{
-						Bitmap* bitmap = nullptr;
-						const auto it = sheetCache.mComponentSpriteSheets.find(fullpath);
-						if (it == sheetCache.mComponentSpriteSheets.end())
-						{
-							bitmap = &sheetCache.mComponentSpriteSheets[fullpath];
-							success = FileHelper::loadBitmap(*bitmap, fullpath);
-						}
-						else
-						{
-							bitmap = &it->second;
-							success = true;
-						}
-
-						if (success)
-						{
-							sprite->accessBitmap().copy(*bitmap, rect);
-						}
-					}
-					else
-					{
-						success = FileHelper::loadBitmap(static_cast<ComponentSprite*>(item.mSprite)->accessBitmap(), fullpath);
-					}
-					item.mSprite->mOffset = -center;
-				}
-
-				RMX_CHECK(success, "Failed to load sprite from '" << *WString(fullpath).toString() << "'", continue);
+				SpriteDefinition& definition = vectorAdd(outDefinitions);
+				definition.mKey = key;
+				definition.mSheetIndex = sheetCache.addSheet(entry.mPath + filename, WString(filename).endsWith(L".png"));	// Palette or RGBA?
+				definition.mCenter = center;
+				definition.mRect = rect;
+				definition.mChangeCounter = mGlobalChangeCounter;
 			}
 		}
 	}
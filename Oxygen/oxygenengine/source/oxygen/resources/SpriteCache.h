@@ -13,6 +13,7 @@
 #include "oxygen/rendering/utils/PaletteSprite.h"
 
 class SpriteDump;
+class SpriteSheetCache;
 
 
 class SpriteCache : public SingleInstance<SpriteCache>
@@ -52,14 +53,17 @@ public:
 	void dumpSprite(uint64 key, std::string_view categoryKey, uint8 spriteNumber, uint8 atex);
 
 private:
-	struct SheetCache
+	struct SpriteDefinition
 	{
-		std::map<std::wstring, PaletteBitmap> mPaletteSpriteSheets;
-		std::map<std::wstring, Bitmap> mComponentSpriteSheets;
+		uint64 mKey = 0;
+		size_t mSheetIndex = 0;
+		Vec2i mCenter;
+		Recti mRect;
+		uint32 mChangeCounter = 0;
 	};
 
 private:
-	void loadSpriteDefinitions(const std::wstring& path);
+	void collectSpriteDefinitions(const std::wstring& path, SpriteSheetCache& sheetCache, std::vector<SpriteDefinition>& outDefinitions);
 
 private:
 	std::unordered_map<uint64, CacheItem> mCachedSprites;
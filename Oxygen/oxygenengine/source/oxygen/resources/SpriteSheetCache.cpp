@@ -0,0 +1,330 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen/pch.h"
+#include "oxygen/resources/SpriteSheetCache.h"
+
+
+namespace
+{
+	const char* FORMAT_IDENTIFIER = "OXY.SPRCACHE";
+	const uint16 FORMAT_VERSION = 0x0100;		// First version
+	const size_t MAX_CACHE_DATA_SIZE = 128 * 1024 * 1024;	// Limit for the summed up pixel data of all cache entries
+
+	struct DecodeJob
+	{
+		SpriteSheetCache::Sheet* mSheet = nullptr;
+		std::vector<uint8> mContent;
+		uint64 mFileTime = 0;
+		uint64 mContentHash = 0;
+		bool mSuccess = false;
+	};
+
+	bool decodeSheet(SpriteSheetCache::Sheet& sheet, const std::vector<uint8>& content)
+	{
+		if (content.empty())
+			return false;
+
+		if (!sheet.mIsComponent)
+		{
+			return sheet.mPaletteBitmap.loadBMP(content);
+		}
+		else
+		{
+			// Get file type, same as "FileHelper::loadBitmap"
+			std::wstring extension;
+			rmx::FileIO::splitPath(sheet.mPath, nullptr, nullptr, &extension);
+
+			MemInputStream stream(&content[0], content.size());
+			return sheet.mBitmap.decode(stream, *WString(extension).toString());
+		}
+	}
+}
+
+
+SpriteSheetCache::~SpriteSheetCache()
+{
+	for (Sheet* sheet : mSheets)
+	{
+		delete sheet;
+	}
+}
+
+void SpriteSheetCache::loadCacheFile(const std::wstring& filename)
+{
+	mCacheFilename = filename;
+	mCacheEntries.clear();
+	mCacheFileContent.clear();
+	mCacheChanged = false;
+
+	if (!FTX::FileSystem->readFile(filename, mCacheFileContent))
+		return;
+
+	VectorBinarySerializer serializer(true, mCacheFileContent);
+	if (!serialize(serializer))
+	{
+		// Ignore a broken or outdated cache, it will simply get rebuilt
+		mCacheEntries.clear();
+		mCacheFileContent.clear();
+		mCacheChanged = true;
+	}
+}
+
+void SpriteSheetCache::saveCacheFile()
+{
+	if (mCacheFilename.empty())
+		return;
+
+	// Remove entries that were not used in this run, e.g. for image files that don't exist any more or belong to mods that are not active
+	//  -> Also make sure the cache file does not grow too large, by dropping entries once the limit is reached
+	size_t totalDataSize = 0;
+	for (auto it = mCacheEntries.begin(); it != mCacheEntries.end(); )
+	{
+		const CacheEntry& entry = it->second;
+		const size_t dataSize = (size_t)entry.mSize.x * (size_t)entry.mSize.y * (entry.mIsComponent ? 4 : 1);
+		if (mSheetIndexByPath.count(it->first) == 0 || totalDataSize + dataSize > MAX_CACHE_DATA_SIZE)
+		{
+			it = mCacheEntries.erase(it);
+			mCacheChanged = true;
+		}
+		else
+		{
+			totalDataSize += dataSize;
+			++it;
+		}
+	}
+
+	if (!mCacheChanged)
+		return;
+
+	std::vector<uint8> content;
+	VectorBinarySerializer serializer(false, content);
+	if (!serialize(serializer))
+		return;
+
+	FTX::FileSystem->saveFile(mCacheFilename, content);
+	mCacheChanged = false;
+}
+
+size_t SpriteSheetCache::addSheet(const std::wstring& path, bool isComponent)
+{
+	const auto it = mSheetIndexByPath.find(path);
+	if (it != mSheetIndexByPath.end())
+		return it->second;
+
+	const size_t index = mSheets.size();
+	Sheet* sheet = new Sheet();
+	sheet->mPath = path;
+	sheet->mIsComponent = isComponent;
+	mSheets.push_back(sheet);
+	mSheetIndexByPath[path] = index;
+	return index;
+}
+
+void SpriteSheetCache::loadSheets()
+{
+	// File access is done sequentially on the calling thread (a startup task worker thread), only the decoding is done in parallel
+	std::vector<DecodeJob> decodeJobs;
+	for (Sheet* sheet : mSheets)
+	{
+		if (sheet->mLoaded)
+			continue;
+
+		const rmx::FileIO::FileEntry* fileEntry = getFileEntry(sheet->mPath);
+		const uint64 fileTime = (nullptr == fileEntry) ? 0 : (uint64)fileEntry->mTime;
+		const uint64 fileSize = (nullptr == fileEntry) ? 0 : (uint64)fileEntry->mSize;
+
+		auto it = mCacheEntries.find(sheet->mPath);
+		CacheEntry* cacheEntry = (it != mCacheEntries.end() && it->second.mIsComponent == sheet->mIsComponent) ? &it->second : nullptr;
+
+		// Unchanged file time and size: Use the cached data without even reading the file
+		if (nullptr != cacheEntry && fileTime != 0 && cacheEntry->mFileTime == fileTime && cacheEntry->mFileSize == fileSize)
+		{
+			loadSheetFromCache(*sheet, *cacheEntry);
+			continue;
+		}
+
+		DecodeJob job;
+		if (!FTX::FileSystem->readFile(sheet->mPath, job.mContent))
+			continue;
+
+		job.mFileTime = fileTime;
+		job.mContentHash = job.mContent.empty() ? 0 : rmx::getMurmur2_64(&job.mContent[0], job.mContent.size());
+
+		// Same content as in the cache, e.g. if the file only got touched or comes from a package without file times
+		if (nullptr != cacheEntry && cacheEntry->mContentHash == job.mContentHash && cacheEntry->mFileSize == (uint64)job.mContent.size())
+		{
+			loadSheetFromCache(*sheet, *cacheEntry);
+			if (cacheEntry->mFileTime != fileTime)
+			{
+				cacheEntry->mFileTime = fileTime;
+				mCacheChanged = true;
+			}
+			continue;
+		}
+
+		job.mSheet = sheet;
+		decodeJobs.emplace_back(std::move(job));
+	}
+
+	if (decodeJobs.empty())
+		return;
+
+	FTX::ParallelFor->execute((int)decodeJobs.size(), 1, [&](int first, int end)
+	{
+		for (int i = first; i < end; ++i)
+		{
+			DecodeJob& job = decodeJobs[i];
+			job.mSuccess = decodeSheet(*job.mSheet, job.mContent);
+		}
+	});
+
+	for (DecodeJob& job : decodeJobs)
+	{
+		if (!job.mSuccess)
+			continue;
+
+		job.mSheet->mLoaded = true;
+		updateCacheEntry(mCacheEntries[job.mSheet->mPath], *job.mSheet, job.mFileTime, (uint64)job.mContent.size(), job.mContentHash);
+	}
+}
+
+const rmx::FileIO::FileEntry* SpriteSheetCache::getFileEntry(const std::wstring& path)
+{
+	// Directory listings are cached, as there's usually lots of files in the same directory
+	std::wstring directory;
+	std::wstring filename = path;
+	const size_t pos = path.find_last_of(L"/\\");
+	if (pos != std::wstring::npos)
+	{
+		directory = path.substr(0, pos + 1);
+		filename = path.substr(pos + 1);
+	}
+
+	auto it = mDirectoryListings.find(directory);
+	if (it == mDirectoryListings.end())
+	{
+		std::map<std::wstring, rmx::FileIO::FileEntry>& listing = mDirectoryListings[directory];
+		std::vector<rmx::FileIO::FileEntry> fileEntries;
+		FTX::FileSystem->listFiles(directory, false, fileEntries);
+		for (rmx::FileIO::FileEntry& fileEntry : fileEntries)
+		{
+			listing[fileEntry.mFilename] = std::move(fileEntry);
+		}
+		it = mDirectoryListings.find(directory);
+	}
+
+	const auto it2 = it->second.find(filename);
+	return (it2 == it->second.end()) ? nullptr : &it2->second;
+}
+
+void SpriteSheetCache::loadSheetFromCache(Sheet& sheet, const CacheEntry& entry) const
+{
+	if (nullptr != entry.mSheet)
+	{
+		if (sheet.mIsComponent)
+			sheet.mBitmap.copy(entry.mSheet->mBitmap);
+		else
+			sheet.mPaletteBitmap.copy(entry.mSheet->mPaletteBitmap);
+	}
+	else if (!sheet.mIsComponent)
+	{
+		sheet.mPaletteBitmap.create(entry.mSize.x, entry.mSize.y);
+		memcpy(sheet.mPaletteBitmap.getData(), &mCacheFileContent[entry.mDataOffset], (size_t)sheet.mPaletteBitmap.getPixelCount());
+	}
+	else
+	{
+		sheet.mBitmap.create(entry.mSize.x, entry.mSize.y);
+		memcpy(sheet.mBitmap.getData(), &mCacheFileContent[entry.mDataOffset], (size_t)sheet.mBitmap.getPixelCount() * 4);
+	}
+	sheet.mLoaded = true;
+}
+
+void SpriteSheetCache::updateCacheEntry(CacheEntry& entry, const Sheet& sheet, uint64 fileTime, uint64 fileSize, uint64 contentHash)
+{
+	entry.mPath = sheet.mPath;
+	entry.mIsComponent = sheet.mIsComponent;
+	entry.mFileTime = fileTime;
+	entry.mFileSize = fileSize;
+	entry.mContentHash = contentHash;
+	entry.mSize = sheet.mIsComponent ? sheet.mBitmap.getSize() : sheet.mPaletteBitmap.getSize();
+	entry.mDataOffset = 0;
+	entry.mSheet = &sheet;
+	mCacheChanged = true;
+}
+
+bool SpriteSheetCache::serialize(VectorBinarySerializer& serializer)
+{
+	// Identifier
+	if (serializer.isReading())
+	{
+		char identifier[13];
+		serializer.read(identifier, 12);
+		if (memcmp(identifier, FORMAT_IDENTIFIER, 12) != 0)
+			return false;
+	}
+	else
+	{
+		serializer.write(FORMAT_IDENTIFIER, 12);
+	}
+
+	// Format version
+	uint16 formatVersion = FORMAT_VERSION;
+	serializer& formatVersion;
+	if (serializer.isReading() && formatVersion != FORMAT_VERSION)
+		return false;
+
+	// Cache entries, each followed by its pixel data
+	if (serializer.isReading())
+	{
+		const size_t count = (size_t)serializer.read<uint32>();
+		for (size_t i = 0; i < count; ++i)
+		{
+			CacheEntry entry;
+			serializer.serialize(entry.mPath);
+			serializer.serialize(entry.mIsComponent);
+			serializer.serialize(entry.mFileTime);
+			serializer.serialize(entry.mFileSize);
+			serializer.serialize(entry.mContentHash);
+			entry.mSize.x = (int)serializer.read<uint32>();
+			entry.mSize.y = (int)serializer.read<uint32>();
+
+			const size_t dataSize = (size_t)entry.mSize.x * (size_t)entry.mSize.y * (entry.mIsComponent ? 4 : 1);
+			if (dataSize > serializer.getRemaining())
+				return false;
+
+			entry.mDataOffset = serializer.getReadPosition();
+			serializer.skip(dataSize);
+			mCacheEntries[entry.mPath] = entry;
+		}
+	}
+	else
+	{
+		serializer.writeAs<uint32>(mCacheEntries.size());
+		for (auto& pair : mCacheEntries)
+		{
+			CacheEntry& entry = pair.second;
+			serializer.serialize(entry.mPath);
+			serializer.serialize(entry.mIsComponent);
+			serializer.serialize(entry.mFileTime);
+			serializer.serialize(entry.mFileSize);
+			serializer.serialize(entry.mContentHash);
+			serializer.writeAs<uint32>(entry.mSize.x);
+			serializer.writeAs<uint32>(entry.mSize.y);
+
+			const size_t dataSize = (size_t)entry.mSize.x * (size_t)entry.mSize.y * (entry.mIsComponent ? 4 : 1);
+			if (dataSize == 0)
+				continue;
+
+			const void* data = (nullptr == entry.mSheet) ? (const void*)&mCacheFileContent[entry.mDataOffset] :
+							   entry.mIsComponent ? (const void*)entry.mSheet->mBitmap.getData() : (const void*)entry.mSheet->mPaletteBitmap.getData();
+			serializer.write(data, dataSize);
+		}
+	}
+	return true;
+}
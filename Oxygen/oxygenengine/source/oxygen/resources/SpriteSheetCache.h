@@ -0,0 +1,70 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "oxygen/rendering/utils/PaletteBitmap.h"
+
+
+// Decoded sprite sheet images, with a persisted binary cache so that unchanged image files don't have to be decoded again on the next start
+class SpriteSheetCache
+{
+public:
+	struct Sheet
+	{
+		std::wstring mPath;
+		bool mIsComponent = false;		// True for RGBA images, false for 8-bit palette images
+		bool mLoaded = false;
+		PaletteBitmap mPaletteBitmap;
+		Bitmap mBitmap;
+	};
+
+public:
+	~SpriteSheetCache();
+
+	void loadCacheFile(const std::wstring& filename);
+	void saveCacheFile();
+
+	// Register a sheet to be loaded and return its index
+	size_t addSheet(const std::wstring& path, bool isComponent);
+
+	// Load all registered sheets, either from the cache or by decoding the image files on multiple threads
+	void loadSheets();
+
+	inline size_t getNumSheets() const  { return mSheets.size(); }
+	inline const Sheet& getSheet(size_t index) const  { return *mSheets[index]; }
+
+private:
+	struct CacheEntry
+	{
+		std::wstring mPath;
+		bool mIsComponent = false;
+		uint64 mFileTime = 0;
+		uint64 mFileSize = 0;
+		uint64 mContentHash = 0;
+		Vec2i mSize;
+		size_t mDataOffset = 0;			// Offset of the pixel data inside the loaded cache file content
+		const Sheet* mSheet = nullptr;	// If set, the pixel data is taken from this sheet instead
+	};
+
+private:
+	const rmx::FileIO::FileEntry* getFileEntry(const std::wstring& path);
+	void loadSheetFromCache(Sheet& sheet, const CacheEntry& entry) const;
+	void updateCacheEntry(CacheEntry& entry, const Sheet& sheet, uint64 fileTime, uint64 fileSize, uint64 contentHash);
+	bool serialize(VectorBinarySerializer& serializer);
+
+private:
+	std::wstring mCacheFilename;
+	std::vector<uint8> mCacheFileContent;
+	std::map<std::wstring, CacheEntry> mCacheEntries;
+	bool mCacheChanged = false;
+
+	std::vector<Sheet*> mSheets;
+	std::map<std::wstring, size_t> mSheetIndexByPath;
+	std::map<std::wstring, std::map<std::wstring, rmx::FileIO::FileEntry>> mDirectoryListings;
+};
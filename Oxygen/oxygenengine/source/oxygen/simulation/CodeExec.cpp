@@ -430,7 +430,10 @@ bool CodeExec::performFrameUpdate()
 	}
 
 	// Run script
-	runScript(false, &mMainCallFrameTracking);
+	{
+		RMX_TRACE_SCOPE("Script frame update");
+		runScript(false, &mMainCallFrameTracking);
+	}
 
 	const bool completedNewFrame = (mExecutionState == ExecutionState::YIELDED);
 	if (completedNewFrame)
@@ -439,9 +442,13 @@ bool CodeExec::performFrameUpdate()
 		//  -> Note that the hook must yield execution, otherwise parts of the next frame get executed
 		if (canExecute() && tryCallUpdateHook(true))
 		{
+			RMX_TRACE_SCOPE("Script post-update hook");
 			runScript(true, &mMainCallFrameTracking);
 		}
 		mAccumulatedStepsOfCurrentFrame = 0;
+
+		// Frame boundary is the right time to get rid of strings created by scripts during the last frames
+		mLemonScriptRuntime.getInternalLemonRuntime().collectUnusedStrings();
 	}
 
 	// Return whether the frame was completed in any way (halted counts as completed)
@@ -463,6 +470,7 @@ bool CodeExec::executeScriptFunction(const std::string& functionName, bool showE
 		if (mLemonScriptRuntime.callFunctionByName(functionName, showErrorOnFail))
 		{
 			const size_t oldAccumulatedSteps = mAccumulatedStepsOfCurrentFrame;
+			rmx::Tracing::Scope traceScope(rmx::Tracing::isCapturing() ? rmx::Tracing::internName(functionName) : nullptr);
 
 		#if 0
 			// Dead code, as call frame tracking is always disabled for single script function calls
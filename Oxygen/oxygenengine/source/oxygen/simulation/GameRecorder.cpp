@@ -13,6 +13,20 @@
 #include "oxygen/helper/FileHelper.h"
 
 
+const char* GameRecorder::StateHashes::getRegionName(size_t index)
+{
+	switch ((Region)index)
+	{
+		case Region::RAM:			 return "RAM";
+		case Region::VRAM:			 return "VRAM";
+		case Region::VSRAM:			 return "VSRAM";
+		case Region::SHARED_MEMORY:	 return "shared memory";
+		case Region::REGISTERS:		 return "registers";
+		case Region::SCRIPT_GLOBALS: return "script globals";
+		default:					 return "unknown";
+	}
+}
+
 void GameRecorder::clear()
 {
 	mFrames.clear();
@@ -36,6 +50,14 @@ void GameRecorder::addKeyFrame(const uint16* inputs, const std::vector<uint8>& d
 	frame.mData = data;
 }
 
+void GameRecorder::setLastFrameStateHashes(const StateHashes& stateHashes)
+{
+	RMX_CHECK(!mFrames.empty(), "No frame to set the state hashes for", return);
+	Frame& frame = *mFrames.back();
+	frame.mHasStateHashes = true;
+	frame.mStateHashes = stateHashes;
+}
+
 void GameRecorder::discardOldFrames(uint32 minKeepNumber)
 {
 	size_t firstIndexToKeep = 0;
@@ -103,6 +125,20 @@ bool GameRecorder::updatePlayback(PlaybackResult& outResult)
 	return true;
 }
 
+const GameRecorder::StateHashes* GameRecorder::getLastPlaybackStateHashes(uint32& outFrameNumber) const
+{
+	const int32 position = mPlaybackPosition - 1;
+	if (position < (int32)mRangeStart || position >= (int32)mRangeEnd)
+		return nullptr;
+
+	const Frame& frame = *mFrames[position - mRangeStart];
+	if (!frame.mHasStateHashes)
+		return nullptr;
+
+	outFrameNumber = frame.mNumber;
+	return &frame.mStateHashes;
+}
+
 bool GameRecorder::loadRecording(const std::wstring& filename)
 {
 	clear();
@@ -117,7 +153,11 @@ bool GameRecorder::loadRecording(const std::wstring& filename)
 	char signature[4];
 	serializer.read(signature, 4);
 	int formatVersion = 0;
-	if (memcmp(signature, "GRC1", 4) == 0)
+	if (memcmp(signature, "GRC2", 4) == 0)
+	{
+		formatVersion = 2;
+	}
+	else if (memcmp(signature, "GRC1", 4) == 0)
 	{
 		formatVersion = 1;
 	}
@@ -146,6 +186,9 @@ bool GameRecorder::loadRecording(const std::wstring& filename)
 		}
 	}
 
+	// State hashes are only usable if the regions match
+	const size_t numStateHashRegions = (formatVersion >= 2) ? (size_t)serializer.read<uint8>() : 0;
+
 	// Load all frames
 	const uint32 frameCount = serializer.read<uint32>();
 	for (uint32 index = 0; index < frameCount; ++index)
@@ -157,6 +200,17 @@ bool GameRecorder::loadRecording(const std::wstring& filename)
 		serializer.serialize(frame.mInputs[0]);
 		serializer.serialize(frame.mInputs[1]);
 
+		if (formatVersion >= 2 && serializer.read<bool>())
+		{
+			for (size_t k = 0; k < numStateHashRegions; ++k)
+			{
+				const uint64 hash = serializer.read<uint64>();
+				if (k < StateHashes::NUM_REGIONS)
+					frame.mStateHashes.mHashes[k] = hash;
+			}
+			frame.mHasStateHashes = (numStateHashRegions == StateHashes::NUM_REGIONS);
+		}
+
 		if (frameType == Frame::Type::KEYFRAME)
 		{
 			frame.mCompressedData = false;
@@ -206,7 +260,7 @@ bool GameRecorder::saveRecording(const std::wstring& filename) const
 
 	// Signature
 	const EngineDelegateInterface::AppMetaData& appMetaData = EngineMain::getDelegate().getAppMetaData();
-	const char SIGNATURE[] = "GRC1";
+	const char SIGNATURE[] = "GRC2";
 	serializer.write(SIGNATURE, 4);
 	serializer.write(appMetaData.mBuildVersion.c_str(), 10);
 
@@ -221,6 +275,7 @@ bool GameRecorder::saveRecording(const std::wstring& filename) const
 			serializer.write(&buffer[0], bufferSize);
 		}
 	}
+	serializer.writeAs<uint8>(StateHashes::NUM_REGIONS);
 
 	// Save all frames
 	const uint32 frameCount = (uint32)mFrames.size();
@@ -232,6 +287,15 @@ bool GameRecorder::saveRecording(const std::wstring& filename) const
 		serializer.write(frame->mInputs[0]);
 		serializer.write(frame->mInputs[1]);
 
+		serializer.write(frame->mHasStateHashes);
+		if (frame->mHasStateHashes)
+		{
+			for (size_t k = 0; k < StateHashes::NUM_REGIONS; ++k)
+			{
+				serializer.write(frame->mStateHashes.mHashes[k]);
+			}
+		}
+
 		if (frame->mType == Frame::Type::KEYFRAME)
 		{
 			if (!frame->mCompressedData)
@@ -262,6 +326,7 @@ GameRecorder::Frame& GameRecorder::createFrameInternal(Frame::Type frameType, ui
 	frame.mInputs[1] = 0;
 	frame.mCompressedData = false;
 	frame.mData.clear();
+	frame.mHasStateHashes = false;
 	return frame;
 }
 
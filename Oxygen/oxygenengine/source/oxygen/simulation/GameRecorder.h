@@ -20,10 +20,30 @@ public:
 		std::vector<uint8>* mData = nullptr;
 	};
 
+	// Hashes of the simulation state after a frame, so that playback can verify that it is still deterministic
+	struct StateHashes
+	{
+		enum class Region : uint8
+		{
+			RAM,
+			VRAM,
+			VSRAM,
+			SHARED_MEMORY,
+			REGISTERS,
+			SCRIPT_GLOBALS,
+			_NUM
+		};
+		static const size_t NUM_REGIONS = (size_t)Region::_NUM;
+		static const char* getRegionName(size_t index);
+
+		uint64 mHashes[NUM_REGIONS] = { 0 };
+	};
+
 public:
 	void clear();
 	void addFrame(const uint16* inputs);
 	void addKeyFrame(const uint16* inputs, const std::vector<uint8>& data);
+	void setLastFrameStateHashes(const StateHashes& stateHashes);
 
 	void discardOldFrames(uint32 minKeepNumber = 3600);
 
@@ -33,6 +53,7 @@ public:
 
 	inline bool isPlaying() const	{ return mPlaybackPosition >= 0; }
 	bool updatePlayback(PlaybackResult& outResult);
+	const StateHashes* getLastPlaybackStateHashes(uint32& outFrameNumber) const;	// Returns null if the frame last played has no state hashes
 
 	bool loadRecording(const std::wstring& filename);
 	bool saveRecording(const std::wstring& filename) const;
@@ -54,6 +75,8 @@ private:
 		uint16 mInputs[2] = { 0 };
 		bool mCompressedData = false;
 		std::vector<uint8> mData;
+		bool mHasStateHashes = false;
+		StateHashes mStateHashes;
 	};
 
 private:
@@ -38,12 +38,12 @@ namespace
 {
 	namespace detail
 	{
-		uint32 loadData(uint32 targetAddress, const std::vector<uint8>& data, uint32 offset, uint32 maxBytes)
+		uint32 loadData(uint32 targetAddress, const uint8* data, uint32 size, uint32 offset, uint32 maxBytes)
 		{
-			if (data.empty())
+			if (size == 0)
 				return 0;
 
-			uint32 bytes = (uint32)data.size();
+			uint32 bytes = size;
 			if (offset != 0)
 			{
 				if (offset >= bytes)
@@ -186,7 +186,7 @@ namespace
 	uint32 System_loadPersistentData(uint32 targetAddress, lemon::StringRef key, uint32 maxBytes)
 	{
 		const std::vector<uint8>& data = PersistentData::instance().getData(key.getHash());
-		return detail::loadData(targetAddress, data, 0, maxBytes);
+		return detail::loadData(targetAddress, data.data(), (uint32)data.size(), 0, maxBytes);
 	}
 
 	void System_savePersistentData(uint32 sourceAddress, lemon::StringRef key, uint32 bytes)
@@ -269,7 +269,7 @@ namespace
 		if (nullptr == rawData)
 			return 0;
 
-		return detail::loadData(targetAddress, rawData->mContent, offset, maxBytes);
+		return detail::loadData(targetAddress, rawData->mData, rawData->mSize, offset, maxBytes);
 	}
 
 	uint32 System_loadExternalRawData2(lemon::StringRef key, uint32 targetAddress)
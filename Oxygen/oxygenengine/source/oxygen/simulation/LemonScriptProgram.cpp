@@ -247,9 +247,12 @@ bool LemonScriptProgram::loadScripts(const std::string& filename, const LoadOpti
 			// Deserialize from cache (so that debug builds don't have to compile themselves, which is quite slow there)
 			if (!config.mForceCompileScripts && !config.mCompiledScriptSavePath.empty())
 			{
-				if (FTX::FileSystem->readFile(config.mCompiledScriptSavePath, buffer))
+				// Read directly from the file if it can be mapped into memory
+				MemoryMappedFile mappedFile;
+				const bool isMapped = mappedFile.open(config.mCompiledScriptSavePath);
+				if (isMapped || FTX::FileSystem->readFile(config.mCompiledScriptSavePath, buffer))
 				{
-					VectorBinarySerializer serializer(true, buffer);
+					VectorBinarySerializer serializer = isMapped ? VectorBinarySerializer(true, mappedFile.getData(), mappedFile.getSize()) : VectorBinarySerializer(true, buffer);
 					scriptsLoaded = mInternal.mScriptModule.serialize(serializer);
 					RMX_CHECK(scriptsLoaded, "Failed to deserialize scripts, possibly because the compiled script file '" << WString(config.mCompiledScriptSavePath).toStdString() << "' is using an older format", );
 				}
@@ -30,9 +30,14 @@ SaveStateSerializer::SaveStateSerializer(CodeExec& codeExec, RenderParts& render
 }
 
 bool SaveStateSerializer::loadState(const std::vector<uint8>& input, StateType* outStateType)
+{
+	return loadState(input.data(), input.size(), outStateType);
+}
+
+bool SaveStateSerializer::loadState(const uint8* data, size_t size, StateType* outStateType)
 {
 	// Deserialize
-	VectorBinarySerializer serializer(true, input);
+	VectorBinarySerializer serializer(true, data, size);
 
 	StateType stateType = StateType::INVALID;
 	if (!serializeState(serializer, stateType))
@@ -50,6 +55,15 @@ bool SaveStateSerializer::loadState(const std::wstring& filename, StateType* out
 	if (nullptr != outStateType)
 		*outStateType = StateType::INVALID;
 
+	// Read directly from the file if it can be mapped into memory
+	{
+		MemoryMappedFile mappedFile;
+		if (mappedFile.open(filename))
+		{
+			return loadState(mappedFile.getData(), mappedFile.getSize(), outStateType);
+		}
+	}
+
 	// Load file
 	std::vector<uint8> state;
 	if (!FTX::FileSystem->readFile(filename, state))
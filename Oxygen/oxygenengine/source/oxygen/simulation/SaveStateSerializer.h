@@ -28,6 +28,7 @@ public:
 	SaveStateSerializer(CodeExec& codeExec, RenderParts& renderParts);
 
 	bool loadState(const std::vector<uint8>& input, StateType* outStateType = nullptr);
+	bool loadState(const uint8* data, size_t size, StateType* outStateType = nullptr);
 	bool loadState(const std::wstring& filename, StateType* outStateType = nullptr);
 
 	bool saveState(std::vector<uint8>& output);
@@ -24,6 +24,8 @@
 #include "oxygen/simulation/LogDisplay.h"
 #include "oxygen/simulation/analyse/ROMDataAnalyser.h"
 
+#include <lemon/runtime/Runtime.h>
+
 
 Simulation::Simulation() :
 	mCodeExec(*new CodeExec()),
@@ -89,6 +91,7 @@ bool Simulation::startup()
 
 		if (mGameRecorder.isPlaying())
 		{
+			mStateDivergenceReported = false;
 			mGameRecorder.setIgnoreKeys(config.mGameRecIgnoreKeys);
 			mFastForwardTarget = config.mGameRecPlayFrom;
 			config.setSettingsReadOnly(true);	// Do not overwrite settings
@@ -237,8 +240,8 @@ void Simulation::update(float timeElapsed)
 	{
 		for (int i = std::min<int>(mFastForwardTarget - mFrameNumber, 500); i > 0; --i)
 		{
-			// Update emulation
-			const bool result = generateFrame();
+			// Update emulation, only the last frame gets displayed
+			const bool result = generateFrame(i == 1);
 			if (!result)
 				break;
 		}
@@ -270,13 +273,17 @@ void Simulation::update(float timeElapsed)
 
 	if (mAccumulatedTime >= tickLength)
 	{
+		// Scale the time limit with the simulation speed, so it does not cut off the additional frames of a higher speed
 		const uint32 startTime = SDL_GetTicks();
-		const uint32 limitTime = startTime + 200;
+		const uint32 limitTime = startTime + (uint32)(200.0f * std::max(mSimulationSpeed, 1.0f));
 
+		// With a simulation speed above 1, there can be multiple frames to simulate now, but only the last one gets displayed
+		int remainingFrames = (int)(mAccumulatedTime / tickLength);
 		while (true)
 		{
 			// Update emulation
-			const bool result = generateFrame();
+			--remainingFrames;
+			const bool result = generateFrame(remainingFrames <= 0);
 			mAccumulatedTime -= tickLength;
 
 			if (!result || mAccumulatedTime < tickLength)
@@ -315,8 +322,9 @@ void Simulation::update(float timeElapsed)
 #endif
 }
 
-bool Simulation::generateFrame()
+bool Simulation::generateFrame(bool willBeDisplayed)
 {
+	RMX_TRACE_SCOPE("Simulation::generateFrame");
 	ControlsIn& controlsIn = ControlsIn::instance();
 	const bool isGameRecorderPlayback = (Configuration::instance().mGameRecording == 2);
 	const bool isGameRecorderRecording = (Configuration::instance().mGameRecording == 1);
@@ -325,6 +333,7 @@ bool Simulation::generateFrame()
 	const float tickLength = 1.0f / getSimulationFrequency();
 
 	bool completedCurrentFrame = false;
+	bool loadedKeyFrame = false;
 	bool inputWasInjected = false;
 
 	// Steps to do when beginning a new frame
@@ -334,7 +343,7 @@ bool Simulation::generateFrame()
 		EngineMain::getDelegate().onPreFrameUpdate();
 
 		// Tell video that we begin a new frame
-		VideoOut::instance().preFrameUpdate();
+		VideoOut::instance().preFrameUpdate(willBeDisplayed);
 
 		// Game recorder playback
 		if (isGameRecorderPlayback)
@@ -352,6 +361,7 @@ bool Simulation::generateFrame()
 					{
 						mCodeExec.reinitRuntime(nullptr, (stateType == SaveStateSerializer::StateType::GENSX) ? CodeExec::CallStackInitPolicy::READ_FROM_ASM : CodeExec::CallStackInitPolicy::USE_EXISTING);
 						completedCurrentFrame = true;
+						loadedKeyFrame = true;
 					}
 					else
 						RMX_ERROR("Failed to load save state", );
@@ -397,8 +407,8 @@ bool Simulation::generateFrame()
 		// Tell game instance
 		EngineMain::getDelegate().onPostFrameUpdate();
 
-		// Tell video that we begin a new frame
-		VideoOut::instance().postFrameUpdate();
+		// Tell video that the frame is complete
+		VideoOut::instance().postFrameUpdate(willBeDisplayed);
 
 		// Update audio
 		EngineMain::instance().getAudioOut().update(tickLength);
@@ -438,6 +448,20 @@ bool Simulation::generateFrame()
 			{
 				mGameRecorder.addFrame(inputState.mInputFlags);
 			}
+
+			const int stateHashInterval = Configuration::instance().mGameRecStateHashInterval;
+			if (stateHashInterval > 0 && ((mGameRecorder.getRangeEnd() - 1) % (uint32)stateHashInterval) == 0)
+			{
+				GameRecorder::StateHashes stateHashes;
+				computeStateHashes(stateHashes);
+				mGameRecorder.setLastFrameStateHashes(stateHashes);
+			}
+		}
+
+		// Check for divergence in game recording playback; frames that just loaded a keyframe's state have nothing to verify
+		if (isGameRecorderPlayback && !loadedKeyFrame)
+		{
+			verifyGameRecordingStateHashes();
 		}
 
 		++mFrameNumber;
@@ -449,6 +473,91 @@ bool Simulation::generateFrame()
 	return (completedCurrentFrame && mCodeExec.isCodeExecutionPossible());
 }
 
+void Simulation::computeStateHashes(GameRecorder::StateHashes& outStateHashes)
+{
+	typedef GameRecorder::StateHashes::Region Region;
+	EmulatorInterface& emulatorInterface = EmulatorInterface::instance();
+	uint64* hashes = outStateHashes.mHashes;
+
+	hashes[(size_t)Region::RAM]   = rmx::getMurmur2_64(emulatorInterface.getRam(), 0x10000);
+	hashes[(size_t)Region::VRAM]  = rmx::getMurmur2_64(emulatorInterface.getVRam(), 0x10000);
+	hashes[(size_t)Region::VSRAM] = rmx::getMurmur2_64((const uint8*)emulatorInterface.getVSRam(), 0x80);
+
+	// Shared memory is only hashed in 16 KB blocks that are in use, and blocks with only zeroes get ignored altogether
+	//  -> This way, the hash does not depend on the usage flags, which are not necessarily the same after loading a save state
+	{
+		const uint8* sharedMemory = emulatorInterface.getSharedMemory();
+		const uint64 usageFlags = emulatorInterface.getSharedMemoryUsage();
+		uint64 blockHashes[64 * 2];
+		size_t numBlockHashes = 0;
+		for (int bit = 0; bit < 64; ++bit)
+		{
+			if (((usageFlags >> bit) & 1) == 0)
+				continue;
+
+			const uint64* block = (const uint64*)&sharedMemory[bit * 0x4000];
+			bool isEmpty = true;
+			for (size_t k = 0; k < 0x4000 / 8; ++k)
+			{
+				if (block[k] != 0)
+				{
+					isEmpty = false;
+					break;
+				}
+			}
+			if (isEmpty)
+				continue;
+
+			blockHashes[numBlockHashes++] = (uint64)bit;
+			blockHashes[numBlockHashes++] = rmx::getMurmur2_64((const uint8*)block, 0x4000);
+		}
+		hashes[(size_t)Region::SHARED_MEMORY] = rmx::getMurmur2_64((const uint8*)blockHashes, numBlockHashes * sizeof(uint64));
+	}
+
+	// Flags are not part of save states, so only registers get included here
+	uint32 registers[16];
+	for (size_t i = 0; i < 16; ++i)
+	{
+		registers[i] = emulatorInterface.getRegister(i);
+	}
+	hashes[(size_t)Region::REGISTERS] = rmx::getMurmur2_64((const uint8*)registers, sizeof(registers));
+
+	const std::vector<int64>& globalVariables = mCodeExec.getLemonScriptRuntime().getInternalLemonRuntime().getGlobalVariableValues();
+	hashes[(size_t)Region::SCRIPT_GLOBALS] = rmx::getMurmur2_64((const uint8*)globalVariables.data(), globalVariables.size() * sizeof(int64));
+}
+
+void Simulation::verifyGameRecordingStateHashes()
+{
+	// Only the first divergence is of interest, everything after that is likely to differ anyways
+	if (mStateDivergenceReported)
+		return;
+
+	uint32 recordedFrameNumber = 0;
+	const GameRecorder::StateHashes* recordedStateHashes = mGameRecorder.getLastPlaybackStateHashes(recordedFrameNumber);
+	if (nullptr == recordedStateHashes)
+		return;
+
+	GameRecorder::StateHashes stateHashes;
+	computeStateHashes(stateHashes);
+
+	std::string differingRegions;
+	for (size_t k = 0; k < GameRecorder::StateHashes::NUM_REGIONS; ++k)
+	{
+		if (stateHashes.mHashes[k] != recordedStateHashes->mHashes[k])
+		{
+			if (!differingRegions.empty())
+				differingRegions += ", ";
+			differingRegions += GameRecorder::StateHashes::getRegionName(k);
+		}
+	}
+	if (differingRegions.empty())
+		return;
+
+	mStateDivergenceReported = true;
+	RMX_LOG_WARNING("Game recording playback diverged from the recording at frame " << recordedFrameNumber << ", differences in: " << differingRegions);
+	LogDisplay::instance().setLogDisplay(String(0, "Playback diverged at frame %d (%s)", recordedFrameNumber, differingRegions.c_str()), 10.0f);
+}
+
 float Simulation::getSimulationFrequency() const
 {
 	return (mSimulationFrequencyOverride > 0.0f) ? mSimulationFrequencyOverride : (float)Configuration::instance().mSimulationFrequency;
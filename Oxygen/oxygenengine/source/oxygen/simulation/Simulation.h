@@ -9,10 +9,11 @@
 #pragma once
 
 
+#include "oxygen/simulation/GameRecorder.h"
+
 class AudioOutBase;
 class EmulatorInterface;
 class CodeExec;
-class GameRecorder;
 class InputRecorder;
 class ROMDataAnalyser;
 
@@ -47,7 +48,7 @@ public:
 	inline uint32 getFrameNumber() const  { return mFrameNumber; }
 
 	void update(float timePassed);
-	bool generateFrame();
+	bool generateFrame(bool willBeDisplayed = true);		// If "willBeDisplayed" is false, render preparation for this frame can be skipped
 
 	float getSimulationFrequency() const;
 	void setSimulationFrequencyOverride(float frequency) { mSimulationFrequencyOverride = frequency; }
@@ -64,6 +65,10 @@ public:
 
 	uint32 saveGameRecording(WString* outFilename = nullptr);
 
+private:
+	void computeStateHashes(GameRecorder::StateHashes& outStateHashes);
+	void verifyGameRecordingStateHashes();
+
 private:
 	CodeExec& mCodeExec;
 	GameRecorder& mGameRecorder;
@@ -80,6 +85,7 @@ private:
 	uint32	mFrameNumber = 0;
 	uint32	mFastForwardTarget = 0;
 	uint32	mLastCorrectionFrame = 0;
+	bool	mStateDivergenceReported = false;
 
 	std::wstring mStateLoaded;
 };
@@ -920,272 +920,221 @@ namespace soundemulation
 		}
 	}
 
-	void YM2612::advance_eg_channels(FM_CH *channel, unsigned int eg_cnt)
+	void YM2612::advance_eg_channel(FM_CH *channel, unsigned int eg_cnt)
 	{
-		unsigned int i = 6; /* six channels */
-		unsigned int j;
-		FM_SLOT *SLOT;
+		unsigned int j = 4; /* four operators per channel */
+		FM_SLOT *SLOT = &channel->SLOT[SLOT1];
 
 		do
 		{
-			SLOT = &channel->SLOT[SLOT1];
-			j = 4; /* four operators per channel */
-			do
+			switch (SLOT->state)
 			{
-				switch (SLOT->state)
+				case EG_ATT:    /* attack phase */
 				{
-					case EG_ATT:    /* attack phase */
+					if (!(eg_cnt & ((1 << SLOT->eg_sh_ar) - 1)))
 					{
-						if (!(eg_cnt & ((1 << SLOT->eg_sh_ar) - 1)))
-						{
-							/* update attenuation level */
-							SLOT->volume += (~SLOT->volume * (eg_inc[SLOT->eg_sel_ar + ((eg_cnt >> SLOT->eg_sh_ar) & 7)])) >> 4;
+						/* update attenuation level */
+						SLOT->volume += (~SLOT->volume * (eg_inc[SLOT->eg_sel_ar + ((eg_cnt >> SLOT->eg_sh_ar) & 7)])) >> 4;
 
-							/* check phase transition*/
-							if (SLOT->volume <= MIN_ATT_INDEX)
-							{
-								SLOT->volume = MIN_ATT_INDEX;
-								SLOT->state = (SLOT->sl == MIN_ATT_INDEX) ? EG_SUS : EG_DEC; /* special case where SL=0 */
-							}
-
-							/* recalculate EG output */
-							if ((SLOT->ssg & 0x08) && (SLOT->ssgn ^ (SLOT->ssg & 0x04)))  /* SSG-EG Output Inversion */
-								SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
-							else
-								SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
+						/* check phase transition*/
+						if (SLOT->volume <= MIN_ATT_INDEX)
+						{
+							SLOT->volume = MIN_ATT_INDEX;
+							SLOT->state = (SLOT->sl == MIN_ATT_INDEX) ? EG_SUS : EG_DEC; /* special case where SL=0 */
 						}
-						break;
+
+						/* recalculate EG output */
+						if ((SLOT->ssg & 0x08) && (SLOT->ssgn ^ (SLOT->ssg & 0x04)))  /* SSG-EG Output Inversion */
+							SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
+						else
+							SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 					}
+					break;
+				}
 
-					case EG_DEC:  /* decay phase */
+				case EG_DEC:  /* decay phase */
+				{
+					if (!(eg_cnt & ((1 << SLOT->eg_sh_d1r) - 1)))
 					{
-						if (!(eg_cnt & ((1 << SLOT->eg_sh_d1r) - 1)))
+						/* SSG EG type */
+						if (SLOT->ssg & 0x08)
 						{
-							/* SSG EG type */
-							if (SLOT->ssg & 0x08)
-							{
-								/* update attenuation level */
-								if (SLOT->volume < 0x200)
-								{
-									SLOT->volume += 4 * eg_inc[SLOT->eg_sel_d1r + ((eg_cnt >> SLOT->eg_sh_d1r) & 7)];
-
-									/* recalculate EG output */
-									if (SLOT->ssgn ^ (SLOT->ssg & 0x04))   /* SSG-EG Output Inversion */
-										SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
-									else
-										SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
-								}
-							}
-							else
+							/* update attenuation level */
+							if (SLOT->volume < 0x200)
 							{
-								/* update attenuation level */
-								SLOT->volume += eg_inc[SLOT->eg_sel_d1r + ((eg_cnt >> SLOT->eg_sh_d1r) & 7)];
+								SLOT->volume += 4 * eg_inc[SLOT->eg_sel_d1r + ((eg_cnt >> SLOT->eg_sh_d1r) & 7)];
 
 								/* recalculate EG output */
-								SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
+								if (SLOT->ssgn ^ (SLOT->ssg & 0x04))   /* SSG-EG Output Inversion */
+									SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
+								else
+									SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 							}
+						}
+						else
+						{
+							/* update attenuation level */
+							SLOT->volume += eg_inc[SLOT->eg_sel_d1r + ((eg_cnt >> SLOT->eg_sh_d1r) & 7)];
 
-							/* check phase transition*/
-							if (SLOT->volume >= (int32)(SLOT->sl))
-								SLOT->state = EG_SUS;
+							/* recalculate EG output */
+							SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 						}
-						break;
+
+						/* check phase transition*/
+						if (SLOT->volume >= (int32)(SLOT->sl))
+							SLOT->state = EG_SUS;
 					}
+					break;
+				}
 
-					case EG_SUS:  /* sustain phase */
+				case EG_SUS:  /* sustain phase */
+				{
+					if (!(eg_cnt & ((1 << SLOT->eg_sh_d2r) - 1)))
 					{
-						if (!(eg_cnt & ((1 << SLOT->eg_sh_d2r) - 1)))
+						/* SSG EG type */
+						if (SLOT->ssg & 0x08)
 						{
-							/* SSG EG type */
-							if (SLOT->ssg & 0x08)
-							{
-								/* update attenuation level */
-								if (SLOT->volume < 0x200)
-								{
-									SLOT->volume += 4 * eg_inc[SLOT->eg_sel_d2r + ((eg_cnt >> SLOT->eg_sh_d2r) & 7)];
-
-									/* recalculate EG output */
-									if (SLOT->ssgn ^ (SLOT->ssg & 0x04))   /* SSG-EG Output Inversion */
-										SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
-									else
-										SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
-								}
-							}
-							else
+							/* update attenuation level */
+							if (SLOT->volume < 0x200)
 							{
-								/* update attenuation level */
-								SLOT->volume += eg_inc[SLOT->eg_sel_d2r + ((eg_cnt >> SLOT->eg_sh_d2r) & 7)];
-
-								/* check phase transition*/
-								if (SLOT->volume >= MAX_ATT_INDEX)
-									SLOT->volume = MAX_ATT_INDEX;
-								/* do not change SLOT->state (verified on real chip) */
+								SLOT->volume += 4 * eg_inc[SLOT->eg_sel_d2r + ((eg_cnt >> SLOT->eg_sh_d2r) & 7)];
 
 								/* recalculate EG output */
-								SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
+								if (SLOT->ssgn ^ (SLOT->ssg & 0x04))   /* SSG-EG Output Inversion */
+									SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
+								else
+									SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 							}
 						}
-						break;
+						else
+						{
+							/* update attenuation level */
+							SLOT->volume += eg_inc[SLOT->eg_sel_d2r + ((eg_cnt >> SLOT->eg_sh_d2r) & 7)];
+
+							/* check phase transition*/
+							if (SLOT->volume >= MAX_ATT_INDEX)
+								SLOT->volume = MAX_ATT_INDEX;
+							/* do not change SLOT->state (verified on real chip) */
+
+							/* recalculate EG output */
+							SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
+						}
 					}
+					break;
+				}
 
-					case EG_REL:  /* release phase */
+				case EG_REL:  /* release phase */
+				{
+					if (!(eg_cnt & ((1 << SLOT->eg_sh_rr) - 1)))
 					{
-						if (!(eg_cnt & ((1 << SLOT->eg_sh_rr) - 1)))
+						/* SSG EG type */
+						if (SLOT->ssg & 0x08)
 						{
-							/* SSG EG type */
-							if (SLOT->ssg & 0x08)
+							/* update attenuation level */
+							if (SLOT->volume < 0x200)
+								SLOT->volume += 4 * eg_inc[SLOT->eg_sel_rr + ((eg_cnt >> SLOT->eg_sh_rr) & 7)];
+
+							/* check phase transition */
+							if (SLOT->volume >= 0x200)
 							{
-								/* update attenuation level */
-								if (SLOT->volume < 0x200)
-									SLOT->volume += 4 * eg_inc[SLOT->eg_sel_rr + ((eg_cnt >> SLOT->eg_sh_rr) & 7)];
-
-								/* check phase transition */
-								if (SLOT->volume >= 0x200)
-								{
-									SLOT->volume = MAX_ATT_INDEX;
-									SLOT->state = EG_OFF;
-								}
+								SLOT->volume = MAX_ATT_INDEX;
+								SLOT->state = EG_OFF;
 							}
-							else
+						}
+						else
+						{
+							/* update attenuation level */
+							SLOT->volume += eg_inc[SLOT->eg_sel_rr + ((eg_cnt >> SLOT->eg_sh_rr) & 7)];
+
+							/* check phase transition*/
+							if (SLOT->volume >= MAX_ATT_INDEX)
 							{
-								/* update attenuation level */
-								SLOT->volume += eg_inc[SLOT->eg_sel_rr + ((eg_cnt >> SLOT->eg_sh_rr) & 7)];
-
-								/* check phase transition*/
-								if (SLOT->volume >= MAX_ATT_INDEX)
-								{
-									SLOT->volume = MAX_ATT_INDEX;
-									SLOT->state = EG_OFF;
-								}
+								SLOT->volume = MAX_ATT_INDEX;
+								SLOT->state = EG_OFF;
 							}
+						}
 
-							/* recalculate EG output */
-							SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
+						/* recalculate EG output */
+						SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 
-						}
-						break;
 					}
+					break;
 				}
-
-				/* next slot */
-				SLOT++;
 			}
-			while (--j);
 
-			/* next channel */
-			channel++;
+			/* next slot */
+			SLOT++;
 		}
-		while (--i);
+		while (--j);
 	}
 
 	/* SSG-EG update process */
 	/* The behavior is based upon Nemesis tests on real hardware */
 	/* This is actually executed before each samples */
-	void YM2612::update_ssg_eg_channels(FM_CH *channel)
+	void YM2612::update_ssg_eg_channel(FM_CH *channel)
 	{
-		unsigned int i = 6; /* six channels */
-		unsigned int j;
-		FM_SLOT *SLOT;
+		unsigned int j = 4; /* four operators per channel */
+		FM_SLOT *SLOT = &channel->SLOT[SLOT1];
 
 		do
 		{
-			j = 4; /* four operators per channel */
-			SLOT = &channel->SLOT[SLOT1];
-
-			do
+			/* detect SSG-EG transition */
+			/* this is not required during release phase as the attenuation has been forced to MAX and output invert flag is not used */
+			/* if an Attack Phase is programmed, inversion can occur on each sample */
+			if ((SLOT->ssg & 0x08) && (SLOT->volume >= 0x200) && (SLOT->state > EG_REL))
 			{
-				/* detect SSG-EG transition */
-				/* this is not required during release phase as the attenuation has been forced to MAX and output invert flag is not used */
-				/* if an Attack Phase is programmed, inversion can occur on each sample */
-				if ((SLOT->ssg & 0x08) && (SLOT->volume >= 0x200) && (SLOT->state > EG_REL))
+				if (SLOT->ssg & 0x01)  /* bit 0 = hold SSG-EG */
 				{
-					if (SLOT->ssg & 0x01)  /* bit 0 = hold SSG-EG */
-					{
-						/* set inversion flag */
-						if (SLOT->ssg & 0x02)
-							SLOT->ssgn = 4;
+					/* set inversion flag */
+					if (SLOT->ssg & 0x02)
+						SLOT->ssgn = 4;
 
-						/* force attenuation level during decay phases */
-						if ((SLOT->state != EG_ATT) && !(SLOT->ssgn ^ (SLOT->ssg & 0x04)))
-							SLOT->volume = MAX_ATT_INDEX;
-					}
-					else  /* loop SSG-EG */
+					/* force attenuation level during decay phases */
+					if ((SLOT->state != EG_ATT) && !(SLOT->ssgn ^ (SLOT->ssg & 0x04)))
+						SLOT->volume = MAX_ATT_INDEX;
+				}
+				else  /* loop SSG-EG */
+				{
+					/* toggle output inversion flag or reset Phase Generator */
+					if (SLOT->ssg & 0x02)
+						SLOT->ssgn ^= 4;
+					else
+						SLOT->phase = 0;
+
+					/* same as Key ON */
+					if (SLOT->state != EG_ATT)
 					{
-						/* toggle output inversion flag or reset Phase Generator */
-						if (SLOT->ssg & 0x02)
-							SLOT->ssgn ^= 4;
+						if ((SLOT->ar + SLOT->ksr) < 94 /*32+62*/)
+						{
+							SLOT->state = (SLOT->volume <= MIN_ATT_INDEX) ? ((SLOT->sl == MIN_ATT_INDEX) ? EG_SUS : EG_DEC) : EG_ATT;
+						}
 						else
-							SLOT->phase = 0;
-
-						/* same as Key ON */
-						if (SLOT->state != EG_ATT)
 						{
-							if ((SLOT->ar + SLOT->ksr) < 94 /*32+62*/)
-							{
-								SLOT->state = (SLOT->volume <= MIN_ATT_INDEX) ? ((SLOT->sl == MIN_ATT_INDEX) ? EG_SUS : EG_DEC) : EG_ATT;
-							}
-							else
-							{
-								/* Attack Rate is maximal: directly switch to Decay or Substain */
-								SLOT->volume = MIN_ATT_INDEX;
-								SLOT->state = (SLOT->sl == MIN_ATT_INDEX) ? EG_SUS : EG_DEC;
-							}
+							/* Attack Rate is maximal: directly switch to Decay or Substain */
+							SLOT->volume = MIN_ATT_INDEX;
+							SLOT->state = (SLOT->sl == MIN_ATT_INDEX) ? EG_SUS : EG_DEC;
 						}
 					}
-
-					/* recalculate EG output */
-					if (SLOT->ssgn ^ (SLOT->ssg & 0x04))
-						SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
-					else
-						SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 				}
 
-				/* next slot */
-				SLOT++;
+				/* recalculate EG output */
+				if (SLOT->ssgn ^ (SLOT->ssg & 0x04))
+					SLOT->vol_out = ((uint32)(0x200 - SLOT->volume) & MAX_ATT_INDEX) + SLOT->tl;
+				else
+					SLOT->vol_out = (uint32)SLOT->volume + SLOT->tl;
 			}
-			while (--j);
 
-			/* next channel */
-			channel++;
+			/* next slot */
+			SLOT++;
 		}
-		while (--i);
+		while (--j);
 	}
 
-	void YM2612::update_phase_lfo_slot(FM_SLOT *SLOT, int32 pms, uint32 block_fnum)
-	{
-		int32 lfo_fn_table_index_offset = lfo_pm_table[(((block_fnum & 0x7f0) >> 4) << 8) + pms + OPN.LFO_PM];
-
-		if (lfo_fn_table_index_offset)  /* LFO phase modulation active */
-		{
-			uint8 blk;
-			unsigned int kc, fc;
-
-			/* there are 2048 FNUMs that can be generated using FNUM/BLK registers
-				  but LFO works with one more bit of a precision so we really need 4096 elements */
-			block_fnum = block_fnum * 2 + lfo_fn_table_index_offset;
-			blk = (block_fnum & 0x7000) >> 12;
-			block_fnum = block_fnum & 0xfff;
-
-			/* keyscale code */
-			kc = (blk << 2) | opn_fktable[block_fnum >> 8];
-
-			/* (frequency) phase increment counter */
-			fc = (((block_fnum << 5) >> (7 - blk)) + SLOT->DT[kc]) & DT_MASK;
-
-			/* update phase */
-			SLOT->phase += (fc * SLOT->mul) >> 1;
-		}
-		else  /* LFO phase modulation  = zero */
-		{
-			SLOT->phase += SLOT->Incr;
-		}
-	}
-
-	void YM2612::update_phase_lfo_channel(FM_CH *channel)
+	void YM2612::update_phase_lfo_channel(FM_CH *channel, uint32 lfo_pm)
 	{
 		uint32 block_fnum = channel->block_fnum;
 
-		int32 lfo_fn_table_index_offset = lfo_pm_table[(((block_fnum & 0x7f0) >> 4) << 8) + channel->pms + OPN.LFO_PM];
+		int32 lfo_fn_table_index_offset = lfo_pm_table[(((block_fnum & 0x7f0) >> 4) << 8) + channel->pms + lfo_pm];
 
 		if (lfo_fn_table_index_offset)  /* LFO phase modulation active */
 		{
@@ -1303,85 +1252,173 @@ namespace soundemulation
 		return tl_tab[p];
 	}
 
-	void YM2612::chan_calc(FM_CH *channel, int num)
+	void YM2612::chan_calc(FM_CH *channel, uint32 lfo_am, uint32 lfo_pm)
 	{
-		do
+		uint32 AM = lfo_am >> channel->ams;
+		unsigned int eg_out = volume_calc(&channel->SLOT[SLOT1]);
+
+		m2 = c1 = c2 = mem = 0;
+
+		*channel->mem_connect = channel->mem_value;  /* restore delayed sample (MEM) value to m2 or c2 */
 		{
-			uint32 AM = OPN.LFO_AM >> channel->ams;
-			unsigned int eg_out = volume_calc(&channel->SLOT[SLOT1]);
+			int32 out = channel->op1_out[0] + channel->op1_out[1];
+			channel->op1_out[0] = channel->op1_out[1];
 
-			m2 = c1 = c2 = mem = 0;
+			if (!channel->connect1)
+			{
+				/* algorithm 5  */
+				mem = c1 = c2 = channel->op1_out[0];
+			}
+			else
+			{
+				/* other algorithms */
+				*channel->connect1 += channel->op1_out[0];
+			}
 
-			*channel->mem_connect = channel->mem_value;  /* restore delayed sample (MEM) value to m2 or c2 */
+			channel->op1_out[1] = 0;
+			if (eg_out < ENV_QUIET)  /* SLOT 1 */
 			{
-				int32 out = channel->op1_out[0] + channel->op1_out[1];
-				channel->op1_out[0] = channel->op1_out[1];
+				if (!channel->FB)
+					out = 0;
 
-				if (!channel->connect1)
-				{
-					/* algorithm 5  */
-					mem = c1 = c2 = channel->op1_out[0];
-				}
-				else
-				{
-					/* other algorithms */
-					*channel->connect1 += channel->op1_out[0];
-				}
+				channel->op1_out[1] = op_calc1(channel->SLOT[SLOT1].phase, eg_out, (out << channel->FB));
+			}
+		}
 
-				channel->op1_out[1] = 0;
-				if (eg_out < ENV_QUIET)  /* SLOT 1 */
-				{
-					if (!channel->FB)
-						out = 0;
+		eg_out = volume_calc(&channel->SLOT[SLOT3]);
+		if (eg_out < ENV_QUIET)    /* SLOT 3 */
+			*channel->connect3 += op_calc(channel->SLOT[SLOT3].phase, eg_out, m2);
 
-					channel->op1_out[1] = op_calc1(channel->SLOT[SLOT1].phase, eg_out, (out << channel->FB));
-				}
-			}
+		eg_out = volume_calc(&channel->SLOT[SLOT2]);
+		if (eg_out < ENV_QUIET)    /* SLOT 2 */
+			*channel->connect2 += op_calc(channel->SLOT[SLOT2].phase, eg_out, c1);
+
+		eg_out = volume_calc(&channel->SLOT[SLOT4]);
+		if (eg_out < ENV_QUIET)    /* SLOT 4 */
+			*channel->connect4 += op_calc(channel->SLOT[SLOT4].phase, eg_out, c2);
+
+
+		/* store current MEM */
+		channel->mem_value = mem;
+
+		/* update phase counters AFTER output calculations */
+		/* note that 3 slot mode uses the channel's block_fnum for LFO PM as well, like it always did here */
+		if (channel->pms)
+		{
+			update_phase_lfo_channel(channel, lfo_pm);
+		}
+		else  /* no LFO phase modulation */
+		{
+			channel->SLOT[SLOT1].phase += channel->SLOT[SLOT1].Incr;
+			channel->SLOT[SLOT2].phase += channel->SLOT[SLOT2].Incr;
+			channel->SLOT[SLOT3].phase += channel->SLOT[SLOT3].Incr;
+			channel->SLOT[SLOT4].phase += channel->SLOT[SLOT4].Incr;
+		}
+	}
 
-			eg_out = volume_calc(&channel->SLOT[SLOT3]);
-			if (eg_out < ENV_QUIET)    /* SLOT 3 */
-				*channel->connect3 += op_calc(channel->SLOT[SLOT3].phase, eg_out, m2);
+	/* check if a channel can't produce any output until its next key on or register write */
+	bool YM2612::is_channel_silent(const FM_CH *channel)
+	{
+		/* pending feedback or delayed samples still need to get flushed */
+		if (channel->op1_out[0] || channel->op1_out[1] || channel->mem_value)
+			return false;
 
-			eg_out = volume_calc(&channel->SLOT[SLOT2]);
-			if (eg_out < ENV_QUIET)    /* SLOT 2 */
-				*channel->connect2 += op_calc(channel->SLOT[SLOT2].phase, eg_out, c1);
+		for (int s = 0; s < 4; ++s)
+		{
+			/* EG_OFF means neither SSG-EG nor envelope generator will touch the slot's volume */
+			const FM_SLOT& SLOT = channel->SLOT[s];
+			if (SLOT.state != EG_OFF || SLOT.vol_out < ENV_QUIET)
+				return false;
+		}
+		return true;
+	}
 
-			eg_out = volume_calc(&channel->SLOT[SLOT4]);
-			if (eg_out < ENV_QUIET)    /* SLOT 4 */
-				*channel->connect4 += op_calc(channel->SLOT[SLOT4].phase, eg_out, c2);
+	/* precalculate LFO and envelope generator timing for the next block of samples */
+	void YM2612::prepare_block(int length)
+	{
+		block.eg_ticks = 0;
+		for (int i = 0; i < length; i++)
+		{
+			block.lfo_am[i] = OPN.LFO_AM;
+			block.lfo_pm[i] = OPN.LFO_PM;
 
+			/* advance LFO */
+			advance_lfo();
 
-			/* store current MEM */
-			channel->mem_value = mem;
+			/* advance envelope generator */
+			OPN.eg_timer++;
 
-			/* update phase counters AFTER output calculations */
-			if (channel->pms)
+			/* EG is updated every 3 samples */
+			if (OPN.eg_timer >= 3)
 			{
-				/* add support for 3 slot mode */
-				if ((OPN.ST.mode & 0xC0) && (channel == &channel[2]))
+				OPN.eg_timer = 0;
+				OPN.eg_cnt++;
+				block.eg_tick_sample[block.eg_ticks] = (uint8)i;
+				block.eg_tick_cnt[block.eg_ticks] = OPN.eg_cnt;
+				++block.eg_ticks;
+			}
+		}
+	}
+
+	/* render a whole block of samples for a single channel */
+	void YM2612::render_channel_block(FM_CH *channel, int ch, bool calc, int length)
+	{
+		int32* output = block.out[ch];
+
+		if (is_channel_silent(channel))
+		{
+			/* only the phase counters are running, as with chan_calc */
+			if (calc)
+			{
+				if (channel->pms)
 				{
-					update_phase_lfo_slot(&channel->SLOT[SLOT1], channel->pms, OPN.SL3.block_fnum[1]);
-					update_phase_lfo_slot(&channel->SLOT[SLOT2], channel->pms, OPN.SL3.block_fnum[2]);
-					update_phase_lfo_slot(&channel->SLOT[SLOT3], channel->pms, OPN.SL3.block_fnum[0]);
-					update_phase_lfo_slot(&channel->SLOT[SLOT4], channel->pms, channel->block_fnum);
+					for (int i = 0; i < length; i++)
+						update_phase_lfo_channel(channel, block.lfo_pm[i]);
 				}
 				else
 				{
-					update_phase_lfo_channel(channel);
+					channel->SLOT[SLOT1].phase += (uint32)channel->SLOT[SLOT1].Incr * (uint32)length;
+					channel->SLOT[SLOT2].phase += (uint32)channel->SLOT[SLOT2].Incr * (uint32)length;
+					channel->SLOT[SLOT3].phase += (uint32)channel->SLOT[SLOT3].Incr * (uint32)length;
+					channel->SLOT[SLOT4].phase += (uint32)channel->SLOT[SLOT4].Incr * (uint32)length;
 				}
 			}
-			else  /* no LFO phase modulation */
+
+			const int32 value = calc ? 0 : ((dacout > 8192) ? 8192 : (dacout < -8192) ? -8192 : dacout);
+			for (int i = 0; i < length; i++)
+				output[i] = value;
+			return;
+		}
+
+		int tick = 0;
+		for (int i = 0; i < length; i++)
+		{
+			/* update SSG-EG output */
+			update_ssg_eg_channel(channel);
+
+			/* calculate FM */
+			if (calc)
+			{
+				out_fm[ch] = 0;
+				chan_calc(channel, block.lfo_am[i], block.lfo_pm[i]);
+			}
+			else
 			{
-				channel->SLOT[SLOT1].phase += channel->SLOT[SLOT1].Incr;
-				channel->SLOT[SLOT2].phase += channel->SLOT[SLOT2].Incr;
-				channel->SLOT[SLOT3].phase += channel->SLOT[SLOT3].Incr;
-				channel->SLOT[SLOT4].phase += channel->SLOT[SLOT4].Incr;
+				/* DAC Mode */
+				out_fm[ch] = dacout;
 			}
 
-			/* next channel */
-			channel++;
+			/* advance envelope generator */
+			if (tick < block.eg_ticks && block.eg_tick_sample[tick] == i)
+			{
+				advance_eg_channel(channel, block.eg_tick_cnt[tick]);
+				++tick;
+			}
+
+			/* 14-bit accumulator channels outputs (range is -8192;+8192) */
+			const int32 out = out_fm[ch];
+			output[i] = (out > 8192) ? 8192 : (out < -8192) ? -8192 : out;
 		}
-		while (--num);
 	}
 
 	/* write a OPN mode register 0x20-0x2f */
@@ -1864,8 +1901,6 @@ namespace soundemulation
 	/* Generate samples for ym2612 */
 	void YM2612::update(int *buffer, int length)
 	{
-		int lt, rt;
-
 		/* refresh PG increments and EG rates if required */
 		refresh_fc_eg_chan(&mChannels[0]);
 		refresh_fc_eg_chan(&mChannels[1]);
@@ -1890,6 +1925,64 @@ namespace soundemulation
 		refresh_fc_eg_chan(&mChannels[4]);
 		refresh_fc_eg_chan(&mChannels[5]);
 
+		/* CSM mode key on / off can happen in the middle of the buffer, which needs sample by sample processing of all channels */
+		if ((OPN.ST.mode & 0xC0) == 0x80 || OPN.SL3.key_csm)
+		{
+			update_per_sample(buffer, length);
+		}
+		else
+		{
+			update_blocks(buffer, length);
+		}
+
+		/* timer B control */
+		INTERNAL_TIMER_B(length);
+	}
+
+	/* Generate samples channel by channel in blocks; this has to produce exactly the same output as "update_per_sample" */
+	void YM2612::update_blocks(int *buffer, int length)
+	{
+		while (length > 0)
+		{
+			const int blockLength = std::min(length, BLOCK_SAMPLES);
+
+			/* precalculate what's shared between all channels */
+			prepare_block(blockLength);
+
+			/* render channels independently */
+			for (int ch = 0; ch < 6; ++ch)
+			{
+				render_channel_block(&mChannels[ch], ch, (ch < 5 || !dacen), blockLength);
+			}
+
+			/* stereo DAC channels outputs mixing  */
+			for (int i = 0; i < blockLength; i++)
+			{
+				int lt = 0;
+				int rt = 0;
+				for (int ch = 0; ch < 6; ++ch)
+				{
+					lt += (block.out[ch][i] & OPN.pan[ch * 2]);
+					rt += (block.out[ch][i] & OPN.pan[ch * 2 + 1]);
+				}
+
+				/* buffering */
+				*buffer++ = lt;
+				*buffer++ = rt;
+
+				/* timer A control (CSM mode is not active here, so this can't trigger any key on) */
+				INTERNAL_TIMER_A();
+			}
+
+			length -= blockLength;
+		}
+	}
+
+	/* Generate samples sample by sample, processing all channels for each */
+	void YM2612::update_per_sample(int *buffer, int length)
+	{
+		int lt, rt;
+
 		/* buffering */
 		for (int i = 0; i < length; i++)
 		{
@@ -1902,18 +1995,18 @@ namespace soundemulation
 			out_fm[5] = 0;
 
 			/* update SSG-EG output */
-			update_ssg_eg_channels(&mChannels[0]);
+			for (int ch = 0; ch < 6; ++ch)
+				update_ssg_eg_channel(&mChannels[ch]);
 
 			/* calculate FM */
-			if (!dacen)
-			{
-				chan_calc(&mChannels[0], 6);
-			}
-			else
+			const int numChannels = dacen ? 5 : 6;
+			for (int ch = 0; ch < numChannels; ++ch)
+				chan_calc(&mChannels[ch], OPN.LFO_AM, OPN.LFO_PM);
+
+			if (dacen)
 			{
 				/* DAC Mode */
 				out_fm[5] = dacout;
-				chan_calc(&mChannels[0], 5);
 			}
 
 			/* advance LFO */
@@ -1927,7 +2020,8 @@ namespace soundemulation
 			{
 				OPN.eg_timer = 0;
 				OPN.eg_cnt++;
-				advance_eg_channels(&mChannels[0], OPN.eg_cnt);
+				for (int ch = 0; ch < 6; ++ch)
+					advance_eg_channel(&mChannels[ch], OPN.eg_cnt);
 			}
 
 			/* 14-bit accumulator channels outputs (range is -8192;+8192) */
@@ -1980,9 +2074,6 @@ namespace soundemulation
 				OPN.SL3.key_csm = 0;
 			}
 		}
-
-		/* timer B control */
-		INTERNAL_TIMER_B(length);
 	}
 
 	void YM2612::config(unsigned char dac_bits)
@@ -147,6 +147,18 @@ namespace soundemulation
 			uint32  LFO_PM;             /* current LFO PM step */
 		};
 
+		/* Block rendering state */
+		static const constexpr int BLOCK_SAMPLES = 64;
+		struct FM_BLOCK
+		{
+			uint32  lfo_am[BLOCK_SAMPLES];              /* LFO AM step for each sample in the block */
+			uint32  lfo_pm[BLOCK_SAMPLES];              /* LFO PM step for each sample in the block */
+			uint32  eg_tick_cnt[BLOCK_SAMPLES / 3 + 1]; /* envelope generator counter for each EG update in the block */
+			uint8   eg_tick_sample[BLOCK_SAMPLES / 3 + 1]; /* sample index after which each EG update happens */
+			int     eg_ticks;                           /* number of EG updates in the block */
+			int32   out[6][BLOCK_SAMPLES];              /* clipped channel outputs */
+		};
+
 	private:
 		void FM_KEYON(FM_CH *CH, int s);
 		void FM_KEYOFF(FM_CH *CH, int s);
@@ -164,13 +176,17 @@ namespace soundemulation
 		void set_sr(FM_SLOT *SLOT, int v);
 		void set_sl_rr(FM_SLOT *SLOT, int v);
 		void advance_lfo();
-		void advance_eg_channels(FM_CH *CH, unsigned int eg_cnt);
-		void update_ssg_eg_channels(FM_CH *CH);
-		void update_phase_lfo_slot(FM_SLOT *SLOT, int32 pms, uint32 block_fnum);
-		void update_phase_lfo_channel(FM_CH *CH);
+		void advance_eg_channel(FM_CH *CH, unsigned int eg_cnt);
+		void update_ssg_eg_channel(FM_CH *CH);
+		void update_phase_lfo_channel(FM_CH *CH, uint32 lfo_pm);
 		void refresh_fc_eg_slot(FM_SLOT *SLOT, unsigned int fc, unsigned int kc);
 		void refresh_fc_eg_chan(FM_CH *CH);
-		void chan_calc(FM_CH *CH, int num);
+		void chan_calc(FM_CH *CH, uint32 lfo_am, uint32 lfo_pm);
+		void update_per_sample(int *buffer, int length);
+		void update_blocks(int *buffer, int length);
+		void prepare_block(int length);
+		void render_channel_block(FM_CH *CH, int ch, bool calc, int length);
+		static bool is_channel_silent(const FM_CH *CH);
 		void OPNWriteMode(int r, int v);
 		void OPNWriteReg(int r, int v);
 		static void reset_channels(FM_CH *CH, int num);
@@ -186,5 +202,6 @@ namespace soundemulation
 		int32  mem;        /* one sample delay memory */
 		int32  out_fm[8];  /* outputs of working channels */
 		uint32 bitmask;    /* working channels output bitmasking (DAC quantization) */
+		FM_BLOCK block;    /* block rendering state */
 	};
 }
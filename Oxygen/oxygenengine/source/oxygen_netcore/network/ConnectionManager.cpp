@@ -10,6 +10,7 @@
 #include "oxygen_netcore/network/ConnectionManager.h"
 #include "oxygen_netcore/network/LowLevelPackets.h"
 #include "oxygen_netcore/network/NetConnection.h"
+#include "oxygen_netcore/network/internal/UDPReceiveThread.h"
 #include "oxygen_netcore/network/internal/WebSocketWrapper.h"
 
 
@@ -24,6 +25,20 @@ ConnectionManager::ConnectionManager(UDPSocket* udpSocket, TCPSocket* tcpListenS
 	mBitmaskForActiveConnectionsLookup = (uint16)(mActiveConnectionsLookup.size() - 1);
 }
 
+ConnectionManager::~ConnectionManager()
+{
+	stopReceiveThread();
+}
+
+void ConnectionManager::stopReceiveThread()
+{
+	if (nullptr != mUDPReceiveThread)
+	{
+		delete mUDPReceiveThread;		// This joins the thread
+		mUDPReceiveThread = nullptr;
+	}
+}
+
 void ConnectionManager::updateConnections(uint64 currentTimestamp)
 {
 	for (NetConnection* connection : mActiveConnectionsLookup)
@@ -43,6 +58,32 @@ bool ConnectionManager::updateReceivePackets()
 	// Update UDP
 	if (nullptr != mUDPSocket)
 	{
+		if (nullptr == mUDPReceiveThread && mUDPSocket->isValid() && UDPReceiveThread::isSupported())
+		{
+			mUDPReceiveThread = new UDPReceiveThread(*mUDPSocket);
+			mUDPReceiveThread->start();
+		}
+	}
+
+	if (nullptr != mUDPReceiveThread)
+	{
+		// Evaluate all datagrams the worker thread received in the meantime
+		while (UDPSocket::ReceiveResult* received = mUDPReceiveThread->peekReceived())
+		{
+			anyActivity = true;
+			receivedPacketInternal(received->mBuffer, received->mSenderAddress, nullptr);
+			mUDPReceiveThread->popReceived();
+		}
+
+		if (mUDPReceiveThread->fetchReceiveFailed())
+		{
+			// The worker thread keeps on receiving, so this only fails the current update
+			return false;
+		}
+	}
+	else if (nullptr != mUDPSocket)
+	{
+		// Fallback without a worker thread: Poll the socket directly
 		for (int runs = 0; runs < 10; ++runs)
 		{
 			// Receive next packet
@@ -130,8 +171,7 @@ bool ConnectionManager::updateReceivePackets()
 
 void ConnectionManager::syncPacketQueues()
 {
-	// TODO: Lock mutex, so the worker thread stops briefly
-	//  -> This is needed for the worker queue, and also for the "mReceivedPacketPool"
+	// Note that the UDP receive thread only deals with raw datagrams, so the queues and the "mReceivedPacketPool" are only ever accessed by the main thread
 
 	// First sync queues
 	{
@@ -150,8 +190,6 @@ void ConnectionManager::syncPacketQueues()
 		}
 		mReceivedPackets.mToBeReturned.mPackets.clear();
 	}
-
-	// TODO: Mutex can be unlocked here
 }
 
 ReceivedPacket* ConnectionManager::getNextReceivedPacket()
@@ -171,14 +209,12 @@ ReceivedPacket* ConnectionManager::getNextReceivedPacket()
 
 bool ConnectionManager::sendUDPPacketData(const std::vector<uint8>& data, const SocketAddress& remoteAddress)
 {
-#ifdef DEBUG
 	// Simulate packet loss
 	if (mDebugSettings.mSendingPacketLoss > 0.0f && randomf() < mDebugSettings.mSendingPacketLoss)
 	{
 		// Act as if the packet was sent successfully
 		return true;
 	}
-#endif
 
 	RMX_ASSERT(nullptr != mUDPSocket, "No UDP socket set");
 	return mUDPSocket->sendData(data, remoteAddress);
@@ -186,14 +222,12 @@ bool ConnectionManager::sendUDPPacketData(const std::vector<uint8>& data, const
 
 bool ConnectionManager::sendTCPPacketData(const std::vector<uint8>& data, TCPSocket& socket, bool isWebSocketServer)
 {
-#ifdef DEBUG
 	// Simulate packet loss
 	if (mDebugSettings.mSendingPacketLoss > 0.0f && randomf() < mDebugSettings.mSendingPacketLoss)
 	{
 		// Act as if the packet was sent successfully
 		return true;
 	}
-#endif
 
 	if (isWebSocketServer)
 	{
@@ -275,17 +309,15 @@ SentPacket& ConnectionManager::rentSentPacket()
 	return sentPacket;
 }
 
-void ConnectionManager::receivedPacketInternal(const std::vector<uint8>& buffer, const SocketAddress& senderAddress, NetConnection* connection)
+void ConnectionManager::receivedPacketInternal(std::vector<uint8>& buffer, const SocketAddress& senderAddress, NetConnection* connection)
 {
 	// Ignore too small packets
 	if (buffer.size() < 6)
 		return;
 
-#ifdef DEBUG
 	// Simulate packet loss
 	if (mDebugSettings.mReceivingPacketLoss > 0.0f && randomf() < mDebugSettings.mReceivingPacketLoss)
 		return;
-#endif
 
 	// Received a packet, check its signature
 	VectorBinarySerializer serializer(true, buffer);
@@ -294,7 +326,7 @@ void ConnectionManager::receivedPacketInternal(const std::vector<uint8>& buffer,
 	{
 		// Store for later evaluation
 		ReceivedPacket& receivedPacket = mReceivedPacketPool.rentObject();
-		receivedPacket.mContent = buffer;
+		receivedPacket.mContent.swap(buffer);
 		receivedPacket.mLowLevelSignature = lowLevelSignature;
 		receivedPacket.mSenderAddress = senderAddress;
 		receivedPacket.mConnection = connection;
@@ -348,7 +380,7 @@ void ConnectionManager::receivedPacketInternal(const std::vector<uint8>& buffer,
 				{
 					// Store for later evaluation
 					ReceivedPacket& receivedPacket = mReceivedPacketPool.rentObject();
-					receivedPacket.mContent = buffer;
+					receivedPacket.mContent.swap(buffer);
 					receivedPacket.mLowLevelSignature = lowLevelSignature;
 					receivedPacket.mSenderAddress = senderAddress;
 					receivedPacket.mConnection = connection;
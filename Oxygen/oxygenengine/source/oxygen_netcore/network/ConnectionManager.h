@@ -17,6 +17,7 @@ namespace lowlevel
 	struct PacketBase;
 }
 struct ConnectionListenerInterface;
+class UDPReceiveThread;
 
 
 class ConnectionManager
@@ -24,7 +25,7 @@ class ConnectionManager
 friend class NetConnection;
 
 public:
-	struct DebugSettings
+	struct DebugSettings	// These are available in all builds, e.g. for load tests with simulated packet loss
 	{
 		float mSendingPacketLoss = 0.0f;	// Fraction of "lost" packets in sending
 		float mReceivingPacketLoss = 0.0f;	// Fraction of "lost" packets in receiving
@@ -33,6 +34,7 @@ public:
 
 public:
 	ConnectionManager(UDPSocket* udpSocket, TCPSocket* tcpListenSocket, ConnectionListenerInterface& listener, VersionRange<uint8> highLevelProtocolVersionRange);
+	~ConnectionManager();
 
 	inline bool hasUDPSocket() const			  { return (nullptr != mUDPSocket); }
 	inline UDPSocket* getUDPSocket() const		  { return mUDPSocket; }
@@ -44,7 +46,8 @@ public:
 	inline VersionRange<uint8> getHighLevelProtocolVersionRange() const  { return mHighLevelProtocolVersionRange; }
 
 	void updateConnections(uint64 currentTimestamp);
-	bool updateReceivePackets();	// TODO: This is meant to be executed by a thread later on
+	bool updateReceivePackets();	// UDP datagrams get received by a worker thread where supported, but all evaluation happens here on the main thread
+	void stopReceiveThread();		// Must be called before shutting down sockets; the next "updateReceivePackets" call restarts the thread
 
 	void syncPacketQueues();
 
@@ -65,7 +68,7 @@ protected:
 	SentPacket& rentSentPacket();
 
 	// Internal
-	void receivedPacketInternal(const std::vector<uint8>& buffer, const SocketAddress& senderAddress, NetConnection* connection);
+	void receivedPacketInternal(std::vector<uint8>& buffer, const SocketAddress& senderAddress, NetConnection* connection);	// Note that the buffer's contents may get swapped out
 	uint16 getFreeLocalConnectionID();
 
 private:
@@ -79,6 +82,7 @@ private:
 private:
 	UDPSocket* mUDPSocket = nullptr;		// Only set if UDP is used (or both UDP and TCP)
 	TCPSocket* mTCPListenSocket = nullptr;	// Only set if TCP is used (or both UDP and TCP)
+	UDPReceiveThread* mUDPReceiveThread = nullptr;	// Only created once the UDP socket is valid, and if threads are supported at all
 	ConnectionListenerInterface& mListener;
 	VersionRange<uint8> mHighLevelProtocolVersionRange = { 1, 1 };
 
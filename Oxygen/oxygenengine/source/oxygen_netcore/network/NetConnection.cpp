@@ -198,6 +198,7 @@ void NetConnection::updateConnection(uint64 currentTimestamp)
 		{
 			sendPacketInternal(sentPacket->mContent);
 		}
+		mStatistics.mPacketsResent += mPacketsToResend.size();
 
 		// Updates that need to be called only every second
 		if (mCurrentTimestamp >= mLast1000msUpdate + 1000)
@@ -286,6 +287,7 @@ void NetConnection::handleLowLevelPacket(ReceivedPacket& receivedPacket)
 	// Reset timeout whenever any packet got received
 	mTimeoutStart = mCurrentTimestamp;
 	mLastMessageReceivedTimestamp = mCurrentTimestamp;	// TODO: It would be nice to use the actual timestamp of receiving the packet here, which happened previously already
+	++mStatistics.mPacketsReceived;
 
 	VectorBinarySerializer serializer(true, receivedPacket.mContent);
 	serializer.skip(6);		// Skip low level signature and connection IDs, they got evaluated already
@@ -389,7 +391,8 @@ bool NetConnection::receivedWebSocketPacket(const std::vector<uint8>& content)
 	if (nullptr == mConnectionManager)
 		return false;
 
-	mConnectionManager->receivedPacketInternal(content, mRemoteAddress, this);
+	std::vector<uint8> buffer = content;	// Copy needed, as the buffer gets swapped into the received packet
+	mConnectionManager->receivedPacketInternal(buffer, mRemoteAddress, this);
 	return true;
 }
 
@@ -424,6 +427,7 @@ bool NetConnection::sendPacketInternal(const std::vector<uint8>& content)
 		return false;
 
 	mLastMessageSentTimestamp = mCurrentTimestamp;
+	++mStatistics.mPacketsSent;
 
 	switch (mSocketType)
 	{
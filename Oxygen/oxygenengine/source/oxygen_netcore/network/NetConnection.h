@@ -61,6 +61,13 @@ public:
 		WEB_SOCKET		// Emscripten web socket usage, used only on client side
 	};
 
+	struct Statistics
+	{
+		uint64 mPacketsSent = 0;		// All low-level packets sent, including resends
+		uint64 mPacketsResent = 0;		// Resends of reliable packets that did not get confirmed in time
+		uint64 mPacketsReceived = 0;	// All low-level packets received for this connection
+	};
+
 public:
 	static uint64 buildSenderKey(const SocketAddress& remoteAddress, uint16 remoteConnectionID);
 
@@ -75,6 +82,7 @@ public:
 	inline uint16 getRemoteConnectionID() const { return mRemoteConnectionID; }
 	inline const SocketAddress& getRemoteAddress() const  { return mRemoteAddress; }
 	inline uint64 getSenderKey() const			{ return mSenderKey; }
+	inline const Statistics& getStatistics() const  { return mStatistics; }
 
 	UDPSocket* getUDPSocket() const;
 
@@ -150,6 +158,8 @@ private:
 	// Request tracking
 	std::unordered_map<uint32, highlevel::RequestBase*> mOpenRequests;
 
+	Statistics mStatistics;
+
 	// For temporary use (these are members to avoid frequent reallocations)
 	std::vector<uint8> mSendBuffer;
 	std::vector<SentPacket*> mPacketsToResend;
@@ -27,6 +27,8 @@
 	#include <netdb.h>  // Needed for getaddrinfo() and freeaddrinfo()
 	#include <unistd.h> // Needed for close()
 	#include <fcntl.h>	// For fcntl(), obviously
+	#include <poll.h>
+	#include <errno.h>
 
 	#define SOCKET int
 	#define INVALID_SOCKET -1
@@ -321,7 +323,7 @@ bool TCPSocket::acceptConnection(TCPSocket& outSocket)
 	timeval timeout;
 	timeout.tv_sec = 0;
 	timeout.tv_usec = 1000;
-	const int result = ::select(0, &socketSet, nullptr, nullptr, &timeout);
+	const int result = ::select((int)mInternal->mSocket + 1, &socketSet, nullptr, nullptr, &timeout);	// First parameter is ignored on Windows, but not on POSIX systems
 	if (result < 0)
 	{
 	#ifdef _WIN32
@@ -738,6 +740,105 @@ bool UDPSocket::receiveNonBlocking(ReceiveResult& outReceiveResult)
 	return true;
 }
 
+bool UDPSocket::waitForData(int timeoutMilliseconds)
+{
+	if (!isValid())
+		return false;
+
+#ifdef _WIN32
+	WSAPOLLFD pollFD = {};
+	pollFD.fd = mInternal->mSocket;
+	pollFD.events = POLLRDNORM;
+	return (::WSAPoll(&pollFD, 1, timeoutMilliseconds) > 0);
+#else
+	pollfd pollFD = {};
+	pollFD.fd = mInternal->mSocket;
+	pollFD.events = POLLIN;
+	return (::poll(&pollFD, 1, timeoutMilliseconds) > 0);
+#endif
+}
+
+bool UDPSocket::receiveMultipleNonBlocking(ReceiveResult* outReceiveResults, size_t maxCount, size_t& outCount)
+{
+	outCount = 0;
+	if (!isValid())
+		return false;
+
+	// Note that buffers only get resized if needed, so that buffers reused for receiving don't get cleared each time
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+	// Receive a whole batch of datagrams with a single system call
+	const constexpr size_t MAX_BATCH_SIZE = 16;
+	const size_t batchSize = std::min(maxCount, MAX_BATCH_SIZE);
+	mmsghdr messages[MAX_BATCH_SIZE];
+	iovec ioVectors[MAX_BATCH_SIZE];
+	for (size_t k = 0; k < batchSize; ++k)
+	{
+		ReceiveResult& receiveResult = outReceiveResults[k];
+		if (receiveResult.mBuffer.size() != MAX_DATAGRAM_SIZE)
+			receiveResult.mBuffer.resize(MAX_DATAGRAM_SIZE);
+
+		ioVectors[k].iov_base = &receiveResult.mBuffer[0];
+		ioVectors[k].iov_len = MAX_DATAGRAM_SIZE;
+		memset(&messages[k], 0, sizeof(mmsghdr));
+		messages[k].msg_hdr.msg_name = receiveResult.mSenderAddress.accessSockAddr();
+		messages[k].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+		messages[k].msg_hdr.msg_iov = &ioVectors[k];
+		messages[k].msg_hdr.msg_iovlen = 1;
+	}
+
+	const int result = ::recvmmsg(mInternal->mSocket, messages, (unsigned int)batchSize, MSG_DONTWAIT, nullptr);
+	if (result < 0)
+	{
+		// Not having any data is not an error
+		return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+	}
+
+	for (int k = 0; k < result; ++k)
+	{
+		outReceiveResults[k].mBuffer.resize(messages[k].msg_len);
+		outReceiveResults[k].mSenderAddress.onSockAddrSet();
+	}
+	outCount = (size_t)result;
+	return true;
+
+#else
+	while (outCount < maxCount)
+	{
+	#ifdef _WIN32
+		// Check if there's pending data at all, as the socket might be a blocking one
+		uint32 pendingDataSize = 0;
+		if (::ioctlsocket(mInternal->mSocket, FIONREAD, (u_long*)(&pendingDataSize)) != 0 || pendingDataSize == 0)
+			break;
+		const int flags = 0;
+	#else
+		const int flags = MSG_DONTWAIT;
+	#endif
+
+		ReceiveResult& receiveResult = outReceiveResults[outCount];
+		if (receiveResult.mBuffer.size() != MAX_DATAGRAM_SIZE)
+			receiveResult.mBuffer.resize(MAX_DATAGRAM_SIZE);
+
+		sockaddr_storage& senderAddr = *reinterpret_cast<sockaddr_storage*>(receiveResult.mSenderAddress.accessSockAddr());
+		socklen_t senderAddrSize = sizeof(sockaddr_storage);
+		const int result = ::recvfrom(mInternal->mSocket, (char*)&receiveResult.mBuffer[0], (int)MAX_DATAGRAM_SIZE, flags, (sockaddr*)&senderAddr, &senderAddrSize);
+		if (result < 0)
+		{
+		#ifdef _WIN32
+			const int errorCode = WSAGetLastError();
+			return (errorCode == WSAECONNRESET || errorCode == WSAEWOULDBLOCK);		// See "receiveInternal" for WSAECONNRESET
+		#else
+			return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+		#endif
+		}
+
+		receiveResult.mBuffer.resize(result);
+		receiveResult.mSenderAddress.onSockAddrSet();
+		++outCount;
+	}
+	return true;
+#endif
+}
+
 bool UDPSocket::receiveInternal(ReceiveResult& outReceiveResult)
 {
 	size_t bytesRead = 0;
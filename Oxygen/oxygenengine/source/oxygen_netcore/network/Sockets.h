@@ -171,6 +171,10 @@ public:
 	bool receiveBlocking(ReceiveResult& outReceiveResult);
 	bool receiveNonBlocking(ReceiveResult& outReceiveResult);
 
+	// Meant to be used by a dedicated receive thread: wait for incoming data (or an error to report), then receive as many datagrams as are pending and fit into the given results
+	bool waitForData(int timeoutMilliseconds);
+	bool receiveMultipleNonBlocking(ReceiveResult* outReceiveResults, size_t maxCount, size_t& outCount);
+
 private:
 	bool receiveInternal(ReceiveResult& outReceiveResult);
 
@@ -18,10 +18,11 @@ ReceivedPacketCache::~ReceivedPacketCache()
 
 void ReceivedPacketCache::clear()
 {
-	// Remove references to all received packets still in the queue
+	// Remove references to all received packets still in the queue, which can have gaps for packets not received yet
 	for (CacheItem& item : mQueue)
 	{
-		item.mReceivedPacket->decReferenceCounter();
+		if (nullptr != item.mReceivedPacket)
+			item.mReceivedPacket->decReferenceCounter();
 	}
 	mQueue.clear();
 	mLastExtractedUniquePacketID = 0;
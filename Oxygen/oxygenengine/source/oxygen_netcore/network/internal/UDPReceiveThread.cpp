@@ -0,0 +1,113 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen_netcore/pch.h"
+#include "oxygen_netcore/network/internal/UDPReceiveThread.h"
+
+
+bool UDPReceiveThread::isSupported()
+{
+#if defined(__EMSCRIPTEN__)
+	return false;
+#else
+	return true;
+#endif
+}
+
+UDPReceiveThread::UDPReceiveThread(UDPSocket& socket) :
+	mSocket(socket)
+{
+}
+
+UDPReceiveThread::~UDPReceiveThread()
+{
+	stop();
+}
+
+void UDPReceiveThread::start()
+{
+	if (mRunning)
+		return;
+
+	mRunning = true;
+	mFailed = false;
+	mThread = std::thread(&UDPReceiveThread::threadFunc, this);
+}
+
+void UDPReceiveThread::stop()
+{
+	if (!mThread.joinable())
+		return;
+
+	mRunning = false;
+	mThread.join();
+}
+
+UDPSocket::ReceiveResult* UDPReceiveThread::peekReceived()
+{
+	const size_t readIndex = mReadIndex.load(std::memory_order_relaxed);
+	if (readIndex == mWriteIndex.load(std::memory_order_acquire))
+		return nullptr;
+	return &mSlots[readIndex % NUM_SLOTS];
+}
+
+void UDPReceiveThread::popReceived()
+{
+	mReadIndex.store(mReadIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void UDPReceiveThread::threadFunc()
+{
+	while (mRunning)
+	{
+		const size_t writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+		const size_t readIndex = mReadIndex.load(std::memory_order_acquire);
+		const size_t numFreeSlots = NUM_SLOTS - (writeIndex - readIndex);
+		if (numFreeSlots == 0)
+		{
+			// Queue is full, wait for the main thread to catch up
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			continue;
+		}
+
+		// Use a timeout so that stopping the thread is still possible when nothing gets received
+		if (!mSocket.waitForData(100))
+		{
+			if (!mSocket.isValid())
+			{
+				// Socket is not bound (yet), or was closed in the meantime
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+			continue;
+		}
+
+		// Receive into the free slots, but without wrapping around, so the batch is contiguous
+		const size_t firstSlot = writeIndex % NUM_SLOTS;
+		const size_t maxCount = std::min(numFreeSlots, NUM_SLOTS - firstSlot);
+		size_t count = 0;
+		if (!mSocket.receiveMultipleNonBlocking(&mSlots[firstSlot], maxCount, count))
+		{
+			// Report the error to the main thread, and retry after a short delay
+			mFailed.store(true, std::memory_order_release);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			continue;
+		}
+
+		if (count > 0)
+		{
+			// Publish the received datagrams to the main thread
+			mWriteIndex.store(writeIndex + count, std::memory_order_release);
+		}
+		else
+		{
+			// Polling signaled something else than data, e.g. a pending socket error (POLLERR) that receiving did not clear
+			//  -> Avoid running into a busy loop
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
@@ -0,0 +1,55 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "oxygen_netcore/network/Sockets.h"
+
+#include <atomic>
+#include <thread>
+
+
+// Worker thread receiving UDP datagrams for the "ConnectionManager"
+//  - Only the raw datagrams get received here, all further evaluation happens on the main thread
+//  - Received datagrams are written into a fixed ring of reused buffers, which serves as a single-producer single-consumer queue
+//  - Receive errors are treated as transient, like the main thread polling did before
+class UDPReceiveThread
+{
+public:
+	static bool isSupported();
+
+public:
+	explicit UDPReceiveThread(UDPSocket& socket);
+	~UDPReceiveThread();
+
+	void start();
+	void stop();
+
+	// Returns true once if receiving failed since the last call; the worker thread keeps on trying in any case
+	inline bool fetchReceiveFailed()  { return mFailed.exchange(false, std::memory_order_acq_rel); }
+
+	// Main thread access: Look at the oldest received datagram, and release it after evaluation
+	//  -> Its buffer may be swapped with another one, it gets resized again by the worker thread anyways
+	UDPSocket::ReceiveResult* peekReceived();
+	void popReceived();
+
+private:
+	void threadFunc();
+
+private:
+	static const constexpr size_t NUM_SLOTS = 64;	// Must be a power of two
+
+	UDPSocket& mSocket;
+	std::thread mThread;
+	std::atomic<bool> mRunning { false };
+	std::atomic<bool> mFailed { false };
+
+	UDPSocket::ReceiveResult mSlots[NUM_SLOTS];
+	std::atomic<size_t> mWriteIndex { 0 };	// Only written by the worker thread
+	std::atomic<size_t> mReadIndex { 0 };		// Only written by the main thread
+};
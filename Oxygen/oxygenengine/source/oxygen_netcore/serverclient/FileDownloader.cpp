@@ -0,0 +1,526 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "oxygen_netcore/pch.h"
+#include "oxygen_netcore/serverclient/FileDownloader.h"
+#include "oxygen_netcore/network/ConnectionListener.h"
+#include "oxygen_netcore/network/NetConnection.h"
+
+
+namespace
+{
+	const char* FORMAT_IDENTIFIER = "OXY.DOWNLOAD";
+	const uint16 FORMAT_VERSION = 0x0100;		// First version
+
+	const uint32 PIECE_SIZE = (uint32)network::FileTransferPiecePacket::MAX_PIECE_SIZE;
+	const size_t MAX_PIECES_PER_REQUEST = 0x40;		// Limit of "FileTransferRequestPiecesPacket"
+
+	const float INITIAL_WINDOW_SIZE = 4.0f;
+	const float MIN_WINDOW_SIZE = 2.0f;
+	const float MAX_WINDOW_SIZE = 128.0f;			// That's about 4 MB in flight
+
+	const uint64 INITIAL_PIECE_TIMEOUT = 3000;		// Used until there's a round trip time estimate
+	const uint64 MIN_PIECE_TIMEOUT = 500;
+	const uint64 MAX_PIECE_TIMEOUT = 10000;
+
+	const uint8 MAX_FAILED_VERIFICATIONS = 3;		// Per chunk, before giving up on the download
+	const uint64 PROGRESS_SAVE_INTERVAL = 1000;
+
+	std::wstring getPartFilename(const std::wstring& localFilename)
+	{
+		return localFilename + L".part";
+	}
+
+	std::wstring getProgressFilename(const std::wstring& localFilename)
+	{
+		return localFilename + L".progress";
+	}
+}
+
+
+FileDownloader::~FileDownloader()
+{
+	cancelDownload();
+}
+
+bool FileDownloader::startDownload(NetConnection& connection, const std::string& remoteFilePath, const std::wstring& localFilename, uint64 currentTimestamp)
+{
+	cancelDownload();
+
+	mConnection = &connection;
+	mLocalFilename = localFilename;
+	mCurrentTimestamp = currentTimestamp;
+
+	mFileDownloadRequest.mQuery.mFilePath = remoteFilePath;
+	if (!connection.sendRequest(mFileDownloadRequest))
+	{
+		mState = State::FAILED;
+		return false;
+	}
+	mState = State::REQUESTED;
+	return true;
+}
+
+void FileDownloader::cancelDownload()
+{
+	if (!isRunning())
+		return;
+
+	stopTransfer();
+	mState = State::NONE;
+}
+
+void FileDownloader::updateDownload(uint64 currentTimestamp)
+{
+	mCurrentTimestamp = currentTimestamp;
+	if (!isRunning())
+		return;
+
+	if (mConnection->getState() != NetConnection::State::CONNECTED)
+	{
+		failDownload();
+		return;
+	}
+
+	switch (mState)
+	{
+		case State::REQUESTED:
+		{
+			if (!mFileDownloadRequest.hasResponse())
+				return;
+
+			if (mFileDownloadRequest.hasError() || !mFileDownloadRequest.mResponse.mFileAvailable)
+			{
+				failDownload();
+				return;
+			}
+			startTransfer();
+			break;
+		}
+
+		case State::DOWNLOADING:
+		{
+			if (currentTimestamp >= mLastLostPiecesCheck + 100)
+			{
+				mLastLostPiecesCheck = currentTimestamp;
+				checkForLostPieces();
+			}
+
+			requestPieces();
+
+			if (mProgressDirty && currentTimestamp >= mLastProgressSave + PROGRESS_SAVE_INTERVAL)
+			{
+				saveProgress();
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+bool FileDownloader::onReceivedPacket(ReceivedPacketEvaluation& evaluation)
+{
+	if (evaluation.mPacketType != network::FileTransferPiecePacket::PACKET_TYPE)
+		return false;
+	if (mState != State::DOWNLOADING || &evaluation.mConnection != mConnection)
+		return false;
+
+	network::FileTransferPiecePacket packet;
+	if (!evaluation.readPacket(packet))
+		return false;
+
+	// Piece could still belong to another download on the same connection
+	if (packet.mTransferHandle != mTransferHandle)
+		return false;
+
+	// The piece's data directly follows the packet, and gets written to the file from the receive buffer without copying it first
+	VectorBinarySerializer& serializer = evaluation.mSerializer;
+	if (packet.mSize == 0 || serializer.getRemaining() < (size_t)packet.mSize)
+		return false;
+
+	onReceivedPiece(packet, serializer.peek());
+	serializer.skip(packet.mSize);
+	return true;
+}
+
+void FileDownloader::startTransfer()
+{
+	const network::FileDownloadRequest::Response& response = mFileDownloadRequest.mResponse;
+	mTransferHandle = response.mTransferHandle;
+	mFileSize = response.mFileSize;
+	mFileHash = response.mFileHash;
+
+	// Split all chunks into pieces
+	mChunks.clear();
+	mPieces.clear();
+	uint32 fileOffset = 0;
+	for (const auto& chunkInfo : response.mChunks)
+	{
+		Chunk& chunk = vectorAdd(mChunks);
+		chunk.mFileOffset = fileOffset;
+		chunk.mSize = chunkInfo.mChunkSize;
+		chunk.mHash = chunkInfo.mChunkHash;
+		chunk.mFirstPieceIndex = mPieces.size();
+		for (uint32 startOffset = 0; startOffset < chunk.mSize; startOffset += PIECE_SIZE)
+		{
+			Piece& piece = vectorAdd(mPieces);
+			piece.mChunkIndex = (uint16)(mChunks.size() - 1);
+			piece.mStartOffset = startOffset;
+			piece.mSize = std::min(PIECE_SIZE, chunk.mSize - startOffset);
+		}
+		chunk.mNumPieces = mPieces.size() - chunk.mFirstPieceIndex;
+		chunk.mPiecesMissing = chunk.mNumPieces;
+		fileOffset += chunk.mSize;
+	}
+	if (fileOffset != mFileSize)
+	{
+		RMX_ERROR("Chunk sizes of file download don't add up to the file size", );
+		failDownload();
+		return;
+	}
+
+	// Continue a previous attempt if possible, otherwise start with an empty file
+	const std::wstring partFilename = getPartFilename(mLocalFilename);
+	const bool resume = rmx::FileIO::exists(partFilename) && loadProgress();
+	if (!resume)
+	{
+		mPartFile.open(partFilename, FILE_ACCESS_WRITE);
+	}
+	if (!mPartFile.open(partFilename, FILE_ACCESS_READWRITE))
+	{
+		RMX_ERROR("Failed to open file '" << WString(partFilename).toStdString() << "' for writing", );
+		failDownload();
+		return;
+	}
+
+	mChunksVerified = 0;
+	mBytesVerified = 0;
+	mBytesReceived = 0;
+	mNextMissingPiece = 0;
+	mPiecesInFlight = 0;
+	mProgressDirty = false;
+	mLastProgressSave = mCurrentTimestamp;
+	mState = State::DOWNLOADING;
+
+	// Chunks from the previous attempt are only trusted if their content still matches
+	if (resume)
+	{
+		for (size_t chunkIndex = 0; chunkIndex < mChunks.size(); ++chunkIndex)
+		{
+			Chunk& chunk = mChunks[chunkIndex];
+			if (chunk.mVerified)
+			{
+				chunk.mVerified = false;
+				chunk.mPiecesMissing = 0;
+				for (size_t k = 0; k < chunk.mNumPieces; ++k)
+				{
+					mPieces[chunk.mFirstPieceIndex + k].mState = PieceState::RECEIVED;
+				}
+				onChunkComplete(chunkIndex);
+				if (mState != State::DOWNLOADING)
+					return;
+			}
+		}
+	}
+
+	mWindowSize = INITIAL_WINDOW_SIZE;
+	mSlowStartThreshold = MAX_WINDOW_SIZE;
+	mLastWindowReduction = 0;
+	mSmoothedRoundTrip = 0.0f;
+	mRoundTripVariance = 0.0f;
+	mLastLostPiecesCheck = mCurrentTimestamp;
+	mLastPacketsResent = mConnection->getStatistics().mPacketsResent;
+
+	if (mChunksVerified == mChunks.size())
+	{
+		finishDownload();
+		return;
+	}
+	requestPieces();
+}
+
+void FileDownloader::requestPieces()
+{
+	const size_t windowSize = (size_t)mWindowSize;
+	if (mPiecesInFlight >= windowSize)
+		return;
+
+	network::FileTransferRequestPiecesPacket& packet = mRequestPiecesPacket;
+	packet.mTransferHandle = mTransferHandle;
+	packet.mTransferComplete = false;
+	packet.mRequestedPieces.clear();
+
+	while (mNextMissingPiece < mPieces.size() && mPiecesInFlight < windowSize)
+	{
+		Piece& piece = mPieces[mNextMissingPiece];
+		++mNextMissingPiece;
+		if (piece.mState != PieceState::MISSING)
+			continue;
+
+		network::FileTransferRequestPiecesPacket::PieceInfo& pieceInfo = vectorAdd(packet.mRequestedPieces);
+		pieceInfo.mChunkIndex = piece.mChunkIndex;
+		pieceInfo.mStartOffset = piece.mStartOffset;
+		pieceInfo.mSize = piece.mSize;
+		piece.mState = PieceState::REQUESTED;
+		piece.mRequestTimestamp = mCurrentTimestamp;
+		++mPiecesInFlight;
+
+		if (packet.mRequestedPieces.size() >= MAX_PIECES_PER_REQUEST)
+		{
+			mConnection->sendPacket(packet);
+			packet.mRequestedPieces.clear();
+		}
+	}
+
+	if (!packet.mRequestedPieces.empty())
+	{
+		mConnection->sendPacket(packet);
+	}
+}
+
+void FileDownloader::onReceivedPiece(const network::FileTransferPiecePacket& packet, const uint8* data)
+{
+	mBytesReceived += packet.mSize;
+
+	// Validate the piece, it might as well be a duplicate or a late arrival for a chunk that got verified already
+	if (packet.mChunkIndex >= mChunks.size() || packet.mStartOffset % PIECE_SIZE != 0)
+		return;
+	Chunk& chunk = mChunks[packet.mChunkIndex];
+	if (chunk.mVerified || packet.mStartOffset >= chunk.mSize)
+		return;
+	Piece& piece = mPieces[chunk.mFirstPieceIndex + packet.mStartOffset / PIECE_SIZE];
+	if (piece.mState == PieceState::RECEIVED || piece.mSize != (uint32)packet.mSize)
+		return;
+
+	if (piece.mState == PieceState::REQUESTED)
+	{
+		--mPiecesInFlight;
+		updateRoundTrip(mCurrentTimestamp - piece.mRequestTimestamp);
+	}
+
+	mPartFile.seek((int64)chunk.mFileOffset + piece.mStartOffset);
+	if (mPartFile.write(data, piece.mSize) != piece.mSize)
+	{
+		RMX_ERROR("Failed to write to file '" << WString(getPartFilename(mLocalFilename)).toStdString() << "'", );
+		failDownload();
+		return;
+	}
+	piece.mState = PieceState::RECEIVED;
+
+	// Grow the window: exponentially at first, then linearly once there were losses
+	if (mWindowSize < mSlowStartThreshold)
+		mWindowSize += 1.0f;
+	else
+		mWindowSize += 1.0f / mWindowSize;
+	mWindowSize = std::min(mWindowSize, MAX_WINDOW_SIZE);
+
+	--chunk.mPiecesMissing;
+	if (chunk.mPiecesMissing == 0)
+	{
+		onChunkComplete(packet.mChunkIndex);
+		if (mState == State::DOWNLOADING && mChunksVerified == mChunks.size())
+		{
+			finishDownload();
+		}
+	}
+}
+
+void FileDownloader::onChunkComplete(size_t chunkIndex)
+{
+	// Read back the chunk for verification, it's most likely still in the file system cache anyways
+	Chunk& chunk = mChunks[chunkIndex];
+	mChunkBuffer.resize(chunk.mSize);
+	mPartFile.flush();
+	mPartFile.seek(chunk.mFileOffset);
+	const bool isValid = (mPartFile.read(mChunkBuffer.data(), chunk.mSize) == chunk.mSize) && (rmx::getMurmur2_64(mChunkBuffer.data(), chunk.mSize) == chunk.mHash);
+	if (isValid)
+	{
+		chunk.mVerified = true;
+		++mChunksVerified;
+		mBytesVerified += chunk.mSize;
+		mProgressDirty = true;
+		return;
+	}
+
+	++chunk.mFailedVerifications;
+	if (chunk.mFailedVerifications >= MAX_FAILED_VERIFICATIONS)
+	{
+		RMX_ERROR("Chunk " << chunkIndex << " of file download '" << mFileDownloadRequest.mQuery.mFilePath << "' failed verification repeatedly", );
+		failDownload();
+		return;
+	}
+
+	// Download the whole chunk again
+	for (size_t k = 0; k < chunk.mNumPieces; ++k)
+	{
+		mPieces[chunk.mFirstPieceIndex + k].mState = PieceState::MISSING;
+	}
+	chunk.mPiecesMissing = chunk.mNumPieces;
+	mNextMissingPiece = std::min(mNextMissingPiece, chunk.mFirstPieceIndex);
+}
+
+void FileDownloader::onPieceLost()
+{
+	// Reduce the window at most once per round trip, as losses usually come in bursts
+	if (mCurrentTimestamp < mLastWindowReduction + (uint64)mSmoothedRoundTrip)
+		return;
+
+	mLastWindowReduction = mCurrentTimestamp;
+	mSlowStartThreshold = std::max(mWindowSize / 2.0f, MIN_WINDOW_SIZE);
+	mWindowSize = mSlowStartThreshold;
+}
+
+void FileDownloader::updateRoundTrip(uint64 roundTripTime)
+{
+	// Same estimate as TCP uses for its retransmission timeout
+	const float sample = (float)roundTripTime;
+	if (mSmoothedRoundTrip <= 0.0f)
+	{
+		mSmoothedRoundTrip = std::max(sample, 1.0f);
+		mRoundTripVariance = sample / 2.0f;
+	}
+	else
+	{
+		mRoundTripVariance = mRoundTripVariance * 0.75f + std::abs(mSmoothedRoundTrip - sample) * 0.25f;
+		mSmoothedRoundTrip = mSmoothedRoundTrip * 0.875f + sample * 0.125f;
+	}
+}
+
+uint64 FileDownloader::getPieceTimeout() const
+{
+	if (mSmoothedRoundTrip <= 0.0f)
+		return INITIAL_PIECE_TIMEOUT;
+	return std::min(std::max((uint64)(mSmoothedRoundTrip + mRoundTripVariance * 4.0f), MIN_PIECE_TIMEOUT), MAX_PIECE_TIMEOUT);
+}
+
+void FileDownloader::checkForLostPieces()
+{
+	// Resends on the connection hint at congestion, even before any pieces time out
+	bool anyLoss = false;
+	const uint64 packetsResent = mConnection->getStatistics().mPacketsResent;
+	if (packetsResent != mLastPacketsResent)
+	{
+		mLastPacketsResent = packetsResent;
+		anyLoss = true;
+	}
+
+	// Pieces are sent reliably, but the server might still have dropped a request, so any piece that is overdue gets requested again
+	if (mPiecesInFlight > 0)
+	{
+		const uint64 timeout = getPieceTimeout();
+		for (size_t pieceIndex = 0; pieceIndex < mNextMissingPiece; ++pieceIndex)
+		{
+			Piece& piece = mPieces[pieceIndex];
+			if (piece.mState == PieceState::REQUESTED && mCurrentTimestamp >= piece.mRequestTimestamp + timeout)
+			{
+				piece.mState = PieceState::MISSING;
+				--mPiecesInFlight;
+				mNextMissingPiece = std::min(mNextMissingPiece, pieceIndex);
+				anyLoss = true;
+			}
+		}
+	}
+
+	if (anyLoss)
+		onPieceLost();
+}
+
+void FileDownloader::finishDownload()
+{
+	stopTransfer();
+
+	const std::wstring progressFilename = getProgressFilename(mLocalFilename);
+	if (!rmx::FileIO::renameFile(getPartFilename(mLocalFilename), mLocalFilename))
+	{
+		RMX_ERROR("Failed to rename downloaded file to '" << WString(mLocalFilename).toStdString() << "'", );
+		mState = State::FAILED;
+		return;
+	}
+	rmx::FileIO::removeFile(progressFilename);
+	mState = State::COMPLETED;
+}
+
+void FileDownloader::stopTransfer()
+{
+	if (mState == State::DOWNLOADING)
+	{
+		// Let the server know it can release the transfer
+		if (mConnection->getState() == NetConnection::State::CONNECTED)
+		{
+			network::FileTransferRequestPiecesPacket& packet = mRequestPiecesPacket;
+			packet.mTransferHandle = mTransferHandle;
+			packet.mTransferComplete = true;
+			packet.mRequestedPieces.clear();
+			mConnection->sendPacket(packet);
+		}
+
+		if (mProgressDirty)
+			saveProgress();
+	}
+	mPartFile.close();
+	mPiecesInFlight = 0;
+}
+
+void FileDownloader::failDownload()
+{
+	stopTransfer();
+	mState = State::FAILED;
+}
+
+bool FileDownloader::loadProgress()
+{
+	std::vector<uint8> content;
+	if (!rmx::FileIO::readFile(getProgressFilename(mLocalFilename), content))
+		return false;
+
+	VectorBinarySerializer serializer(true, content);
+	char identifier[12];
+	serializer.read(identifier, 12);
+	if (serializer.hasError() || memcmp(identifier, FORMAT_IDENTIFIER, 12) != 0)
+		return false;
+	if (serializer.read<uint16>() != FORMAT_VERSION)
+		return false;
+
+	// Progress is only of any use if it's still the same file
+	const uint32 fileSize = serializer.read<uint32>();
+	const uint64 fileHash = serializer.read<uint64>();
+	const uint32 numChunks = serializer.read<uint32>();
+	if (serializer.hasError() || fileSize != mFileSize || fileHash != mFileHash || numChunks != (uint32)mChunks.size())
+		return false;
+
+	if (serializer.getRemaining() < (size_t)numChunks)
+		return false;
+	for (Chunk& chunk : mChunks)
+	{
+		chunk.mVerified = (serializer.read<uint8>() != 0);
+	}
+	return true;
+}
+
+void FileDownloader::saveProgress()
+{
+	std::vector<uint8> content;
+	VectorBinarySerializer serializer(false, content);
+	serializer.write(FORMAT_IDENTIFIER, 12);
+	serializer.write(FORMAT_VERSION);
+	serializer.write(mFileSize);
+	serializer.write(mFileHash);
+	serializer.writeAs<uint32>(mChunks.size());
+	for (const Chunk& chunk : mChunks)
+	{
+		serializer.writeAs<uint8>(chunk.mVerified ? 1 : 0);
+	}
+
+	// Make sure the verified chunks actually made it into the file before claiming them
+	mPartFile.flush();
+	rmx::FileIO::saveFile(getProgressFilename(mLocalFilename), content.data(), content.size());
+	mProgressDirty = false;
+	mLastProgressSave = mCurrentTimestamp;
+}
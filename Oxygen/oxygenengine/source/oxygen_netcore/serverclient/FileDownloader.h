@@ -0,0 +1,131 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include "oxygen_netcore/serverclient/FileTransferPackets.h"
+
+class NetConnection;
+struct ReceivedPacketEvaluation;
+
+
+// Client side of a file download from the server
+//  - Many pieces are requested at once, with the number of pieces in flight adapting to how fast they arrive
+//  - Received pieces get written directly into a ".part" file, and each chunk is checked against its hash when complete
+//  - Verified chunks are recorded in a ".progress" file next to it, so that an interrupted download can be resumed later on
+class FileDownloader
+{
+public:
+	enum class State
+	{
+		NONE,			// No download started
+		REQUESTED,		// Waiting for the server to respond to the download request
+		DOWNLOADING,	// Pieces are being transferred
+		COMPLETED,		// File was fully downloaded and verified
+		FAILED			// Download could not be completed; starting it again resumes from the verified chunks
+	};
+
+public:
+	~FileDownloader();
+
+	inline State getState() const  { return mState; }
+	inline bool isRunning() const  { return (mState == State::REQUESTED || mState == State::DOWNLOADING); }
+
+	inline uint32 getFileSize() const		 { return mFileSize; }
+	inline uint32 getBytesVerified() const	 { return mBytesVerified; }
+	inline uint64 getBytesReceived() const	 { return mBytesReceived; }	// Including resent or discarded pieces
+	inline size_t getWindowSize() const		 { return (size_t)mWindowSize; }
+
+	// Local filename is where the complete file ends up; it should not be changed between attempts to resume a download
+	//  -> Note that the connection has to outlive the download, or the downloader itself
+	bool startDownload(NetConnection& connection, const std::string& remoteFilePath, const std::wstring& localFilename, uint64 currentTimestamp);
+	void cancelDownload();
+	void updateDownload(uint64 currentTimestamp);
+
+	// Needs to be called by the owner's "onReceivedPacket", returns true if the packet was handled
+	bool onReceivedPacket(ReceivedPacketEvaluation& evaluation);
+
+private:
+	enum class PieceState : uint8
+	{
+		MISSING,
+		REQUESTED,
+		RECEIVED
+	};
+
+	struct Piece
+	{
+		uint16 mChunkIndex = 0;
+		uint32 mStartOffset = 0;	// Relative address inside chunk
+		uint32 mSize = 0;
+		PieceState mState = PieceState::MISSING;
+		uint64 mRequestTimestamp = 0;
+	};
+
+	struct Chunk
+	{
+		uint32 mFileOffset = 0;
+		uint32 mSize = 0;
+		uint64 mHash = 0;
+		size_t mFirstPieceIndex = 0;
+		size_t mNumPieces = 0;
+		size_t mPiecesMissing = 0;	// Number of pieces not received yet
+		uint8 mFailedVerifications = 0;
+		bool mVerified = false;
+	};
+
+private:
+	void startTransfer();
+	void requestPieces();
+	void onReceivedPiece(const network::FileTransferPiecePacket& packet, const uint8* data);
+	void onChunkComplete(size_t chunkIndex);
+	void onPieceLost();
+	void updateRoundTrip(uint64 roundTripTime);
+	uint64 getPieceTimeout() const;
+	void checkForLostPieces();
+	void finishDownload();
+	void stopTransfer();
+	void failDownload();
+
+	bool loadProgress();
+	void saveProgress();
+
+private:
+	State mState = State::NONE;
+	NetConnection* mConnection = nullptr;
+	std::wstring mLocalFilename;
+	uint64 mCurrentTimestamp = 0;
+
+	network::FileDownloadRequest mFileDownloadRequest;
+	network::FileTransferRequestPiecesPacket mRequestPiecesPacket;
+	uint32 mTransferHandle = 0;
+	uint32 mFileSize = 0;
+	uint64 mFileHash = 0;
+
+	std::vector<Chunk> mChunks;
+	std::vector<Piece> mPieces;
+	size_t mNextMissingPiece = 0;	// All pieces before this one were at least requested already
+	size_t mPiecesInFlight = 0;
+	size_t mChunksVerified = 0;
+	uint32 mBytesVerified = 0;
+	uint64 mBytesReceived = 0;
+	FileHandle mPartFile;
+	std::vector<uint8> mChunkBuffer;	// Only used for reading back chunks for verification
+
+	// Window of pieces in flight, grown additively on timely arrivals and halved on losses
+	float mWindowSize = 0.0f;
+	float mSlowStartThreshold = 0.0f;
+	uint64 mLastWindowReduction = 0;
+	float mSmoothedRoundTrip = 0.0f;		// In milliseconds
+	float mRoundTripVariance = 0.0f;
+	uint64 mLastLostPiecesCheck = 0;
+	uint64 mLastPacketsResent = 0;
+
+	bool mProgressDirty = false;
+	uint64 mLastProgressSave = 0;
+};
@@ -0,0 +1,119 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "regressiontests/pch.h"
+#include "regressiontests/RegressionTests.h"
+#include "sonic3air/helper/BlueSpheresRendering.h"
+
+
+namespace
+{
+	struct TestSetup
+	{
+		int mScreenWidth;
+		bool mUseFiltering;
+		uint16 mFieldColorA;
+		uint16 mFieldColorB;
+		uint64 mExpectedHash;	// Recorded with the original per-pixel implementation of "BlueSpheresRendering::renderToBitmap"
+	};
+
+	// Screen widths include some that are not a multiple of 16, for the scalar remainder of vectorized rows
+	const TestSetup TEST_SETUPS[] =
+	{
+		{ 320, false, 0x0e40, 0x0ec0, 0x47fe2f656e31b023 },
+		{ 320, true,  0x0e40, 0x0ec0, 0x10c74cb2cd00dff2 },
+		{ 398, false, 0x0e40, 0x0ec0, 0x354a879cf01fb657 },
+		{ 398, true,  0x0e40, 0x0ec0, 0xecdf4fb0e88cea44 },
+		{ 496, false, 0x0e40, 0x0ec0, 0x235ba623ec3a3a2e },
+		{ 496, true,  0x0e40, 0x0ec0, 0xda80a63fc88d7c7b },
+		{ 398, false, 0x00ee, 0x0202, 0xfd3954ffce826635 },
+		{ 398, true,  0x00ee, 0x0202, 0x07fc13027ae1221c },
+	};
+
+	const int NUM_POSITIONS_PER_ROTATION = 8;
+
+	bool equalBitmaps(const Bitmap& a, const Bitmap& b)
+	{
+		return (a.getSize() == b.getSize()) && (a.getPixelCount() == 0 || memcmp(a.getData(), b.getData(), (size_t)a.getPixelCount() * 4) == 0);
+	}
+}
+
+
+bool regressiontests::testBlueSpheresRendering()
+{
+	bool success = true;
+	for (const TestSetup& setup : TEST_SETUPS)
+	{
+		// The reference always renders into new bitmaps, while the other one only renders if needed, like the game does
+		BlueSpheresRendering reference;
+		BlueSpheresRendering rendering;
+		reference.startup();
+		rendering.startup();
+
+		Bitmap persistentOpaque;
+		Bitmap persistentAlpha;
+		uint64 hash = 0;
+		uint32 randomState = 0x12345678;
+		int numRendered = 0;
+		int numMismatches = 0;
+
+		// Go through all rotations, each with a few positions, and sometimes with movement inside the same grid cell to get unchanged output
+		for (int rotation = 0; rotation < 0x100; ++rotation)
+		{
+			uint16 px = 0;
+			uint16 py = 0;
+			for (int k = 0; k < NUM_POSITIONS_PER_ROTATION; ++k)
+			{
+				randomState = randomState * 1103515245 + 12345;
+				if (k % 2 == 0)
+				{
+					px = (uint16)(randomState >> 8);
+					py = (uint16)(randomState >> 16);
+				}
+				else
+				{
+					// Small step only, usually getting the same output as before
+					px += (uint16)((randomState >> 28) & 0x03);
+				}
+
+				Bitmap bitmapOpaque;
+				Bitmap bitmapAlpha;
+				reference.renderToBitmap(bitmapOpaque, bitmapAlpha, setup.mScreenWidth, px, py, (uint8)rotation, setup.mFieldColorA, setup.mFieldColorB, setup.mUseFiltering);
+				hash = combineHash(hash, bitmapOpaque.getData(), (size_t)bitmapOpaque.getPixelCount() * 4);
+				hash = combineHash(hash, bitmapAlpha.getData(), (size_t)bitmapAlpha.getPixelCount() * 4);
+
+				// Skipping the rendering must not make a difference
+				if (rendering.needsRendering(persistentOpaque, persistentAlpha, setup.mScreenWidth, px, py, (uint8)rotation, setup.mFieldColorA, setup.mFieldColorB, setup.mUseFiltering))
+				{
+					rendering.renderToBitmap(persistentOpaque, persistentAlpha, setup.mScreenWidth, px, py, (uint8)rotation, setup.mFieldColorA, setup.mFieldColorB, setup.mUseFiltering);
+					++numRendered;
+				}
+				if (!equalBitmaps(bitmapOpaque, persistentOpaque) || !equalBitmaps(bitmapAlpha, persistentAlpha))
+					++numMismatches;
+			}
+		}
+
+		const char* style = setup.mUseFiltering ? "filtered" : "classic";
+		if (hash != setup.mExpectedHash)
+		{
+			printf("Blue Spheres ground output differs for width %d, %s style, colors %04x / %04x: expected hash %016llx, got %016llx\n", setup.mScreenWidth, style, setup.mFieldColorA, setup.mFieldColorB, (unsigned long long)setup.mExpectedHash, (unsigned long long)hash);
+			success = false;
+		}
+		if (numMismatches > 0)
+		{
+			printf("Blue Spheres ground output differs when skipping unchanged frames in %d cases for width %d, %s style\n", numMismatches, setup.mScreenWidth, style);
+			success = false;
+		}
+		if (numRendered >= 0x100 * NUM_POSITIONS_PER_ROTATION)
+		{
+			printf("Blue Spheres ground rendering never got skipped for width %d, %s style\n", setup.mScreenWidth, style);
+			success = false;
+		}
+	}
+	return success;
+}
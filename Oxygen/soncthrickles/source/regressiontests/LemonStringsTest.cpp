@@ -0,0 +1,196 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "regressiontests/pch.h"
+#include "regressiontests/RegressionTests.h"
+
+#include <lemon/compiler/Compiler.h>
+#include <lemon/program/FunctionWrapper.h>
+#include <lemon/program/GlobalsLookup.h>
+#include <lemon/program/Module.h>
+#include <lemon/program/Program.h>
+#include <lemon/runtime/Runtime.h>
+#include <lemon/runtime/StandardLibrary.h>
+
+#include <filesystem>
+
+
+namespace
+{
+	// None of the strings logged here are literals, so they all exist only as strings created at runtime
+	const char* SCRIPT =
+		"//# script-feature-level(2)\n"
+		"\n"
+		"global string storedText\n"
+		"global u32 garbageCounter\n"
+		"\n"
+		"function void main()\n"
+		"{\n"
+		"	string name = stringformat(\"Player %d\", 3)\n"
+		"	logString(name)\n"
+		"	string text = name + \" scores \" + stringformat(\"%d\", 1200)\n"
+		"	logString(text)\n"
+		"	logString(stringformat(\"[%s] %s\", name, text))\n"
+		"	storedText = text + \"!\"\n"
+		"}\n"
+		"\n"
+		"function void makeGarbage()\n"
+		"{\n"
+		"	// Enough garbage to make a garbage collection worth it\n"
+		"	for (u32 i = 0; i < 20000; ++i)\n"
+		"	{\n"
+		"		string garbage = stringformat(\"garbage %d\", garbageCounter)\n"
+		"		++garbageCounter\n"
+		"	}\n"
+		"}\n";
+
+	const char* EXPECTED_LOG[] =
+	{
+		"Player 3",
+		"Player 3 scores 1200",
+		"[Player 3] Player 3 scores 1200",
+	};
+
+	const char* EXPECTED_STORED_TEXT = "Player 3 scores 1200!";
+
+	std::vector<std::string> gLoggedStrings;
+
+	void logString(lemon::StringRef str)
+	{
+		gLoggedStrings.emplace_back(str.isValid() ? std::string(str.getString()) : std::string("<invalid>"));
+	}
+
+	bool runFunction(lemon::Runtime& runtime, const lemon::Program& program, std::string_view functionName)
+	{
+		const lemon::Function* function = program.getFunctionBySignature(rmx::getMurmur2_64(functionName) + lemon::Function::getVoidSignatureHash());
+		if (nullptr == function)
+			return false;
+
+		runtime.callFunction(*function);
+		lemon::Runtime::ExecuteResult result;
+		while (true)
+		{
+			runtime.executeSteps(result, 1000);
+			if (result.mResult == lemon::Runtime::ExecuteResult::CALL)
+			{
+				if (nullptr == runtime.handleResultCall(result))
+					return false;
+			}
+			else if (result.mResult == lemon::Runtime::ExecuteResult::RETURN)
+			{
+				if (runtime.getMainControlFlow().getCallStack().count == 0)
+					return true;
+			}
+			else if (result.mResult == lemon::Runtime::ExecuteResult::HALT)
+			{
+				return true;
+			}
+		}
+	}
+
+	bool checkStoredText(lemon::Runtime& runtime, const lemon::Program& program, const char* description)
+	{
+		const lemon::Variable* variable = program.getGlobalVariableByName(rmx::getMurmur2_64(std::string_view("storedText")));
+		const lemon::FlyweightString* str = (nullptr == variable) ? nullptr : runtime.resolveStringByKey((uint64)runtime.getGlobalVariableValue(*variable));
+		if (nullptr == str || str->getString() != EXPECTED_STORED_TEXT)
+		{
+			printf("Lemon script global string is \"%s\" %s, expected \"%s\"\n", (nullptr == str) ? "<invalid>" : std::string(str->getString()).c_str(), description, EXPECTED_STORED_TEXT);
+			return false;
+		}
+		return true;
+	}
+}
+
+
+bool regressiontests::testLemonStrings()
+{
+	lemon::Module module("test_module");
+	module.addUserDefinedFunction("logString", lemon::wrap(&logString));
+	lemon::StandardLibrary::registerBindings(module);
+
+	lemon::GlobalsLookup globalsLookup;
+	globalsLookup.addDefinitionsFromModule(module);
+	{
+		// The compiler only loads scripts from files
+		const std::wstring scriptPath = (std::filesystem::temp_directory_path() / "regressiontests_lemonstrings.lemon").wstring();
+		if (!rmx::FileIO::saveFile(scriptPath, SCRIPT, strlen(SCRIPT)))
+		{
+			printf("Failed to write lemon script file\n");
+			return false;
+		}
+
+		lemon::Compiler::CompileOptions options;
+		lemon::Compiler compiler(module, globalsLookup, options);
+		const bool compileSuccess = compiler.loadScript(scriptPath);
+		rmx::FileIO::removeFile(scriptPath);
+		if (!compileSuccess)
+		{
+			for (const lemon::Compiler::ErrorMessage& error : compiler.getErrors())
+			{
+				printf("Lemon script compile error in line %d: %s\n", (int)error.mError.mLineNumber, error.mMessage.c_str());
+			}
+			return false;
+		}
+	}
+
+	lemon::Program program;
+	program.addModule(module);
+
+	lemon::Runtime runtime;
+	runtime.setProgram(program);
+	gLoggedStrings.clear();
+	if (!runFunction(runtime, program, "main") || !runFunction(runtime, program, "makeGarbage"))
+	{
+		printf("Lemon script execution failed\n");
+		return false;
+	}
+
+	// Concatenated and formatted strings
+	bool success = true;
+	for (size_t i = 0; i < std::size(EXPECTED_LOG); ++i)
+	{
+		const std::string logged = (i < gLoggedStrings.size()) ? gLoggedStrings[i] : "<missing>";
+		if (logged != EXPECTED_LOG[i])
+		{
+			printf("Lemon script logged \"%s\", expected \"%s\"\n", logged.c_str(), EXPECTED_LOG[i]);
+			success = false;
+		}
+	}
+
+	// Garbage collection must keep strings still referenced by globals
+	//  -> The first collection only ages all strings, they get reclaimed by the next one if not referenced any more
+	runtime.collectUnusedStrings();
+	if (!runFunction(runtime, program, "makeGarbage") || !runFunction(runtime, program, "makeGarbage"))
+	{
+		printf("Lemon script execution failed\n");
+		return false;
+	}
+	const size_t numStringsBefore = runtime.getRuntimeStrings().size();
+	runtime.collectUnusedStrings();
+	if (runtime.getRuntimeStrings().size() >= numStringsBefore)
+	{
+		printf("Lemon script garbage collection did not reclaim any strings\n");
+		success = false;
+	}
+	success = checkStoredText(runtime, program, "after garbage collection") && success;
+
+	// A fresh runtime knows the string only from the serialized state
+	std::vector<uint8> buffer;
+	{
+		VectorBinarySerializer serializer(false, buffer);
+		runtime.serializeState(serializer);
+	}
+	lemon::Runtime loadingRuntime;
+	loadingRuntime.setProgram(program);
+	{
+		VectorBinarySerializer serializer(true, buffer);
+		loadingRuntime.serializeState(serializer);
+	}
+	success = checkStoredText(loadingRuntime, program, "after loading the serialized state") && success;
+	return success;
+}
@@ -0,0 +1,26 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+
+// Regression tests for optimized code paths, each comparing the output against what the original implementation produced
+//  -> Tests return true on success, and print the reason for any failure
+namespace regressiontests
+{
+	bool testBlueSpheresRendering();
+	bool testYM2612();
+	bool testSpriteBlitting();
+	bool testLemonStrings();
+
+	// Combine hashes of multiple outputs into one
+	inline uint64 combineHash(uint64 hash, const void* data, size_t size)
+	{
+		return (hash * rmx::FNV1a_64_MAGIC_PRIME) ^ rmx::getMurmur2_64((const uint8*)data, size);
+	}
+}
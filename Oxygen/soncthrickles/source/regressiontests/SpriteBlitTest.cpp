@@ -0,0 +1,338 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "regressiontests/pch.h"
+#include "regressiontests/RegressionTests.h"
+#include "oxygen/rendering/utils/PaletteBitmap.h"
+#include "oxygen/rendering/utils/SpriteBase.h"
+
+
+namespace
+{
+	struct TintSetup
+	{
+		const char* mName;
+		bool mUseTintColor;
+		Vec4f mTintColor;
+		bool mUseAddedColor;
+		Vec4f mAddedColor;
+		int mMaxDifference;		// Allowed difference per color channel to the original float calculation
+		uint64 mExpectedHash;	// For exact setups, this is what the original implementation produced, otherwise it pins down the fixed-point results
+	};
+
+	const TintSetup TINT_SETUPS[] =
+	{
+		{ "no tint",              false, Vec4f(1.0f, 1.0f, 1.0f, 1.0f),   false, Vec4f(0.0f, 0.0f, 0.0f, 0.0f),    0, 0xf96382a3658732a7 },
+		{ "white tint",           true,  Vec4f(1.0f, 1.0f, 1.0f, 1.0f),   false, Vec4f(0.0f, 0.0f, 0.0f, 0.0f),    1, 0x7adabb56871dfb04 },
+		{ "color tint",           true,  Vec4f(0.8f, 0.35f, 0.6f, 1.0f),  false, Vec4f(0.0f, 0.0f, 0.0f, 0.0f),    1, 0x122757fdcf04f218 },
+		{ "translucent tint",     true,  Vec4f(0.9f, 0.7f, 1.0f, 0.55f),  false, Vec4f(0.0f, 0.0f, 0.0f, 0.0f),    1, 0x7d8cad54ac657237 },
+		{ "added color",          false, Vec4f(1.0f, 1.0f, 1.0f, 1.0f),   true,  Vec4f(0.3f, 0.1f, 0.75f, 0.0f),   1, 0x51d74cd09959fddd },
+		{ "subtracted color",     true,  Vec4f(0.5f, 1.0f, 0.25f, 0.8f),  true,  Vec4f(-0.2f, -0.6f, 0.1f, 0.0f),  1, 0xbec52ef76bbe5a36 },
+		{ "out of range (float)", true,  Vec4f(1.5f, 0.5f, 2.0f, 1.0f),   true,  Vec4f(-1.5f, 0.2f, 0.0f, 0.0f),   0, 0xc96e26e8a0244043 },
+	};
+
+	struct TransformSetup
+	{
+		const char* mName;
+		bool mUseTransform;
+		float mAngle;		// In degrees
+		Vec2f mScale;
+	};
+
+	const TransformSetup TRANSFORM_SETUPS[] =
+	{
+		{ "untransformed",   false, 0.0f,    Vec2f(1.0f, 1.0f) },
+		{ "identity",        true,  0.0f,    Vec2f(1.0f, 1.0f) },
+		{ "scaled x2",       true,  0.0f,    Vec2f(2.0f, 2.0f) },		// Texel borders exactly at pixel centers
+		{ "scaled x1/2",     true,  0.0f,    Vec2f(0.5f, 0.5f) },
+		{ "scaled x3/2",     true,  0.0f,    Vec2f(1.5f, 1.5f) },
+		{ "mirrored",        true,  0.0f,    Vec2f(-1.0f, 2.0f) },
+		{ "rotated 90",      true,  90.0f,   Vec2f(1.0f, 1.0f) },
+		{ "rotated 30",      true,  30.0f,   Vec2f(1.0f, 1.0f) },
+		{ "rotated scaled",  true,  -113.0f, Vec2f(1.25f, 0.75f) },
+	};
+
+	const int SPRITE_WIDTH = 27;
+	const int SPRITE_HEIGHT = 19;
+	const int OUTPUT_WIDTH = 0x200;		// Same as the depth buffer's line stride
+	const int OUTPUT_HEIGHT = 96;
+
+	uint32 getRandom(uint32& state)
+	{
+		state = state * 1103515245 + 12345;
+		return (state >> 8) & 0xffff;
+	}
+
+	uint32 getRandomColor(uint32& state)
+	{
+		return getRandom(state) | (getRandom(state) << 16);
+	}
+
+	uint32 getRandomSpriteColor(uint32& state)
+	{
+		// Mix of fully transparent, opaque and translucent pixels
+		const uint32 rgb = getRandomColor(state) & 0x00ffffff;
+		switch (getRandom(state) % 4)
+		{
+			case 0:   return rgb;
+			case 1:   return rgb | ((getRandom(state) & 0xff) << 24);
+			default:  return rgb | 0xff000000;
+		}
+	}
+
+
+	// Copy of the original sprite blitting code using float calculations, as a reference to compare against
+	namespace reference
+	{
+		uint32 blendColors(uint32 src, uint32 dst)
+		{
+			const uint8* srcPtr = (uint8*)&src;
+			uint8* dstPtr = (uint8*)&dst;
+			const int alpha = srcPtr[3];
+			const int oneMinusAlpha = 0x100 - alpha;
+
+			dstPtr[0] = ((int)srcPtr[0] * alpha + (int)dstPtr[0] * oneMinusAlpha) >> 8;
+			dstPtr[1] = ((int)srcPtr[1] * alpha + (int)dstPtr[1] * oneMinusAlpha) >> 8;
+			dstPtr[2] = ((int)srcPtr[2] * alpha + (int)dstPtr[2] * oneMinusAlpha) >> 8;
+			return dst | 0xff000000;
+		}
+
+		uint32 applyTintAdd(uint32 pixel, uint32 dst, bool useAlpha, const Color& tintColor, const Color& addedColor)
+		{
+			Color color = Color::fromABGR32(pixel);
+			color.r = saturate(addedColor.r + color.r * tintColor.r);
+			color.g = saturate(addedColor.g + color.g * tintColor.g);
+			color.b = saturate(addedColor.b + color.b * tintColor.b);
+			if (useAlpha)
+				color.a = saturate(color.a * tintColor.a);
+			else
+				color.a = tintColor.a;
+
+			if (color.a < 1.0f)
+			{
+				color = color.blendOver(Color::fromABGR32(dst | 0xff000000));
+				color.a = 1.0f;
+			}
+			return color.getABGR32();
+		}
+
+		void blitSpriteNoTransform(Bitmap& destBitmap, const Vec2i& destPosition, const Bitmap& sourceBitmap, const Vec2i& offset, const SpriteBase::BlitOptions& blitOptions)
+		{
+			const bool useTintAdd = (nullptr != blitOptions.mTintColor || nullptr != blitOptions.mAddedColor);
+			const Color tintColor = (nullptr == blitOptions.mTintColor) ? Color::WHITE : *blitOptions.mTintColor;
+			const Color addedColor = (nullptr == blitOptions.mAddedColor) ? Color::TRANSPARENT : *blitOptions.mAddedColor;
+			const bool useAlpha = !blitOptions.mIgnoreAlpha;
+
+			const int px = destPosition.x + offset.x;
+			const int py = destPosition.y + offset.y;
+			Recti bbox(px, py, sourceBitmap.mWidth, sourceBitmap.mHeight);
+			bbox.intersect(Recti(0, 0, destBitmap.mWidth, destBitmap.mHeight));
+
+			for (int iy = bbox.y; iy < bbox.y + bbox.height; ++iy)
+			{
+				for (int ix = bbox.x; ix < bbox.x + bbox.width; ++ix)
+				{
+					uint32& dst = destBitmap.mData[ix + iy * destBitmap.mWidth];
+					uint32 pixel = sourceBitmap.mData[(ix - px) + (iy - py) * sourceBitmap.mWidth];
+					if (useAlpha && (pixel & 0xff000000) == 0)
+						continue;
+					if (nullptr != blitOptions.mDepthBuffer && blitOptions.mDepthValue < blitOptions.mDepthBuffer[ix + iy * 0x200])
+						continue;
+
+					if (useTintAdd)
+					{
+						pixel = applyTintAdd(pixel, dst, useAlpha, tintColor, addedColor);
+					}
+					else if (useAlpha && (pixel & 0xff000000) != 0xff000000)
+					{
+						pixel = blendColors(pixel, dst);
+					}
+					dst = pixel;
+				}
+			}
+		}
+
+		void blitSpriteWithTransform(Bitmap& destBitmap, const Vec2i& destPosition, const Bitmap& sourceBitmap, const Vec2i& offset, const SpriteBase::BlitOptions& blitOptions)
+		{
+			const bool useTintAdd = (nullptr != blitOptions.mTintColor || nullptr != blitOptions.mAddedColor);
+			const Color tintColor = (nullptr == blitOptions.mTintColor) ? Color::WHITE : *blitOptions.mTintColor;
+			const Color addedColor = (nullptr == blitOptions.mAddedColor) ? Color::TRANSPARENT : *blitOptions.mAddedColor;
+
+			Recti bbox;
+			{
+				Vec2f min(1e10f, 1e10f);
+				Vec2f max(-1e10f, -1e10f);
+				const Vec2i corners[4] = { Vec2i(0, 0), Vec2i(sourceBitmap.mWidth - 1, 0), Vec2i(0, sourceBitmap.mHeight - 1), Vec2i(sourceBitmap.mWidth - 1, sourceBitmap.mHeight - 1) };
+				for (int i = 0; i < 4; ++i)
+				{
+					const Vec2f localCorner((float)(corners[i].x + offset.x + 0.5f), (float)(corners[i].y + offset.y + 0.5f));
+					const float screenCornerX = destPosition.x + localCorner.x * blitOptions.mTransform[0] + localCorner.y * blitOptions.mTransform[1];
+					const float screenCornerY = destPosition.y + localCorner.x * blitOptions.mTransform[2] + localCorner.y * blitOptions.mTransform[3];
+					min.x = std::min(screenCornerX, min.x);
+					min.y = std::min(screenCornerY, min.y);
+					max.x = std::max(screenCornerX, max.x);
+					max.y = std::max(screenCornerY, max.y);
+				}
+
+				bbox.x = (int)min.x;
+				bbox.y = (int)min.y;
+				bbox.width = (int)max.x + 1 - bbox.x;
+				bbox.height = (int)max.y + 1 - bbox.y;
+			}
+			bbox.intersect(Recti(0, 0, destBitmap.mWidth, destBitmap.mHeight));
+
+			for (int iy = bbox.y; iy < bbox.y + bbox.height; ++iy)
+			{
+				for (int ix = bbox.x; ix < bbox.x + bbox.width; ++ix)
+				{
+					const float dx = (float)(ix - destPosition.x) + 0.5f;
+					const float dy = (float)(iy - destPosition.y) + 0.5f;
+					const int localX = roundToInt(dx * blitOptions.mInvTransform[0] + dy * blitOptions.mInvTransform[1] - 0.5f) - offset.x;
+					const int localY = roundToInt(dx * blitOptions.mInvTransform[2] + dy * blitOptions.mInvTransform[3] - 0.5f) - offset.y;
+					if (localX < 0 || localX >= (int)sourceBitmap.mWidth || localY < 0 || localY >= (int)sourceBitmap.mHeight)
+						continue;
+
+					uint32& dst = destBitmap.mData[ix + iy * destBitmap.mWidth];
+					uint32 pixel = sourceBitmap.mData[localX + localY * sourceBitmap.mWidth];
+					if ((pixel & 0xff000000) == 0 || blitOptions.mIgnoreAlpha)
+						continue;
+					if (nullptr != blitOptions.mDepthBuffer && blitOptions.mDepthValue < blitOptions.mDepthBuffer[ix + iy * 0x200])
+						continue;
+
+					if (useTintAdd)
+					{
+						pixel = applyTintAdd(pixel, dst, true, tintColor, addedColor);
+					}
+					else if ((pixel & 0xff000000) != 0xff000000)
+					{
+						pixel = blendColors(pixel, dst);
+					}
+					dst = pixel;
+				}
+			}
+		}
+	}
+
+
+	int getMaxChannelDifference(uint32 a, uint32 b)
+	{
+		int result = 0;
+		for (int k = 0; k < 32; k += 8)
+		{
+			result = std::max(result, std::abs((int)((a >> k) & 0xff) - (int)((b >> k) & 0xff)));
+		}
+		return result;
+	}
+
+	bool compareOutput(const Bitmap& output, const Bitmap& expected, int maxDifference, const char* description)
+	{
+		for (int i = 0; i < output.getPixelCount(); ++i)
+		{
+			if (getMaxChannelDifference(output.mData[i], expected.mData[i]) > maxDifference)
+			{
+				printf("Sprite blit differs for %s at pixel (%d, %d): expected %08x, got %08x\n", description, i % output.mWidth, i / output.mWidth, expected.mData[i], output.mData[i]);
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+
+bool regressiontests::testSpriteBlitting()
+{
+	// Sprite with the same content as RGBA and as palette bitmap
+	uint32 randomState = 0x5eed1234;
+	uint32 palette[0x100];
+	for (uint32& color : palette)
+	{
+		color = getRandomSpriteColor(randomState);
+	}
+
+	PaletteBitmap paletteSprite;
+	Bitmap sprite;
+	paletteSprite.create(SPRITE_WIDTH, SPRITE_HEIGHT);
+	sprite.create(SPRITE_WIDTH, SPRITE_HEIGHT);
+	for (int i = 0; i < sprite.getPixelCount(); ++i)
+	{
+		paletteSprite.getData()[i] = (uint8)getRandom(randomState);
+		sprite.mData[i] = palette[paletteSprite.getData()[i]];
+	}
+
+	Bitmap background;
+	std::vector<uint8> depthBuffer((size_t)OUTPUT_WIDTH * OUTPUT_HEIGHT);
+	background.create(OUTPUT_WIDTH, OUTPUT_HEIGHT);
+	for (int i = 0; i < background.getPixelCount(); ++i)
+	{
+		background.mData[i] = getRandomColor(randomState);
+		depthBuffer[i] = (uint8)getRandom(randomState);
+	}
+
+	bool success = true;
+	Bitmap output;
+	Bitmap paletteOutput;
+	Bitmap expected;
+	for (const TintSetup& tintSetup : TINT_SETUPS)
+	{
+		uint64 hash = 0;
+		for (const TransformSetup& transformSetup : TRANSFORM_SETUPS)
+		{
+			const float angle = deg2rad(transformSetup.mAngle);
+			const float transform[4] =
+			{
+				std::cos(angle) * transformSetup.mScale.x, -std::sin(angle) * transformSetup.mScale.y,
+				std::sin(angle) * transformSetup.mScale.x,  std::cos(angle) * transformSetup.mScale.y
+			};
+			const float det = transform[0] * transform[3] - transform[1] * transform[2];
+			const float invTransform[4] = { transform[3] / det, -transform[1] / det, -transform[2] / det, transform[0] / det };
+
+			for (int variant = 0; variant < 4; ++variant)
+			{
+				// Variants: plain, ignored alpha, depth test, and a sprite cut by the output's border
+				SpriteBase::BlitOptions blitOptions;
+				blitOptions.mTransform = transformSetup.mUseTransform ? transform : nullptr;
+				blitOptions.mInvTransform = transformSetup.mUseTransform ? invTransform : nullptr;
+				blitOptions.mTintColor = tintSetup.mUseTintColor ? &tintSetup.mTintColor : nullptr;
+				blitOptions.mAddedColor = tintSetup.mUseAddedColor ? &tintSetup.mAddedColor : nullptr;
+				blitOptions.mIgnoreAlpha = (variant == 1);
+				if (variant == 2)
+				{
+					blitOptions.mDepthBuffer = &depthBuffer[0];
+					blitOptions.mDepthValue = 0x80;
+				}
+
+				SpriteBase spriteBase;
+				spriteBase.mOffset.set(-SPRITE_WIDTH / 2, -SPRITE_HEIGHT / 2);
+				const Vec2i position = (variant == 3) ? Vec2i(OUTPUT_WIDTH - 7, 4) : Vec2i(61, 47);
+
+				output = background;
+				paletteOutput = background;
+				expected = background;
+				spriteBase.blitInto(output, sprite, position, blitOptions);
+				spriteBase.blitInto(paletteOutput, paletteSprite, palette, position, blitOptions);
+				if (transformSetup.mUseTransform)
+					reference::blitSpriteWithTransform(expected, position, sprite, spriteBase.mOffset, blitOptions);
+				else
+					reference::blitSpriteNoTransform(expected, position, sprite, spriteBase.mOffset, blitOptions);
+
+				const std::string description = std::string("\"") + tintSetup.mName + "\", \"" + transformSetup.mName + "\", variant " + std::to_string(variant);
+				success = compareOutput(output, expected, tintSetup.mMaxDifference, description.c_str()) && success;
+				success = compareOutput(paletteOutput, output, 0, (description + " (palette sprite)").c_str()) && success;
+				hash = combineHash(hash, output.mData, (size_t)output.getPixelCount() * 4);
+			}
+		}
+
+		// Any change of the output gets noticed, including differences between the SSE2 and the scalar code
+		if (hash != tintSetup.mExpectedHash)
+		{
+			printf("Sprite blit output differs for \"%s\": expected hash %016llx, got %016llx\n", tintSetup.mName, (unsigned long long)tintSetup.mExpectedHash, (unsigned long long)hash);
+			success = false;
+		}
+	}
+	return success;
+}
@@ -0,0 +1,207 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "regressiontests/pch.h"
+#include "regressiontests/RegressionTests.h"
+#include "oxygen/simulation/sound/ym2612.h"
+
+
+namespace
+{
+	enum class WriteMode
+	{
+		INSTRUMENTS,	// Plausible instrument setups and notes, like the sound driver writes them
+		RELEASE,		// Same as above, but with long pauses after key off, so that channels become silent
+		RANDOM			// Random writes to all registers
+	};
+
+	struct TestSetup
+	{
+		const char* mName;
+		WriteMode mWriteMode;
+		bool mAllowCSM;
+		uint32 mSeed;
+		uint64 mExpectedHash;	// Recorded with the original per-sample implementation of "YM2612::update"
+	};
+
+	const TestSetup TEST_SETUPS[] =
+	{
+		{ "instruments",     WriteMode::INSTRUMENTS, false, 0x1e2d3c4b, 0x5a205bbd7760f907 },
+		{ "release",         WriteMode::RELEASE,     false, 0x5a697887, 0x139d33fabe7564be },
+		{ "random",          WriteMode::RANDOM,      false, 0x13579bdf, 0x842fb43a5c00784f },
+		{ "random with CSM", WriteMode::RANDOM,      true,  0x2468ace0, 0xb77189c63ffe4d8a },
+	};
+
+	const int NUM_FRAMES = 3000;
+	const int MAX_SAMPLES_PER_UPDATE = 1080;	// Same limit as in "SoundEmulation::fmUpdate"
+
+	class RegisterWriter
+	{
+	public:
+		RegisterWriter(soundemulation::YM2612& ym2612, uint32 seed) : mYM2612(ym2612), mRandomState(seed) {}
+
+		uint32 random(uint32 range)
+		{
+			mRandomState = mRandomState * 1103515245 + 12345;
+			return (mRandomState >> 8) % range;
+		}
+
+		void write(uint32 address, uint32 data)
+		{
+			// Same as "SoundEmulation::internalUpdate" does it
+			mYM2612.write((address & 0x100) ? 2 : 0, address & 0xff);
+			mYM2612.write(1, data);
+		}
+
+		void writeInstrument(int channel)
+		{
+			const uint32 base = ((channel >= 3) ? 0x100 : 0) + (channel % 3);
+			const uint32 algorithm = random(8);
+			write(base + 0xb0, (random(8) << 3) | algorithm);
+			write(base + 0xb4, 0xc0 | (random(4) << 4) | random(8));
+			for (uint32 op = 0; op < 4; ++op)
+			{
+				// Keep the carrier operators audible
+				const bool isCarrier = (op == 3) || (algorithm >= 4 && op != 0) || (algorithm == 7);
+				const uint32 opBase = base + op * 4;
+				write(opBase + 0x30, random(0x80));
+				write(opBase + 0x40, isCarrier ? random(0x20) : random(0x80));
+				write(opBase + 0x50, (random(4) << 6) | (0x10 + random(0x10)));
+				write(opBase + 0x60, (random(2) << 7) | random(0x20));
+				write(opBase + 0x70, random(0x20));
+				write(opBase + 0x80, random(0x100));
+				write(opBase + 0x90, (random(4) == 0) ? (0x08 | random(8)) : 0);
+			}
+			writeFrequency(channel);
+		}
+
+		void writeFrequency(int channel)
+		{
+			const uint32 base = ((channel >= 3) ? 0x100 : 0) + (channel % 3);
+			const uint32 value = (random(8) << 11) | (0x200 + random(0x200));
+			write(base + 0xa4, value >> 8);
+			write(base + 0xa0, value & 0xff);
+		}
+
+		void writeReleaseRates(int channel, uint32 value)
+		{
+			const uint32 base = ((channel >= 3) ? 0x100 : 0) + (channel % 3);
+			for (uint32 op = 0; op < 4; ++op)
+				write(base + op * 4 + 0x80, value);
+		}
+
+		void writeKey(int channel, bool keyOn)
+		{
+			const uint32 channelBits = (channel >= 3) ? (channel + 1) : channel;
+			write(0x28, (keyOn ? 0xf0 : 0x00) | channelBits);
+		}
+
+		void writeRandomRegister(bool allowCSM)
+		{
+			const uint32 address = (random(2) << 8) + 0x21 + random(0xb7 - 0x21 + 1);
+			uint32 data = random(0x100);
+			if ((address & 0xff) == 0x27 && !allowCSM)
+				data &= 0x7f;
+			write(address, data);
+		}
+
+	private:
+		soundemulation::YM2612& mYM2612;
+		uint32 mRandomState;
+	};
+
+	void writeFrame(RegisterWriter& writer, WriteMode writeMode, bool allowCSM, int frame)
+	{
+		switch (writeMode)
+		{
+			case WriteMode::INSTRUMENTS:
+			case WriteMode::RELEASE:
+			{
+				if (frame == 0)
+				{
+					for (int channel = 0; channel < 6; ++channel)
+						writer.writeInstrument(channel);
+				}
+
+				// Long pauses without any writes in the release mode
+				if (writeMode == WriteMode::RELEASE && (frame / 200) % 2 == 1)
+				{
+					if (frame % 200 == 0)
+					{
+						// Fast release and no DAC output, so all channels become silent
+						writer.write(0x2b, 0x00);
+						for (int channel = 0; channel < 6; ++channel)
+						{
+							writer.writeReleaseRates(channel, 0xff);
+							writer.writeKey(channel, false);
+						}
+					}
+					break;
+				}
+
+				const int channel = writer.random(6);
+				switch (writer.random(8))
+				{
+					case 0:  writer.writeInstrument(channel);  break;
+					case 1:  writer.writeFrequency(channel);   break;
+					case 2:  writer.writeKey(channel, false);  break;
+					case 3:  writer.write(0x22, writer.random(0x10));  break;					// LFO
+					case 4:  writer.write(0x27, writer.random(2) << 6);  break;				// 3-slot mode
+					case 5:  writer.write(0x2b, writer.random(4) == 0 ? 0x80 : 0x00);  break;	// DAC enable
+					default: writer.writeKey(channel, true);  break;
+				}
+				writer.write(0x2a, writer.random(0x100));
+				break;
+			}
+
+			case WriteMode::RANDOM:
+			{
+				const int numWrites = writer.random(16);
+				for (int k = 0; k < numWrites; ++k)
+					writer.writeRandomRegister(allowCSM);
+				if (writer.random(2) == 0)
+					writer.writeKey(writer.random(6), writer.random(2) == 0);
+				break;
+			}
+		}
+	}
+}
+
+
+bool regressiontests::testYM2612()
+{
+	bool success = true;
+	std::vector<int> buffer(MAX_SAMPLES_PER_UPDATE * 2);
+	for (const TestSetup& setup : TEST_SETUPS)
+	{
+		// The chip is too large for the stack
+		std::unique_ptr<soundemulation::YM2612> ym2612 = std::make_unique<soundemulation::YM2612>();
+		ym2612->init();
+		ym2612->config(14);
+		ym2612->resetChip();
+
+		// Output gets produced in chunks of varying length, so block boundaries end up everywhere
+		RegisterWriter writer(*ym2612, setup.mSeed);
+		uint64 hash = 0;
+		for (int frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			writeFrame(writer, setup.mWriteMode, setup.mAllowCSM, frame);
+
+			const int numSamples = (writer.random(4) == 0) ? (1 + writer.random(MAX_SAMPLES_PER_UPDATE)) : (1 + writer.random(200));
+			ym2612->update(&buffer[0], numSamples);
+			hash = combineHash(hash, &buffer[0], (size_t)numSamples * 2 * sizeof(int));
+		}
+
+		if (hash != setup.mExpectedHash)
+		{
+			printf("YM2612 output differs for \"%s\" register writes: expected hash %016llx, got %016llx\n", setup.mName, (unsigned long long)setup.mExpectedHash, (unsigned long long)hash);
+			success = false;
+		}
+	}
+	return success;
+}
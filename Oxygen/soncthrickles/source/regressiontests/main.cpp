@@ -0,0 +1,72 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#define RMX_LIB
+#include "regressiontests/pch.h"
+#include "regressiontests/RegressionTests.h"
+
+#include <chrono>
+#include <cstdio>
+
+
+namespace
+{
+	struct Test
+	{
+		const char* mName;
+		bool(*mFunction)();
+	};
+
+	const Test TESTS[] =
+	{
+		{ "bluespheres", &regressiontests::testBlueSpheresRendering },
+		{ "ym2612", &regressiontests::testYM2612 },
+		{ "spriteblit", &regressiontests::testSpriteBlitting },
+		{ "lemonstrings", &regressiontests::testLemonStrings },
+	};
+}
+
+
+int main(int argc, char** argv)
+{
+	INIT_RMX;
+
+	// Optionally, the names of the tests to run can be given as arguments
+	//  -> Some tests need data files, so this is meant to be run from the "soncthrickles" directory
+	int numFailed = 0;
+	int numExecuted = 0;
+	for (const Test& test : TESTS)
+	{
+		bool selected = (argc <= 1);
+		for (int i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], test.mName) == 0)
+				selected = true;
+		}
+		if (!selected)
+			continue;
+
+		const auto startTime = std::chrono::steady_clock::now();
+		const bool success = test.mFunction();
+		const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		printf("%s %s (%.0f ms)\n", success ? "[ OK ]" : "[FAIL]", test.mName, milliseconds);
+		fflush(stdout);
+
+		++numExecuted;
+		if (!success)
+			++numFailed;
+	}
+
+	if (numExecuted == 0)
+	{
+		printf("No matching tests found\n");
+		return 1;
+	}
+	printf("%d of %d tests passed\n", numExecuted - numFailed, numExecuted);
+	return (numFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+/*
+*	Part of the Oxygen Engine / Sonic 3 A.I.R. software distribution.
+*	Copyright (C) 2017-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+// Include relevant RMX libraries
+#include <rmxmedia.h>
+
+// Oxygen headers, as the tests cover code of the engine as well as of the game
+#include "oxygen/pch.h"
@@ -1024,12 +1024,23 @@ void Game::renderBlueSpheresGround(uint16 px, uint16 py, uint8 rotation, uint16
 	for (int k = 0; k < 2; ++k)
 	{
 		SpriteCache::CacheItem& item = SpriteCache::instance().getOrCreateComponentSprite(keys[k]);
-		++item.mChangeCounter;
 		bitmaps[k] = &static_cast<ComponentSprite*>(item.mSprite)->accessBitmap();
 		items[k] = &item;
 	}
 
-	mBlueSpheresRendering.renderToBitmap(*bitmaps[0], *bitmaps[1], VideoOut::instance().getScreenWidth(), px, py, rotation, fieldColorA, fieldColorB);
+	const int screenWidth = VideoOut::instance().getScreenWidth();
+	const bool useFiltering = (SharedDatabase::getSettingValue(SharedDatabase::Setting::SETTING_BS_VISUAL_STYLE) & 0x01) != 0;
+	if (mBlueSpheresRendering.needsRendering(*bitmaps[0], *bitmaps[1], screenWidth, px, py, rotation, fieldColorA, fieldColorB, useFiltering))
+	{
+		// The bitmaps get written (and possibly reallocated), while the render thread might still be drawing the last frame using them
+		VideoOut::instance().finishPipelinedRendering();
+
+		mBlueSpheresRendering.renderToBitmap(*bitmaps[0], *bitmaps[1], screenWidth, px, py, rotation, fieldColorA, fieldColorB, useFiltering);
+
+		// Only now the sprites have to be updated by the renderer, e.g. uploaded as textures again
+		++items[0]->mChangeCounter;
+		++items[1]->mChangeCounter;
+	}
 
 	items[0]->mSprite->mOffset.y = VideoOut::instance().getScreenHeight() - bitmaps[0]->mHeight;
 	items[1]->mSprite->mOffset.y = items[0]->mSprite->mOffset.y - bitmaps[1]->mHeight;
@@ -31,6 +31,8 @@ GameClient::GameClient() :
 
 GameClient::~GameClient()
 {
+	// The UDP receive thread must not use the socket any more
+	mConnectionManager.stopReceiveThread();
 	Sockets::shutdownSockets();
 }
 
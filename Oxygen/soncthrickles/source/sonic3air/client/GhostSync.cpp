@@ -22,7 +22,62 @@
 namespace
 {
 	static const constexpr uint32 GHOSTSYNC_BROADCAST_MESSAGE_TYPE = rmx::compileTimeFNV_32("S3AIR_GhostSync");
-	static const constexpr uint8 GHOSTSYNC_BROADCAST_MESSAGE_VERSION = 1;
+	static const constexpr uint8 GHOSTSYNC_BROADCAST_MESSAGE_VERSION = 2;	// Version 1 had all frames fully serialized, version 2 uses delta encoding; both are supported for receiving
+	static const constexpr char* GHOSTSYNC_CHANNEL_PREFIX = "sonic3air-ghostsync-v2-";		// Includes the message version, as older builds drop messages of a newer version, and should not share a channel with newer ones
+	static const constexpr size_t GHOSTSYNC_FRAMES_PER_MESSAGE = 6;
+	static const constexpr size_t GHOSTSYNC_MAX_QUEUED_FRAMES = 12;
+
+	// Flags for the properties that changed compared to the previous frame, used in delta encoding
+	enum DeltaFlag : uint8
+	{
+		DELTA_FRAME_COUNTER	  = 0x01,	// Frame counter did not simply increase by one
+		DELTA_POSITION_X	  = 0x02,
+		DELTA_POSITION_Y	  = 0x04,
+		DELTA_SPRITE		  = 0x08,
+		DELTA_ROTATION		  = 0x10,
+		DELTA_FLAGS			  = 0x20,
+		DELTA_MOVE_DIRECTION  = 0x40,
+		DELTA_FULL_FRAME	  = 0x80	// Character or zone changed, so the frame is fully serialized instead
+	};
+
+	void writeVarInt(VectorBinarySerializer& serializer, uint32 value)
+	{
+		while (value >= 0x80)
+		{
+			serializer.writeAs<uint8>((value & 0x7f) | 0x80);
+			value >>= 7;
+		}
+		serializer.writeAs<uint8>(value);
+	}
+
+	uint32 readVarInt(VectorBinarySerializer& serializer)
+	{
+		uint32 value = 0;
+		for (int shift = 0; shift < 32; shift += 7)
+		{
+			const uint8 byte = serializer.read<uint8>();
+			value |= (uint32)(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0 || serializer.hasError())
+				break;
+		}
+		return value;
+	}
+
+	void serializeDelta16(VectorBinarySerializer& serializer, uint16& value, uint16 previousValue)
+	{
+		// Using zigzag encoding for the difference, so that small negative differences fit into a single byte as well
+		if (serializer.isReading())
+		{
+			const uint32 encoded = readVarInt(serializer);
+			const int32 delta = (int32)(encoded >> 1) ^ -(int32)(encoded & 1);
+			value = (uint16)(previousValue + delta);
+		}
+		else
+		{
+			const int32 delta = (int16)(value - previousValue);
+			writeVarInt(serializer, ((uint32)delta << 1) ^ (uint32)(delta >> 31));
+		}
+	}
 }
 
 
@@ -44,7 +99,7 @@ void GhostSync::performUpdate()
 			if (nullptr != subChannelName)
 			{
 				// Join channel
-				mJoinChannelRequest.mQuery.mChannelName = "sonic3air-ghostsync-" + ConfigurationImpl::instance().mGameServer.mGhostSync.mChannelName + "-" + subChannelName;
+				mJoinChannelRequest.mQuery.mChannelName = GHOSTSYNC_CHANNEL_PREFIX + ConfigurationImpl::instance().mGameServer.mGhostSync.mChannelName + "-" + subChannelName;
 				mJoinChannelRequest.mQuery.mChannelHash = (uint32)rmx::getMurmur2_64(mJoinChannelRequest.mQuery.mChannelName);
 				mGameClient.getServerConnection().sendRequest(mJoinChannelRequest);
 
@@ -142,7 +197,7 @@ bool GhostSync::onReceivedPacket(ReceivedPacketEvaluation& evaluation)
 				return false;
 
 			// Ignore messages of the wrong type or with an unsupported version
-			if (packet.mMessageType != GHOSTSYNC_BROADCAST_MESSAGE_TYPE || packet.mMessageVersion != GHOSTSYNC_BROADCAST_MESSAGE_VERSION)
+			if (packet.mMessageType != GHOSTSYNC_BROADCAST_MESSAGE_TYPE || packet.mMessageVersion < 1 || packet.mMessageVersion > GHOSTSYNC_BROADCAST_MESSAGE_VERSION)
 				return false;
 
 			PlayerData* playerData = nullptr;
@@ -164,20 +219,34 @@ bool GhostSync::onReceivedPacket(ReceivedPacketEvaluation& evaluation)
 
 			VectorBinarySerializer serializer(true, packet.mMessage);
 			const size_t count = (size_t)serializer.read<uint8>();
-			if (count > 12)
+			if (count > GHOSTSYNC_MAX_QUEUED_FRAMES)
+				return true;
+
+			// Read all frames first, so that a broken message does not add anything to the queue
+			GhostData frames[GHOSTSYNC_MAX_QUEUED_FRAMES];
+			for (size_t k = 0; k < count; ++k)
+			{
+				if (packet.mMessageVersion >= 2 && k > 0)
+				{
+					serializeGhostDataDelta(serializer, frames[k], frames[k - 1]);
+				}
+				else
+				{
+					serializeGhostData(serializer, frames[k]);
+				}
+				frames[k].mValid = true;
+			}
+			if (serializer.hasError())
 				return true;
 
-			while (playerData->mGhostDataQueue.size() + count > 12)
+			while (playerData->mGhostDataQueue.size() + count > GHOSTSYNC_MAX_QUEUED_FRAMES)
 			{
-				playerData->mGhostDataQueue.pop_front();
+				playerData->mGhostDataQueue.popFront();
 			}
 			for (size_t k = 0; k < count; ++k)
 			{
-				playerData->mGhostDataQueue.emplace_back();
-				serializeGhostData(serializer, playerData->mGhostDataQueue.back());
-				playerData->mGhostDataQueue.back().mValid = true;
+				playerData->mGhostDataQueue.pushBack() = frames[k];
 			}
-			
 			return true;
 		}
 	}
@@ -215,21 +284,23 @@ void GhostSync::updateSending()
 	if (emulatorInterface.readMemory8(0xffffb046) == 0x0e)						 { mOwnGhostData.mFlags |= GhostData::FLAG_LAYER; }
 	if (emulatorInterface.readMemory16(0xfffffe10) != mOwnGhostData.mZoneAndAct) { mOwnGhostData.mFlags |= GhostData::FLAG_ACT_TRANSITION; }
 
-	mOwnUnsentGhostData.emplace_back(mOwnGhostData);
-	if (mOwnUnsentGhostData.size() >= 6)
+	mOwnUnsentGhostData.pushBack() = mOwnGhostData;
+	if (mOwnUnsentGhostData.size() >= GHOSTSYNC_FRAMES_PER_MESSAGE)
 	{
 		// Send ghost data for the last frames
-		while (mOwnUnsentGhostData.size() > 6)
-			mOwnUnsentGhostData.pop_front();
+		while (mOwnUnsentGhostData.size() > GHOSTSYNC_FRAMES_PER_MESSAGE)
+			mOwnUnsentGhostData.popFront();
 
 		network::BroadcastChannelMessagePacket& packet = mBroadcastChannelMessagePacket;
 		packet.mMessage.clear();
 		VectorBinarySerializer serializer(false, packet.mMessage);
 
+		// Only the first frame is fully serialized, all others are delta-encoded relative to their respective previous frame
 		serializer.writeAs<uint8>(mOwnUnsentGhostData.size());
-		for (GhostData& ghostData : mOwnUnsentGhostData)
+		serializeGhostData(serializer, mOwnUnsentGhostData[0]);
+		for (size_t k = 1; k < mOwnUnsentGhostData.size(); ++k)
 		{
-			serializeGhostData(serializer, ghostData);
+			serializeGhostDataDelta(serializer, mOwnUnsentGhostData[k], mOwnUnsentGhostData[k - 1]);
 		}
 
 		packet.mIsReplicatedData = false;
@@ -272,7 +343,7 @@ void GhostSync::updateGhostPlayers()
 		else
 		{
 			playerData.mShownGhostData = playerData.mGhostDataQueue.front();
-			playerData.mGhostDataQueue.pop_front();
+			playerData.mGhostDataQueue.popFront();
 		}
 
 		const GhostData& ghostData = playerData.mShownGhostData;
@@ -376,3 +447,64 @@ void GhostSync::serializeGhostData(VectorBinarySerializer& serializer, GhostData
 		serializer.serialize(ghostData.mFlags);
 	}
 }
+
+void GhostSync::serializeGhostDataDelta(VectorBinarySerializer& serializer, GhostData& ghostData, const GhostData& previousGhostData)
+{
+	// Start with a byte telling which properties changed, everything else is the same as in the previous frame
+	uint8 changes = 0;
+	if (!serializer.isReading())
+	{
+		if (ghostData.mCharacter != previousGhostData.mCharacter || ghostData.mZoneAndAct != previousGhostData.mZoneAndAct)
+		{
+			changes = DELTA_FULL_FRAME;
+		}
+		else if (ghostData.mZoneAndAct != 0xffff)
+		{
+			if (ghostData.mFrameCounter != (uint16)(previousGhostData.mFrameCounter + 1))	{ changes |= DELTA_FRAME_COUNTER; }
+			if ((int16)ghostData.mPosition.x != (int16)previousGhostData.mPosition.x)		{ changes |= DELTA_POSITION_X; }
+			if ((int16)ghostData.mPosition.y != (int16)previousGhostData.mPosition.y)		{ changes |= DELTA_POSITION_Y; }
+			if (ghostData.mSprite != previousGhostData.mSprite)								{ changes |= DELTA_SPRITE; }
+			if (ghostData.mRotation != previousGhostData.mRotation)							{ changes |= DELTA_ROTATION; }
+			if (ghostData.mFlags != previousGhostData.mFlags)								{ changes |= DELTA_FLAGS; }
+			if (ghostData.mCharacter == 1 && ghostData.mMoveDirection != previousGhostData.mMoveDirection)	{ changes |= DELTA_MOVE_DIRECTION; }	// Only for Tails
+		}
+	}
+	serializer.serialize(changes);
+
+	if (changes & DELTA_FULL_FRAME)
+	{
+		serializeGhostData(serializer, ghostData);
+		return;
+	}
+
+	if (serializer.isReading())
+	{
+		ghostData = previousGhostData;
+		ghostData.mFrameCounter = previousGhostData.mFrameCounter + 1;
+	}
+
+	if (changes & DELTA_FRAME_COUNTER)
+		serializeDelta16(serializer, ghostData.mFrameCounter, previousGhostData.mFrameCounter + 1);
+
+	if (changes & (DELTA_POSITION_X | DELTA_POSITION_Y))
+	{
+		// Positions are 16-bit values on the wire as well
+		uint16 px = (uint16)ghostData.mPosition.x;
+		uint16 py = (uint16)ghostData.mPosition.y;
+		if (changes & DELTA_POSITION_X)
+			serializeDelta16(serializer, px, (uint16)previousGhostData.mPosition.x);
+		if (changes & DELTA_POSITION_Y)
+			serializeDelta16(serializer, py, (uint16)previousGhostData.mPosition.y);
+		if (serializer.isReading())
+			ghostData.mPosition.set((int16)px, (int16)py);
+	}
+
+	if (changes & DELTA_SPRITE)
+		serializeDelta16(serializer, ghostData.mSprite, previousGhostData.mSprite);
+	if (changes & DELTA_ROTATION)
+		serializer.serialize(ghostData.mRotation);
+	if (changes & DELTA_FLAGS)
+		serializer.serialize(ghostData.mFlags);
+	if (changes & DELTA_MOVE_DIRECTION)
+		serializer.serialize(ghostData.mMoveDirection);
+}
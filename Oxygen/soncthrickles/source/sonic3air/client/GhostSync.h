@@ -62,10 +62,36 @@ private:
 		FAILED
 	};
 
+	// Fixed-size queue of ghost data, dropping the oldest entry when adding to a full queue
+	struct GhostDataRingBuffer
+	{
+		static const constexpr size_t CAPACITY = 16;
+
+		GhostData mItems[CAPACITY];
+		size_t mStart = 0;
+		size_t mCount = 0;
+
+		inline bool empty() const	{ return (mCount == 0); }
+		inline size_t size() const	{ return mCount; }
+		inline void clear()			{ mStart = 0;  mCount = 0; }
+
+		inline GhostData& operator[](size_t index)  { return mItems[(mStart + index) % CAPACITY]; }
+		inline GhostData& front()  { return mItems[mStart]; }
+		inline void popFront()	   { mStart = (mStart + 1) % CAPACITY;  --mCount; }
+
+		inline GhostData& pushBack()
+		{
+			if (mCount == CAPACITY)
+				popFront();
+			++mCount;
+			return operator[](mCount - 1);
+		}
+	};
+
 	struct PlayerData
 	{
 		uint32 mPlayerID = 0;
-		std::deque<GhostData> mGhostDataQueue;
+		GhostDataRingBuffer mGhostDataQueue;
 		GhostData mShownGhostData;
 		int mTimeout = 0;
 	};
@@ -73,6 +99,7 @@ private:
 private:
 	const char* getDesiredSubChannelName() const;
 	void serializeGhostData(VectorBinarySerializer& serializer, GhostData& ghostData);
+	void serializeGhostDataDelta(VectorBinarySerializer& serializer, GhostData& ghostData, const GhostData& previousGhostData);
 
 private:
 	GameClient& mGameClient;
@@ -84,7 +111,7 @@ private:
 	const char* mJoiningSubChannelName = nullptr;
 
 	GhostData mOwnGhostData;
-	std::deque<GhostData> mOwnUnsentGhostData;
+	GhostDataRingBuffer mOwnUnsentGhostData;
 	network::BroadcastChannelMessagePacket mBroadcastChannelMessagePacket;
 
 	std::unordered_map<uint32, PlayerData> mGhostPlayers;
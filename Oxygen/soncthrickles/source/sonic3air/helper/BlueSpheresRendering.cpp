@@ -8,11 +8,15 @@
 
 #include "sonic3air/pch.h"
 #include "sonic3air/helper/BlueSpheresRendering.h"
-#include "sonic3air/data/SharedDatabase.h"
 
 #include "oxygen/application/Configuration.h"
 #include "oxygen/simulation/EmulatorInterface.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define USE_SSE2_ROW_OUTPUT
+#endif
+
 //#define OUTPUT_FOG_BITMAPS
 
 
@@ -20,6 +24,7 @@ namespace
 {
 	static const constexpr int LOOKUP_WIDTH  = 496;
 	static const constexpr int LOOKUP_HEIGHT = 224;
+	static const constexpr int MIN_ROWS_PER_TASK = 32;
 
 	static float CAMERA_POSITION_HEIGHT = 0.196f;
 	static float CAMERA_POSITION_BACKANGLE = 6.2f;
@@ -110,6 +115,80 @@ namespace
 		transform.z =  std::sin(angle);
 		transform.w =  std::cos(angle);
 	}
+
+	inline void writeOpaqueRow(uint32* output, int numPixels, const uint8* lookupData, const uint32* colorLookup)
+	{
+		for (int x = 0; x < numPixels; ++x)
+		{
+			output[x] = colorLookup[lookupData[x]];
+		}
+	}
+
+	inline void writeAlphaRow(uint32* output, int numPixels, const uint8* lookupData, const uint8* visibilityData, const uint32* colorLookup)
+	{
+		for (int x = 0; x < numPixels; ++x)
+		{
+			output[x] = (colorLookup[lookupData[x]] & 0x00ffffff) | ((uint32)visibilityData[x] << 24);
+		}
+	}
+
+	// Variants for a color lookup that consists of only two colors, the first for lookup values below 0x80, the second for the others
+	void writeOpaqueRowTwoColors(uint32* output, int numPixels, const uint8* lookupData, const uint32* colors)
+	{
+		int x = 0;
+	#ifdef USE_SSE2_ROW_OUTPUT
+		// Process 16 pixels at once, selecting the color by each lookup value's highest bit
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i color0 = _mm_set1_epi32((int)colors[0]);
+		const __m128i colorDiff = _mm_set1_epi32((int)(colors[0] ^ colors[1]));
+		for (; x + 16 <= numPixels; x += 16)
+		{
+			const __m128i mask8 = _mm_cmplt_epi8(_mm_loadu_si128((const __m128i*)&lookupData[x]), zero);
+			const __m128i mask16lo = _mm_unpacklo_epi8(mask8, mask8);
+			const __m128i mask16hi = _mm_unpackhi_epi8(mask8, mask8);
+			_mm_storeu_si128((__m128i*)&output[x],      _mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpacklo_epi16(mask16lo, mask16lo))));
+			_mm_storeu_si128((__m128i*)&output[x + 4],  _mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpackhi_epi16(mask16lo, mask16lo))));
+			_mm_storeu_si128((__m128i*)&output[x + 8],  _mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpacklo_epi16(mask16hi, mask16hi))));
+			_mm_storeu_si128((__m128i*)&output[x + 12], _mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpackhi_epi16(mask16hi, mask16hi))));
+		}
+	#endif
+		for (; x < numPixels; ++x)
+		{
+			output[x] = colors[lookupData[x] >> 7];
+		}
+	}
+
+	void writeAlphaRowTwoColors(uint32* output, int numPixels, const uint8* lookupData, const uint8* visibilityData, const uint32* colors)
+	{
+		const uint32 rgb[2] = { colors[0] & 0x00ffffff, colors[1] & 0x00ffffff };
+		int x = 0;
+	#ifdef USE_SSE2_ROW_OUTPUT
+		// Same as for the opaque rows, plus the visibility gets moved into the alpha channel
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i color0 = _mm_set1_epi32((int)rgb[0]);
+		const __m128i colorDiff = _mm_set1_epi32((int)(rgb[0] ^ rgb[1]));
+		for (; x + 16 <= numPixels; x += 16)
+		{
+			const __m128i mask8 = _mm_cmplt_epi8(_mm_loadu_si128((const __m128i*)&lookupData[x]), zero);
+			const __m128i mask16lo = _mm_unpacklo_epi8(mask8, mask8);
+			const __m128i mask16hi = _mm_unpackhi_epi8(mask8, mask8);
+
+			// Interleaving with zeroes twice shifts each byte into the highest byte of a 32-bit value
+			const __m128i visibility8 = _mm_loadu_si128((const __m128i*)&visibilityData[x]);
+			const __m128i visibility16lo = _mm_unpacklo_epi8(zero, visibility8);
+			const __m128i visibility16hi = _mm_unpackhi_epi8(zero, visibility8);
+
+			_mm_storeu_si128((__m128i*)&output[x],      _mm_or_si128(_mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpacklo_epi16(mask16lo, mask16lo))), _mm_unpacklo_epi16(zero, visibility16lo)));
+			_mm_storeu_si128((__m128i*)&output[x + 4],  _mm_or_si128(_mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpackhi_epi16(mask16lo, mask16lo))), _mm_unpackhi_epi16(zero, visibility16lo)));
+			_mm_storeu_si128((__m128i*)&output[x + 8],  _mm_or_si128(_mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpacklo_epi16(mask16hi, mask16hi))), _mm_unpacklo_epi16(zero, visibility16hi)));
+			_mm_storeu_si128((__m128i*)&output[x + 12], _mm_or_si128(_mm_xor_si128(color0, _mm_and_si128(colorDiff, _mm_unpackhi_epi16(mask16hi, mask16hi))), _mm_unpackhi_epi16(zero, visibility16hi)));
+		}
+	#endif
+		for (; x < numPixels; ++x)
+		{
+			output[x] = rgb[lookupData[x] >> 7] | ((uint32)visibilityData[x] << 24);
+		}
+	}
 }
 
 
@@ -131,7 +210,24 @@ void BlueSpheresRendering::startup()
 	}
 }
 
-void BlueSpheresRendering::renderToBitmap(Bitmap& bitmapOpaque, Bitmap& bitmapAlpha, int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB)
+bool BlueSpheresRendering::needsRendering(const Bitmap& bitmapOpaque, const Bitmap& bitmapAlpha, int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB, bool useFiltering)
+{
+	RenderedState state;
+	prepareRendering(screenWidth, px, py, rotation, fieldColorA, fieldColorB, useFiltering, state);
+
+	// Bitmaps without the expected size were just created or replaced (e.g. by a reload of the sprite cache), so they need to be filled in any case
+	const int maxX = std::min(LOOKUP_WIDTH, screenWidth);
+	const int numRowsUntilPureGround = LOOKUP_HEIGHT - mNumPureGroundRows;
+	if (bitmapAlpha.empty() || bitmapAlpha.getSize() != Vec2i(maxX, numRowsUntilPureGround - mNumPureSkyRows))
+		return true;
+	if (bitmapOpaque.empty() || bitmapOpaque.getSize() != Vec2i(maxX, mNumPureGroundRows))
+		return true;
+
+	// The output often stays the same for a few frames, e.g. while standing still or rotating
+	return (state.mLookupData != mRenderedState.mLookupData || state.mColorLookup != mRenderedState.mColorLookup || state.mScreenWidth != mRenderedState.mScreenWidth);
+}
+
+void BlueSpheresRendering::renderToBitmap(Bitmap& bitmapOpaque, Bitmap& bitmapAlpha, int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB, bool useFiltering)
 {
 #if 0
 	// This is meant for fine-tuning the camera parameters
@@ -161,148 +257,53 @@ void BlueSpheresRendering::renderToBitmap(Bitmap& bitmapOpaque, Bitmap& bitmapAl
 		GRID_SIZE += FTX::getTimeDifference() * 0.8f;
 #endif
 
-	// Perform calculations that only need to be done once
-	if (!mInitializedLookups)
-	{
-		performLookupCalculations();
-	}
+	RenderedState state;
+	prepareRendering(screenWidth, px, py, rotation, fieldColorA, fieldColorB, useFiltering, state);
 
 	const int maxX = std::min(LOOKUP_WIDTH, screenWidth);
 	const int maxY = LOOKUP_HEIGHT;
 	const int indentX = (screenWidth - maxX) / 2;
 	const int offsetX = (LOOKUP_WIDTH - maxX) / 2;
+	const uint8* lookupDataBase = state.mLookupData;
+	const uint32* mixedFieldColorLookup = state.mColorLookup;
 
-	if (mPureRowsForWidth != screenWidth)
-	{
-		mNumPureSkyRows = 0;
-		for (int row = 0; ; ++row)
-		{
-			const uint8* lookup = &mVisibilityLookup[row * LOOKUP_WIDTH + offsetX];
-			const uint8* end = &mVisibilityLookup[(row + 1) * LOOKUP_WIDTH - offsetX - 1];
-			for (; lookup <= end; ++lookup)
-			{
-				if (*lookup != 0)
-					break;
-			}
-			if (lookup <= end)
-				break;
-			++mNumPureSkyRows;
-		}
-
-		mNumPureGroundRows = 0;
-		for (int row = LOOKUP_HEIGHT - 1; ; --row)
-		{
-			const uint8* lookup = &mVisibilityLookup[row * LOOKUP_WIDTH + offsetX];
-			const uint8* end = &mVisibilityLookup[(row + 1) * LOOKUP_WIDTH - offsetX - 1];
-			for (; lookup <= end; ++lookup)
-			{
-				if (*lookup != 0xff)
-					break;
-			}
-			if (lookup <= end)
-				break;
-			++mNumPureGroundRows;
-		}
-
-		mPureRowsForWidth = screenWidth;
-	}
-
-	// Refresh mixed field color lookup
-	{
-		const bool useFiltering = (SharedDatabase::getSettingValue(SharedDatabase::Setting::SETTING_BS_VISUAL_STYLE) & 0x01) != 0;
-		if (fieldColorA != mLastFieldColorA || fieldColorB != mLastFieldColorB || useFiltering != mLastFiltering)
-		{
-			const Color colorA = colorFromCompact(fieldColorA);
-			const Color colorB = colorFromCompact(fieldColorB);
-			for (int i = 0; i < 0x100; ++i)
-			{
-				const float intensity = useFiltering ? ((float)i / 255.0f) : (i >= 128 ? 1.0f : 0.0f);
-				const uint32 color = (Color::interpolateColor(colorA, colorB, intensity).getABGR32() & 0x00ffffff) | 0xff000000;
-				mMixedFieldColorLookup[i] = color;
-				mMixedFieldColorLookupInverse[0xff - i] = color;
-			}
+	// Ignore the first that are just sky, so completely transparent
+	//  -> Then we have some rows of pixels that can be anything -- sky or ground or something in between
+	//  -> And the rest is only ground
+	const int numRowsUntilPureGround = LOOKUP_HEIGHT - mNumPureGroundRows;
+	bitmapAlpha.create(maxX, numRowsUntilPureGround - mNumPureSkyRows);
+	bitmapOpaque.create(maxX, mNumPureGroundRows);
 
-			mLastFieldColorA = fieldColorA;
-			mLastFieldColorB = fieldColorB;
-			mLastFiltering = useFiltering;
-		}
-	}
+	// Without filtering, there's only two colors, which allows for vectorization
+	const uint32 colors[2] = { mixedFieldColorLookup[0x00], mixedFieldColorLookup[0xff] };
 
-	// Output the bitmaps
+	// Rows are independent of each other, so they can be split up between threads
+	FTX::ParallelFor->execute(maxY - mNumPureSkyRows, MIN_ROWS_PER_TASK, [&](int firstRow, int endRow)
 	{
-		int movementStep = 0;
-		int rotationStep = 0;
-		bool parity = false;
+		for (int y = mNumPureSkyRows + firstRow; y < mNumPureSkyRows + endRow; ++y)
 		{
-			const bool isRotating = (rotation & 0x3f) != 0;
-			if (isRotating || (rotation & 0x40) == 0)
-				px = (px + 0x80) & 0xff00;
-			if (isRotating || (rotation & 0x40) != 0)
-				py = (py + 0x80) & 0xff00;
-
-			parity = (((px + py) & 0x100) != 0) == ((rotation & 0x40) != 0);
-
-			if (isRotating)
+			const uint8* lookupData = &lookupDataBase[y * LOOKUP_WIDTH + offsetX];
+			if (y < numRowsUntilPureGround)
 			{
-				rotationStep = (rotation & 0x3f) / 4;
+				uint32* output = &bitmapAlpha.mData[(y - mNumPureSkyRows) * bitmapAlpha.mWidth + indentX];
+				const uint8* visibilityData = &mVisibilityLookup[y * LOOKUP_WIDTH + offsetX];
+				if (mIsTwoColorLookup)
+					writeAlphaRowTwoColors(output, maxX, lookupData, visibilityData, colors);
+				else
+					writeAlphaRow(output, maxX, lookupData, visibilityData, mixedFieldColorLookup);
 			}
 			else
 			{
-				if ((rotation & 0x80) == 0)
-				{
-					movementStep = (0xff - ((rotation & 0x40) ? px : py) & 0xff) / 8;
-					parity = !parity;
-				}
+				uint32* output = &bitmapOpaque.mData[(y - numRowsUntilPureGround) * bitmapOpaque.mWidth + indentX];
+				if (mIsTwoColorLookup)
+					writeOpaqueRowTwoColors(output, maxX, lookupData, colors);
 				else
-				{
-					movementStep = (((rotation & 0x40) ? px : py) & 0xff) / 8;
-				}
+					writeOpaqueRow(output, maxX, lookupData, mixedFieldColorLookup);
 			}
 		}
+	});
 
-		const uint32* mixedFieldColorLookup = parity ? mMixedFieldColorLookupInverse : mMixedFieldColorLookup;
-		const uint8* lookupDataBase;
-		if (rotationStep != 0)
-		{
-			lookupDataBase = &mRotationIntensityLookup[rotationStep - 1][0];
-		}
-		else
-		{
-			lookupDataBase = &mStraightIntensityLookup[movementStep][0];
-		}
-
-		// Ignore the first that are just sky, so completely transparent
-
-		// Then we have some rows of pixels that can be anything -- sky or ground or something in between
-		const int numRowsUntilPureGround = LOOKUP_HEIGHT - mNumPureGroundRows;
-		bitmapAlpha.create(maxX, numRowsUntilPureGround - mNumPureSkyRows);
-		for (int y = mNumPureSkyRows; y < numRowsUntilPureGround; ++y)
-		{
-			uint32* output = &bitmapAlpha.mData[(y - mNumPureSkyRows) * bitmapAlpha.mWidth + indentX];
-			const uint32* outputEnd = output + maxX;
-			const uint8* lookupData = &lookupDataBase[y * LOOKUP_WIDTH + offsetX];
-			const uint8* visibilityData = &mVisibilityLookup[y * LOOKUP_WIDTH + offsetX];
-
-			for (; output != outputEnd; ++output, ++lookupData, ++visibilityData)
-			{
-				*output = (mixedFieldColorLookup[*lookupData] & 0x00ffffff) | ((uint32)*visibilityData << 24);
-			}
-		}
-
-		// And the rest is only ground
-		bitmapOpaque.create(maxX, mNumPureGroundRows);
-		for (int y = numRowsUntilPureGround; y < maxY; ++y)
-		{
-			uint32* output = &bitmapOpaque.mData[(y - numRowsUntilPureGround) * bitmapOpaque.mWidth + indentX];
-			const uint32* outputEnd = output + maxX;
-			const uint8* lookupData = &lookupDataBase[y * LOOKUP_WIDTH + offsetX];
-
-			for (; output != outputEnd; ++output, ++lookupData)
-			{
-				*output = mixedFieldColorLookup[*lookupData];
-			}
-		}
-	}
+	mRenderedState = state;
 }
 
 void BlueSpheresRendering::writeVisibleSpheresData(uint32 targetAddress, uint32 sourceAddress, uint16 px, uint16 py, uint8 rotation, EmulatorInterface& emulatorInterface)
@@ -372,6 +373,59 @@ void BlueSpheresRendering::writeVisibleSpheresData(uint32 targetAddress, uint32
 	*(uint16*)(&originalOutputPtr[0]) = swapBytes16(count);
 }
 
+void BlueSpheresRendering::prepareRendering(int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB, bool useFiltering, RenderedState& outState)
+{
+	// Perform calculations that only need to be done once
+	if (!mInitializedLookups)
+	{
+		performLookupCalculations();
+	}
+
+	refreshPureRows(screenWidth);
+	refreshMixedFieldColorLookup(fieldColorA, fieldColorB, useFiltering);
+
+	int movementStep = 0;
+	int rotationStep = 0;
+	bool parity = false;
+	{
+		const bool isRotating = (rotation & 0x3f) != 0;
+		if (isRotating || (rotation & 0x40) == 0)
+			px = (px + 0x80) & 0xff00;
+		if (isRotating || (rotation & 0x40) != 0)
+			py = (py + 0x80) & 0xff00;
+
+		parity = (((px + py) & 0x100) != 0) == ((rotation & 0x40) != 0);
+
+		if (isRotating)
+		{
+			rotationStep = (rotation & 0x3f) / 4;
+		}
+		else
+		{
+			if ((rotation & 0x80) == 0)
+			{
+				movementStep = (0xff - ((rotation & 0x40) ? px : py) & 0xff) / 8;
+				parity = !parity;
+			}
+			else
+			{
+				movementStep = (((rotation & 0x40) ? px : py) & 0xff) / 8;
+			}
+		}
+	}
+
+	outState.mColorLookup = parity ? mMixedFieldColorLookupInverse : mMixedFieldColorLookup;
+	if (rotationStep != 0)
+	{
+		outState.mLookupData = &mRotationIntensityLookup[rotationStep - 1][0];
+	}
+	else
+	{
+		outState.mLookupData = &mStraightIntensityLookup[movementStep][0];
+	}
+	outState.mScreenWidth = screenWidth;
+}
+
 bool BlueSpheresRendering::loadLookupData()
 {
 	std::vector<uint8> data;
@@ -689,3 +743,77 @@ void BlueSpheresRendering::performLookupCalculations()
 	// Done
 	mInitializedLookups = true;
 }
+
+void BlueSpheresRendering::refreshPureRows(int screenWidth)
+{
+	if (mPureRowsForWidth == screenWidth)
+		return;
+
+	const int maxX = std::min(LOOKUP_WIDTH, screenWidth);
+	const int offsetX = (LOOKUP_WIDTH - maxX) / 2;
+
+	mNumPureSkyRows = 0;
+	for (int row = 0; ; ++row)
+	{
+		const uint8* lookup = &mVisibilityLookup[row * LOOKUP_WIDTH + offsetX];
+		const uint8* end = &mVisibilityLookup[(row + 1) * LOOKUP_WIDTH - offsetX - 1];
+		for (; lookup <= end; ++lookup)
+		{
+			if (*lookup != 0)
+				break;
+		}
+		if (lookup <= end)
+			break;
+		++mNumPureSkyRows;
+	}
+
+	mNumPureGroundRows = 0;
+	for (int row = LOOKUP_HEIGHT - 1; ; --row)
+	{
+		const uint8* lookup = &mVisibilityLookup[row * LOOKUP_WIDTH + offsetX];
+		const uint8* end = &mVisibilityLookup[(row + 1) * LOOKUP_WIDTH - offsetX - 1];
+		for (; lookup <= end; ++lookup)
+		{
+			if (*lookup != 0xff)
+				break;
+		}
+		if (lookup <= end)
+			break;
+		++mNumPureGroundRows;
+	}
+
+	mPureRowsForWidth = screenWidth;
+	mRenderedState = RenderedState();
+}
+
+void BlueSpheresRendering::refreshMixedFieldColorLookup(uint16 fieldColorA, uint16 fieldColorB, bool useFiltering)
+{
+	if (fieldColorA == mLastFieldColorA && fieldColorB == mLastFieldColorB && useFiltering == mLastFiltering)
+		return;
+
+	const Color colorA = colorFromCompact(fieldColorA);
+	const Color colorB = colorFromCompact(fieldColorB);
+	for (int i = 0; i < 0x100; ++i)
+	{
+		const float intensity = useFiltering ? ((float)i / 255.0f) : (i >= 128 ? 1.0f : 0.0f);
+		const uint32 color = (Color::interpolateColor(colorA, colorB, intensity).getABGR32() & 0x00ffffff) | 0xff000000;
+		mMixedFieldColorLookup[i] = color;
+		mMixedFieldColorLookupInverse[0xff - i] = color;
+	}
+
+	// Check if the lookup is just a split into two halfs with one color each -- this can happen with filtering as well, if both colors are the same
+	mIsTwoColorLookup = true;
+	for (int i = 0; i < 0x100; ++i)
+	{
+		if (mMixedFieldColorLookup[i] != mMixedFieldColorLookup[(i < 0x80) ? 0x00 : 0xff])
+		{
+			mIsTwoColorLookup = false;
+			break;
+		}
+	}
+
+	mLastFieldColorA = fieldColorA;
+	mLastFieldColorB = fieldColorB;
+	mLastFiltering = useFiltering;
+	mRenderedState = RenderedState();
+}
@@ -18,12 +18,26 @@ class BlueSpheresRendering
 public:
 	void startup();
 
-	void renderToBitmap(Bitmap& bitmapOpaque, Bitmap& bitmapAlpha, int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB);
+	// Check whether "renderToBitmap" would change the bitmaps' content; if not, they still hold the right output and rendering can be skipped
+	bool needsRendering(const Bitmap& bitmapOpaque, const Bitmap& bitmapAlpha, int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB, bool useFiltering);
+	void renderToBitmap(Bitmap& bitmapOpaque, Bitmap& bitmapAlpha, int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB, bool useFiltering);
 	void writeVisibleSpheresData(uint32 targetAddress, uint32 sourceAddress, uint16 px, uint16 py, uint8 rotation, EmulatorInterface& emulatorInterface);
 
 private:
+	// What gets written into the bitmaps only depends on the selected intensity lookup (i.e. the rotation or movement step), the colors and the screen width
+	struct RenderedState
+	{
+		const uint8* mLookupData = nullptr;
+		const uint32* mColorLookup = nullptr;
+		int mScreenWidth = 0;
+	};
+
+private:
+	void prepareRendering(int screenWidth, uint16 px, uint16 py, uint8 rotation, uint16 fieldColorA, uint16 fieldColorB, bool useFiltering, RenderedState& outState);
 	bool loadLookupData();
 	void performLookupCalculations();
+	void refreshPureRows(int screenWidth);
+	void refreshMixedFieldColorLookup(uint16 fieldColorA, uint16 fieldColorB, bool useFiltering);
 
 private:
 	bool mInitializedLookups = false;
@@ -39,4 +53,9 @@ private:
 	uint16 mLastFieldColorB = 0;
 	uint32 mMixedFieldColorLookup[0x100];
 	uint32 mMixedFieldColorLookupInverse[0x100];
+	bool mIsTwoColorLookup = false;		// Set if the mixed field color lookup has only two different colors, split at the middle (i.e. no filtering)
+
+	// What was written into the bitmaps last time, so that unchanged output does not have to be rendered again
+	//  -> This gets reset whenever the lookups it refers to change their content
+	RenderedState mRenderedState;
 };
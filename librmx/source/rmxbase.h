@@ -53,6 +53,7 @@
 #include "rmxbase/String.h"
 #include "rmxbase/Tools.h"
 #include "rmxbase/FileHandle.h"
+#include "rmxbase/MemoryMappedFile.h"
 #include "rmxbase/FileIO.h"
 #include "rmxbase/FileProvider.h"
 #include "rmxbase/FileSystem.h"
@@ -67,6 +68,7 @@
 #include "rmxbase/Color.h"
 #include "rmxbase/Bitmap.h"
 #include "rmxbase/Logging.h"
+#include "rmxbase/Tracing.h"
 
 
 // Library linking via pragma
@@ -41,7 +41,7 @@ private:
 private:
 	typedef const uint8* Constuint8Ptr;
 
-	static bool initialized;
+	static std::once_flag initializedFlag;		// Decoding may happen on multiple threads at once
 	static float cos_lookup[8][8];
 	static unsigned char zigzag_lookup[64];
 
@@ -88,7 +88,7 @@ public:
 
 
 // Static data
-bool BitmapJPG::initialized = false;
+std::once_flag BitmapJPG::initializedFlag;
 float BitmapJPG::cos_lookup[8][8];
 unsigned char BitmapJPG::zigzag_lookup[64] = {  0,  1,  5,  6, 14, 15, 27, 28,
 												2,  4,  7, 13, 16, 26, 29, 42,
@@ -127,7 +127,7 @@ unsigned char BitmapJPG::zigzag_lookup[64] = {  0,  1,  5,  6, 14, 15, 27, 28,
 
 BitmapJPG::BitmapJPG()
 {
-	if (!initialized)
+	std::call_once(initializedFlag, []()
 	{
 		for (int i = 0; i < 8; ++i)
 		{
@@ -136,8 +136,7 @@ BitmapJPG::BitmapJPG()
 				cos_lookup[i][j] = cos(float(2*i+1) * j * 0.196349540849f);		// This constant is PI / 16
 			}
 		}
-		initialized = true;
-	}
+	});
 }
 
 void BitmapJPG::refillBitBuffer()
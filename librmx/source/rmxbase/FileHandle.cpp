@@ -72,7 +72,7 @@ bool FileHandle::open(const WString& filename, uint32 flags)
 		case FILE_ACCESS_READ:      mode = (flags & FILE_ACCESS_TEXT) ? L"rt" : L"rb";  break;
 		case FILE_ACCESS_WRITE:     mode = (flags & FILE_ACCESS_TEXT) ? L"wt" : L"wb";  break;
 		case FILE_ACCESS_APPEND:    mode = (flags & FILE_ACCESS_TEXT) ? L"at" : L"ab";  break;
-		case FILE_ACCESS_READWRITE: mode = (flags & FILE_ACCESS_TEXT) ? L"at+": L"ab+"; break;
+		case FILE_ACCESS_READWRITE: mode = (flags & FILE_ACCESS_TEXT) ? L"rt+": L"rb+"; break;
 	}
 
 	if (_wfopen_s(&mFile, *filename, mode) != 0)
@@ -83,7 +83,7 @@ bool FileHandle::open(const WString& filename, uint32 flags)
 		case FILE_ACCESS_READ:      mode = (flags & FILE_ACCESS_TEXT) ? "rt" : "rb";  break;
 		case FILE_ACCESS_WRITE:     mode = (flags & FILE_ACCESS_TEXT) ? "wt" : "wb";  break;
 		case FILE_ACCESS_APPEND:    mode = (flags & FILE_ACCESS_TEXT) ? "at" : "ab";  break;
-		case FILE_ACCESS_READWRITE: mode = (flags & FILE_ACCESS_TEXT) ? "at+": "ab+"; break;
+		case FILE_ACCESS_READWRITE: mode = (flags & FILE_ACCESS_TEXT) ? "rt+": "rb+"; break;
 	}
 
 #ifdef USE_UTF8_PATHS
@@ -16,6 +16,7 @@
 
 	#include <direct.h>
 	#include <io.h>
+	#include <sys/stat.h>
 
 #elif defined(PLATFORM_LINUX) || defined(PLATFORM_WEB)
 	#include <experimental/filesystem>
@@ -226,6 +227,23 @@ namespace rmx
 		return file.getSize();
 	}
 
+	time_t FileIO::getModificationTime(std::wstring_view path)
+	{
+		// Remove a trailing slash, as not all platforms accept that for directories
+		if (!path.empty() && (path.back() == L'/' || path.back() == L'\\'))
+			path.remove_suffix(1);
+
+	#ifdef PLATFORM_WINDOWS
+		struct _stat64 fileinfo;
+		return (_wstat64(std::wstring(path).c_str(), &fileinfo) == 0) ? (time_t)fileinfo.st_mtime : 0;
+	#elif defined(USE_UTF8_PATHS)
+		struct stat fileinfo;
+		return (stat(*WString(path).toUTF8(), &fileinfo) == 0) ? fileinfo.st_mtime : 0;
+	#else
+		#error "Unsupported platform"
+	#endif
+	}
+
 	bool FileIO::readFile(std::wstring_view filename, std::vector<uint8>& outData)
 	{
 		// Read from file system
@@ -291,6 +309,32 @@ namespace rmx
 		createDir(path, true);
 	}
 
+	bool FileIO::removeFile(std::wstring_view filename)
+	{
+	#ifdef USE_STD_FILESYSTEM
+		std::error_code errorCode;
+		return std_filesystem::remove(std_filesystem::path(std::wstring(filename)), errorCode);
+	#else
+		RMX_ASSERT(false, "Not implemented: FileIO::removeFile");
+		return false;
+	#endif
+	}
+
+	bool FileIO::renameFile(std::wstring_view oldFilename, std::wstring_view newFilename)
+	{
+	#ifdef USE_STD_FILESYSTEM
+		// Replace an existing file with the new name, which not all platforms do on their own
+		std::error_code errorCode;
+		const std_filesystem::path newPath = std::wstring(newFilename);
+		std_filesystem::remove(newPath, errorCode);
+		std_filesystem::rename(std_filesystem::path(std::wstring(oldFilename)), newPath, errorCode);
+		return !errorCode;
+	#else
+		RMX_ASSERT(false, "Not implemented: FileIO::renameFile");
+		return false;
+	#endif
+	}
+
 	void FileIO::listFiles(std::wstring_view path, bool recursive, std::vector<FileEntry>& outFileEntries)
 	{
 		std::wstring basePath = std::wstring(path);
@@ -28,12 +28,15 @@ namespace rmx
 	public:
 		static bool exists(std::wstring_view path);
 		static uint64 getFileSize(std::wstring_view filename);
+		static time_t getModificationTime(std::wstring_view path);		// Works for directories as well, returns 0 on failure
 
 		static bool readFile(std::wstring_view filename, std::vector<uint8>& outData);
 		static bool saveFile(std::wstring_view filename, const void* data, size_t size);
 		static InputStream* createInputStream(std::wstring_view filename);
 
 		static void createDirectory(std::wstring_view path);
+		static bool removeFile(std::wstring_view filename);
+		static bool renameFile(std::wstring_view oldFilename, std::wstring_view newFilename);
 		static void listFiles(std::wstring_view path, bool recursive, std::vector<FileEntry>& outFileEntries);
 		static void listFilesByMask(std::wstring_view filemask, bool recursive, std::vector<FileEntry>& outFileEntries);
 		static void listDirectories(std::wstring_view path, std::vector<std::wstring>& outDirectories);
@@ -39,46 +39,38 @@ namespace rmx
 
 	bool FileSystem::exists(std::wstring_view filename)
 	{
-		mTempPath2 = normalizePath(filename, mTempPath2, false);
-		for (MountPoint& mountPoint : mMountPoints)
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(filename, false, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
-			{
-				if (mountPoint.mFileProvider->exists(*localPath))
-					return true;
-			}
+			if (resolvedPath.mFileProvider->exists(resolvedPath.mLocalPath))
+				return true;
 		}
 		return false;
 	}
 
 	uint64 FileSystem::getFileSize(std::wstring_view filename)
 	{
-		mTempPath2 = normalizePath(filename, mTempPath2, false);
-		for (MountPoint& mountPoint : mMountPoints)
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(filename, false, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
-			{
-				uint64 fileSize = 0;
-				if (mountPoint.mFileProvider->getFileSize(*localPath, fileSize))
-					return fileSize;
-			}
+			uint64 fileSize = 0;
+			if (resolvedPath.mFileProvider->getFileSize(resolvedPath.mLocalPath, fileSize))
+				return fileSize;
 		}
 		return 0;
 	}
 
 	bool FileSystem::readFile(std::wstring_view filename, std::vector<uint8>& outData)
 	{
-		mTempPath2 = normalizePath(filename, mTempPath2, false);
-		for (MountPoint& mountPoint : mMountPoints)
+		RMX_TRACE_SCOPE("FileSystem::readFile");
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(filename, false, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
-			{
-				if (mountPoint.mFileProvider->readFile(*localPath, outData))
-					return true;
-			}
+			if (resolvedPath.mFileProvider->readFile(resolvedPath.mLocalPath, outData))
+				return true;
 		}
 		return false;
 	}
@@ -86,22 +78,19 @@ namespace rmx
 	bool FileSystem::saveFile(std::wstring_view filename, const void* data, size_t size)
 	{
 		// TODO: Use file providers here as well
-		mTempPath2 = normalizePath(filename, mTempPath2, false);
-		return FileIO::saveFile(mTempPath2, data, size);
+		std::wstring tempPath;
+		return FileIO::saveFile(normalizePath(filename, tempPath, false), data, size);
 	}
 
 	InputStream* FileSystem::createInputStream(std::wstring_view filename)
 	{
-		mTempPath2 = normalizePath(filename, mTempPath2, false);
-		for (MountPoint& mountPoint : mMountPoints)
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(filename, false, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
-			{
-				InputStream* stream = mountPoint.mFileProvider->createInputStream(*localPath);
-				if (nullptr != stream)
-					return stream;
-			}
+			InputStream* stream = resolvedPath.mFileProvider->createInputStream(resolvedPath.mLocalPath);
+			if (nullptr != stream)
+				return stream;
 		}
 		return nullptr;
 	}
@@ -109,26 +98,23 @@ namespace rmx
 	void FileSystem::createDirectory(std::wstring_view path)
 	{
 		// TODO: Use file providers here as well
-		mTempPath2 = normalizePath(path, mTempPath2, true);
-		FileIO::createDirectory(mTempPath2);
+		std::wstring tempPath;
+		FileIO::createDirectory(normalizePath(path, tempPath, true));
 	}
 
 	void FileSystem::listFiles(std::wstring_view path, bool recursive, std::vector<rmx::FileIO::FileEntry>& outEntries)
 	{
-		mTempPath2 = normalizePath(path, mTempPath2, false);
-		for (MountPoint& mountPoint : mMountPoints)
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(path, false, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
-			{
-				mountPoint.mFileProvider->listFiles(*localPath, recursive, outEntries);
+			resolvedPath.mFileProvider->listFiles(resolvedPath.mLocalPath, recursive, outEntries);
 
-				if (mountPoint.mNeedsPrefixConversion || !mountPoint.mPrefixReplacement.empty())
+			if (resolvedPath.mNeedsPrefixConversion)
+			{
+				for (FileIO::FileEntry& fileEntry : outEntries)
 				{
-					for (FileIO::FileEntry& fileEntry : outEntries)
-					{
-						removeMountPointPath(mountPoint, fileEntry.mPath);
-					}
+					removeMountPointPath(resolvedPath, fileEntry.mPath);
 				}
 			}
 		}
@@ -136,20 +122,17 @@ namespace rmx
 
 	void FileSystem::listFilesByMask(std::wstring_view filemask, bool recursive, std::vector<rmx::FileIO::FileEntry>& outEntries)
 	{
-		mTempPath2 = normalizePath(filemask, mTempPath2, false);
-		for (MountPoint& mountPoint : mMountPoints)
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(filemask, false, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
-			{
-				mountPoint.mFileProvider->listFilesByMask(*localPath, recursive, outEntries);
+			resolvedPath.mFileProvider->listFilesByMask(resolvedPath.mLocalPath, recursive, outEntries);
 
-				if (mountPoint.mNeedsPrefixConversion || !mountPoint.mPrefixReplacement.empty())
+			if (resolvedPath.mNeedsPrefixConversion)
+			{
+				for (FileIO::FileEntry& fileEntry : outEntries)
 				{
-					for (FileIO::FileEntry& fileEntry : outEntries)
-					{
-						removeMountPointPath(mountPoint, fileEntry.mPath);
-					}
+					removeMountPointPath(resolvedPath, fileEntry.mPath);
 				}
 			}
 		}
@@ -157,31 +140,18 @@ namespace rmx
 
 	void FileSystem::listDirectories(std::wstring_view path, std::vector<std::wstring>& outEntries)
 	{
-		mTempPath2 = normalizePath(path, mTempPath2, true);
-		for (MountPoint& mountPoint : mMountPoints)
+		std::vector<ResolvedPath> resolvedPaths;
+		resolvePath(path, true, resolvedPaths);
+		for (const ResolvedPath& resolvedPath : resolvedPaths)
 		{
-			const std::wstring* localPath = applyMountPoint(mountPoint, mTempPath2, mTempPath);
-			if (nullptr != localPath)
+			if (nullptr != resolvedPath.mFileProvider)
 			{
-				mountPoint.mFileProvider->listDirectories(*localPath, outEntries);
+				resolvedPath.mFileProvider->listDirectories(resolvedPath.mLocalPath, outEntries);
 			}
 			else
 			{
-				// Handle the special case that the mount point includes the given path
-				//  -> In this case, we want the mount point itself to act as a virtual directory
-				if (startsWith(mountPoint.mMountPoint, mTempPath2))
-				{
-					const size_t startPos = mTempPath2.size();
-					size_t endPos = startPos;
-					while (endPos < mountPoint.mMountPoint.size() && mountPoint.mMountPoint[endPos] != '/')
-					{
-						++endPos;
-					}
-					if (endPos < mountPoint.mMountPoint.size())
-					{
-						outEntries.emplace_back(mountPoint.mMountPoint, startPos, endPos - startPos);
-					}
-				}
+				// Mount point itself acting as a virtual directory, see "resolvePath"
+				outEntries.emplace_back(resolvedPath.mLocalPath);
 			}
 		}
 	}
@@ -223,17 +193,20 @@ namespace rmx
 
 	void FileSystem::addManagedFileProvider(FileProvider& fileProvider)
 	{
+		std::lock_guard<std::mutex> lock(mMutex);
 		mManagedFileProviders.insert(&fileProvider);
 	}
 
 	void FileSystem::clearMountPoints()
 	{
+		std::lock_guard<std::mutex> lock(mMutex);
 		// This also removes the default real file provider -- this way you can get rid of it
 		mMountPoints.clear();
 	}
 
 	void FileSystem::addMountPoint(FileProvider& fileProvider, std::wstring_view mountPoint, std::wstring_view prefixReplacement, int priority)
 	{
+		std::lock_guard<std::mutex> lock(mMutex);
 		MountPoint& newMountPoint = vectorAdd(mMountPoints);
 		newMountPoint.mFileProvider = &fileProvider;
 		newMountPoint.mPriority = priority;
@@ -280,6 +253,7 @@ namespace rmx
 
 	void FileSystem::onFileProviderDestroyed(FileProvider& fileProvider)
 	{
+		std::lock_guard<std::mutex> lock(mMutex);
 		// Remove all mount points of this file provider
 		for (size_t k = 0; k < mMountPoints.size(); ++k)
 		{
@@ -291,6 +265,53 @@ namespace rmx
 		}
 	}
 
+	void FileSystem::resolvePath(std::wstring_view path, bool isDirectory, std::vector<ResolvedPath>& outResolvedPaths) const
+	{
+		std::wstring normalizedPathBuffer;
+		std::wstring tempPath;
+		const std::wstring_view normalizedPathView = normalizePath(path, normalizedPathBuffer, isDirectory);
+		const std::wstring normalizedPath(normalizedPathView);
+
+		// Only the mount points lookup needs the lock, the file providers get called outside of it
+		std::lock_guard<std::mutex> lock(mMutex);
+		outResolvedPaths.reserve(mMountPoints.size());
+		for (const MountPoint& mountPoint : mMountPoints)
+		{
+			const std::wstring* localPath = applyMountPoint(mountPoint, normalizedPath, tempPath);
+			if (nullptr != localPath)
+			{
+				ResolvedPath& resolvedPath = vectorAdd(outResolvedPaths);
+				resolvedPath.mFileProvider = mountPoint.mFileProvider;
+				resolvedPath.mLocalPath = *localPath;
+				if (mountPoint.mNeedsPrefixConversion)
+				{
+					resolvedPath.mNeedsPrefixConversion = true;
+					resolvedPath.mMountPoint = mountPoint.mMountPoint;
+					resolvedPath.mPrefixReplacement = mountPoint.mPrefixReplacement;
+				}
+			}
+			else if (isDirectory)
+			{
+				// Handle the special case that the mount point includes the given path
+				//  -> In this case, we want the mount point itself to act as a virtual directory
+				if (startsWith(mountPoint.mMountPoint, normalizedPath))
+				{
+					const size_t startPos = normalizedPath.size();
+					size_t endPos = startPos;
+					while (endPos < mountPoint.mMountPoint.size() && mountPoint.mMountPoint[endPos] != '/')
+					{
+						++endPos;
+					}
+					if (endPos < mountPoint.mMountPoint.size())
+					{
+						ResolvedPath& resolvedPath = vectorAdd(outResolvedPaths);
+						resolvedPath.mLocalPath.assign(mountPoint.mMountPoint, startPos, endPos - startPos);
+					}
+				}
+			}
+		}
+	}
+
 	const std::wstring* FileSystem::applyMountPoint(const MountPoint& mountPoint, const std::wstring& inPath, std::wstring& tempPath) const
 	{
 		// Check if path starts with the mount point
@@ -310,15 +331,15 @@ namespace rmx
 		}
 	}
 
-	void FileSystem::removeMountPointPath(const MountPoint& mountPoint, std::wstring& path) const
+	void FileSystem::removeMountPointPath(const ResolvedPath& resolvedPath, std::wstring& path) const
 	{
 		// Check if path starts with the mount point
-		if (!mountPoint.mPrefixReplacement.empty() && !startsWith(path, mountPoint.mPrefixReplacement))
+		if (!resolvedPath.mPrefixReplacement.empty() && !startsWith(path, resolvedPath.mPrefixReplacement))
 			return;
 
-		if (mountPoint.mNeedsPrefixConversion)
+		if (resolvedPath.mNeedsPrefixConversion)
 		{
-			path = mountPoint.mMountPoint + path.substr(mountPoint.mPrefixReplacement.length());
+			path = resolvedPath.mMountPoint + path.substr(resolvedPath.mPrefixReplacement.length());
 		}
 	}
 
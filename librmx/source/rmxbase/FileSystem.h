@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <mutex>
+
 
 class InputStream;
 
@@ -64,26 +66,37 @@ namespace rmx
 	private:
 		struct MountPoint
 		{
-			FileProvider* mFileProvider;
+			FileProvider* mFileProvider = nullptr;
 			int mPriority = 0;
 			std::wstring mMountPoint;
 			std::wstring mPrefixReplacement;
 			bool mNeedsPrefixConversion = false;	// Set if mount point and prefix replacement are different
 		};
 
+		// File provider and path local to it, for each mount point matching a given path
+		struct ResolvedPath
+		{
+			FileProvider* mFileProvider = nullptr;	// Null for a mount point acting as a virtual directory in "listDirectories", with its name as local path
+			std::wstring mLocalPath;
+			bool mNeedsPrefixConversion = false;
+			std::wstring mMountPoint;			// Only set if the mount point needs prefix conversion, to convert paths returned by the file provider back
+			std::wstring mPrefixReplacement;	// Same here
+		};
+
 	private:
 		void onFileProviderDestroyed(FileProvider& fileProvider);
 
+		void resolvePath(std::wstring_view path, bool isDirectory, std::vector<ResolvedPath>& outResolvedPaths) const;
+
 		const std::wstring* applyMountPoint(const MountPoint& mountPoint, const std::wstring& inPath, std::wstring& tempPath) const;
-		void removeMountPointPath(const MountPoint& mountPoint, std::wstring& path) const;
+		void removeMountPointPath(const ResolvedPath& resolvedPath, std::wstring& path) const;
 
 	private:
 		RealFileProvider mDefaultRealFileProvider;
 		std::set<FileProvider*> mManagedFileProviders;	// List of file providers that get deleted automatically with this file system -- though file providers that have mount points here can be managed outside as well, they're not in this list then
 		std::vector<MountPoint> mMountPoints;
 
-		mutable std::wstring mTempPath;		// Only for temporary internal use
-		mutable std::wstring mTempPath2;	// Only for temporary internal use
+		mutable std::mutex mMutex;	// Protects the mount points only, so that multiple threads can access files in parallel; mount points must not get removed while other threads use them though
 	};
 
 }
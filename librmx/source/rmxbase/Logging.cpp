@@ -16,9 +16,11 @@
 #endif
 
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
+#include <thread>
 
 
 namespace rmx
@@ -41,6 +43,147 @@ namespace rmx
 	}
 
 
+	namespace logging
+	{
+		static const constexpr size_t RING_SIZE = 0x1000;	// Must be a power of two
+
+		// Bounded multi-producer ring buffer, see Dmitry Vyukov's MPMC queue
+		//  -> Each slot's sequence number tells whether it is free for the producer at a certain position, or ready to be read by the consumer
+		//  -> There's only one consumer at a time, namely the one holding the logging mutex
+		struct Slot
+		{
+			std::atomic<size_t> mSequence { 0 };
+			LogLevel mLogLevel = LogLevel::INFO;
+			std::string mString;
+		};
+
+		Slot mRing[RING_SIZE];
+		std::atomic<size_t> mEnqueuePosition { 0 };
+		std::atomic<size_t> mDequeuePosition { 0 };		// Only modified by the consumer
+
+		std::thread* mWriterThread = nullptr;				// Intentionally never destroyed at exit, as a still running thread would terminate the application there
+		std::mutex mWakeUpMutex;
+		std::condition_variable mWakeUpCondition;
+		std::atomic<bool> mWakeUpRequested { false };
+		bool mStopRequested = false;						// Protected by the wake up mutex
+		bool mRingInitialized = false;
+
+		std::atomic<std::thread::id> mMutexOwner;			// Thread currently holding the logging mutex, if any
+
+		// Locks the logging mutex and remembers the owning thread, so that a crash handler can tell whether its own thread holds it
+		class MutexLock
+		{
+		public:
+			explicit MutexLock(std::mutex& mutex, bool tryOnly = false) :
+				mMutex(mutex)
+			{
+				if (tryOnly)
+				{
+					mLocked = mMutex.try_lock();
+				}
+				else
+				{
+					mMutex.lock();
+					mLocked = true;
+				}
+
+				if (mLocked)
+					mMutexOwner = std::this_thread::get_id();
+			}
+
+			~MutexLock()
+			{
+				if (mLocked)
+				{
+					mMutexOwner = std::thread::id();
+					mMutex.unlock();
+				}
+			}
+
+			inline bool isLocked() const  { return mLocked; }
+
+		private:
+			std::mutex& mMutex;
+			bool mLocked = false;
+		};
+
+		void initializeRing()
+		{
+			// Only done once, positions keep counting up when restarting the writer
+			if (mRingInitialized)
+				return;
+			for (size_t k = 0; k < RING_SIZE; ++k)
+				mRing[k].mSequence.store(k, std::memory_order_relaxed);
+			mRingInitialized = true;
+
+			// In case the application exits without stopping the writer, which must not be running any more when static objects get destroyed
+			std::atexit([]() { Logging::stopAsyncWriter(); });
+		}
+
+		bool tryEnqueue(LogLevel logLevel, const std::string& string)
+		{
+			size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+			Slot* slot;
+			while (true)
+			{
+				slot = &mRing[position & (RING_SIZE - 1)];
+				const intptr_t difference = (intptr_t)slot->mSequence.load(std::memory_order_acquire) - (intptr_t)position;
+				if (difference == 0)
+				{
+					if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+				{
+					// Ring is full
+					return false;
+				}
+				else
+				{
+					position = mEnqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			slot->mLogLevel = logLevel;
+			slot->mString = string;
+			slot->mSequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool tryDequeue(LogLevel& outLogLevel, std::string& outString)
+		{
+			// Logging mutex must be locked when calling this
+			const size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+			Slot& slot = mRing[position & (RING_SIZE - 1)];
+			if (slot.mSequence.load(std::memory_order_acquire) != position + 1)
+				return false;	// Empty, or the next line is not completely written yet
+
+			outLogLevel = slot.mLogLevel;
+			outString.swap(slot.mString);
+			slot.mSequence.store(position + RING_SIZE, std::memory_order_release);
+			mDequeuePosition.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool hasQueuedLines()
+		{
+			return mEnqueuePosition.load(std::memory_order_acquire) != mDequeuePosition.load(std::memory_order_acquire);
+		}
+
+		void wakeUpWriter()
+		{
+			// Only notify if not done already since the writer's last wake up
+			if (!mWakeUpRequested.exchange(true, std::memory_order_acq_rel))
+			{
+				{
+					std::lock_guard<std::mutex> lock(mWakeUpMutex);
+				}
+				mWakeUpCondition.notify_one();
+			}
+		}
+	}
+
+
 	StdCoutLogger::StdCoutLogger(bool addTimestamp) :
 		mAddTimestamp(addTimestamp)
 	{
@@ -54,7 +197,6 @@ namespace rmx
 			std::cout << detail::getTimestampString();
 		}
 		std::cout << string << "\r\n";
-		std::cout << std::flush;
 
 		// Write to debug output, depending on platform
 	#if defined(PLATFORM_WINDOWS)
@@ -69,6 +211,11 @@ namespace rmx
 	#endif
 	}
 
+	void StdCoutLogger::flush()
+	{
+		std::cout << std::flush;
+	}
+
 
 	FileLogger::FileLogger(const std::wstring& filename, bool addTimestamp) :
 		mAddTimestamp(addTimestamp)
@@ -94,6 +241,10 @@ namespace rmx
 		// Write to file
 		mFileHandle.write(string.c_str(), string.length());
 		mFileHandle.write("\r\n", 2);
+	}
+
+	void FileLogger::flush()
+	{
 		mFileHandle.flush();
 	}
 
@@ -101,6 +252,9 @@ namespace rmx
 
 	void Logging::clear()
 	{
+		stopAsyncWriter();
+
+		logging::MutexLock lock(mMutex);
 		for (LoggerBase* logger : mLoggers)
 			delete logger;
 		mLoggers.clear();
@@ -108,14 +262,146 @@ namespace rmx
 
 	void Logging::addLogger(LoggerBase& logger)
 	{
+		logging::MutexLock lock(mMutex);
 		mLoggers.emplace_back(&logger);
 	}
 
 	void Logging::log(LogLevel logLevel, const std::string& string)
 	{
-		for (LoggerBase* logger : mLoggers)
+		if (mAsyncWriterRunning.load(std::memory_order_acquire))
+		{
+			while (!logging::tryEnqueue(logLevel, string))
+			{
+				// Ring is full, so write out what's there right here, instead of losing lines
+				writeQueuedLines();
+				std::this_thread::yield();
+			}
+
+			if (logLevel >= LogLevel::ERROR)
+			{
+				// Errors often come right before the application terminates, so don't leave them in the queue
+				flush();
+			}
+			else if (logLevel >= LogLevel::WARNING || logging::mEnqueuePosition.load(std::memory_order_relaxed) - logging::mDequeuePosition.load(std::memory_order_relaxed) >= logging::RING_SIZE / 2)
+			{
+				logging::wakeUpWriter();
+			}
+		}
+		else
+		{
+			logging::MutexLock lock(mMutex);
+
+			// Possibly there's still something left from the async writer, which has to come first
+			if (logging::hasQueuedLines())
+			{
+				LogLevel queuedLogLevel;
+				std::string queuedString;
+				while (logging::tryDequeue(queuedLogLevel, queuedString))
+				{
+					for (LoggerBase* logger : mLoggers)
+						logger->log(queuedLogLevel, queuedString);
+				}
+			}
+
+			for (LoggerBase* logger : mLoggers)
+			{
+				logger->log(logLevel, string);
+				logger->flush();
+			}
+		}
+	}
+
+	void Logging::startAsyncWriter()
+	{
+		if (mAsyncWriterRunning)
+			return;
+
+		{
+			logging::MutexLock lock(mMutex);
+			logging::initializeRing();
+		}
+		logging::mStopRequested = false;
+		logging::mWakeUpRequested = false;
+
+		logging::mWriterThread = new std::thread([]()
+		{
+			Tracing::setThreadName("Log Writer");
+			bool stop = false;
+			while (!stop)
+			{
+				{
+					std::unique_lock<std::mutex> lock(logging::mWakeUpMutex);
+					logging::mWakeUpCondition.wait_for(lock, std::chrono::milliseconds(100), []() { return logging::mWakeUpRequested.load() || logging::mStopRequested; });
+					logging::mWakeUpRequested = false;
+					stop = logging::mStopRequested;
+				}
+				writeQueuedLines();
+			}
+		});
+		mAsyncWriterRunning = true;
+	}
+
+	void Logging::stopAsyncWriter()
+	{
+		if (!mAsyncWriterRunning)
+			return;
+
+		// Lines logged from now on get written directly, after all queued lines
+		mAsyncWriterRunning = false;
+		{
+			std::lock_guard<std::mutex> lock(logging::mWakeUpMutex);
+			logging::mStopRequested = true;
+		}
+		logging::mWakeUpCondition.notify_one();
+		logging::mWriterThread->join();
+		delete logging::mWriterThread;
+		logging::mWriterThread = nullptr;
+		writeQueuedLines();
+	}
+
+	void Logging::flush()
+	{
+		writeQueuedLines();
+	}
+
+	void Logging::flushAfterCrash()
+	{
+		// This must not depend on the writer thread, and must not wait for the mutex
+		//  -> If the crashed thread holds the mutex itself, even trying to lock it is undefined behavior, and the loggers might be in an inconsistent state
+		if (logging::mMutexOwner.load() == std::this_thread::get_id())
+			return;
+
+		// Only a single attempt, if another thread holds the mutex, there's no telling when it gets released
+		logging::MutexLock lock(mMutex, true);
+		if (lock.isLocked())
+		{
+			writeQueuedLinesInternal();
+		}
+	}
+
+	void Logging::writeQueuedLines()
+	{
+		logging::MutexLock lock(mMutex);
+		writeQueuedLinesInternal();
+	}
+
+	void Logging::writeQueuedLinesInternal()
+	{
+		// Logging mutex must be locked when calling this
+		LogLevel logLevel;
+		std::string string;
+		bool anyWritten = false;
+		while (logging::tryDequeue(logLevel, string))
+		{
+			for (LoggerBase* logger : mLoggers)
+				logger->log(logLevel, string);
+			anyWritten = true;
+		}
+
+		if (anyWritten)
 		{
-			logger->log(logLevel, string);
+			for (LoggerBase* logger : mLoggers)
+				logger->flush();
 		}
 	}
 
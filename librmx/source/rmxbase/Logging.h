@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 
 namespace rmx
 {
@@ -26,6 +29,7 @@ namespace rmx
 	public:
 		virtual ~LoggerBase() {}
 		virtual void log(LogLevel logLevel, const std::string& string) = 0;
+		virtual void flush() {}
 	};
 
 
@@ -34,6 +38,7 @@ namespace rmx
 	public:
 		explicit StdCoutLogger(bool addTimestamp = false);
 		void log(LogLevel logLevel, const std::string& string) override;
+		void flush() override;
 
 	private:
 		bool mAddTimestamp = false;
@@ -45,6 +50,7 @@ namespace rmx
 	public:
 		FileLogger(const std::wstring& filename, bool addTimestamp = false);
 		void log(LogLevel logLevel, const std::string& string) override;
+		void flush() override;
 
 	private:
 		FileHandle mFileHandle;
@@ -52,6 +58,10 @@ namespace rmx
 	};
 
 
+	// Log lines get written to all registered loggers, either directly or by a background writer thread
+	//  - With the async writer running, "log" only puts the line into a bounded lock-free ring buffer
+	//  - The writer thread writes lines in batches and flushes the loggers afterwards, at least every 100 ms, and right away for warnings and errors
+	//  - If the ring buffer is full, the logging thread writes out the queued lines itself, so no lines get lost
 	class Logging
 	{
 	public:
@@ -59,8 +69,23 @@ namespace rmx
 		static void addLogger(LoggerBase& logger);
 		static void log(LogLevel logLevel, const std::string& string);
 
+		static void startAsyncWriter();
+		static void stopAsyncWriter();
+
+		// Writes out all queued lines and flushes all loggers, e.g. before the application terminates
+		static void flush();
+
+		// Same for crash handlers, but skips writing if the logging mutex is held by the crashed thread itself or can't be locked right away
+		static void flushAfterCrash();
+
+	private:
+		static void writeQueuedLines();
+		static void writeQueuedLinesInternal();
+
 	private:
 		static inline std::vector<LoggerBase*> mLoggers;
+		static inline std::mutex mMutex;		// Log output may come from worker threads as well
+		static inline std::atomic<bool> mAsyncWriterRunning { false };
 	};
 
 }
@@ -0,0 +1,114 @@
+/*
+*	rmx Library
+*	Copyright (C) 2008-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "../rmxbase.h"
+
+#if defined(PLATFORM_WINDOWS)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#define USE_MEMORY_MAPPING
+
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_MAC) || defined(PLATFORM_ANDROID)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define USE_MEMORY_MAPPING
+#endif
+
+
+MemoryMappedFile::MemoryMappedFile()
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	close();
+}
+
+bool MemoryMappedFile::open(const std::wstring& filename)
+{
+	close();
+
+#if defined(PLATFORM_WINDOWS)
+	HANDLE fileHandle = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (nullptr == mappingHandle)
+	{
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	const void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (nullptr == data)
+	{
+		CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	mFileHandle = fileHandle;
+	mMappingHandle = mappingHandle;
+	mData = (const uint8*)data;
+	mSize = (size_t)fileSize.QuadPart;
+	return true;
+
+#elif defined(USE_MEMORY_MAPPING)
+	const int fd = ::open(*WString(filename).toUTF8(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);		// The mapping stays valid without the file descriptor
+	if (data == MAP_FAILED)
+		return false;
+
+	mData = (const uint8*)data;
+	mSize = (size_t)fileInfo.st_size;
+	return true;
+
+#else
+	return false;
+#endif
+}
+
+void MemoryMappedFile::close()
+{
+	if (nullptr == mData)
+		return;
+
+#if defined(PLATFORM_WINDOWS)
+	UnmapViewOfFile(mData);
+	CloseHandle((HANDLE)mMappingHandle);
+	CloseHandle((HANDLE)mFileHandle);
+	mMappingHandle = nullptr;
+	mFileHandle = nullptr;
+#elif defined(USE_MEMORY_MAPPING)
+	munmap((void*)mData, mSize);
+#endif
+
+	mData = nullptr;
+	mSize = 0;
+}
@@ -0,0 +1,33 @@
+/*
+*	rmx Library
+*	Copyright (C) 2008-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+
+// Read-only memory mapping of a whole file; not supported on all platforms, so callers need a fallback if "open" fails
+class API_EXPORT MemoryMappedFile
+{
+public:
+	MemoryMappedFile();
+	~MemoryMappedFile();
+
+	bool open(const std::wstring& filename);
+	void close();
+
+	inline bool isOpen() const  { return (nullptr != mData); }
+	inline const uint8* getData() const  { return mData; }
+	inline size_t getSize() const  { return mSize; }
+
+private:
+	const uint8* mData = nullptr;
+	size_t mSize = 0;
+#ifdef PLATFORM_WINDOWS
+	void* mFileHandle = nullptr;
+	void* mMappingHandle = nullptr;
+#endif
+};
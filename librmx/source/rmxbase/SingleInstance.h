@@ -25,14 +25,15 @@ public:
 protected:
 	SingleInstance()
 	{
-		// TODO: Sanity check: (mSingleInstance == nullptr)
-		mSingleInstance = static_cast<CLASS*>(this);
+		// Additional instances (like a snapshot copy) don't replace the one that's already registered
+		if (nullptr == mSingleInstance)
+			mSingleInstance = static_cast<CLASS*>(this);
 	}
 
 	virtual ~SingleInstance()
 	{
-		// TODO: Sanity check: (mSingleInstance == this)
-		mSingleInstance = nullptr;
+		if (mSingleInstance == this)
+			mSingleInstance = nullptr;
 	}
 
 private:
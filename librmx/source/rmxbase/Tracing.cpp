@@ -0,0 +1,263 @@
+/*
+*	rmx Library
+*	Copyright (C) 2008-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "../rmxbase.h"
+
+#include <chrono>
+#include <mutex>
+
+
+namespace rmx
+{
+	namespace tracing
+	{
+		static const constexpr size_t MAX_EVENTS_PER_THREAD = 0x8000;
+		static const constexpr uint64 INSTANT_EVENT = 0xffffffffffffffffull;
+
+		struct Event
+		{
+			const char* mName = nullptr;
+			uint64 mStartTime = 0;
+			uint64 mDuration = 0;		// INSTANT_EVENT for events without duration
+		};
+
+		// Only the owning thread writes events, and publishes them by incrementing the number of events afterwards
+		struct ThreadBuffer
+		{
+			std::vector<Event> mEvents;
+			std::atomic<size_t> mNumEvents { 0 };
+			std::atomic<uint32> mNumDropped { 0 };
+			std::atomic<uint32> mCaptureIndex { 0 };
+			std::atomic<const char*> mThreadName { nullptr };
+			uint32 mThreadIndex = 0;
+		};
+
+		std::mutex mMutex;		// Only used for registration of threads and names, not for recording
+		std::vector<ThreadBuffer*> mThreadBuffers;
+		std::unordered_set<std::string> mInternedNames;
+		std::atomic<uint32> mCaptureIndex { 0 };
+		uint64 mCaptureStartTime = 0;
+		std::wstring mCaptureFilename;
+		uint32 mRemainingFrames = 0;
+
+		thread_local ThreadBuffer* tThreadBuffer = nullptr;
+		thread_local const char* tThreadName = nullptr;
+
+		const char* internNameInternal(std::string_view name)
+		{
+			// Node-based container, so the pointers stay valid
+			return mInternedNames.emplace(name).first->c_str();
+		}
+
+		ThreadBuffer& getThreadBuffer()
+		{
+			ThreadBuffer* buffer = tThreadBuffer;
+			if (nullptr == buffer)
+			{
+				// First event on this thread, buffers get reused in all later captures
+				buffer = new ThreadBuffer();
+				buffer->mEvents.resize(MAX_EVENTS_PER_THREAD);
+				buffer->mThreadName = tThreadName;
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					buffer->mThreadIndex = (uint32)mThreadBuffers.size() + 1;
+					mThreadBuffers.push_back(buffer);
+				}
+				tThreadBuffer = buffer;
+			}
+
+			const uint32 captureIndex = mCaptureIndex.load(std::memory_order_acquire);
+			if (buffer->mCaptureIndex.load(std::memory_order_relaxed) != captureIndex)
+			{
+				// Events from a previous capture are not needed any more
+				buffer->mNumEvents.store(0, std::memory_order_relaxed);
+				buffer->mNumDropped.store(0, std::memory_order_relaxed);
+				buffer->mCaptureIndex.store(captureIndex, std::memory_order_release);
+			}
+			return *buffer;
+		}
+
+		void addEvent(const char* name, uint64 startTime, uint64 duration)
+		{
+			ThreadBuffer& buffer = getThreadBuffer();
+			const size_t index = buffer.mNumEvents.load(std::memory_order_relaxed);
+			if (index >= buffer.mEvents.size())
+			{
+				buffer.mNumDropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			Event& event = buffer.mEvents[index];
+			event.mName = name;
+			event.mStartTime = startTime;
+			event.mDuration = duration;
+			buffer.mNumEvents.store(index + 1, std::memory_order_release);
+		}
+
+		void appendEscapedString(std::string& output, const char* string)
+		{
+			for (const char* ch = string; *ch; ++ch)
+			{
+				if (*ch == '"' || *ch == '\\')
+					output += '\\';
+				if ((uint8)*ch >= 0x20)
+					output += *ch;
+			}
+		}
+
+		void appendMicroseconds(std::string& output, uint64 nanoseconds)
+		{
+			char buffer[32];
+			snprintf(buffer, sizeof(buffer), "%llu.%03u", (unsigned long long)(nanoseconds / 1000), (uint32)(nanoseconds % 1000));
+			output += buffer;
+		}
+	}
+
+	using namespace tracing;
+
+
+	std::atomic<bool> Tracing::mCapturing { false };
+
+	void Tracing::startCapture(const std::wstring& filename, uint32 numFrames)
+	{
+		if (isCapturing())
+			return;
+
+		mCaptureFilename = filename;
+		mRemainingFrames = numFrames;
+		mCaptureStartTime = getTimestamp();
+
+		// Threads reset their buffers on their next event
+		mCaptureIndex.fetch_add(1, std::memory_order_release);
+		mCapturing.store(true, std::memory_order_release);
+	}
+
+	bool Tracing::stopCapture()
+	{
+		if (!isCapturing())
+			return false;
+
+		mCapturing.store(false, std::memory_order_release);
+		const uint32 captureIndex = mCaptureIndex.load(std::memory_order_relaxed);
+
+		std::vector<ThreadBuffer*> threadBuffers;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			threadBuffers = mThreadBuffers;
+		}
+
+		// Build the output JSON manually, as there can be a lot of events
+		std::string output;
+		output.reserve(0x100000);
+		output += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool first = true;
+		uint32 numDropped = 0;
+		for (ThreadBuffer* buffer : threadBuffers)
+		{
+			if (buffer->mCaptureIndex.load(std::memory_order_acquire) != captureIndex)
+				continue;
+
+			// Events written while stopping are possibly not included, but everything that was published is complete
+			const size_t numEvents = buffer->mNumEvents.load(std::memory_order_acquire);
+			numDropped += buffer->mNumDropped.load(std::memory_order_relaxed);
+			const std::string tid = std::to_string(buffer->mThreadIndex);
+
+			if (!first)
+				output += ",\n";
+			first = false;
+			output += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"";
+			const char* threadName = buffer->mThreadName.load(std::memory_order_relaxed);
+			appendEscapedString(output, (nullptr == threadName) ? ("Thread " + tid).c_str() : threadName);
+			output += "\"}}";
+
+			for (size_t k = 0; k < numEvents; ++k)
+			{
+				const Event& event = buffer->mEvents[k];
+				output += ",\n{\"name\":\"";
+				appendEscapedString(output, event.mName);
+				output += "\",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+				appendMicroseconds(output, (event.mStartTime > mCaptureStartTime) ? (event.mStartTime - mCaptureStartTime) : 0);
+				if (event.mDuration == INSTANT_EVENT)
+				{
+					output += ",\"ph\":\"i\",\"s\":\"t\"}";
+				}
+				else
+				{
+					output += ",\"ph\":\"X\",\"dur\":";
+					appendMicroseconds(output, event.mDuration);
+					output += "}";
+				}
+			}
+		}
+		output += "\n]}\n";
+
+		if (numDropped > 0)
+		{
+			RMX_LOG_WARNING("Trace capture dropped " << numDropped << " events because of full buffers");
+		}
+		const bool success = FileIO::saveFile(mCaptureFilename, output.data(), output.length());
+		RMX_CHECK(success, "Failed to write trace capture", );
+		return success;
+	}
+
+	void Tracing::nextFrame()
+	{
+		if (!isCapturing())
+			return;
+
+		addInstantEvent("Frame");
+		if (mRemainingFrames > 0)
+		{
+			--mRemainingFrames;
+			if (mRemainingFrames == 0)
+			{
+				stopCapture();
+			}
+		}
+	}
+
+	void Tracing::setThreadName(std::string_view name)
+	{
+		const char* internedName;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			internedName = internNameInternal(name);
+		}
+		tThreadName = internedName;
+		if (nullptr != tThreadBuffer)
+		{
+			tThreadBuffer->mThreadName.store(internedName, std::memory_order_relaxed);
+		}
+	}
+
+	const char* Tracing::internName(std::string_view name)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return internNameInternal(name);
+	}
+
+	uint64 Tracing::getTimestamp()
+	{
+		return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Tracing::addCompleteEvent(const char* name, uint64 startTime)
+	{
+		// Still record this if the capture stopped meanwhile, it possibly won't make it into the output then
+		addEvent(name, startTime, getTimestamp() - startTime);
+	}
+
+	void Tracing::addInstantEvent(const char* name)
+	{
+		if (isCapturing())
+		{
+			addEvent(name, getTimestamp(), INSTANT_EVENT);
+		}
+	}
+
+}
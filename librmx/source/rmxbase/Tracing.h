@@ -0,0 +1,61 @@
+/*
+*	rmx Library
+*	Copyright (C) 2008-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#pragma once
+
+#include <atomic>
+
+
+namespace rmx
+{
+
+	// Timeline capture of scoped events on all threads, written as Chrome trace event JSON (can be opened in Perfetto or "chrome://tracing")
+	//  - Each thread records into a buffer of its own, so recording needs no locks
+	//  - Outside of a capture, a scope only costs a check of an atomic flag
+	//  - Capture start, stop and frame counting must all be done by the same thread (usually the main thread)
+	class API_EXPORT Tracing
+	{
+	public:
+		struct Scope
+		{
+		public:
+			// Name must stay valid until the end of the capture, so use string literals or "internName"; a null pointer disables the scope
+			inline explicit Scope(const char* name) : mName(name), mActive(nullptr != name && isCapturing())  { if (mActive) mStartTime = getTimestamp(); }
+			inline ~Scope()  { if (mActive) addCompleteEvent(mName, mStartTime); }
+
+		private:
+			const char* mName = nullptr;
+			uint64 mStartTime = 0;
+			bool mActive = false;
+		};
+
+	public:
+		inline static bool isCapturing()  { return mCapturing.load(std::memory_order_relaxed); }
+
+		// Capture runs for the given number of frames, or until stopped explicitly; either way, the output gets written at the end
+		static void startCapture(const std::wstring& filename, uint32 numFrames);
+		static bool stopCapture();
+		static void nextFrame();
+
+		static void setThreadName(std::string_view name);
+		static const char* internName(std::string_view name);
+
+		static uint64 getTimestamp();
+		static void addCompleteEvent(const char* name, uint64 startTime);
+		static void addInstantEvent(const char* name);
+
+	private:
+		static std::atomic<bool> mCapturing;
+	};
+
+}
+
+
+#define RMX_TRACE_SCOPE_CONCAT_INNER(a, b) a##b
+#define RMX_TRACE_SCOPE_CONCAT(a, b) RMX_TRACE_SCOPE_CONCAT_INNER(a, b)
+#define RMX_TRACE_SCOPE(name)  rmx::Tracing::Scope RMX_TRACE_SCOPE_CONCAT(_traceScope, __LINE__)(name)
@@ -9,60 +9,49 @@
 #include "../rmxbase.h"
 
 
-namespace
+template<typename T>
+FORCE_INLINE void VectorBinarySerializer::serializePrimitive(T& value)
 {
-	template<typename T>
-	FORCE_INLINE bool serializePrimitiveDataType(T& value, bool reading, std::vector<uint8>& buffer, size_t& readPosition)
+	if (mReading)
 	{
-		if (reading)
-		{
-			if (readPosition + sizeof(T) > buffer.size())
-				return false;
-
-			value = *(T*)&buffer[readPosition];
-			readPosition += sizeof(T);
-		}
-		else
-		{
-			const size_t oldSize = buffer.size();
-			buffer.resize(oldSize + sizeof(T));
-			*(T*)&buffer[oldSize] = value;
-		}
-		return true;
+		const uint8* pointer = readAccess(sizeof(T));
+		if (nullptr != pointer)
+			memcpy(&value, pointer, sizeof(T));
 	}
-
-	template<>
-	FORCE_INLINE bool serializePrimitiveDataType<bool>(bool& value, bool reading, std::vector<uint8>& buffer, size_t& readPosition)
+	else
 	{
-		if (reading)
-		{
-			if (readPosition >= buffer.size())
-				return false;
-
-			value = *(bool*)&buffer[readPosition];
-			++readPosition;
-		}
-		else
-		{
-			const size_t oldSize = buffer.size();
-			buffer.resize(oldSize + 1);
-			buffer[oldSize] = value ? 1 : 0;
-		}
-		return true;
+		uint8* pointer = writeAccess(sizeof(T));
+		if (nullptr != pointer)
+			memcpy(pointer, &value, sizeof(T));
 	}
 }
 
 
 VectorBinarySerializer::VectorBinarySerializer(bool read, std::vector<uint8>& buffer) :
 	mReading(read),
-	mBuffer(buffer)
+	mVector(&buffer)
 {
 }
 
 VectorBinarySerializer::VectorBinarySerializer(bool read, const std::vector<uint8>& buffer) :
 	mReading(read),
-	mBuffer(const_cast<std::vector<uint8>&>(buffer))
+	mVector(const_cast<std::vector<uint8>*>(&buffer))
+{
+}
+
+VectorBinarySerializer::VectorBinarySerializer(bool read, uint8* data, size_t size) :
+	mReading(read),
+	mData(data),
+	mSize(size)
+{
+}
+
+VectorBinarySerializer::VectorBinarySerializer(bool read, const uint8* data, size_t size) :
+	mReading(read),
+	mData(const_cast<uint8*>(data)),
+	mSize(size)
 {
+	RMX_ASSERT(read, "Can't write into a constant memory region");
 }
 
 void VectorBinarySerializer::read(void* pointer, size_t size)
@@ -76,7 +65,11 @@ void VectorBinarySerializer::read(void* pointer, size_t size)
 
 void VectorBinarySerializer::write(const void* pointer, size_t size)
 {
-	memcpy(writeAccess(size), pointer, size);
+	uint8* target = writeAccess(size);
+	if (nullptr != target)
+	{
+		memcpy(target, pointer, size);
+	}
 }
 
 void VectorBinarySerializer::serialize(void* pointer, size_t size)
@@ -93,57 +86,59 @@ void VectorBinarySerializer::serialize(void* pointer, size_t size)
 
 void VectorBinarySerializer::serialize(bool& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	uint8 byte = value ? 1 : 0;
+	serializePrimitive(byte);
+	value = (byte != 0);
 }
 
 void VectorBinarySerializer::serialize(uint8& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(int8& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(uint16& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(int16& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(uint32& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(int32& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(uint64& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(int64& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(float& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(double& value)
 {
-	mHasError = (mHasError || !serializePrimitiveDataType(value, mReading, mBuffer, mReadPosition));
+	serializePrimitive(value);
 }
 
 void VectorBinarySerializer::serialize(std::string& value, size_t stringLengthLimit)
@@ -199,7 +194,12 @@ void VectorBinarySerializer::serialize(std::wstring& value)
 			static_assert(sizeof(wchar_t) == 2);
 			read(&value[0], value.length() * sizeof(wchar_t));
 		#else
-			const uint16* pointer = (uint16*)readAccess(value.length() * 2);
+			const uint16* pointer = (const uint16*)readAccess(value.length() * 2);
+			if (nullptr == pointer)
+			{
+				value.clear();
+				return;
+			}
 			for (size_t i = 0; i < value.length(); ++i)
 				value[i] = (wchar_t)pointer[i];
 		#endif
@@ -217,8 +217,11 @@ void VectorBinarySerializer::serialize(std::wstring& value)
 		#else
 			const size_t size = value.length() * 2;
 			uint16* pointer = (uint16*)writeAccess(size);
-			for (size_t i = 0; i < value.length(); ++i)
-				pointer[i] = (uint16)value[i];
+			if (nullptr != pointer)
+			{
+				for (size_t i = 0; i < value.length(); ++i)
+					pointer[i] = (uint16)value[i];
+			}
 		#endif
 		}
 	}
@@ -347,8 +350,11 @@ void VectorBinarySerializer::write(std::wstring_view value)
 	#else
 		const size_t size = value.length() * 2;
 		uint16* pointer = (uint16*)writeAccess(size);
-		for (size_t i = 0; i < value.length(); ++i)
-			pointer[i] = (uint16)value[i];
+		if (nullptr != pointer)
+		{
+			for (size_t i = 0; i < value.length(); ++i)
+				pointer[i] = (uint16)value[i];
+		}
 	#endif
 	}
 }
@@ -365,7 +371,7 @@ const uint8* VectorBinarySerializer::peek() const
 {
 	if (mReading)
 	{
-		return &mBuffer[mReadPosition];
+		return getData() + mReadPosition;
 	}
 	else
 	{
@@ -376,21 +382,36 @@ const uint8* VectorBinarySerializer::peek() const
 const uint8* VectorBinarySerializer::readAccess(size_t size)
 {
 	// Don't read more data than there is
-	if (mReadPosition + size > mBuffer.size())
+	const size_t totalSize = getSize();
+	if (mReadPosition + size > totalSize)
 	{
 		mHasError = true;
-		mReadPosition = mBuffer.size();
+		mReadPosition = totalSize;
 		return nullptr;
 	}
 
-	const uint8* result = &mBuffer[mReadPosition];
+	const uint8* result = getData() + mReadPosition;
 	mReadPosition += size;
 	return result;
 }
 
 uint8* VectorBinarySerializer::writeAccess(size_t size)
 {
-	const size_t oldSize = mBuffer.size();
-	mBuffer.resize(oldSize + size);
-	return &mBuffer[oldSize];
+	if (nullptr != mVector)
+	{
+		const size_t oldSize = mVector->size();
+		mVector->resize(oldSize + size);
+		return mVector->data() + oldSize;
+	}
+
+	// A fixed memory region can't grow
+	if (mWritePosition + size > mSize)
+	{
+		mHasError = true;
+		return nullptr;
+	}
+
+	uint8* result = mData + mWritePosition;
+	mWritePosition += size;
+	return result;
 }
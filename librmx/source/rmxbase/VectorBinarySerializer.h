@@ -8,19 +8,24 @@
 
 #pragma once
 
+// Binary serializer working either on a vector that grows as needed, or on a fixed memory region provided by the caller
+//  - A fixed memory region can e.g. be a memory-mapped file for reading, or a preallocated buffer for writing
+//  - When writing into a fixed memory region, running out of space sets the error flag instead of reallocating
 class VectorBinarySerializer
 {
 public:
 	VectorBinarySerializer(bool read, std::vector<uint8>& buffer);
 	VectorBinarySerializer(bool read, const std::vector<uint8>& buffer);
+	VectorBinarySerializer(bool read, uint8* data, size_t size);
+	VectorBinarySerializer(bool read, const uint8* data, size_t size);
 
 	inline bool isReading() const		   { return mReading; }
-	inline size_t getSize() const		   { return mBuffer.size(); }
+	inline size_t getSize() const		   { return (nullptr != mVector) ? mVector->size() : mReading ? mSize : mWritePosition; }
 	inline size_t getReadPosition() const  { return mReadPosition; }
-	inline size_t getRemaining() const	   { return mBuffer.size() - mReadPosition; }
+	inline size_t getRemaining() const	   { return getSize() - mReadPosition; }
 
-	inline const std::vector<uint8>& getBuffer() const	 { return mBuffer; }
-	inline uint8* getBufferPointer(size_t offset) const	 { return &mBuffer[offset]; }
+	inline const uint8* getData() const					 { return (nullptr != mVector) ? mVector->data() : mData; }
+	inline uint8* getBufferPointer(size_t offset) const	 { return const_cast<uint8*>(getData()) + offset; }
 
 	inline bool hasError() const  { return mHasError; }
 	inline void setError()		  { mHasError = true; }
@@ -30,6 +35,46 @@ public:
 
 	void serialize(void* pointer, size_t size);
 
+	// Bulk serialization of plain data arrays, with a single bounds check for the whole array
+	template <typename T>
+	void serializeArray(T* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		serialize((void*)values, count * sizeof(T));
+	}
+
+	// Same as "serializeArray", but storing each element as type T
+	template <typename T, typename S>
+	void serializeArrayAs(S* values, size_t count)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		if (mReading)
+		{
+			const uint8* pointer = readAccess(count * sizeof(T));
+			if (nullptr == pointer)
+				return;
+
+			for (size_t k = 0; k < count; ++k)
+			{
+				T value;
+				memcpy(&value, pointer + k * sizeof(T), sizeof(T));
+				values[k] = static_cast<S>(value);
+			}
+		}
+		else
+		{
+			uint8* pointer = writeAccess(count * sizeof(T));
+			if (nullptr == pointer)
+				return;
+
+			for (size_t k = 0; k < count; ++k)
+			{
+				const T value = static_cast<T>(values[k]);
+				memcpy(pointer + k * sizeof(T), &value, sizeof(T));
+			}
+		}
+	}
+
 	void serialize(bool& value);
 	void serialize(uint8& value);
 	void serialize(int8& value);
@@ -136,12 +181,18 @@ public:
 	const uint8* peek() const;
 
 private:
+	template <typename T>
+	void serializePrimitive(T& value);
+
 	const uint8* readAccess(size_t size);
 	uint8* writeAccess(size_t size);
 
 private:
 	bool mReading;
-	std::vector<uint8>& mBuffer;
+	std::vector<uint8>* mVector = nullptr;	// Null if working on a fixed memory region
+	uint8* mData = nullptr;					// Fixed memory region, only used if there's no vector
+	size_t mSize = 0;						// Size of the fixed memory region
 	size_t mReadPosition = 0;
+	size_t mWritePosition = 0;				// Only used for writing into a fixed memory region
 	bool mHasError = false;
 };
@@ -42,6 +42,7 @@
 #include "rmxmedia/AudioReference.h"
 #include "rmxmedia/AudioMixer.h"
 #include "rmxmedia/JobManager.h"
+#include "rmxmedia/ParallelFor.h"
 #include "rmxmedia/GuiBase.h"
 #include "rmxmedia/AppFramework.h"
 #include "rmxmedia/FTX_System.h"
@@ -58,6 +59,7 @@
 namespace FTX
 {
 	extern SingletonPtr<rmx::JobManager>		JobManager;
+	extern SingletonPtr<rmx::ParallelFor>		ParallelFor;
 	extern SingletonPtr<rmx::FTX_SystemManager>	System;
 	extern SingletonPtr<rmx::FTX_VideoManager>	Video;
 	extern SingletonPtr<rmx::AudioManager>		Audio;
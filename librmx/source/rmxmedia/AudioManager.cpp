@@ -385,6 +385,15 @@ namespace rmx
 
 	void AudioManager::mixAudioStatic(void* _userdata, uint8* outputStream, int outputBytes)
 	{
+		// This gets called by SDL on its audio thread
+		static thread_local bool threadNameSet = false;
+		if (!threadNameSet)
+		{
+			Tracing::setThreadName("SDL audio callback");
+			threadNameSet = true;
+		}
+
+		RMX_TRACE_SCOPE("AudioManager::mixAudio");
 		FTX::Audio->mixAudio(outputStream, outputBytes);
 	}
 
@@ -286,11 +286,27 @@ void Font::printBitmap(Bitmap& outBitmap, Vec2i& outDrawPosition, const Recti& d
 void Font::printBitmap(Bitmap& outBitmap, Recti& outInnerRect, const StringReader& text, int spacing)
 {
 	// Render text into a bitmap
-	if (nullptr == mFontSource || text.mLength == 0)
+	Recti bounds;
+	if (!getPrintLayout(&outBitmap, bounds, outInnerRect, text, spacing))
 	{
 		outBitmap.clear();
-		return;
 	}
+}
+
+Recti Font::getPrintBounds(const Recti& drawRect, const StringReader& text, int alignment, int spacing)
+{
+	Recti bounds;
+	Recti innerRect;
+	if (!getPrintLayout(nullptr, bounds, innerRect, text, spacing))
+		return Recti();
+
+	return Recti(applyAlignment(drawRect, innerRect, alignment), bounds.getSize());
+}
+
+bool Font::getPrintLayout(Bitmap* outBitmap, Recti& outBounds, Recti& outInnerRect, const StringReader& text, int spacing)
+{
+	if (nullptr == mFontSource || text.mLength == 0)
+		return false;
 
 	std::vector<Font::TypeInfo> typeInfos;
 	std::vector<FontOutput::ExtendedTypeInfo> extendedTypeInfos;
@@ -299,10 +315,7 @@ void Font::printBitmap(Bitmap& outBitmap, Recti& outInnerRect, const StringReade
 	FontOutput* output = FTX::Painter->getFontOutput(*this);
 	output->applyToTypeInfos(extendedTypeInfos, typeInfos);
 	if (extendedTypeInfos.empty())
-	{
-		outBitmap.clear();
-		return;
-	}
+		return false;
 
 	// Get bounds
 	Vec2i boundsMin(+10000, +10000);
@@ -317,12 +330,17 @@ void Font::printBitmap(Bitmap& outBitmap, Recti& outInnerRect, const StringReade
 		boundsMax.y = std::max(boundsMax.y, maxPos.y);
 	}
 
-	// Setup and fill bitmap
-	outBitmap.create(boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y, 0);
+	outBounds.set(boundsMin.x, boundsMin.y, boundsMax.x - boundsMin.x, boundsMax.y - boundsMin.y);
 
-	for (const FontOutput::ExtendedTypeInfo& extendedTypeInfo : extendedTypeInfos)
+	// Setup and fill bitmap
+	if (nullptr != outBitmap)
 	{
-		outBitmap.insertBlend(extendedTypeInfo.mDrawPosition.x - boundsMin.x, extendedTypeInfo.mDrawPosition.y - boundsMin.y, *extendedTypeInfo.mBitmap);
+		outBitmap->create(outBounds.width, outBounds.height, 0);
+
+		for (const FontOutput::ExtendedTypeInfo& extendedTypeInfo : extendedTypeInfos)
+		{
+			outBitmap->insertBlend(extendedTypeInfo.mDrawPosition.x - boundsMin.x, extendedTypeInfo.mDrawPosition.y - boundsMin.y, *extendedTypeInfo.mBitmap);
+		}
 	}
 
 	// Write inner rect
@@ -338,6 +356,7 @@ void Font::printBitmap(Bitmap& outBitmap, Recti& outInnerRect, const StringReade
 		}
 	}
 	outInnerRect.height = mFontSource->getHeight();
+	return true;
 }
 
 Vec2i Font::applyAlignment(const Recti& drawRect, const Recti& innerRect, int alignment)
@@ -134,10 +134,14 @@ public:
 	void printBitmap(Bitmap& outBitmap, Vec2i& outDrawPosition, const Recti& drawRect, const StringReader& text, int alignment = 1, int spacing = 0);
 	void printBitmap(Bitmap& outBitmap, Recti& outInnerRect, const StringReader& text, int spacing = 0);
 
+	// Returns the rect that "printBitmap" would cover, without actually rendering the text
+	Recti getPrintBounds(const Recti& drawRect, const StringReader& text, int alignment = 1, int spacing = 0);
+
 	static Vec2i applyAlignment(const Recti& drawRect, const Recti& innerRect, int alignment);
 
 private:
 	bool rebuildFontSource();
+	bool getPrintLayout(Bitmap* outBitmap, Recti& outBounds, Recti& outInnerRect, const StringReader& text, int spacing);
 
 private:
 	FontSource* mFontSource = nullptr;
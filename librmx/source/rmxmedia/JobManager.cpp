@@ -301,9 +301,9 @@ namespace rmx
 
 
 	JobWorkerThread::JobWorkerThread(JobManager& jobManager, int index) :
+		ThreadBase("rmx JobWorkerThread " + std::to_string(index)),
 		mJobManager(jobManager)
 	{
-		// Index goes unused at the moment
 	}
 
 	void JobWorkerThread::threadFunc()
@@ -0,0 +1,199 @@
+/*
+*	rmx Library
+*	Copyright (C) 2008-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*/
+
+#include "../rmxmedia.h"
+
+
+namespace rmx
+{
+	namespace
+	{
+		// Set while the current thread executes a range function, to detect nested calls
+		//  -> The execute mutex can't be used for this, as SDL mutexes are recursive
+		thread_local bool tInsideRangeFunction = false;
+	}
+
+
+	ParallelFor::ParallelFor()
+	{
+		mMutex = SDL_CreateMutex();
+		mExecuteMutex = SDL_CreateMutex();
+		mWakeUpCondition = SDL_CreateCond();
+		mDoneCondition = SDL_CreateCond();
+	}
+
+	ParallelFor::~ParallelFor()
+	{
+		stopAllThreads();
+		SDL_DestroyCond(mDoneCondition);
+		SDL_DestroyCond(mWakeUpCondition);
+		SDL_DestroyMutex(mExecuteMutex);
+		SDL_DestroyMutex(mMutex);
+	}
+
+	void ParallelFor::setMaxThreads(int count)
+	{
+		count = (count < 0) ? -1 : clamp(count, 0, 16);
+		if (count != mMaxThreads)
+		{
+			// Threads will get recreated on demand
+			SDL_LockMutex(mExecuteMutex);
+			stopAllThreads();
+			mMaxThreads = count;
+			SDL_UnlockMutex(mExecuteMutex);
+		}
+	}
+
+	int ParallelFor::getMaxThreads() const
+	{
+		if (mMaxThreads >= 0)
+			return mMaxThreads;
+
+		// Leave one core for the calling thread
+		return clamp(SDL_GetCPUCount() - 1, 0, 16);
+	}
+
+	void ParallelFor::execute(int numItems, int minItemsPerTask, const RangeFunction& function)
+	{
+		if (numItems <= 0)
+			return;
+
+		// Check if it's worth splitting the work at all
+		const int maxThreads = getMaxThreads();
+		minItemsPerTask = std::max(minItemsPerTask, 1);
+		const int maxTasks = std::min((numItems + minItemsPerTask - 1) / minItemsPerTask, (maxThreads + 1) * 4);
+		if (maxThreads == 0 || maxTasks <= 1 || tInsideRangeFunction || SDL_TryLockMutex(mExecuteMutex) != 0)
+		{
+			function(0, numItems);
+			return;
+		}
+
+		startThreads();
+
+		// Setup a new batch and wake up the worker threads
+		SDL_LockMutex(mMutex);
+		++mBatchIndex;
+		const uint32 batchIndex = mBatchIndex;
+		mFunction = &function;
+		mNumItems = numItems;
+		mNumTasks = maxTasks;
+		mNextTask = 0;
+		mFinishedTasks = 0;
+		SDL_CondBroadcast(mWakeUpCondition);
+		SDL_UnlockMutex(mMutex);
+
+		// Take part in the processing
+		processTasks(batchIndex);
+
+		// Wait for the tasks still being executed by worker threads
+		SDL_LockMutex(mMutex);
+		while (mFinishedTasks < mNumTasks)
+		{
+			SDL_CondWait(mDoneCondition, mMutex);
+		}
+		mFunction = nullptr;
+		SDL_UnlockMutex(mMutex);
+
+		SDL_UnlockMutex(mExecuteMutex);
+	}
+
+	void ParallelFor::startThreads()
+	{
+		const int maxThreads = getMaxThreads();
+		while ((int)mThreads.size() < maxThreads)
+		{
+			ParallelForWorkerThread* thread = new ParallelForWorkerThread(*this);
+			mThreads.push_back(thread);
+			thread->startThread();
+		}
+	}
+
+	void ParallelFor::stopAllThreads()
+	{
+		for (ParallelForWorkerThread* thread : mThreads)
+		{
+			thread->wakeUpForStop();
+		}
+		for (ParallelForWorkerThread* thread : mThreads)
+		{
+			thread->joinThread();
+		}
+		for (ParallelForWorkerThread* thread : mThreads)
+		{
+			delete thread;
+		}
+		mThreads.clear();
+	}
+
+	void ParallelFor::processTasks(uint32 batchIndex)
+	{
+		SDL_LockMutex(mMutex);
+		while (mBatchIndex == batchIndex && mNextTask < mNumTasks)
+		{
+			// Claim the next task
+			const int taskIndex = mNextTask;
+			++mNextTask;
+			const RangeFunction& function = *mFunction;
+			const int beginIndex = (int)((int64)mNumItems * taskIndex / mNumTasks);
+			const int endIndex = (int)((int64)mNumItems * (taskIndex + 1) / mNumTasks);
+			SDL_UnlockMutex(mMutex);
+
+			tInsideRangeFunction = true;
+			function(beginIndex, endIndex);
+			tInsideRangeFunction = false;
+
+			SDL_LockMutex(mMutex);
+			++mFinishedTasks;
+			if (mFinishedTasks >= mNumTasks)
+			{
+				SDL_CondSignal(mDoneCondition);
+			}
+		}
+		SDL_UnlockMutex(mMutex);
+	}
+
+
+
+	ParallelForWorkerThread::ParallelForWorkerThread(ParallelFor& parallelFor) :
+		ThreadBase("rmx ParallelFor"),
+		mParallelFor(parallelFor)
+	{
+	}
+
+	void ParallelForWorkerThread::threadFunc()
+	{
+		uint32 lastBatchIndex = 0;
+		SDL_LockMutex(mParallelFor.mMutex);
+		lastBatchIndex = mParallelFor.mBatchIndex;
+		while (mShouldBeRunning)
+		{
+			if (mParallelFor.mBatchIndex != lastBatchIndex)
+			{
+				lastBatchIndex = mParallelFor.mBatchIndex;
+				SDL_UnlockMutex(mParallelFor.mMutex);
+				mParallelFor.processTasks(lastBatchIndex);
+				SDL_LockMutex(mParallelFor.mMutex);
+			}
+			else
+			{
+				// Using a time-out to have a chance to check if "mShouldBeRunning" changed outside
+				SDL_CondWaitTimeout(mParallelFor.mWakeUpCondition, mParallelFor.mMutex, 100);
+			}
+		}
+		SDL_UnlockMutex(mParallelFor.mMutex);
+	}
+
+	void ParallelForWorkerThread::wakeUpForStop()
+	{
+		SDL_LockMutex(mParallelFor.mMutex);
+		signalStopThread(false);
+		SDL_CondBroadcast(mParallelFor.mWakeUpCondition);
+		SDL_UnlockMutex(mParallelFor.mMutex);
+	}
+
+}
@@ -0,0 +1,78 @@
+/*
+*	rmx Library
+*	Copyright (C) 2008-2022 by Eukaryot
+*
+*	Published under the GNU GPLv3 open source software license, see license.txt
+*	or https://www.gnu.org/licenses/gpl-3.0.en.html
+*
+*	ParallelFor
+*		Splits work on a range of items into tasks that get executed by a pool of worker threads.
+*/
+
+#pragma once
+
+#include <functional>
+
+
+namespace rmx
+{
+	class ParallelForWorkerThread;
+
+
+	class ParallelFor
+	{
+	friend class ParallelForWorkerThread;
+
+	public:
+		// Function to process a part of the items, gets called with the first and the end index of the range
+		typedef std::function<void(int, int)> RangeFunction;
+
+	public:
+		ParallelFor();
+		~ParallelFor();
+
+		// Number of worker threads, in addition to the calling thread; a negative value means it's chosen depending on the CPU count
+		void setMaxThreads(int count);
+		int getMaxThreads() const;
+
+		// Execute the function for all items and return once all are done; the calling thread takes part in processing as well
+		//  -> If the pool is busy already (e.g. this gets called from inside a range function), everything is executed on the calling thread instead
+		void execute(int numItems, int minItemsPerTask, const RangeFunction& function);
+
+	private:
+		void startThreads();
+		void stopAllThreads();
+		void processTasks(uint32 batchIndex);
+
+	private:
+		SDL_mutex* mMutex = nullptr;
+		SDL_mutex* mExecuteMutex = nullptr;
+		SDL_cond* mWakeUpCondition = nullptr;
+		SDL_cond* mDoneCondition = nullptr;
+
+		// Worker threads
+		int mMaxThreads = -1;
+		std::vector<ParallelForWorkerThread*> mThreads;
+
+		// Current batch of tasks, all protected by the mutex
+		const RangeFunction* mFunction = nullptr;
+		uint32 mBatchIndex = 0;
+		int mNumItems = 0;
+		int mNumTasks = 0;
+		int mNextTask = 0;
+		int mFinishedTasks = 0;
+	};
+
+
+
+	class ParallelForWorkerThread final : public ThreadBase
+	{
+	public:
+		ParallelForWorkerThread(ParallelFor& parallelFor);
+		void threadFunc();
+		void wakeUpForStop();
+
+	private:
+		ParallelFor& mParallelFor;
+	};
+}
@@ -56,6 +56,7 @@ namespace rmx
 
 	void ThreadBase::runThreadInternal()
 	{
+		Tracing::setThreadName(mName);
 		mIsThreadRunning = true;
 		mShouldBeRunning = true;
 		threadFunc();
@@ -14,6 +14,7 @@
 namespace FTX
 {
 	SingletonPtr<rmx::JobManager>		 JobManager;
+	SingletonPtr<rmx::ParallelFor>		 ParallelFor;
 	SingletonPtr<rmx::FTX_SystemManager> System;
 	SingletonPtr<rmx::FTX_VideoManager>	 Video;
 	SingletonPtr<rmx::AudioManager>		 Audio;